@@ -0,0 +1,320 @@
+// generated by tools/mkwebui.py from web/index.html, do not edit
+
+#ifndef WEBUI_PAGE_H
+#define WEBUI_PAGE_H
+
+#include <stdint.h>
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#define WEBUI_PAGE_SIZE 4783      // gzip
+#define WEBUI_PAGE_RAW_SIZE 11990
+#define WEBUI_PAGE_ETAG "\"d67a3942\""
+// map record layout the page was built for, checked against map_codec.h
+#define WEBUI_MAP_CODEC_VERSION 3
+#define WEBUI_MAP_CODEC_BUTTON_SIZE 8
+
+const uint8_t WEBUI_PAGE[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x3a, 0x6b, 0x73, 0xdb, 0x38,
+  0x92, 0xdf, 0xf5, 0x2b, 0x30, 0x9c, 0x54, 0x96, 0xba, 0x48, 0x32, 0xf5, 0xa6, 0x1f, 0xf2, 0x94,
+  0x9f, 0x1b, 0xd7, 0xda, 0xb1, 0xca, 0xf2, 0x4e, 0x6e, 0xca, 0xe7, 0xdd, 0x80, 0x24, 0x28, 0x71,
+  0x4c, 0x91, 0x0c, 0x49, 0xd9, 0xd1, 0x66, 0x3c, 0xbf, 0xfd, 0xba, 0xd1, 0x00, 0x1f, 0x92, 0x9c,
+  0xdb, 0xab, 0xba, 0x1b, 0x4f, 0x45, 0x44, 0xa3, 0xd1, 0xdd, 0xe8, 0x37, 0x40, 0x1e, 0xfd, 0x74,
+  0x7e, 0x7b, 0x76, 0xff, 0xdb, 0xf4, 0x82, 0x2d, 0xf2, 0x65, 0x78, 0xdc, 0x38, 0xc2, 0x1f, 0x16,
+  0xf2, 0x68, 0x3e, 0x31, 0x44, 0x64, 0x20, 0x40, 0x70, 0x0f, 0x7e, 0x96, 0x22, 0xe7, 0xcc, 0x5d,
+  0xf0, 0x34, 0x13, 0xf9, 0xc4, 0x58, 0xe5, 0x7e, 0xdb, 0x36, 0x34, 0x38, 0xe2, 0x4b, 0x31, 0x31,
+  0x9e, 0x03, 0xf1, 0x92, 0xc4, 0x69, 0x6e, 0x30, 0x37, 0x8e, 0x72, 0x11, 0x01, 0xda, 0x4b, 0xe0,
+  0xe5, 0x8b, 0x89, 0x27, 0x9e, 0x03, 0x57, 0xb4, 0xe5, 0xa0, 0xc5, 0x82, 0x28, 0xc8, 0x03, 0x1e,
+  0xb6, 0x33, 0x97, 0x87, 0x62, 0xd2, 0x45, 0x22, 0x79, 0x90, 0x87, 0xe2, 0xf8, 0x3a, 0xc8, 0xe1,
+  0x87, 0x7d, 0x14, 0x61, 0x22, 0xd2, 0xa3, 0x3d, 0x02, 0x36, 0x8e, 0xb2, 0x7c, 0x8d, 0xbf, 0x4e,
+  0xec, 0xad, 0xd9, 0x77, 0xe6, 0x03, 0xe9, 0xb6, 0xcf, 0x97, 0x41, 0xb8, 0x3e, 0x60, 0x19, 0x8f,
+  0xb2, 0x76, 0x26, 0xd2, 0xc0, 0x3f, 0x64, 0x4b, 0x9e, 0xce, 0x83, 0xe8, 0x80, 0x59, 0x87, 0xcc,
+  0xe1, 0xee, 0xd3, 0x3c, 0x8d, 0x57, 0x91, 0x77, 0xc0, 0x7e, 0xee, 0xf5, 0x7a, 0x87, 0x20, 0x50,
+  0x18, 0xa7, 0x30, 0x10, 0x42, 0x1c, 0xb2, 0xd7, 0x06, 0x6e, 0x49, 0xa4, 0x40, 0x2d, 0xe1, 0x9e,
+  0x17, 0x44, 0xf3, 0x03, 0xd6, 0xb5, 0x92, 0x6f, 0xac, 0x3b, 0x48, 0xbe, 0x6d, 0xac, 0xee, 0xf7,
+  0xfb, 0x87, 0xcc, 0x0b, 0xb2, 0x24, 0xe4, 0xc0, 0xcf, 0x0f, 0x05, 0x20, 0xe0, 0xbf, 0xed, 0x97,
+  0x94, 0x27, 0x07, 0x0c, 0xff, 0x3d, 0x64, 0x73, 0x7c, 0x44, 0x0a, 0x87, 0x8c, 0x87, 0xc1, 0x3c,
+  0x6a, 0x07, 0xb9, 0x58, 0x66, 0x07, 0xcc, 0x05, 0x1d, 0x88, 0xb4, 0xc2, 0x70, 0xd1, 0xd5, 0x3b,
+  0xc8, 0x82, 0x7f, 0x09, 0x58, 0x63, 0xe3, 0x9a, 0x42, 0x72, 0xc6, 0x57, 0x79, 0x0c, 0x3f, 0x16,
+  0x2e, 0x59, 0xf2, 0x20, 0x7a, 0x43, 0xc2, 0xd7, 0x46, 0x26, 0xdc, 0x3c, 0x88, 0x71, 0xbe, 0xbe,
+  0x57, 0x17, 0xff, 0x60, 0x0b, 0x71, 0x0a, 0xec, 0xda, 0x29, 0xf7, 0x82, 0x15, 0xc8, 0x31, 0xc2,
+  0x45, 0x35, 0x42, 0x9a, 0x69, 0xdb, 0x89, 0xf3, 0x3c, 0x5e, 0x6a, 0x20, 0x08, 0xda, 0xdb, 0x90,
+  0x70, 0x58, 0x97, 0xd0, 0x62, 0x36, 0x21, 0x76, 0x9c, 0x15, 0xac, 0x8c, 0x32, 0x40, 0x2f, 0xd4,
+  0x33, 0x4f, 0x03, 0xef, 0x50, 0xfe, 0xdb, 0x06, 0x05, 0x00, 0x2c, 0x17, 0x6d, 0xd0, 0xfc, 0x6a,
+  0x19, 0x81, 0x10, 0xa9, 0x48, 0x04, 0xcf, 0x4d, 0xdc, 0x62, 0xdb, 0x0f, 0xc2, 0xb0, 0xc5, 0x96,
+  0x41, 0xb4, 0xe4, 0xdf, 0xcc, 0x1e, 0xf2, 0x6e, 0xb1, 0xae, 0x9f, 0x36, 0x9b, 0x35, 0x5d, 0x22,
+  0x93, 0x5c, 0xee, 0x91, 0xb6, 0x13, 0x0a, 0x3f, 0x97, 0x9b, 0x61, 0x59, 0x1c, 0x06, 0x1e, 0xfb,
+  0xd9, 0xb6, 0xed, 0x62, 0x5f, 0x6a, 0x56, 0x49, 0x17, 0x72, 0x47, 0x84, 0x55, 0xd1, 0xc8, 0x72,
+  0xbf, 0xaf, 0xb2, 0x3c, 0xf0, 0xd7, 0x6d, 0xe5, 0x9f, 0xe0, 0x40, 0x09, 0x07, 0xc7, 0x74, 0x44,
+  0xfe, 0x22, 0x44, 0xa4, 0x98, 0x8f, 0xaa, 0x3b, 0xee, 0x03, 0x37, 0x30, 0x47, 0x55, 0x23, 0x7d,
+  0x62, 0x11, 0x44, 0xc9, 0x2a, 0x6f, 0xb1, 0x4c, 0x84, 0x60, 0x8b, 0x16, 0x23, 0x75, 0x6c, 0x28,
+  0xaf, 0xbf, 0xe5, 0x4f, 0x83, 0xc1, 0x60, 0xc3, 0x1b, 0x69, 0x73, 0x80, 0x5c, 0xee, 0x6b, 0x38,
+  0x1c, 0x6e, 0xd9, 0xb0, 0xca, 0xf5, 0x21, 0x5f, 0x27, 0x62, 0x12, 0xad, 0x96, 0x8e, 0x48, 0x1f,
+  0x81, 0xa5, 0x0c, 0x2c, 0x10, 0x5c, 0x69, 0xad, 0x10, 0xa5, 0x30, 0xf9, 0x10, 0x5d, 0xa7, 0x87,
+  0xb3, 0xee, 0x2a, 0xcd, 0x90, 0x77, 0x12, 0x07, 0xda, 0x37, 0x09, 0xbd, 0x93, 0xa4, 0x01, 0x6c,
+  0x7a, 0xbd, 0xe5, 0x52, 0x7c, 0x54, 0xc8, 0xa2, 0xe5, 0x96, 0xb0, 0xd7, 0xc6, 0xcf, 0x59, 0xce,
+  0xf3, 0x55, 0xb6, 0x6b, 0xcf, 0x1a, 0x93, 0x73, 0x2e, 0xed, 0xb8, 0x08, 0x3c, 0x4f, 0x44, 0x55,
+  0x83, 0x44, 0x71, 0x24, 0x43, 0x31, 0x49, 0xc5, 0x06, 0x01, 0x29, 0xe7, 0xcb, 0x02, 0x62, 0xa8,
+  0x2d, 0xcd, 0x03, 0xc2, 0xa6, 0xa2, 0x4d, 0x91, 0x56, 0x09, 0xf2, 0xd7, 0xc6, 0xd1, 0x9e, 0x4a,
+  0x0d, 0x47, 0x7b, 0x2a, 0x47, 0x61, 0x8e, 0x50, 0x19, 0x4b, 0xa4, 0xf8, 0xd0, 0xad, 0x27, 0x15,
+  0x76, 0x04, 0x14, 0x23, 0x16, 0x78, 0x13, 0xc3, 0x7f, 0x31, 0x8e, 0x81, 0x00, 0x0c, 0xe1, 0x07,
+  0xf0, 0x1a, 0x47, 0xd2, 0x67, 0x8e, 0x2f, 0xbc, 0x20, 0x07, 0x36, 0x09, 0xa0, 0x4a, 0xcb, 0x4a,
+  0x64, 0x01, 0x40, 0x89, 0x2e, 0x41, 0xf0, 0x40, 0xb8, 0x7a, 0xcd, 0x09, 0x04, 0xe3, 0xb3, 0xd8,
+  0x5a, 0xc5, 0x25, 0x78, 0xe7, 0xba, 0x42, 0x0c, 0x52, 0xa1, 0x71, 0x1c, 0xc6, 0x1c, 0x4d, 0xa5,
+  0x24, 0x52, 0x3b, 0x92, 0x7b, 0xc0, 0x3c, 0x80, 0x2b, 0x28, 0xe2, 0x71, 0x53, 0xbd, 0xe3, 0x53,
+  0x8a, 0x3d, 0xc0, 0xea, 0x01, 0xc0, 0x0b, 0x9e, 0x99, 0x1b, 0xf2, 0x2c, 0x9b, 0x18, 0x2a, 0x28,
+  0x0d, 0x49, 0x5b, 0x0f, 0x80, 0x2f, 0xa0, 0x00, 0x62, 0x72, 0x7c, 0xa4, 0x7c, 0x43, 0xa1, 0x2b,
+  0x9b, 0x13, 0x7a, 0xc6, 0x51, 0xd8, 0x19, 0xa7, 0x9d, 0x1c, 0xed, 0x11, 0x2a, 0x2c, 0x4e, 0x50,
+  0x9e, 0x92, 0x7f, 0x4d, 0x92, 0x99, 0xc8, 0x73, 0x90, 0x5b, 0x8b, 0xe2, 0xc7, 0xe9, 0x92, 0x88,
+  0x29, 0xb8, 0x51, 0x28, 0xe9, 0x34, 0x5c, 0x89, 0x3c, 0x8e, 0xf3, 0x85, 0xac, 0x16, 0xec, 0x48,
+  0x7a, 0xb2, 0xaa, 0x1c, 0xf8, 0xaf, 0x81, 0xf9, 0x20, 0x14, 0xd1, 0x1c, 0x0a, 0x86, 0x61, 0x1b,
+  0x5b, 0x4a, 0xfe, 0x7c, 0x7d, 0xf2, 0x89, 0xcd, 0x66, 0x57, 0xe7, 0xf5, 0xa5, 0x59, 0x16, 0x78,
+  0xff, 0xd6, 0xd2, 0x04, 0x76, 0xfc, 0x02, 0x7e, 0x5c, 0x5f, 0xae, 0xa1, 0x06, 0x93, 0x31, 0x55,
+  0x19, 0xd7, 0x48, 0x32, 0x70, 0x5a, 0x57, 0x2c, 0xe2, 0x10, 0x6c, 0x02, 0xc5, 0x2f, 0x82, 0x3a,
+  0x18, 0xcd, 0x85, 0xb7, 0xcd, 0xea, 0x64, 0xba, 0x43, 0x46, 0x9e, 0xcc, 0x48, 0x4a, 0xfe, 0x4d,
+  0x93, 0xec, 0x8e, 0x76, 0xae, 0xdd, 0x2d, 0x24, 0x4f, 0xa6, 0xff, 0xc7, 0x62, 0x7e, 0x8c, 0xb3,
+  0x7c, 0xdb, 0x0c, 0x0b, 0x05, 0xfd, 0x9f, 0xf4, 0x79, 0x7d, 0x71, 0xce, 0x9c, 0x34, 0x98, 0x2f,
+  0xf2, 0x48, 0x64, 0x59, 0x9d, 0x46, 0x09, 0xd7, 0xb2, 0xa6, 0x28, 0x83, 0x24, 0x39, 0x31, 0x2c,
+  0xa9, 0x84, 0x89, 0xd1, 0x1b, 0x0e, 0xb7, 0xc9, 0xde, 0xdc, 0x9c, 0x31, 0x6a, 0x15, 0x18, 0x68,
+  0xd0, 0xec, 0xf6, 0xc6, 0x6c, 0x02, 0x05, 0x35, 0x6c, 0xd6, 0x39, 0x2c, 0x97, 0xee, 0x55, 0xa1,
+  0x08, 0x4a, 0x82, 0x1b, 0xd4, 0x61, 0x65, 0x95, 0xfa, 0x9b, 0x6e, 0x4f, 0xce, 0x9e, 0x15, 0x2e,
+  0xac, 0x3c, 0x9e, 0x69, 0x74, 0x62, 0x41, 0x03, 0x8a, 0x91, 0x55, 0xe2, 0x41, 0x51, 0x33, 0x8e,
+  0x2f, 0x83, 0x74, 0xf9, 0xc2, 0x21, 0x75, 0x11, 0x60, 0x33, 0x58, 0x30, 0x0c, 0x7e, 0x10, 0x34,
+  0xe7, 0x01, 0x9f, 0x47, 0xa0, 0xeb, 0xc0, 0xd5, 0x71, 0x83, 0x59, 0x10, 0xe9, 0x7b, 0x30, 0x83,
+  0xa2, 0xc3, 0xb8, 0xbe, 0x7e, 0x4f, 0xa7, 0x01, 0x37, 0x0d, 0x92, 0xfc, 0xb8, 0x01, 0x15, 0x2c,
+  0xcb, 0xd9, 0x25, 0x28, 0x08, 0x92, 0x67, 0xc8, 0xe7, 0x50, 0x21, 0xac, 0x16, 0xb4, 0x67, 0x90,
+  0x3f, 0x5b, 0x90, 0x5b, 0x73, 0xc8, 0x9a, 0xbd, 0x16, 0x7b, 0x16, 0x21, 0x54, 0x8e, 0x56, 0xc3,
+  0x75, 0x0f, 0xd8, 0xa0, 0xc5, 0x62, 0xc8, 0x9c, 0x43, 0xf8, 0xf1, 0x7d, 0x28, 0x16, 0x2d, 0x9d,
+  0xa4, 0xc7, 0xec, 0xf5, 0x50, 0xd1, 0x3b, 0xbd, 0xba, 0x9f, 0x49, 0x92, 0x29, 0x24, 0x2c, 0x9e,
+  0x01, 0x91, 0x87, 0xcb, 0x8e, 0x24, 0xdf, 0x42, 0xf2, 0xdd, 0xc7, 0x16, 0xf3, 0xa3, 0x2a, 0xb0,
+  0x47, 0xc0, 0x65, 0xe0, 0x05, 0x55, 0x70, 0x1f, 0xfe, 0x7f, 0x6c, 0x41, 0x0b, 0xe3, 0xa6, 0x71,
+  0x15, 0x0e, 0xcc, 0xc7, 0x8f, 0x24, 0x26, 0x00, 0xdd, 0x05, 0x51, 0x1d, 0x22, 0x85, 0xa5, 0x5b,
+  0xc0, 0x06, 0x12, 0x56, 0x4a, 0x35, 0x3d, 0xb9, 0xbe, 0xb8, 0xbf, 0xbf, 0x00, 0xc1, 0x1e, 0x1e,
+  0x8c, 0x93, 0x10, 0xfc, 0x03, 0x73, 0x89, 0xd1, 0x32, 0x7c, 0xcb, 0xb7, 0x7d, 0xdf, 0x78, 0x6c,
+  0x01, 0x18, 0xfa, 0xd0, 0xc5, 0x3a, 0xcb, 0x01, 0xba, 0xbf, 0x3f, 0x1a, 0xb9, 0x2e, 0x41, 0xa3,
+  0x3c, 0xf8, 0xba, 0x12, 0x9f, 0xb1, 0x98, 0x20, 0x3e, 0x17, 0x8e, 0x37, 0xa6, 0x99, 0xaf, 0x2b,
+  0x0e, 0x10, 0xcb, 0xf2, 0x7d, 0x4d, 0x01, 0x20, 0xe0, 0x15, 0x41, 0x84, 0x98, 0x63, 0x80, 0x7a,
+  0x03, 0x82, 0xff, 0x6b, 0x95, 0x2a, 0x66, 0x1a, 0xf5, 0x54, 0x04, 0x73, 0x09, 0x1a, 0xfa, 0x43,
+  0x8f, 0x38, 0x9d, 0x06, 0xd9, 0x57, 0x92, 0xc9, 0x17, 0x03, 0x97, 0x56, 0x9e, 0x42, 0x30, 0x3e,
+  0x49, 0x26, 0xf8, 0x9f, 0x06, 0x41, 0x50, 0x0a, 0xef, 0x24, 0x5c, 0xc6, 0x91, 0x47, 0xe8, 0x8e,
+  0xeb, 0xa9, 0x39, 0x49, 0x00, 0x71, 0x35, 0x1f, 0x80, 0xfc, 0x1a, 0xc4, 0xa1, 0xc0, 0x6d, 0xd9,
+  0xbc, 0xe7, 0x88, 0x1e, 0xc1, 0xd3, 0xf8, 0x25, 0x02, 0x10, 0x1f, 0xf6, 0x78, 0x8f, 0x13, 0x68,
+  0x95, 0x86, 0xeb, 0xcf, 0x71, 0x8c, 0x34, 0x3d, 0xe1, 0xd8, 0x36, 0x6d, 0xf3, 0x0c, 0x8a, 0x48,
+  0xae, 0x08, 0x0f, 0xfd, 0x7d, 0xc1, 0x49, 0x8c, 0x33, 0x68, 0xe3, 0xf3, 0x54, 0xac, 0x32, 0xbd,
+  0x57, 0x4b, 0xc3, 0x63, 0x70, 0x0a, 0x2e, 0x95, 0xe5, 0xf5, 0x46, 0xfb, 0x5d, 0x41, 0xe0, 0x38,
+  0xe5, 0xa1, 0x14, 0x76, 0xec, 0x0f, 0x2d, 0x0d, 0x8a, 0xfc, 0x30, 0x7e, 0x11, 0xa9, 0xa2, 0x3e,
+  0x1a, 0xec, 0x0f, 0x85, 0x57, 0xcc, 0x65, 0x41, 0xf8, 0x24, 0x57, 0xf8, 0xb6, 0xd2, 0xd0, 0x19,
+  0x04, 0x5d, 0x16, 0xa3, 0xd8, 0x9e, 0xdb, 0x1d, 0xf4, 0x15, 0x70, 0xcd, 0xa3, 0xba, 0x19, 0xce,
+  0x79, 0xfa, 0x54, 0xd1, 0x84, 0xed, 0x14, 0xd0, 0x02, 0xd7, 0x76, 0x2a, 0xd0, 0xbf, 0x62, 0xb2,
+  0x8b, 0x52, 0xb9, 0x71, 0xd8, 0xf6, 0xc8, 0xaa, 0x4c, 0xa5, 0x7c, 0x8d, 0x5a, 0xda, 0xc7, 0xbf,
+  0x0a, 0x14, 0x5a, 0x3d, 0x49, 0x67, 0x34, 0x50, 0xdb, 0x46, 0xf0, 0xdf, 0x16, 0xfc, 0x29, 0x40,
+  0x1a, 0x9e, 0x33, 0x1e, 0x95, 0x34, 0x6e, 0xf8, 0x1c, 0x1a, 0x45, 0x74, 0x15, 0xdb, 0xa9, 0x49,
+  0x73, 0x1b, 0x42, 0x6d, 0xd7, 0xb4, 0x86, 0xc3, 0x91, 0xd3, 0x2b, 0xe5, 0xbf, 0xa5, 0x94, 0x87,
+  0xdb, 0xb7, 0xdd, 0x0a, 0x8f, 0xdb, 0xd4, 0x85, 0x46, 0x48, 0xba, 0x68, 0xbf, 0xa7, 0x5c, 0x14,
+  0xe1, 0x77, 0xc2, 0x53, 0x0c, 0x2a, 0xc8, 0x33, 0x8e, 0x3e, 0x02, 0x70, 0x01, 0x0e, 0x3d, 0xe6,
+  0x25, 0x5c, 0x70, 0xcd, 0xd6, 0xf6, 0x1d, 0xd7, 0x2e, 0xd9, 0xce, 0xd0, 0x72, 0x4a, 0x77, 0x03,
+  0xbb, 0xef, 0x55, 0xa4, 0x95, 0x53, 0x4a, 0x1f, 0x3d, 0x7f, 0x00, 0x7f, 0xc5, 0xd4, 0xfd, 0x2a,
+  0xfd, 0xba, 0x8a, 0x83, 0x8c, 0x34, 0xee, 0x0a, 0xaf, 0x5b, 0x4c, 0x15, 0xbe, 0xb7, 0x0f, 0x9a,
+  0xf2, 0xfa, 0x04, 0x17, 0x22, 0x99, 0x06, 0x11, 0x19, 0xb7, 0x3b, 0xd8, 0x27, 0xe8, 0x65, 0x88,
+  0x2e, 0x52, 0xc4, 0x99, 0xef, 0x73, 0x9f, 0x76, 0x72, 0x19, 0xa7, 0x22, 0xcb, 0xb5, 0xc0, 0xbd,
+  0x9e, 0xed, 0xf4, 0xc8, 0x87, 0x2f, 0x57, 0xee, 0x22, 0x0b, 0xb8, 0xc4, 0x2e, 0x1c, 0xfe, 0xaf,
+  0x90, 0xe4, 0x32, 0x68, 0x36, 0x63, 0xe9, 0x25, 0xf8, 0x47, 0x60, 0x2c, 0x4c, 0x05, 0x71, 0xbb,
+  0x08, 0x7a, 0xb4, 0xbd, 0x24, 0xe0, 0x8d, 0x95, 0xe2, 0xaa, 0xde, 0xe0, 0x71, 0x88, 0x0f, 0x05,
+  0xa6, 0x9d, 0xdb, 0x16, 0xfe, 0x29, 0x88, 0xf6, 0x02, 0x5b, 0x2b, 0x5d, 0x82, 0x7e, 0x13, 0x21,
+  0x78, 0x35, 0x7a, 0x8d, 0xe7, 0xfb, 0xca, 0xa4, 0x1f, 0xa1, 0x55, 0x5d, 0x7b, 0xe2, 0x45, 0x27,
+  0x01, 0x4b, 0x41, 0xf3, 0x42, 0x0f, 0xa3, 0x7d, 0x87, 0x42, 0xfe, 0x2a, 0x82, 0x0c, 0x1e, 0x91,
+  0x3d, 0x5d, 0x6f, 0xe8, 0x0e, 0xdd, 0x02, 0x3c, 0xc7, 0x4d, 0x0d, 0xd0, 0x89, 0x48, 0x01, 0x57,
+  0xcf, 0x71, 0xba, 0x26, 0x65, 0x69, 0x92, 0xda, 0x07, 0x7d, 0x4b, 0x8c, 0x6c, 0x5a, 0x79, 0x0d,
+  0x15, 0x2a, 0x82, 0x6a, 0x8e, 0x7e, 0x30, 0x12, 0x23, 0x9f, 0xd7, 0xa0, 0x60, 0xec, 0x6c, 0x41,
+  0x34, 0x2c, 0x7f, 0xa8, 0xa6, 0x5e, 0x22, 0xbd, 0xb9, 0xb1, 0xeb, 0x6b, 0xf7, 0xbb, 0x16, 0xe0,
+  0x4c, 0x67, 0x8b, 0xc0, 0xf7, 0xa5, 0x4f, 0xa1, 0x85, 0x54, 0xda, 0xb9, 0xc6, 0x7a, 0xad, 0xbc,
+  0x06, 0xce, 0x0b, 0xb6, 0x18, 0x95, 0xe0, 0x22, 0xf0, 0x4b, 0xc5, 0x11, 0x9c, 0x42, 0x51, 0x94,
+  0x61, 0x2b, 0xc1, 0x85, 0xf6, 0x0b, 0x2d, 0x82, 0x1f, 0x70, 0xaf, 0x57, 0xc1, 0x50, 0x92, 0xed,
+  0x5b, 0x42, 0xec, 0x5b, 0x35, 0x38, 0xea, 0xc2, 0xeb, 0xe3, 0x5f, 0x09, 0x2e, 0x14, 0xec, 0x8c,
+  0xdc, 0x6e, 0x09, 0x2e, 0x42, 0x03, 0x76, 0x61, 0xa9, 0xd0, 0xa0, 0x89, 0x32, 0x36, 0x7a, 0x96,
+  0xd3, 0xe3, 0xd5, 0xa9, 0xa7, 0xb5, 0xda, 0xa4, 0x3d, 0x76, 0x85, 0x5f, 0x9d, 0xa9, 0xc4, 0xc6,
+  0x78, 0x6c, 0xdb, 0xfb, 0xfb, 0x5b, 0x73, 0x62, 0xe7, 0x5c, 0x2e, 0x44, 0xa8, 0x68, 0x3a, 0x96,
+  0x3b, 0xf0, 0x44, 0x39, 0x57, 0x2a, 0x00, 0xfe, 0x13, 0x7a, 0xa3, 0x4b, 0xa1, 0x72, 0x9d, 0x55,
+  0x42, 0xb4, 0xbc, 0x90, 0x10, 0xbc, 0xbe, 0xd6, 0x54, 0x24, 0x41, 0x18, 0x44, 0xca, 0x1a, 0x65,
+  0x1a, 0xaa, 0x44, 0xcb, 0x0d, 0x4f, 0x63, 0xa9, 0x06, 0xbb, 0x2c, 0x30, 0x37, 0x70, 0x54, 0x59,
+  0x2d, 0x6b, 0xb5, 0x0c, 0xaa, 0xa1, 0xa7, 0x34, 0x41, 0xb3, 0x95, 0xf4, 0xaa, 0x7c, 0x80, 0xe0,
+  0x45, 0x7a, 0x72, 0xf8, 0x70, 0xa8, 0xcc, 0x40, 0x33, 0xd3, 0x55, 0x9a, 0x84, 0xb8, 0x66, 0xbf,
+  0x3f, 0xb6, 0x3c, 0xa7, 0x32, 0x53, 0xd1, 0x78, 0xdf, 0x75, 0xfa, 0xe3, 0x6e, 0x75, 0xae, 0x92,
+  0x8f, 0xc6, 0xce, 0xc8, 0x16, 0xa2, 0x3a, 0x09, 0x4d, 0x58, 0x34, 0x2f, 0xc3, 0xd0, 0x87, 0x24,
+  0x5d, 0x99, 0xae, 0x66, 0xa5, 0x81, 0xed, 0x75, 0x55, 0xb6, 0xa4, 0x49, 0xca, 0x4b, 0x2a, 0xca,
+  0xc6, 0xdd, 0xa1, 0x4d, 0xae, 0x7f, 0x13, 0x78, 0x51, 0xc5, 0x99, 0xbb, 0xfb, 0xdd, 0xfd, 0xb1,
+  0xd2, 0x0a, 0x1c, 0x76, 0xcf, 0x52, 0xc1, 0x97, 0x54, 0xb4, 0x7d, 0x65, 0xfe, 0x9b, 0x00, 0x0e,
+  0x90, 0x77, 0x71, 0xa6, 0xeb, 0xb6, 0x50, 0xd2, 0xc7, 0xae, 0xcb, 0xb3, 0x20, 0x52, 0x50, 0x87,
+  0xa8, 0x7f, 0xe2, 0xcf, 0xfc, 0xf7, 0xb8, 0x4c, 0x71, 0x1e, 0x1c, 0xd0, 0xf4, 0xc4, 0x5a, 0x57,
+  0x2b, 0x62, 0x77, 0x1b, 0x7a, 0xd7, 0xd0, 0x87, 0x23, 0x9a, 0xe7, 0x0f, 0x95, 0x09, 0x65, 0xc1,
+  0x50, 0x49, 0xc8, 0xb2, 0x4a, 0xd0, 0x79, 0xca, 0x1d, 0xb4, 0x92, 0x63, 0x8b, 0x1e, 0xe9, 0xbc,
+  0x52, 0x3e, 0xf8, 0x50, 0xa3, 0x4a, 0x18, 0x6d, 0xd9, 0xf7, 0x07, 0x25, 0x58, 0x99, 0xcc, 0xe3,
+  0x60, 0x18, 0x62, 0x34, 0xe5, 0xa1, 0xa8, 0xe6, 0x41, 0x21, 0x84, 0xad, 0xec, 0x2f, 0xa7, 0x74,
+  0x08, 0x42, 0xf5, 0xd8, 0xb7, 0x0b, 0x70, 0x55, 0xe1, 0xdc, 0x87, 0x35, 0xa2, 0x98, 0xaa, 0xaa,
+  0x1b, 0xaa, 0xa3, 0xa5, 0x72, 0xfe, 0x94, 0x27, 0x7c, 0xcd, 0x41, 0x21, 0x09, 0x29, 0xca, 0xf7,
+  0x48, 0x51, 0x53, 0xc1, 0xdd, 0xc5, 0x74, 0x05, 0x4e, 0x2a, 0xd5, 0xc4, 0x9d, 0x7d, 0x05, 0x4e,
+  0x57, 0x32, 0x2b, 0xda, 0xc3, 0x3e, 0xf9, 0x6f, 0x11, 0xdd, 0xae, 0xe5, 0x92, 0x4f, 0x4d, 0x43,
+  0x2e, 0x77, 0xe3, 0xba, 0xc3, 0x61, 0x5f, 0x71, 0x09, 0x57, 0x68, 0x35, 0xcf, 0xe3, 0x96, 0x47,
+  0xfa, 0x9e, 0xc6, 0x2f, 0x5e, 0xd1, 0x76, 0x38, 0x96, 0xd0, 0x31, 0x52, 0x38, 0xa9, 0x5d, 0x5a,
+  0x42, 0x2b, 0xac, 0x88, 0x0f, 0xb0, 0xf6, 0x5a, 0xb7, 0x4f, 0x58, 0x3c, 0x55, 0xf9, 0xbc, 0x8b,
+  0xd7, 0x5c, 0xc7, 0xf2, 0xa0, 0x3b, 0xda, 0x57, 0x9e, 0x30, 0x83, 0x84, 0x18, 0x0a, 0x8d, 0x6f,
+  0x3b, 0x83, 0x61, 0xb7, 0xaf, 0x26, 0x74, 0x06, 0xe2, 0xb6, 0x35, 0xee, 0x29, 0x58, 0xe4, 0x15,
+  0xb4, 0xfd, 0x01, 0x1f, 0x8c, 0x88, 0x65, 0x35, 0x29, 0x09, 0xdb, 0x19, 0x8e, 0x35, 0x34, 0x5b,
+  0x40, 0x96, 0xa0, 0x1c, 0x31, 0x54, 0xea, 0x9e, 0x05, 0x22, 0x8a, 0x30, 0xcc, 0xb9, 0x35, 0xec,
+  0xf5, 0x3c, 0x05, 0x0b, 0x9f, 0x65, 0x01, 0x00, 0x35, 0xc1, 0x1f, 0xc1, 0x6a, 0xd9, 0x4c, 0x90,
+  0xf6, 0xaa, 0xf1, 0x36, 0xe2, 0x43, 0x9d, 0xe0, 0x6b, 0xf9, 0x0d, 0x14, 0xa3, 0xf2, 0x6e, 0x2d,
+  0xb5, 0x55, 0xc0, 0x91, 0xce, 0x5b, 0x5c, 0x45, 0xc9, 0x56, 0xa4, 0x42, 0x17, 0x48, 0x13, 0x95,
+  0x04, 0x38, 0x18, 0xd9, 0x3d, 0x55, 0x03, 0xef, 0x65, 0x6d, 0xf0, 0x60, 0xa8, 0x6a, 0xd8, 0xbd,
+  0x90, 0x45, 0xc4, 0x2a, 0x8b, 0xc8, 0xfd, 0x02, 0x22, 0x4f, 0xda, 0x0a, 0x9a, 0x14, 0xdf, 0x23,
+  0x2f, 0xbc, 0x8f, 0x97, 0x3c, 0x8f, 0xa9, 0x9e, 0xf6, 0x07, 0xa4, 0xa5, 0x5a, 0x1a, 0x00, 0x53,
+  0x7b, 0xb4, 0xbe, 0x68, 0x4c, 0xc0, 0xb5, 0x7b, 0x4a, 0x75, 0x9f, 0x17, 0x82, 0xe7, 0x32, 0xbe,
+  0xa1, 0xff, 0xed, 0x2b, 0x50, 0xd1, 0x8f, 0xe8, 0x3a, 0x25, 0x41, 0xb3, 0x65, 0xfc, 0xa4, 0xfb,
+  0x77, 0x55, 0x36, 0x6b, 0x09, 0x5b, 0xf9, 0x0a, 0xc1, 0x8a, 0x78, 0xe1, 0x94, 0xa0, 0x1f, 0xf5,
+  0xb1, 0xe4, 0xe3, 0xc5, 0xc9, 0xf9, 0xc5, 0x1d, 0x9c, 0x4a, 0xec, 0x16, 0xfb, 0xf5, 0xe2, 0x6e,
+  0x76, 0x75, 0xfb, 0x09, 0x06, 0x70, 0xf4, 0xb9, 0x39, 0x99, 0xe2, 0x29, 0xaa, 0xdb, 0xb3, 0x35,
+  0xea, 0xcd, 0xd5, 0xf9, 0x15, 0x1e, 0x5f, 0x8c, 0x4f, 0x31, 0x0a, 0xc4, 0x8c, 0xb3, 0x33, 0xfc,
+  0x17, 0x0e, 0xbc, 0xf8, 0x33, 0x3d, 0x03, 0x76, 0x6c, 0x7a, 0x46, 0xab, 0x4f, 0x4f, 0x3e, 0xfd,
+  0xed, 0x9f, 0x9f, 0x6e, 0x3f, 0x5d, 0x6c, 0x90, 0xb8, 0x39, 0x93, 0x14, 0x70, 0xc1, 0xec, 0xfe,
+  0x76, 0x2a, 0x17, 0x5e, 0x9f, 0xfc, 0x86, 0xbf, 0xe7, 0x17, 0x97, 0x17, 0x77, 0x77, 0x70, 0x28,
+  0xd7, 0x80, 0xcb, 0x93, 0xd9, 0x3d, 0xbb, 0xbc, 0xbd, 0xfb, 0x7c, 0x72, 0x77, 0x8e, 0xe3, 0xbb,
+  0x8b, 0xcf, 0x57, 0x9f, 0xd4, 0xd3, 0xd9, 0xed, 0xdd, 0x39, 0x9b, 0xdd, 0xdf, 0xdd, 0x9e, 0x5e,
+  0x54, 0x00, 0x17, 0xff, 0x79, 0x75, 0x5f, 0x19, 0x4e, 0x4f, 0xfe, 0x3e, 0x93, 0xd3, 0xf4, 0x50,
+  0xec, 0xf9, 0x1d, 0xc8, 0x10, 0x78, 0x6c, 0x72, 0xcc, 0xbc, 0xd8, 0x5d, 0x2d, 0xa1, 0x26, 0x75,
+  0xe6, 0x22, 0xbf, 0x08, 0x05, 0x3e, 0x9e, 0xae, 0xaf, 0x3c, 0x33, 0xf0, 0x9a, 0x87, 0x0d, 0x30,
+  0x0e, 0x1c, 0x21, 0x5d, 0xbc, 0xc8, 0x98, 0xb0, 0x68, 0x15, 0x86, 0x87, 0x6c, 0x6f, 0x8f, 0xe5,
+  0x0b, 0xba, 0x23, 0x53, 0x33, 0x3c, 0x83, 0x27, 0xee, 0xb5, 0x18, 0xde, 0xae, 0x09, 0x8f, 0x05,
+  0x11, 0x5d, 0x5f, 0xb0, 0x2c, 0x66, 0x7e, 0x20, 0x42, 0x2f, 0x63, 0xab, 0xe8, 0x09, 0xdc, 0x31,
+  0x62, 0x0b, 0x01, 0xe7, 0xe3, 0x6c, 0x95, 0x3e, 0x43, 0xbe, 0x6c, 0xf8, 0xab, 0x88, 0x2e, 0xbf,
+  0xdd, 0xd4, 0xed, 0xf7, 0x4c, 0x67, 0x9d, 0x8b, 0xac, 0xc9, 0xbe, 0x4b, 0xa6, 0x2e, 0xf0, 0xfb,
+  0xd3, 0x3a, 0x6c, 0xc0, 0x01, 0x9c, 0x99, 0x24, 0xb2, 0x03, 0xe7, 0x5d, 0x56, 0x20, 0xb9, 0xec,
+  0x1f, 0x13, 0xe6, 0x28, 0x04, 0x5c, 0xf1, 0x04, 0x2b, 0xac, 0x43, 0xf8, 0x39, 0x62, 0x36, 0xfc,
+  0x7c, 0xf8, 0xd0, 0x94, 0x44, 0x4c, 0x97, 0x1d, 0x1f, 0x1f, 0xb3, 0x6e, 0x93, 0xfd, 0x83, 0x99,
+  0xd6, 0xb7, 0x8b, 0xf3, 0x53, 0xdb, 0xee, 0xf7, 0x2c, 0xf6, 0x9e, 0xb5, 0x61, 0xea, 0x3d, 0x4c,
+  0xc0, 0x36, 0x5f, 0x1b, 0xa9, 0xc8, 0x57, 0x69, 0xc4, 0xfe, 0x24, 0x6c, 0x0b, 0x41, 0x85, 0x78,
+  0x74, 0xb5, 0x67, 0xe6, 0xe2, 0x5b, 0x0e, 0x9c, 0xd9, 0x3b, 0x53, 0x5f, 0xf6, 0x35, 0x3b, 0x08,
+  0x3b, 0xa3, 0x3b, 0x68, 0xe0, 0x85, 0x23, 0xbc, 0xcf, 0x2c, 0x56, 0xc6, 0x09, 0xfe, 0x64, 0xa6,
+  0xbe, 0x5b, 0xc6, 0x7b, 0x0f, 0x38, 0x3d, 0xfb, 0x41, 0x9a, 0x21, 0xa9, 0x06, 0xc1, 0x3b, 0x41,
+  0x14, 0x89, 0xf4, 0xe3, 0xfd, 0xcd, 0x35, 0x2a, 0x19, 0x51, 0x3a, 0xa0, 0x5d, 0xd3, 0x8c, 0x5a,
+  0x2c, 0x68, 0xa2, 0x89, 0x22, 0xf6, 0x0b, 0xfb, 0x72, 0x44, 0xc4, 0xd8, 0x33, 0x87, 0x40, 0x9d,
+  0x18, 0xef, 0xbe, 0x07, 0xec, 0x03, 0x33, 0x25, 0x29, 0xf6, 0xc7, 0x1f, 0xcc, 0x6a, 0xbe, 0x1a,
+  0xc7, 0xef, 0xbe, 0x47, 0xaf, 0x47, 0x7b, 0x84, 0x78, 0xfc, 0x85, 0x1d, 0x30, 0x03, 0x64, 0xfc,
+  0x3d, 0x0e, 0x22, 0x13, 0x1e, 0x6a, 0x7b, 0x82, 0xb3, 0xab, 0xfb, 0x64, 0x3a, 0x52, 0x93, 0x52,
+  0xbb, 0xa1, 0x88, 0x80, 0xbb, 0xf3, 0x30, 0x7a, 0x64, 0x7f, 0xc0, 0xcf, 0xf8, 0x91, 0x1d, 0xa1,
+  0x22, 0x1b, 0x81, 0xcf, 0x4c, 0xa7, 0x43, 0x77, 0x48, 0xa0, 0x5a, 0x15, 0x2b, 0x1f, 0x24, 0xfe,
+  0x07, 0x36, 0x40, 0xd6, 0xce, 0x83, 0xf5, 0xc8, 0x7e, 0x9a, 0xb0, 0xf1, 0x88, 0x46, 0x5d, 0x1a,
+  0x8d, 0x69, 0xd4, 0x93, 0x23, 0x15, 0x57, 0x4d, 0xa6, 0x14, 0xed, 0xf3, 0x30, 0x13, 0xda, 0x19,
+  0xc1, 0xfe, 0x68, 0x29, 0xe7, 0xa1, 0x4a, 0x9d, 0xe4, 0xd8, 0xe0, 0xd7, 0x25, 0xb1, 0x76, 0x4d,
+  0xf5, 0xe4, 0x54, 0x77, 0xb4, 0x6b, 0xae, 0x2f, 0xe7, 0x7a, 0x83, 0xa6, 0xb6, 0xae, 0x92, 0x42,
+  0x39, 0x5e, 0x27, 0x5b, 0x39, 0x3c, 0x85, 0xc4, 0x6a, 0x5a, 0xad, 0xda, 0x0e, 0x9b, 0xa0, 0xfe,
+  0xc9, 0x04, 0xd1, 0x6a, 0xca, 0x93, 0x4e, 0x6d, 0xca, 0x5b, 0x29, 0x7c, 0x0b, 0x96, 0xac, 0xa4,
+  0x5f, 0x28, 0x9a, 0x5f, 0xd4, 0x25, 0xd8, 0xbb, 0xef, 0xf2, 0xf7, 0x95, 0x81, 0xa5, 0x10, 0xe5,
+  0x55, 0xdf, 0x63, 0x7d, 0xa9, 0xb9, 0x08, 0xdd, 0x7b, 0x99, 0x4f, 0x62, 0x2d, 0xdf, 0xa3, 0xb4,
+  0xf0, 0xe2, 0xab, 0x46, 0x8d, 0x6e, 0xcc, 0xea, 0x97, 0x64, 0x1e, 0xcf, 0x79, 0xdb, 0x47, 0x27,
+  0x80, 0x75, 0xaf, 0xea, 0xd2, 0xec, 0xdd, 0x77, 0xf8, 0x79, 0x55, 0x37, 0x67, 0x30, 0xe0, 0xdf,
+  0xc0, 0x23, 0xea, 0xcc, 0xc8, 0xdf, 0x88, 0xd9, 0xa6, 0x2f, 0x16, 0x0c, 0xd5, 0xc5, 0xf7, 0x06,
+  0x0f, 0x70, 0xa7, 0x0f, 0xff, 0x8f, 0xce, 0x09, 0xe8, 0x46, 0x71, 0xbd, 0x6e, 0xd4, 0x5d, 0x15,
+  0x6f, 0xb7, 0x4e, 0xe5, 0x8b, 0x0b, 0xd3, 0x0b, 0x9e, 0x5b, 0x2c, 0x29, 0xbd, 0x56, 0xce, 0x81,
+  0xef, 0xa8, 0x9b, 0xa5, 0x07, 0xca, 0x48, 0x0f, 0x09, 0x90, 0xbb, 0xec, 0xc8, 0x49, 0x4c, 0xf3,
+  0xb0, 0xaa, 0x23, 0xdf, 0x30, 0x74, 0xe8, 0xfd, 0xc7, 0x99, 0x5a, 0x45, 0xab, 0x7f, 0x61, 0xc6,
+  0xcf, 0x06, 0x2c, 0x90, 0x23, 0x74, 0x5e, 0x94, 0xac, 0x26, 0x41, 0x2a, 0xcf, 0x68, 0x66, 0xc9,
+  0x56, 0xbf, 0x32, 0x9b, 0xa8, 0x14, 0xf8, 0x30, 0x80, 0xbc, 0x8f, 0x6f, 0x3d, 0x4a, 0xc8, 0xf0,
+  0x91, 0xb2, 0xa7, 0x7c, 0x0b, 0x3b, 0x91, 0x14, 0x8b, 0x54, 0x15, 0x50, 0xaa, 0x0a, 0x20, 0x9e,
+  0x14, 0x25, 0x18, 0x60, 0xc2, 0xfa, 0xde, 0x90, 0xe8, 0x1f, 0x26, 0xa0, 0xd1, 0xea, 0xcb, 0x80,
+  0x3c, 0x52, 0x36, 0x77, 0xa4, 0x6e, 0x41, 0x99, 0xe5, 0xcb, 0x03, 0x46, 0xca, 0xee, 0xbe, 0xca,
+  0x1b, 0x48, 0xb4, 0x12, 0xb9, 0xa7, 0x21, 0x6b, 0x95, 0xde, 0x83, 0xa1, 0x5f, 0x70, 0x99, 0x06,
+  0xde, 0xf1, 0xc1, 0x10, 0xa7, 0x9b, 0xcd, 0x46, 0x81, 0x7e, 0xb6, 0xe0, 0x90, 0x86, 0xa0, 0xbe,
+  0x6b, 0x97, 0x34, 0x5c, 0x38, 0x91, 0xe2, 0x2d, 0x64, 0x77, 0xd4, 0x6c, 0x96, 0x64, 0x55, 0xe5,
+  0xd3, 0x48, 0x11, 0x0d, 0xf1, 0xfa, 0xaf, 0x37, 0xae, 0xe2, 0xfd, 0x2a, 0xc2, 0xd8, 0x0d, 0xf2,
+  0x75, 0x05, 0xf7, 0x59, 0x92, 0xd7, 0xa8, 0x15, 0xd6, 0x67, 0x6c, 0x8f, 0x25, 0x69, 0x3c, 0x4f,
+  0xb1, 0xb1, 0x2f, 0xf9, 0xbb, 0x3b, 0x09, 0x03, 0xb6, 0x74, 0x33, 0x06, 0x7b, 0xdf, 0x63, 0x0e,
+  0x8f, 0x9e, 0xd8, 0xcd, 0xec, 0x14, 0xaf, 0x99, 0x6d, 0xcc, 0x9f, 0x70, 0xc6, 0x6f, 0x56, 0x88,
+  0xc8, 0xad, 0x4b, 0x22, 0xf6, 0x06, 0x4b, 0x45, 0xc4, 0xf7, 0x35, 0x95, 0xeb, 0x1f, 0x50, 0xc1,
+  0x26, 0x78, 0x07, 0x19, 0x2a, 0xfc, 0x85, 0x66, 0x97, 0x28, 0x31, 0xc0, 0xaa, 0xe2, 0x9e, 0x8a,
+  0x05, 0x5e, 0x4e, 0x9b, 0xa8, 0xb7, 0x66, 0x05, 0xd9, 0x47, 0xc1, 0xb0, 0xd9, 0xc5, 0x83, 0x3f,
+  0x83, 0xa6, 0x69, 0x3e, 0x87, 0x46, 0xea, 0xb1, 0x4a, 0xfd, 0x1e, 0xce, 0x0a, 0x59, 0xb0, 0x61,
+  0x3e, 0x75, 0xa3, 0x5b, 0x5b, 0x7c, 0xa7, 0x60, 0x8f, 0x55, 0xc6, 0x37, 0x78, 0x69, 0x0b, 0x35,
+  0x6f, 0xc7, 0x76, 0xe4, 0x7d, 0x2e, 0x6d, 0xa8, 0xae, 0x5a, 0x0c, 0x81, 0x0a, 0x2f, 0x57, 0x8d,
+  0x55, 0x78, 0xc9, 0xc8, 0x77, 0x31, 0xe8, 0x5d, 0x48, 0xf9, 0xcd, 0xa6, 0x8a, 0x5a, 0x7c, 0x27,
+  0x25, 0x03, 0x06, 0x2a, 0xa3, 0x7e, 0x55, 0xd5, 0xac, 0x15, 0x35, 0xf4, 0xea, 0x5a, 0x2d, 0x47,
+  0xe7, 0x86, 0x6a, 0x5e, 0x5b, 0x00, 0x07, 0xa0, 0xd0, 0x83, 0x50, 0x2b, 0xc3, 0x2c, 0x81, 0xa5,
+  0x45, 0x3a, 0xc6, 0x20, 0xc6, 0x18, 0xc8, 0x44, 0xde, 0x71, 0xd8, 0x7f, 0xc8, 0x70, 0xab, 0xd1,
+  0xa4, 0x44, 0x09, 0x54, 0x11, 0xf3, 0xeb, 0x4a, 0xa4, 0xeb, 0x99, 0xdc, 0x46, 0x9c, 0x9e, 0x84,
+  0xa1, 0x69, 0x3c, 0x50, 0x42, 0x7b, 0x34, 0x9a, 0x25, 0x03, 0xc8, 0x6c, 0xd8, 0x07, 0xe1, 0xc2,
+  0x82, 0xb6, 0x4f, 0x35, 0x0f, 0x6f, 0xd0, 0x1f, 0x60, 0xfe, 0xb1, 0xa9, 0xe6, 0xc9, 0x5d, 0xa0,
+  0x4c, 0x55, 0x72, 0x4c, 0x81, 0x04, 0xea, 0x78, 0x84, 0xda, 0x52, 0x01, 0x40, 0x1e, 0x79, 0x5f,
+  0x19, 0xf6, 0x1e, 0x51, 0x59, 0xa6, 0x64, 0x08, 0xd9, 0x00, 0x42, 0x0b, 0xf2, 0x4e, 0x17, 0x52,
+  0x8d, 0x05, 0x75, 0x59, 0x40, 0x2d, 0xdc, 0xe0, 0x52, 0x4d, 0x64, 0x92, 0xc2, 0x23, 0x2a, 0x78,
+  0x47, 0x2a, 0x44, 0x70, 0x25, 0x55, 0x51, 0x0b, 0x66, 0x8a, 0x72, 0x8f, 0xa4, 0x96, 0x09, 0x13,
+  0x9d, 0x9c, 0xa7, 0xd0, 0xe3, 0xb5, 0xa4, 0xf2, 0xf5, 0xae, 0xdd, 0x10, 0x4e, 0xcd, 0x59, 0xae,
+  0xd5, 0xe3, 0x3c, 0x62, 0x9f, 0x80, 0xfb, 0xff, 0x09, 0xb1, 0x20, 0x75, 0xff, 0xb4, 0xa1, 0x1d,
+  0x5d, 0xc1, 0x0f, 0xff, 0x1d, 0x1b, 0x15, 0xb9, 0xb0, 0xf5, 0x96, 0xaa, 0x55, 0x1a, 0x0f, 0xf9,
+  0x12, 0x09, 0x99, 0xb0, 0xa5, 0x30, 0x6e, 0xb1, 0x05, 0x95, 0x96, 0x1b, 0x9e, 0x2f, 0x3a, 0x50,
+  0xd4, 0xcc, 0x45, 0xd0, 0x52, 0x03, 0xfe, 0xcd, 0x44, 0x84, 0x04, 0xbf, 0x5e, 0xb9, 0x8a, 0x72,
+  0xf3, 0xb9, 0x49, 0xf5, 0xa5, 0xb9, 0x65, 0x35, 0xbd, 0xff, 0x07, 0x8e, 0x2f, 0xf7, 0x17, 0x81,
+  0x9f, 0x63, 0x6d, 0xcd, 0x9e, 0x1e, 0x81, 0x4f, 0x81, 0xa6, 0x05, 0x40, 0x85, 0xd4, 0x6d, 0x23,
+  0x45, 0x32, 0x2b, 0x46, 0xd1, 0xa9, 0x90, 0xb5, 0xa5, 0xdd, 0x76, 0xcc, 0x5b, 0xc4, 0xa0, 0xa9,
+  0x89, 0xbe, 0xf0, 0xac, 0x6e, 0x49, 0x9e, 0x4b, 0x27, 0x91, 0xc2, 0x80, 0x77, 0x20, 0x32, 0xb6,
+  0x22, 0xb5, 0xf9, 0xad, 0x05, 0xef, 0xd9, 0x9f, 0x26, 0x62, 0x62, 0x07, 0x23, 0x57, 0xc2, 0x8e,
+  0x41, 0x5e, 0x3d, 0xa2, 0x7d, 0x6b, 0xd9, 0x65, 0x6e, 0x67, 0xef, 0xdf, 0x83, 0x26, 0x71, 0x3c,
+  0x3d, 0x6b, 0x62, 0xf3, 0x65, 0x4a, 0x49, 0xe4, 0x10, 0xf5, 0x82, 0x0b, 0x8a, 0xe9, 0x5a, 0xc5,
+  0x8c, 0xa3, 0x0d, 0x01, 0x00, 0xe4, 0xfb, 0x52, 0x63, 0xfa, 0x30, 0xa3, 0xbc, 0x95, 0xa8, 0x6c,
+  0x2d, 0x3e, 0xae, 0x60, 0xee, 0xa4, 0x0d, 0xb9, 0xfc, 0x70, 0xc7, 0x52, 0x64, 0xf2, 0xa3, 0xb5,
+  0x24, 0x84, 0x6c, 0xcb, 0xb7, 0xa2, 0xdb, 0xfc, 0xcb, 0x83, 0xee, 0x55, 0x20, 0x51, 0x3e, 0xfe,
+  0xa5, 0xb9, 0x33, 0x88, 0x90, 0xff, 0xe1, 0x8f, 0x17, 0xe3, 0xc9, 0xf2, 0xcd, 0xd5, 0x20, 0x81,
+  0x0c, 0x35, 0x46, 0xc1, 0x5a, 0xd1, 0x39, 0x25, 0x49, 0x6a, 0xa1, 0xb6, 0xba, 0x0f, 0xec, 0x32,
+  0x76, 0x7a, 0x8a, 0x4e, 0xa9, 0xaa, 0xb3, 0x06, 0xa7, 0x92, 0x7e, 0xb3, 0x2b, 0xbe, 0x89, 0xe5,
+  0x76, 0x46, 0x78, 0x93, 0xb6, 0x96, 0x0c, 0x5f, 0x76, 0x42, 0x74, 0x14, 0x43, 0xd8, 0x20, 0x78,
+  0x76, 0x79, 0x2e, 0x3d, 0x90, 0xa5, 0xf5, 0xb0, 0xa1, 0x0e, 0x38, 0x86, 0x7a, 0xcb, 0x2c, 0xdf,
+  0x3b, 0x32, 0xfc, 0x8a, 0xc0, 0xa3, 0x53, 0x03, 0xcf, 0xd6, 0x91, 0x5b, 0xb4, 0x12, 0x0c, 0x3f,
+  0x71, 0xb8, 0x81, 0x4a, 0x50, 0xc6, 0x18, 0x1e, 0x06, 0x27, 0x98, 0xcd, 0xe5, 0xf7, 0x15, 0x4a,
+  0x85, 0x25, 0x5d, 0xf5, 0x4d, 0x84, 0x44, 0xc3, 0x4e, 0xcb, 0xfc, 0x80, 0x4f, 0x1f, 0xe8, 0xec,
+  0x45, 0x14, 0x52, 0x91, 0x25, 0xf0, 0x80, 0x7a, 0xe7, 0x2f, 0x3c, 0xc8, 0x99, 0x2f, 0x72, 0x77,
+  0x61, 0x1a, 0x7b, 0x3c, 0x09, 0xf6, 0x00, 0xfb, 0x97, 0xe5, 0x04, 0x57, 0xc2, 0x53, 0xb1, 0x44,
+  0x1e, 0x05, 0xb1, 0xb8, 0x89, 0x17, 0xf6, 0xf7, 0x20, 0xca, 0xed, 0x13, 0xd9, 0xc2, 0xd3, 0x72,
+  0x4d, 0xaf, 0x23, 0xfb, 0xfa, 0xd3, 0x95, 0xef, 0x63, 0x03, 0xa7, 0x73, 0x5b, 0x31, 0x1b, 0x3f,
+  0xc9, 0x1c, 0xa7, 0x4e, 0x43, 0xf2, 0x6c, 0x89, 0xcd, 0xb7, 0x16, 0x7c, 0x5b, 0x60, 0xac, 0x78,
+  0xd0, 0x29, 0xae, 0x42, 0x4f, 0x2a, 0xc9, 0x11, 0xf2, 0xe8, 0x0b, 0x6a, 0xd2, 0x69, 0x91, 0xbd,
+  0x36, 0x8a, 0x03, 0xb3, 0x24, 0x88, 0x11, 0x4e, 0xed, 0x63, 0xa9, 0x90, 0x9d, 0x8a, 0xd8, 0xd2,
+  0x33, 0x5a, 0xa0, 0xae, 0x67, 0x3a, 0xa4, 0x29, 0x4f, 0x90, 0x27, 0x35, 0xf5, 0xac, 0x8e, 0x6b,
+  0x2d, 0x75, 0x94, 0xa2, 0x73, 0x0d, 0xcd, 0xfd, 0xe0, 0x70, 0xb3, 0xfb, 0xf4, 0x3c, 0x50, 0xa7,
+  0x67, 0x45, 0x7a, 0xe3, 0x28, 0x25, 0xf3, 0x27, 0x72, 0xc1, 0x93, 0x94, 0x69, 0x43, 0x92, 0x7f,
+  0x6a, 0x42, 0x8e, 0xb2, 0xbe, 0x5d, 0x5e, 0xfe, 0x2f, 0x6d, 0xb9, 0xe1, 0x2e, 0x2d, 0xd0, 0x3b,
+  0xbe, 0xfb, 0x8d, 0x3d, 0xe8, 0xbf, 0xa7, 0xb7, 0x33, 0xbc, 0xc5, 0xc0, 0xcf, 0x80, 0x0e, 0x94,
+  0x20, 0x2d, 0xf5, 0xed, 0x5d, 0x76, 0x00, 0x88, 0x86, 0x3a, 0x74, 0xb7, 0xef, 0xe1, 0x5c, 0x64,
+  0xc0, 0x02, 0x9e, 0x24, 0x61, 0xe0, 0x72, 0xd4, 0xdb, 0x5e, 0xec, 0xe6, 0x22, 0x6f, 0x67, 0xb9,
+  0xbc, 0x27, 0x66, 0xaf, 0xec, 0xb5, 0xd4, 0x7c, 0xd5, 0xf0, 0xd0, 0xf7, 0xa3, 0xf6, 0xc9, 0xcf,
+  0xb1, 0xe9, 0x87, 0x27, 0xf4, 0x52, 0x9f, 0x07, 0xa1, 0x40, 0x21, 0x30, 0x01, 0xd7, 0x9d, 0x09,
+  0x0f, 0xf8, 0xe6, 0x4e, 0x5b, 0x25, 0x31, 0x14, 0xd1, 0x55, 0x1a, 0x92, 0xcc, 0xa5, 0xc5, 0xde,
+  0xd0, 0x85, 0xc4, 0x7c, 0x6b, 0xbf, 0xf2, 0x03, 0xc9, 0xb7, 0x85, 0x2e, 0x04, 0x7e, 0x4b, 0x38,
+  0x75, 0x92, 0xab, 0x2c, 0x7b, 0x23, 0x88, 0x67, 0x40, 0x5f, 0x54, 0xdc, 0x2b, 0x2b, 0xa4, 0x34,
+  0xb7, 0x0d, 0x87, 0xc2, 0x08, 0x68, 0x9e, 0x3a, 0xbf, 0x67, 0x71, 0x84, 0xce, 0x0c, 0xf6, 0xf3,
+  0x5f, 0xb6, 0xee, 0x40, 0x8c, 0x5f, 0x51, 0x6f, 0x59, 0xc7, 0x7f, 0x39, 0x2c, 0x93, 0x03, 0x12,
+  0x96, 0xd1, 0xd9, 0xf1, 0xd3, 0x78, 0x69, 0x7e, 0x67, 0x94, 0xf5, 0x0e, 0xe8, 0x86, 0xed, 0xb5,
+  0xc5, 0xcc, 0x7f, 0xea, 0xe3, 0x24, 0xb4, 0xad, 0x2a, 0x36, 0x02, 0x1d, 0x18, 0xfa, 0x16, 0xa5,
+  0x70, 0x98, 0x96, 0xa4, 0x59, 0x9f, 0x51, 0xdf, 0x68, 0x95, 0x73, 0x1b, 0xee, 0x45, 0xf9, 0x49,
+  0x63, 0x15, 0x30, 0x79, 0x9a, 0xd5, 0x92, 0xca, 0x8f, 0x9e, 0x24, 0x5e, 0xf1, 0xd5, 0x53, 0xb3,
+  0xd6, 0x62, 0x62, 0x26, 0x85, 0x06, 0xf3, 0x81, 0xbe, 0x73, 0x82, 0xc6, 0x5b, 0x7e, 0xb4, 0xd4,
+  0x62, 0xfa, 0xc3, 0x20, 0x78, 0x2a, 0x3e, 0xbd, 0x81, 0xe7, 0xca, 0x27, 0x34, 0x30, 0xa2, 0xcf,
+  0x5d, 0xa0, 0x33, 0x41, 0x36, 0x1d, 0x41, 0x57, 0x6d, 0x99, 0x4c, 0xe5, 0xa5, 0x38, 0xaa, 0x2b,
+  0x01, 0x11, 0xe4, 0x17, 0x24, 0x9b, 0xda, 0xfd, 0xe2, 0xa7, 0x42, 0x30, 0x08, 0x84, 0x04, 0x8e,
+  0x7d, 0x59, 0x07, 0x1f, 0x5e, 0x29, 0xcd, 0x60, 0xe3, 0xf4, 0x22, 0xf0, 0x66, 0x0f, 0xe0, 0xd0,
+  0x33, 0x7d, 0xc4, 0xa9, 0xff, 0x8a, 0x52, 0x01, 0xe5, 0x2e, 0xcb, 0x33, 0x09, 0xd6, 0x03, 0x80,
+  0x3b, 0x71, 0x4c, 0xa8, 0xf8, 0x00, 0x63, 0x79, 0x58, 0x0c, 0x22, 0xb5, 0xda, 0x0b, 0xae, 0xa2,
+  0xd7, 0x2f, 0x5b, 0x2d, 0x3d, 0xf7, 0xbc, 0x8b, 0x67, 0x10, 0xe4, 0x3a, 0xc8, 0x40, 0x1e, 0x3a,
+  0x22, 0xd2, 0x1b, 0x0e, 0xd5, 0x77, 0xd6, 0xd4, 0xfe, 0x03, 0x6c, 0x55, 0x41, 0x08, 0xbd, 0xb0,
+  0xc9, 0x0f, 0x16, 0x98, 0xd2, 0x37, 0x64, 0x90, 0x91, 0x37, 0xd2, 0xa2, 0x32, 0x93, 0xd4, 0x0d,
+  0xdb, 0x24, 0xca, 0xf2, 0x43, 0xb8, 0x9d, 0x74, 0x21, 0x57, 0x3c, 0xe1, 0x39, 0x87, 0x32, 0x2c,
+  0x61, 0xab, 0x4f, 0x82, 0x7e, 0x84, 0xbf, 0x25, 0x86, 0x5e, 0xa3, 0xf8, 0x15, 0x5e, 0xb3, 0x83,
+  0x06, 0xa4, 0xe1, 0x25, 0xe8, 0x05, 0x54, 0x85, 0x34, 0xbe, 0x37, 0x44, 0x27, 0x49, 0x05, 0xa2,
+  0x9c, 0x0b, 0x9f, 0xaf, 0xc2, 0xdc, 0x2c, 0x0a, 0x1b, 0x36, 0x24, 0xba, 0xae, 0xdd, 0x5d, 0xcf,
+  0x04, 0x4f, 0xdd, 0xc5, 0x94, 0xc3, 0xd9, 0x38, 0x33, 0x9b, 0xbb, 0x4f, 0x3c, 0xba, 0xb7, 0x2f,
+  0xbc, 0xaa, 0x29, 0x3b, 0x14, 0xea, 0x0b, 0xe4, 0xe7, 0x61, 0xd0, 0x12, 0x56, 0xba, 0x84, 0xa6,
+  0xe4, 0xd1, 0x81, 0xa4, 0x09, 0xa5, 0xa9, 0x82, 0xd6, 0xaa, 0x21, 0x1d, 0x36, 0x2a, 0x3b, 0x2d,
+  0xf6, 0xd6, 0x92, 0x6b, 0x31, 0x07, 0xe2, 0xfd, 0x70, 0x99, 0x45, 0x3a, 0xf9, 0x42, 0x44, 0xa6,
+  0xb6, 0x6c, 0x07, 0x72, 0x31, 0xa4, 0x0e, 0x52, 0x98, 0x2e, 0x7b, 0xea, 0x9b, 0x30, 0x2c, 0x9c,
+  0x29, 0xbe, 0x5b, 0xe2, 0x4e, 0x48, 0xba, 0x3b, 0xda, 0xd3, 0x9f, 0x43, 0x1d, 0xed, 0xa9, 0x4f,
+  0x3f, 0xf7, 0xe8, 0x2b, 0xf6, 0xff, 0x06, 0x19, 0x50, 0xb3, 0xfc, 0xd6, 0x2e, 0x00, 0x00,
+};
+
+#endif // WEBUI_PAGE_H
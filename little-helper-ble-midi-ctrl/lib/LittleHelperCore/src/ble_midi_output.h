@@ -0,0 +1,27 @@
+/**
+ * @file ble_midi_output.h
+ * @brief MidiOutput that batches all messages of one loop pass into BLE-MIDI packets.
+ */
+
+#ifndef BLE_MIDI_OUTPUT_H
+#define BLE_MIDI_OUTPUT_H
+
+#include "midi_engine.h"
+#include "ble_midi_packet.h"
+
+class BleMidiBatchOutput : public MidiOutput {
+public:
+  explicit BleMidiBatchOutput(BleMidiPacketSink& sink) : _builder(sink) {}
+
+  void send(const uint8_t* data, uint8_t len, uint16_t timestampMs) override { _builder.add(data, len, timestampMs); }
+
+  // send everything collected since the last flush as one (or more, if the MTU is exceeded) packet
+  void flush() { _builder.flush(); }
+
+  BleMidiPacketBuilder& builder() { return _builder; }
+
+private:
+  BleMidiPacketBuilder _builder;
+};
+
+#endif // BLE_MIDI_OUTPUT_H
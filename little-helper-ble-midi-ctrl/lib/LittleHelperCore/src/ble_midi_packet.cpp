@@ -0,0 +1,166 @@
+/**
+ * @file ble_midi_packet.cpp
+ * @brief BLE-MIDI packet builder with running status and 13 bit timestamps.
+ */
+
+#include "ble_midi_packet.h"
+#include <string.h>
+
+// length of a MIDI message by status byte, 0 = SysEx or invalid
+static uint8_t messageLength(uint8_t status) {
+  switch (status & 0xF0) {
+    case 0x80: case 0x90: case 0xA0: case 0xB0: case 0xE0:
+      return 3;
+    case 0xC0: case 0xD0:
+      return 2;
+    default:
+      break;
+  }
+  switch (status) {
+    case 0xF1: case 0xF3: return 2;
+    case 0xF2: return 3;
+    case 0xF6: return 1;
+    case 0xF8: case 0xFA: case 0xFB: case 0xFC: case 0xFE: case 0xFF: return 1;
+    default: return 0;
+  }
+}
+
+BleMidiPacketBuilder::BleMidiPacketBuilder(BleMidiPacketSink& sink)
+  : _sink(sink), _len(0), _maxPacket(0), _runningStatus(0), _lastTimestamp(0),
+    _messages(0), _packets(0), _bytes(0) {
+  setMtu(BLE_MIDI_DEFAULT_MTU);
+}
+
+void BleMidiPacketBuilder::setMtu(uint16_t mtu) {
+  uint16_t payload = mtu > 3 ? mtu - 3 : 0;
+  if (payload > BLE_MIDI_MAX_PACKET) payload = BLE_MIDI_MAX_PACKET;
+  if (payload < 5) payload = BLE_MIDI_DEFAULT_MTU - 3;
+  if (payload < _len) flush();
+  _maxPacket = (uint8_t)payload;
+}
+
+void BleMidiPacketBuilder::begin(uint16_t timestamp) {
+  _packet[0] = 0x80 | ((timestamp >> 7) & 0x3F);
+  _len = 1;
+  _runningStatus = 0;
+  _lastTimestamp = timestamp;
+}
+
+// the receiver rebuilds the time from the header and the low 7 bits, a smaller low value
+// than the previous message means one overflow into the high bits, nothing more
+bool BleMidiPacketBuilder::sameTimestampWindow(uint16_t timestamp) const {
+  uint16_t lastHigh = _lastTimestamp >> 7;
+  uint16_t high = timestamp >> 7;
+  uint8_t lastLow = _lastTimestamp & 0x7F;
+  uint8_t low = timestamp & 0x7F;
+  if (high == lastHigh) return low >= lastLow;
+  return high == ((lastHigh + 1) & 0x3F) && low < lastLow;
+}
+
+void BleMidiPacketBuilder::flush() {
+  if (_len <= 1) {
+    _len = 0;
+    return;
+  }
+  _sink.sendPacket(_packet, _len);
+  _packets++;
+  _bytes += _len;
+  _len = 0;
+  _runningStatus = 0;
+}
+
+bool BleMidiPacketBuilder::add(const uint8_t* data, size_t len, uint16_t timestampMs) {
+
+  if (data == nullptr || len == 0 || !(data[0] & 0x80)) return false;
+
+  uint16_t timestamp = timestampMs & BLE_MIDI_TIMESTAMP_MASK;
+  if (_len) {
+    // messages in a packet must not go back in time, an earlier edge handled after a later
+    // one (two buttons in the same input pass) starts a new packet and keeps its own time
+    uint16_t diff = (timestamp - _lastTimestamp) & BLE_MIDI_TIMESTAMP_MASK;
+    if (diff > (BLE_MIDI_TIMESTAMP_MASK >> 1)) flush();
+  }
+
+  if (data[0] == 0xF0) {
+    if (len < 2 || data[len - 1] != 0xF7) return false;
+    addSysEx(data, len, timestamp);
+    _messages++;
+    return true;
+  }
+
+  uint8_t expected = messageLength(data[0]);
+  if (expected == 0 || len != expected) return false;
+
+  bool channelMessage = data[0] < 0xF0;
+  bool realtime = data[0] >= 0xF8;
+
+  if (_len && sameTimestampWindow(timestamp)) {
+    bool running = channelMessage && data[0] == _runningStatus;
+    size_t need = 1 + (running ? len - 1 : len);
+    if (fits(need)) {
+      _packet[_len++] = 0x80 | (timestamp & 0x7F);
+      memcpy(&_packet[_len], running ? data + 1 : data, need - 1);
+      _len += need - 1;
+      _lastTimestamp = timestamp;
+      if (channelMessage) _runningStatus = data[0];
+      else if (!realtime) _runningStatus = 0;
+      _messages++;
+      return true;
+    }
+  }
+
+  flush();
+  begin(timestamp);
+  _packet[_len++] = 0x80 | (timestamp & 0x7F);
+  memcpy(&_packet[_len], data, len);
+  _len += len;
+  if (channelMessage) _runningStatus = data[0];
+  _messages++;
+  return true;
+}
+
+void BleMidiPacketBuilder::addSysEx(const uint8_t* data, size_t len, uint16_t timestamp) {
+
+  // ts F0 ... ts F7
+  if (!(_len && sameTimestampWindow(timestamp) && fits(len + 2))) {
+    flush();
+    begin(timestamp);
+  }
+
+  uint8_t tsByte = 0x80 | (timestamp & 0x7F);
+  _lastTimestamp = timestamp;
+  _runningStatus = 0;
+
+  if (fits(len + 2)) {
+    _packet[_len++] = tsByte;
+    memcpy(&_packet[_len], data, len - 1);
+    _len += len - 1;
+    _packet[_len++] = tsByte;
+    _packet[_len++] = 0xF7;
+    return;
+  }
+
+  // larger than one packet: ts F0 data.. | hdr data.. | hdr data.. ts F7
+  _packet[_len++] = tsByte;
+  size_t pos = 0;
+  size_t body = len - 1; // everything but the F7
+  while (pos < body) {
+    if (_len == _maxPacket) {
+      flush();
+      _packet[0] = 0x80 | ((timestamp >> 7) & 0x3F);
+      _len = 1;
+    }
+    size_t chunk = _maxPacket - _len;
+    if (chunk > body - pos) chunk = body - pos;
+    memcpy(&_packet[_len], data + pos, chunk);
+    _len += chunk;
+    pos += chunk;
+  }
+  if (!fits(2)) {
+    flush();
+    _packet[0] = 0x80 | ((timestamp >> 7) & 0x3F);
+    _len = 1;
+  }
+  _packet[_len++] = tsByte;
+  _packet[_len++] = 0xF7;
+}
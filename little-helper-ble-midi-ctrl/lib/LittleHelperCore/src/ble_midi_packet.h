@@ -0,0 +1,78 @@
+/**
+ * @file ble_midi_packet.h
+ * @brief BLE-MIDI packet builder with running status and 13 bit timestamps.
+ *
+ * @details Collects MIDI messages into one BLE-MIDI packet (header byte with timestamp
+ * bits 12..7, a timestamp byte with bits 6..0 in front of every message). Channel
+ * messages with the same status as the previous one in the packet are sent with
+ * running status. A packet never exceeds the negotiated MTU - 3 bytes, when the next
+ * message does not fit the current packet is handed to the sink and a new one is started.
+ * SysEx messages larger than a packet are split into continuation packets.
+ */
+
+#ifndef BLE_MIDI_PACKET_H
+#define BLE_MIDI_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BLE_MIDI_DEFAULT_MTU 23   // ATT default MTU, 20 byte payload
+#define BLE_MIDI_DEFAULT_INTERVAL_US 7500 // shortest BLE connection interval, until the connect event tells
+#define BLE_MIDI_MAX_PACKET 244   // largest payload we build, fits a data length extended PDU
+#define BLE_MIDI_TIMESTAMP_MASK 0x1FFF
+
+/**
+ * @brief Receives finished BLE-MIDI packets, on the device this is the notify of the MIDI characteristic.
+ */
+class BleMidiPacketSink {
+public:
+  virtual ~BleMidiPacketSink() {}
+  virtual void sendPacket(const uint8_t* packet, uint8_t len) = 0;
+};
+
+class BleMidiPacketBuilder {
+public:
+  explicit BleMidiPacketBuilder(BleMidiPacketSink& sink);
+
+  // set the negotiated ATT MTU, the payload is MTU - 3 bytes
+  void setMtu(uint16_t mtu);
+  uint8_t maxPacket() const { return _maxPacket; }
+
+  /**
+   * @brief Append one complete MIDI message.
+   *
+   * @param data channel message (status + 1..2 data bytes) or SysEx (F0 ... F7)
+   * @param len number of bytes
+   * @param timestampMs milliseconds, only the lower 13 bits are used
+   * @return false if the message is invalid
+   */
+  bool add(const uint8_t* data, size_t len, uint16_t timestampMs);
+
+  // send the pending packet, if any
+  void flush();
+
+  bool empty() const { return _len == 0; }
+
+  // statistics since construction
+  uint32_t messages() const { return _messages; }
+  uint32_t packets() const { return _packets; }
+  uint32_t bytes() const { return _bytes; }
+
+private:
+  void begin(uint16_t timestamp);
+  bool fits(size_t n) const { return _len + n <= _maxPacket; }
+  bool sameTimestampWindow(uint16_t timestamp) const;
+  void addSysEx(const uint8_t* data, size_t len, uint16_t timestamp);
+
+  BleMidiPacketSink& _sink;
+  uint8_t _packet[BLE_MIDI_MAX_PACKET];
+  uint8_t _len;
+  uint8_t _maxPacket;
+  uint8_t _runningStatus; // 0 = none
+  uint16_t _lastTimestamp;
+  uint32_t _messages;
+  uint32_t _packets;
+  uint32_t _bytes;
+};
+
+#endif // BLE_MIDI_PACKET_H
@@ -0,0 +1,125 @@
+/**
+ * @file button_config.h
+ * @brief Hardware independent button and map configuration of the Little Helper.
+ *
+ * @details Shared by the firmware and the host (env:native) build, so it must not
+ * include any Arduino or ESP-IDF header.
+ */
+
+#ifndef BUTTON_CONFIG_H
+#define BUTTON_CONFIG_H
+
+#include <stdint.h>
+#include "button_palette.h"
+
+#define MIDIFUNC_NOTE 0
+#define MIDIFUNC_CC 1
+#define MIDIFUNC_SYSEX 2
+#define MIDIFUNC_PC 3
+
+// btnMidiCCValueStateOn / Off of a Program Change button are the Bank Select MSB / LSB, from
+// this value on no Bank Select is sent. A button that becomes PC starts with it.
+#define PC_BANK_NONE 128
+
+#define NUBER_OF_MAPS 128 // one map per Program Change, in flash (map_bank_store.h)
+
+enum my_mmc_t {
+  MMC_STOP          = 0x01,
+  MMC_PLAY          = 0x02,
+  MMC_DEFERRED_PLAY = 0x03,
+  MMC_FAST_FORWARD  = 0x04,
+  MMC_REWIND        = 0x05,
+  MMC_RECORD_STROBE = 0x06,
+  MMC_RECORD_EXIT   = 0x07,
+  MMC_RECORD_PAUSE  = 0x08,
+  MMC_PAUSE         = 0x09,
+};
+
+enum my_btn_function {
+  BTN_PUSH = 0x00,
+  BTN_TOGGLE = 0x01,
+};
+
+enum my_btn_state {
+  BTN_OFF = 0x00,
+  BTN_ON = 0x01,
+};
+
+enum my_midi_function {
+  MIDI_NOTE = 0x00,
+  MIDI_CC = 0x01,
+  MIDI_MMC = 0x02,
+  MIDI_PROGRAMCHANGE = 0x03,
+};
+
+enum my_midi_cc {
+  MIDI_CC_VOLUME = 0x07,
+  MIDI_CC_PAN = 0x0A,
+  MIDI_CC_EXPRESSION = 0x0B,
+  MIDI_CC_SUSTAIN = 0x40,
+  MIDI_CC_PORTAMENTO = 0x41,
+  MIDI_CC_DATAENTRY = 0x06,
+  MIDI_CC_BANKSELECT = 0x00,
+  MIDI_CC_MODULATION = 0x01,
+  MIDI_CC_BREATH = 0x02,
+  MIDI_CC_FOOT = 0x04,
+  MIDI_CC_PORTAMENTOTIME = 0x05,
+  MIDI_CC_REVERB = 0x5B,
+  MIDI_CC_CHORUS = 0x5D,
+  MIDI_CC_DELAY = 0x5E,
+  MIDI_CC_PHASER = 0x5F,
+};
+
+enum my_midi_channel {
+  MIDI_CH_1 = 0x00,
+  MIDI_CH_2 = 0x01,
+  MIDI_CH_3 = 0x02,
+  MIDI_CH_4 = 0x03,
+  MIDI_CH_5 = 0x04,
+  MIDI_CH_6 = 0x05,
+  MIDI_CH_7 = 0x06,
+  MIDI_CH_8 = 0x07,
+  MIDI_CH_9 = 0x08,
+  MIDI_CH_10 = 0x09,
+  MIDI_CH_11 = 0x0A,
+  MIDI_CH_12 = 0x0B,
+  MIDI_CH_13 = 0x0C,
+  MIDI_CH_14 = 0x0D,
+  MIDI_CH_15 = 0x0E,
+  MIDI_CH_16 = 0x0F,
+};
+
+/**
+ * @brief One button in one map, 8 bytes.
+ *
+ * @details The maps are stored map by map (myMapButton maps[NUBER_OF_MAPS][buttons]), so
+ * compiling or switching a map reads one contiguous block. Flags and small values are bit
+ * fields and the color is an index into BUTTON_PALETTE (button_palette.h). The stored
+ * format (map_codec.h) is written field by field and does not depend on this layout.
+ */
+struct myMapButton
+{
+  uint8_t btnMidiFunction : 2; // my_midi_function
+  uint8_t btnFunction : 1;     // my_btn_function
+  uint8_t needRelease : 1;     // send on release instead of press
+  uint8_t btnLongpress : 1;
+  uint8_t btnMacro : 3;        // 0 = none, 1 .. 7 the press plays this macro (macro_sequencer.h)
+  uint8_t btnMidiChannel : 4;  // 0 - 15
+  uint8_t btnMidiMMC : 4;      // my_mmc_t
+  uint8_t btnMidiNote;
+  uint8_t btnMidiVelocity;
+  uint8_t btnMidiCC;
+  uint8_t btnMidiCCValueStateOn;
+  uint8_t btnMidiCCValueStateOff;
+  uint8_t btnColor;            // index into BUTTON_PALETTE
+};
+
+static_assert(sizeof(myMapButton) == 8, "myMapButton is packed into 8 bytes");
+
+// the hardware of one button, the settings are in myMapButton
+struct myButton
+{
+  uint8_t btnGpio; // GPIO Pin bleibt unverändert
+};
+
+#endif // BUTTON_CONFIG_H
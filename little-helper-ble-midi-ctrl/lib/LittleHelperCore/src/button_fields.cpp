@@ -0,0 +1,145 @@
+/**
+ * @file button_fields.cpp
+ * @brief Descriptor table of the per map button fields and the control id -> field index.
+ */
+
+#include "button_fields.h"
+#include "macro_sequencer.h"
+#include "midi_action_table.h"
+
+#include <string.h>
+
+// Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
+static const myFieldOption MIDI_FUNCTION_OPTIONS[] = {
+  { "Note", MIDI_NOTE }, { "CC", MIDI_CC }, { "MMC", MIDI_MMC }, { "PC", MIDI_PROGRAMCHANGE },
+};
+
+static const myFieldOption MMC_OPTIONS[] = {
+  { "STOP", MMC_STOP }, { "PLAY", MMC_PLAY }, { "DEFERRED PLAY", MMC_DEFERRED_PLAY },
+  { "FAST FORWARD", MMC_FAST_FORWARD }, { "REWIND", MMC_REWIND }, { "RECORD STROBE", MMC_RECORD_STROBE },
+  { "RECORD EXIT", MMC_RECORD_EXIT }, { "RECORD PAUSE", MMC_RECORD_PAUSE }, { "PAUSE", MMC_PAUSE },
+};
+
+static const myFieldOption BEHAVE_OPTIONS[] = {
+  { "Push", BTN_PUSH }, { "Toggle", BTN_TOGGLE },
+};
+
+static const myFieldOption TRANSITION_OPTIONS[] = {
+  { "Push", 0 }, { "Release", 1 },
+};
+
+// a button that becomes Program Change starts without Bank Select, one that stops being one
+// gets CC values again instead of PC_BANK_NONE
+static void setMidiFunction(myMapButton& btn, uint8_t value) {
+  bool wasPc = btn.btnMidiFunction == MIDI_PROGRAMCHANGE;
+  if (value == MIDI_PROGRAMCHANGE && !wasPc) {
+    btn.btnMidiCCValueStateOn = btn.btnMidiCCValueStateOff = PC_BANK_NONE;
+  } else if (value != MIDI_PROGRAMCHANGE && wasPc) {
+    if (btn.btnMidiCCValueStateOn >= PC_BANK_NONE) btn.btnMidiCCValueStateOn = 127;
+    if (btn.btnMidiCCValueStateOff >= PC_BANK_NONE) btn.btnMidiCCValueStateOff = 0;
+  }
+  btn.btnMidiFunction = value;
+}
+
+// get and set of one myMapButton member, bit fields included
+#define FIELD(member) \
+  [](const myMapButton& btn) -> uint8_t { return btn.member; }, \
+  [](myMapButton& btn, uint8_t value) { btn.member = value; }
+#define OPTIONS(list) list, sizeof(list) / sizeof(list[0])
+
+// the order is the order of the controls in the web UI
+const myFieldDescriptor BUTTON_FIELDS[] = {
+  { "Midi Channel 0 - 15:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiChannel), 0, 15, nullptr, 0 },
+  { "Midi Function:", FIELD_WIDGET_SELECT, FIELD_TYPE_U8, [](const myMapButton& btn) -> uint8_t { return btn.btnMidiFunction; },
+    setMidiFunction, 0, 0, OPTIONS(MIDI_FUNCTION_OPTIONS) },
+  { "Midi CC / PC Program 0 - 127:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiCC), 0, 127, nullptr, 0 },
+  { "Midi CC Value On / PC Bank MSB 0 - 127, 128 = none:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiCCValueStateOn), 0, PC_BANK_NONE, nullptr, 0 },
+  { "Midi CC Value Off / PC Bank LSB 0 - 127, 128 = none:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiCCValueStateOff), 0, PC_BANK_NONE, nullptr, 0 },
+  { "Midi Note 0 - 127:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiNote), 0, 127, nullptr, 0 },
+  { "MMC Function:", FIELD_WIDGET_SELECT, FIELD_TYPE_U8, FIELD(btnMidiMMC), 0, 0, OPTIONS(MMC_OPTIONS) },
+  { "Midi Note Velocity 0 - 127:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMidiVelocity), 0, 127, nullptr, 0 },
+  { "Button behave: Midi Note only", FIELD_WIDGET_SELECT, FIELD_TYPE_U8, FIELD(btnFunction), 0, 0, OPTIONS(BEHAVE_OPTIONS) },
+  { "Button Transition: Midi Note excluded", FIELD_WIDGET_SELECT, FIELD_TYPE_U8, FIELD(needRelease), 0, 0, OPTIONS(TRANSITION_OPTIONS) },
+  { "Button Color:", FIELD_WIDGET_SLIDER, FIELD_TYPE_COLOR, FIELD(btnColor), 0, BUTTON_PALETTE_SIZE - 1, nullptr, 0 },
+  { "Macro 0 = none, 1 - 7:", FIELD_WIDGET_NUMBER, FIELD_TYPE_U8, FIELD(btnMacro), 0, MACRO_COUNT, nullptr, 0 },
+};
+
+const uint8_t BUTTON_FIELD_COUNT = sizeof(BUTTON_FIELDS) / sizeof(BUTTON_FIELDS[0]);
+
+static_assert(BUTTON_FIELD_COUNT < FIELD_MAX_SLOTS, "one slot per field and one for the map select");
+
+#undef FIELD
+#undef OPTIONS
+
+#define FIELD_UNBOUND 0xFF
+
+ButtonFieldRegistry::ButtonFieldRegistry() {
+  clearControls();
+}
+
+void ButtonFieldRegistry::clearControls() {
+  memset(_byId, FIELD_UNBOUND, sizeof(_byId));
+}
+
+bool ButtonFieldRegistry::bindControl(uint16_t controlId, uint8_t button, uint8_t slot) {
+  if (controlId >= FIELD_INDEX_MAX_ID || button >= FIELD_MAX_BUTTONS || slot >= FIELD_MAX_SLOTS) return false;
+  _byId[controlId] = button << 4 | slot;
+  return true;
+}
+
+bool ButtonFieldRegistry::findControl(uint16_t controlId, uint8_t& button, uint8_t& slot) const {
+  if (controlId >= FIELD_INDEX_MAX_ID || _byId[controlId] == FIELD_UNBOUND) return false;
+  button = _byId[controlId] >> 4;
+  slot = _byId[controlId] & 0x0F;
+  return true;
+}
+
+int32_t ButtonFieldRegistry::uiValue(const myMapButton& btn, uint8_t field) const {
+  if (field >= BUTTON_FIELD_COUNT) return 0;
+  return BUTTON_FIELDS[field].get(btn);
+}
+
+my_field_result ButtonFieldRegistry::setUiValue(myMapButton& btn, uint8_t field, int32_t value) const {
+  if (field >= BUTTON_FIELD_COUNT) return FIELD_UNKNOWN;
+  const myFieldDescriptor& d = BUTTON_FIELDS[field];
+
+  if (d.widget == FIELD_WIDGET_SELECT) {
+    uint8_t i = 0;
+    while (i < d.optionCount && d.options[i].value != value) i++;
+    if (i == d.optionCount) return FIELD_OUT_OF_RANGE;
+  } else if (value < d.min || value > d.max) {
+    return FIELD_OUT_OF_RANGE;
+  }
+  d.set(btn, value);
+  return FIELD_OK;
+}
+
+my_field_result ButtonFieldRegistry::setUiText(myMapButton& btn, uint8_t field, const char* text) const {
+  int32_t value;
+  if (!parseFieldNumber(text, value)) return FIELD_NOT_A_NUMBER;
+  return setUiValue(btn, field, value);
+}
+
+bool parseFieldNumber(const char* text, int32_t& value) {
+  if (text == nullptr) return false;
+  bool negative = *text == '-';
+  if (negative) text++;
+  if (*text == '\0') return false;
+  int32_t v = 0;
+  for (uint8_t digits = 0; *text != '\0'; text++, digits++) {
+    if (*text < '0' || *text > '9' || digits == 9) return false;
+    v = v * 10 + (*text - '0');
+  }
+  value = negative ? -v : v;
+  return true;
+}
+
+const char* fieldResultName(my_field_result result) {
+  switch (result) {
+    case FIELD_OK: return "ok";
+    case FIELD_NOT_A_NUMBER: return "not a number";
+    case FIELD_OUT_OF_RANGE: return "out of range";
+    case FIELD_UNKNOWN: return "unknown field";
+    default: return "?";
+  }
+}
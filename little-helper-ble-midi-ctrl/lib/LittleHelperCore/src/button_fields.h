@@ -0,0 +1,87 @@
+/**
+ * @file button_fields.h
+ * @brief Descriptor table of the per map button fields and the control id -> field index.
+ *
+ * @details Every field the configurator edits is one line in BUTTON_FIELDS: how to read and
+ * write it in myMapButton, its range or options and the widget that shows it. The web UI builds its
+ * controls from the table, input is validated against it, and a control id is mapped to
+ * (button, slot) by one indexed read instead of a scan over all controls. Adding a field
+ * is one line here, no new callback.
+ */
+
+#ifndef BUTTON_FIELDS_H
+#define BUTTON_FIELDS_H
+
+#include <stdint.h>
+#include "button_config.h"
+
+enum my_field_widget {
+  FIELD_WIDGET_NUMBER = 0,
+  FIELD_WIDGET_SELECT,
+  FIELD_WIDGET_SLIDER,
+};
+
+enum my_field_type {
+  FIELD_TYPE_U8 = 0,
+  FIELD_TYPE_COLOR,  // BUTTON_PALETTE index
+};
+
+struct myFieldOption {
+  const char* label;
+  uint8_t value;
+};
+
+struct myFieldDescriptor {
+  const char* label;
+  uint8_t widget;  // my_field_widget
+  uint8_t type;    // my_field_type
+  uint8_t (*get)(const myMapButton& btn);
+  void (*set)(myMapButton& btn, uint8_t value); // the value is validated before, may change other fields
+  uint8_t min;
+  uint8_t max;
+  const myFieldOption* options; // FIELD_WIDGET_SELECT only, the allowed values
+  uint8_t optionCount;
+};
+
+extern const myFieldDescriptor BUTTON_FIELDS[];
+extern const uint8_t BUTTON_FIELD_COUNT;
+
+#define FIELD_MAX_BUTTONS 15
+#define FIELD_MAX_SLOTS 16 // per button: the fields and other controls such as the map select
+#define FIELD_INDEX_MAX_ID 512 // ESPUI hands out ids from 1 in creation order
+
+enum my_field_result {
+  FIELD_OK = 0,
+  FIELD_NOT_A_NUMBER,
+  FIELD_OUT_OF_RANGE, // outside min .. max or not one of the options
+  FIELD_UNKNOWN,      // no such field
+};
+
+class ButtonFieldRegistry {
+public:
+  ButtonFieldRegistry();
+
+  // ~ control id -> (button, slot) ~
+  void clearControls();
+  // slot: a field of BUTTON_FIELDS or any other per button control, up to FIELD_MAX_SLOTS
+  bool bindControl(uint16_t controlId, uint8_t button, uint8_t slot);
+  bool findControl(uint16_t controlId, uint8_t& button, uint8_t& slot) const;
+
+  // ~ values ~
+  // value as the widget shows it
+  int32_t uiValue(const myMapButton& btn, uint8_t field) const;
+  // validate a value as the widget sends it and store it
+  my_field_result setUiValue(myMapButton& btn, uint8_t field, int32_t value) const;
+  // the same from the text of a control, no allocation
+  my_field_result setUiText(myMapButton& btn, uint8_t field, const char* text) const;
+
+private:
+  uint8_t _byId[FIELD_INDEX_MAX_ID]; // button << 4 | slot, 0xFF = not bound
+};
+
+// "12", "-3" -> value, false for empty text, other characters or more than 9 digits
+bool parseFieldNumber(const char* text, int32_t& value);
+
+const char* fieldResultName(my_field_result result);
+
+#endif // BUTTON_FIELDS_H
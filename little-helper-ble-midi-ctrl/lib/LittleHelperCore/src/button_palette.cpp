@@ -0,0 +1,29 @@
+/**
+ * @file button_palette.cpp
+ * @brief The button colors, a fixed palette of the HTML colors FastLED knows by name.
+ */
+
+#include "button_palette.h"
+
+const uint32_t BUTTON_PALETTE[BUTTON_PALETTE_SIZE] = {
+#define PALETTE_RGB(name, rgb) rgb,
+  BUTTON_PALETTE_COLORS(PALETTE_RGB)
+#undef PALETTE_RGB
+};
+
+uint8_t nearestPaletteColor(uint32_t rgb) {
+  uint8_t best = 0;
+  uint32_t bestDistance = UINT32_MAX;
+  for (uint8_t i = 0; i < BUTTON_PALETTE_SIZE; i++) {
+    int32_t dr = (int32_t)((BUTTON_PALETTE[i] >> 16) & 0xFF) - (int32_t)((rgb >> 16) & 0xFF);
+    int32_t dg = (int32_t)((BUTTON_PALETTE[i] >> 8) & 0xFF) - (int32_t)((rgb >> 8) & 0xFF);
+    int32_t db = (int32_t)(BUTTON_PALETTE[i] & 0xFF) - (int32_t)(rgb & 0xFF);
+    uint32_t distance = dr * dr + dg * dg + db * db;
+    if (distance < bestDistance) {
+      best = i;
+      bestDistance = distance;
+      if (distance == 0) break;
+    }
+  }
+  return best;
+}
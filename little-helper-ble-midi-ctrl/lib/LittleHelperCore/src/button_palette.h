@@ -0,0 +1,82 @@
+/**
+ * @file button_palette.h
+ * @brief The button colors, a fixed palette of the HTML colors FastLED knows by name.
+ *
+ * @details A button stores the palette index of its color (one byte) instead of the RGB
+ * value, so the configurator shows and sets the index without a search and the LED gets
+ * the color with one read. The firmware checks every entry against CRGB::HTMLColorCode.
+ */
+
+#ifndef BUTTON_PALETTE_H
+#define BUTTON_PALETTE_H
+
+#include <stdint.h>
+
+// X(name, 0xRRGGBB), the order is the order of the configurator color slider
+#define BUTTON_PALETTE_COLORS(X) \
+  X(AliceBlue, 0xF0F8FF) X(Amethyst, 0x9966CC) X(AntiqueWhite, 0xFAEBD7) \
+  X(Aqua, 0x00FFFF) X(Aquamarine, 0x7FFFD4) X(Azure, 0xF0FFFF) \
+  X(Beige, 0xF5F5DC) X(Bisque, 0xFFE4C4) X(Black, 0x000000) \
+  X(BlanchedAlmond, 0xFFEBCD) X(Blue, 0x0000FF) X(BlueViolet, 0x8A2BE2) \
+  X(Brown, 0xA52A2A) X(BurlyWood, 0xDEB887) X(CadetBlue, 0x5F9EA0) \
+  X(Chartreuse, 0x7FFF00) X(Chocolate, 0xD2691E) X(Coral, 0xFF7F50) \
+  X(CornflowerBlue, 0x6495ED) X(Cornsilk, 0xFFF8DC) X(Crimson, 0xDC143C) \
+  X(Cyan, 0x00FFFF) X(DarkBlue, 0x00008B) X(DarkCyan, 0x008B8B) \
+  X(DarkGoldenrod, 0xB8860B) X(DarkGray, 0xA9A9A9) X(DarkGreen, 0x006400) \
+  X(DarkKhaki, 0xBDB76B) X(DarkMagenta, 0x8B008B) X(DarkOliveGreen, 0x556B2F) \
+  X(DarkOrange, 0xFF8C00) X(DarkOrchid, 0x9932CC) X(DarkRed, 0x8B0000) \
+  X(DarkSalmon, 0xE9967A) X(DarkSeaGreen, 0x8FBC8F) X(DarkSlateBlue, 0x483D8B) \
+  X(DarkSlateGray, 0x2F4F4F) X(DarkTurquoise, 0x00CED1) X(DarkViolet, 0x9400D3) \
+  X(DeepPink, 0xFF1493) X(FloralWhite, 0xFFFAF0) X(ForestGreen, 0x228B22) \
+  X(Fuchsia, 0xFF00FF) X(Gainsboro, 0xDCDCDC) X(GhostWhite, 0xF8F8FF) \
+  X(Gold, 0xFFD700) X(Goldenrod, 0xDAA520) X(Gray, 0x808080) \
+  X(Green, 0x008000) X(GreenYellow, 0xADFF2F) X(Honeydew, 0xF0FFF0) \
+  X(HotPink, 0xFF69B4) X(IndianRed, 0xCD5C5C) X(Indigo, 0x4B0082) \
+  X(Ivory, 0xFFFFF0) X(Khaki, 0xF0E68C) X(Lavender, 0xE6E6FA) \
+  X(LavenderBlush, 0xFFF0F5) X(LawnGreen, 0x7CFC00) X(LemonChiffon, 0xFFFACD) \
+  X(LightBlue, 0xADD8E6) X(LightCoral, 0xF08080) X(LightCyan, 0xE0FFFF) \
+  X(LightGoldenrodYellow, 0xFAFAD2) X(LightGreen, 0x90EE90) X(LightGrey, 0xD3D3D3) \
+  X(LightPink, 0xFFB6C1) X(LightSalmon, 0xFFA07A) X(LightSeaGreen, 0x20B2AA) \
+  X(LightSkyBlue, 0x87CEFA) X(LightSlateGray, 0x778899) X(LightSlateGrey, 0x778899) \
+  X(LightSteelBlue, 0xB0C4DE) X(LightYellow, 0xFFFFE0) X(Lime, 0x00FF00) \
+  X(LimeGreen, 0x32CD32) X(Linen, 0xFAF0E6) X(Magenta, 0xFF00FF) \
+  X(Maroon, 0x800000) X(MediumAquamarine, 0x66CDAA) X(MediumBlue, 0x0000CD) \
+  X(MediumOrchid, 0xBA55D3) X(MediumPurple, 0x9370DB) X(MediumSeaGreen, 0x3CB371) \
+  X(MediumSlateBlue, 0x7B68EE) X(MediumSpringGreen, 0x00FA9A) X(MediumTurquoise, 0x48D1CC) \
+  X(MediumVioletRed, 0xC71585) X(MidnightBlue, 0x191970) X(MintCream, 0xF5FFFA) \
+  X(MistyRose, 0xFFE4E1) X(Moccasin, 0xFFE4B5) X(NavajoWhite, 0xFFDEAD) \
+  X(Navy, 0x000080) X(OldLace, 0xFDF5E6) X(Olive, 0x808000) \
+  X(OliveDrab, 0x6B8E23) X(Orange, 0xFFA500) X(OrangeRed, 0xFF4500) \
+  X(Orchid, 0xDA70D6) X(PaleGoldenrod, 0xEEE8AA) X(PaleGreen, 0x98FB98) \
+  X(PaleTurquoise, 0xAFEEEE) X(PaleVioletRed, 0xDB7093) X(PapayaWhip, 0xFFEFD5) \
+  X(PeachPuff, 0xFFDAB9) X(Peru, 0xCD853F) X(Pink, 0xFFC0CB) \
+  X(Plaid, 0xCC5533) X(Plum, 0xDDA0DD) X(PowderBlue, 0xB0E0E6) \
+  X(Purple, 0x800080) X(Red, 0xFF0000) X(RosyBrown, 0xBC8F8F) \
+  X(RoyalBlue, 0x4169E1) X(SaddleBrown, 0x8B4513) X(Salmon, 0xFA8072) \
+  X(SandyBrown, 0xF4A460) X(SeaGreen, 0x2E8B57) X(Seashell, 0xFFF5EE) \
+  X(Sienna, 0xA0522D) X(Silver, 0xC0C0C0) X(SkyBlue, 0x87CEEB) \
+  X(SlateBlue, 0x6A5ACD) X(SlateGray, 0x708090) X(SlateGrey, 0x708090) \
+  X(Snow, 0xFFFAFA) X(SpringGreen, 0x00FF7F) X(SteelBlue, 0x4682B4) \
+  X(Tan, 0xD2B48C) X(Teal, 0x008080) X(Thistle, 0xD8BFD8) \
+  X(Tomato, 0xFF6347) X(Turquoise, 0x40E0D0) X(Violet, 0xEE82EE) \
+  X(Wheat, 0xF5DEB3) X(White, 0xFFFFFF) X(WhiteSmoke, 0xF5F5F5) \
+  X(Yellow, 0xFFFF00) X(YellowGreen, 0x9ACD32)
+
+enum my_palette_color {
+#define PALETTE_ENUM(name, rgb) PALETTE_##name,
+  BUTTON_PALETTE_COLORS(PALETTE_ENUM)
+#undef PALETTE_ENUM
+  BUTTON_PALETTE_SIZE
+};
+
+extern const uint32_t BUTTON_PALETTE[BUTTON_PALETTE_SIZE];
+
+// RGB of a palette index, black for an index out of the palette
+inline uint32_t paletteColor(uint8_t index) {
+  return index < BUTTON_PALETTE_SIZE ? BUTTON_PALETTE[index] : 0;
+}
+
+// index of the palette color closest to rgb, for colors stored as RGB by older firmware
+uint8_t nearestPaletteColor(uint32_t rgb);
+
+#endif // BUTTON_PALETTE_H
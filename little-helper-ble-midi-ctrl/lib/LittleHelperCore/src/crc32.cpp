@@ -0,0 +1,23 @@
+/**
+ * @file crc32.cpp
+ * @brief CRC-32 (IEEE 802.3, the zlib one) for stored records.
+ */
+
+#include "crc32.h"
+
+// nibble table, 64 bytes instead of 1k, fast enough for records of a few hundred bytes
+static const uint32_t __crcNibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t crc32(const void* data, size_t len, uint32_t crc) {
+  const uint8_t* p = (const uint8_t*)data;
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ __crcNibble[crc & 0x0F];
+    crc = (crc >> 4) ^ __crcNibble[crc & 0x0F];
+  }
+  return ~crc;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 (IEEE 802.3, the zlib one) for stored records.
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// crc of data, pass the previous result as crc to continue over several buffers
+uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+
+#endif // CRC32_H
@@ -0,0 +1,121 @@
+/**
+ * @file delta_patch.cpp
+ * @brief Streaming applier of the delta patches made by tools/mkdelta.py.
+ */
+
+#include "delta_patch.h"
+#include "crc32.h"
+#include <string.h>
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool decodeDeltaHeader(const uint8_t* buf, size_t len, myDeltaHeader& header) {
+  if (buf == nullptr || len < DELTA_HEADER_SIZE) return false;
+  if (buf[0] != 'L' || buf[1] != 'H' || buf[2] != 'D' || buf[3] != 'P') return false;
+  if (crc32(buf, DELTA_HEADER_SIZE - 4) != get32(buf + DELTA_HEADER_SIZE - 4)) return false;
+  if (buf[4] != DELTA_PATCH_VERSION) return false;
+  header.sourceSize = get32(buf + 8);
+  header.targetSize = get32(buf + 12);
+  memcpy(header.sourceHash, buf + 16, SHA256_SIZE);
+  memcpy(header.targetHash, buf + 16 + SHA256_SIZE, SHA256_SIZE);
+  return true;
+}
+
+DeltaPatcher::DeltaPatcher(DeltaSource& source, DeltaSink& sink)
+  : _source(source), _sink(sink), _state(DELTA_FAILED), _shift(0), _value(0), _sourcePos(0),
+    _copyOffset(0), _remaining(0), _written(0) {
+  memset(&_header, 0, sizeof(_header));
+}
+
+void DeltaPatcher::begin(const myDeltaHeader& header) {
+  _header = header;
+  _state = DELTA_OPCODE;
+  _shift = 0;
+  _value = 0;
+  _sourcePos = 0;
+  _remaining = 0;
+  _written = 0;
+}
+
+// one byte of a LEB128 varint into _value, true once it is complete
+bool DeltaPatcher::readVarint(uint8_t byte) {
+  if (_shift > 28) {
+    fail();
+    return false;
+  }
+  _value |= (uint32_t)(byte & 0x7F) << _shift;
+  _shift += 7;
+  if (byte & 0x80) return false;
+  _shift = 0;
+  return true;
+}
+
+bool DeltaPatcher::copy(uint32_t offset, uint32_t len) {
+  if (offset > _header.sourceSize || len > _header.sourceSize - offset) return false;
+  if (len > _header.targetSize - _written) return false;
+  while (len) {
+    uint32_t n = len < sizeof(_buf) ? len : sizeof(_buf);
+    if (!_source.read(offset, _buf, n) || !_sink.write(_buf, n)) return false;
+    offset += n;
+    len -= n;
+    _written += n;
+  }
+  _sourcePos = offset;
+  return true;
+}
+
+size_t DeltaPatcher::feed(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while (i < len && _state != DELTA_DONE && _state != DELTA_FAILED) {
+    switch (_state) {
+      case DELTA_OPCODE: {
+        uint8_t op = data[i++];
+        _value = 0;
+        _shift = 0;
+        if (op == DELTA_OP_COPY) _state = DELTA_COPY_OFFSET;
+        else if (op == DELTA_OP_INSERT) _state = DELTA_INSERT_LENGTH;
+        else if (op == DELTA_OP_END) _state = _written == _header.targetSize ? DELTA_DONE : DELTA_FAILED;
+        else fail();
+        break;
+      }
+      case DELTA_COPY_OFFSET:
+        if (readVarint(data[i++])) {
+          int32_t delta = (int32_t)(_value >> 1) ^ -(int32_t)(_value & 1); // zigzag
+          _copyOffset = _sourcePos + delta;
+          _value = 0;
+          _state = DELTA_COPY_LENGTH;
+        }
+        break;
+      case DELTA_COPY_LENGTH:
+        if (readVarint(data[i++])) {
+          if (!copy(_copyOffset, _value)) fail();
+          else _state = DELTA_OPCODE;
+        }
+        break;
+      case DELTA_INSERT_LENGTH:
+        if (readVarint(data[i++])) {
+          _remaining = _value;
+          if (_remaining > _header.targetSize - _written) fail();
+          else _state = _remaining ? DELTA_INSERT_DATA : DELTA_OPCODE;
+        }
+        break;
+      case DELTA_INSERT_DATA: {
+        size_t n = len - i < _remaining ? len - i : _remaining;
+        if (!_sink.write(data + i, n)) {
+          fail();
+          break;
+        }
+        i += n;
+        _remaining -= n;
+        _written += n;
+        if (_remaining == 0) _state = DELTA_OPCODE;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return i;
+}
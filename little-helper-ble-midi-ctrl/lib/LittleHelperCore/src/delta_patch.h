@@ -0,0 +1,103 @@
+/**
+ * @file delta_patch.h
+ * @brief Streaming applier of the delta patches made by tools/mkdelta.py.
+ *
+ * @details A patch turns the running firmware (source) into the next one (target) and is
+ * applied while it is downloaded: feed() takes the patch in pieces of any size, the target
+ * comes out in order through the DeltaSink, copies are read from the DeltaSource. Nothing
+ * is allocated, the whole state is a few bytes and a small copy buffer.
+ *
+ *   header  'L' 'H' 'D' 'P' version reserved(3) sourceSize(4) targetSize(4)
+ *           sourceHash(32) targetHash(32) crc(4), little endian, CRC-32 over the bytes before
+ *   ops     0x01 COPY   zigzag varint offset delta, varint length
+ *                       offset = end of the previous copy + delta
+ *           0x02 INSERT varint length, length bytes
+ *           0x00 END
+ *
+ * The hashes are SHA-256 of the whole source and target image, the caller checks the
+ * source before and the target after applying.
+ */
+
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+#define DELTA_PATCH_VERSION 1
+#define DELTA_HEADER_SIZE 84
+#define DELTA_COPY_BUFFER 256
+
+#define DELTA_OP_END 0x00
+#define DELTA_OP_COPY 0x01
+#define DELTA_OP_INSERT 0x02
+
+struct myDeltaHeader {
+  uint32_t sourceSize;
+  uint32_t targetSize;
+  uint8_t sourceHash[SHA256_SIZE];
+  uint8_t targetHash[SHA256_SIZE];
+};
+
+// false if the header is broken or of an unknown version
+bool decodeDeltaHeader(const uint8_t* buf, size_t len, myDeltaHeader& header);
+
+class DeltaSource {
+public:
+  virtual ~DeltaSource() {}
+  virtual bool read(uint32_t offset, uint8_t* buf, size_t len) = 0;
+};
+
+class DeltaSink {
+public:
+  virtual ~DeltaSink() {}
+  virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+enum my_delta_state {
+  DELTA_OPCODE = 0,
+  DELTA_COPY_OFFSET,
+  DELTA_COPY_LENGTH,
+  DELTA_INSERT_LENGTH,
+  DELTA_INSERT_DATA,
+  DELTA_DONE,
+  DELTA_FAILED,
+};
+
+class DeltaPatcher {
+public:
+  DeltaPatcher(DeltaSource& source, DeltaSink& sink);
+
+  // start a patch, the header was read and decoded by the caller
+  void begin(const myDeltaHeader& header);
+
+  /**
+   * @brief Apply the next piece of the patch.
+   * @return bytes consumed, less than len only once the patch is done or failed
+   */
+  size_t feed(const uint8_t* data, size_t len);
+
+  bool done() const { return _state == DELTA_DONE; }
+  bool failed() const { return _state == DELTA_FAILED; }
+  uint32_t written() const { return _written; }
+
+private:
+  bool readVarint(uint8_t byte);
+  bool copy(uint32_t offset, uint32_t len);
+  void fail() { _state = DELTA_FAILED; }
+
+  DeltaSource& _source;
+  DeltaSink& _sink;
+  myDeltaHeader _header;
+  uint8_t _state;
+  uint8_t _shift;
+  uint32_t _value;
+  uint32_t _sourcePos;   // end of the previous copy
+  uint32_t _copyOffset;
+  uint32_t _remaining;   // insert bytes still to come
+  uint32_t _written;
+  uint8_t _buf[DELTA_COPY_BUFFER];
+};
+
+#endif // DELTA_PATCH_H
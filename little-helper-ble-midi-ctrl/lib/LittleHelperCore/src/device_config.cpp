@@ -0,0 +1,128 @@
+/**
+ * @file device_config.cpp
+ * @brief All device settings except the button maps in one versioned, CRC protected record.
+ */
+
+#include "device_config.h"
+#include "crc32.h"
+#include <string.h>
+
+static_assert(DEVICE_CONFIG_FIELD_SSID == DEVICE_CONFIG_FIELD_BLE_NAME + DEVICE_CONFIG_NAME_LEN + 1
+  && DEVICE_CONFIG_FIELD_PASSWORD == DEVICE_CONFIG_FIELD_SSID + DEVICE_CONFIG_NAME_LEN + 1
+  && DEVICE_CONFIG_FIELD_AP_SSID == DEVICE_CONFIG_FIELD_PASSWORD + DEVICE_CONFIG_PASSWORD_LEN + 1
+  && DEVICE_CONFIG_FIELD_AP_PASSWORD == DEVICE_CONFIG_FIELD_AP_SSID + DEVICE_CONFIG_AP_SSID_LEN + 1
+  && DEVICE_CONFIG_FIELD_HOSTNAME == DEVICE_CONFIG_FIELD_AP_PASSWORD + DEVICE_CONFIG_PASSWORD_LEN + 1
+  && DEVICE_CONFIG_FIELD_MMC_DEVICE_ID == DEVICE_CONFIG_FIELD_HOSTNAME + DEVICE_CONFIG_NAME_LEN + 1
+  && DEVICE_CONFIG_FIELD_MMC_DEVICE_ID < DEVICE_CONFIG_PAYLOAD_SIZE, "the string fields follow each other");
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v; p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint16_t get16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// a 0 terminated string into its field, 0 padded
+static void putString(uint8_t* p, const char* value, size_t size) {
+  size_t len = strnlen(value, size - 1);
+  memcpy(p, value, len);
+  memset(p + len, 0, size - len);
+}
+
+// never trust the terminator of a stored string
+static void getString(char* value, size_t size, const uint8_t* p) {
+  memcpy(value, p, size);
+  value[size - 1] = 0;
+}
+
+DeviceConfig::DeviceConfig() : _dirty(false) {
+  memset(&_data, 0, sizeof(_data));
+  _data.updateErrorCode = -1;
+  _data.mmcDeviceId = DEVICE_CONFIG_MMC_ALL_CALL;
+}
+
+bool DeviceConfig::setString(char* field, size_t size, const char* value) {
+  if (value == nullptr) value = "";
+  size_t len = strlen(value);
+  if (len >= size) return false;
+  if (strcmp(field, value) == 0) return true;
+  memset(field, 0, size);
+  memcpy(field, value, len);
+  _dirty = true;
+  return true;
+}
+
+bool DeviceConfig::decode(const uint8_t* record, size_t len) {
+
+  if (record == nullptr || len < DEVICE_CONFIG_HEADER_SIZE + DEVICE_CONFIG_CRC_SIZE) return false;
+  if (get16(record) != DEVICE_CONFIG_MAGIC) return false;
+  uint8_t version = record[2];
+  uint16_t length = get16(record + 4);
+  if ((size_t)DEVICE_CONFIG_HEADER_SIZE + length + DEVICE_CONFIG_CRC_SIZE != len) return false;
+  if (crc32(record, DEVICE_CONFIG_HEADER_SIZE + length) != get32(record + DEVICE_CONFIG_HEADER_SIZE + length)) return false;
+  if (length != DEVICE_CONFIG_PAYLOAD_SIZE) return false;
+
+  const uint8_t* p = record + DEVICE_CONFIG_HEADER_SIZE;
+  myDeviceConfig data;
+  memset(&data, 0, sizeof(data));
+  switch (version) {
+    case 1:
+      data.mmcDeviceId = DEVICE_CONFIG_MMC_ALL_CALL; // what version 1 sent
+      break;
+    case 2:
+      data.mmcDeviceId = p[DEVICE_CONFIG_FIELD_MMC_DEVICE_ID] & 0x7F;
+      break;
+    default:
+      return false;
+  }
+  data.updateErrorCode = (int32_t)get32(p + DEVICE_CONFIG_FIELD_UPDATE_ERROR);
+  data.fwVersion = get32(p + DEVICE_CONFIG_FIELD_FW_VERSION);
+  data.updateFailure = p[DEVICE_CONFIG_FIELD_UPDATE_FAILURE];
+  data.doUpdate = p[DEVICE_CONFIG_FIELD_DO_UPDATE];
+  data.activeMap = p[DEVICE_CONFIG_FIELD_ACTIVE_MAP];
+  data.ledBrightness = p[DEVICE_CONFIG_FIELD_BRIGHTNESS];
+  getString(data.bleName, sizeof(data.bleName), p + DEVICE_CONFIG_FIELD_BLE_NAME);
+  getString(data.ssid, sizeof(data.ssid), p + DEVICE_CONFIG_FIELD_SSID);
+  getString(data.password, sizeof(data.password), p + DEVICE_CONFIG_FIELD_PASSWORD);
+  getString(data.apSsid, sizeof(data.apSsid), p + DEVICE_CONFIG_FIELD_AP_SSID);
+  getString(data.apPassword, sizeof(data.apPassword), p + DEVICE_CONFIG_FIELD_AP_PASSWORD);
+  getString(data.hostname, sizeof(data.hostname), p + DEVICE_CONFIG_FIELD_HOSTNAME);
+
+  _data = data;
+  _dirty = false;
+  return true;
+}
+
+size_t DeviceConfig::encode(uint8_t* buf) const {
+  memset(buf, 0, DEVICE_CONFIG_RECORD_SIZE);
+  put16(buf, DEVICE_CONFIG_MAGIC);
+  buf[2] = DEVICE_CONFIG_VERSION;
+  put16(buf + 4, DEVICE_CONFIG_PAYLOAD_SIZE);
+
+  uint8_t* p = buf + DEVICE_CONFIG_HEADER_SIZE;
+  put32(p + DEVICE_CONFIG_FIELD_UPDATE_ERROR, (uint32_t)_data.updateErrorCode);
+  put32(p + DEVICE_CONFIG_FIELD_FW_VERSION, _data.fwVersion);
+  p[DEVICE_CONFIG_FIELD_UPDATE_FAILURE] = _data.updateFailure;
+  p[DEVICE_CONFIG_FIELD_DO_UPDATE] = _data.doUpdate;
+  p[DEVICE_CONFIG_FIELD_ACTIVE_MAP] = _data.activeMap;
+  p[DEVICE_CONFIG_FIELD_BRIGHTNESS] = _data.ledBrightness;
+  putString(p + DEVICE_CONFIG_FIELD_BLE_NAME, _data.bleName, sizeof(_data.bleName));
+  putString(p + DEVICE_CONFIG_FIELD_SSID, _data.ssid, sizeof(_data.ssid));
+  putString(p + DEVICE_CONFIG_FIELD_PASSWORD, _data.password, sizeof(_data.password));
+  putString(p + DEVICE_CONFIG_FIELD_AP_SSID, _data.apSsid, sizeof(_data.apSsid));
+  putString(p + DEVICE_CONFIG_FIELD_AP_PASSWORD, _data.apPassword, sizeof(_data.apPassword));
+  putString(p + DEVICE_CONFIG_FIELD_HOSTNAME, _data.hostname, sizeof(_data.hostname));
+  p[DEVICE_CONFIG_FIELD_MMC_DEVICE_ID] = _data.mmcDeviceId;
+
+  put32(p + DEVICE_CONFIG_PAYLOAD_SIZE, crc32(buf, DEVICE_CONFIG_HEADER_SIZE + DEVICE_CONFIG_PAYLOAD_SIZE));
+  return DEVICE_CONFIG_RECORD_SIZE;
+}
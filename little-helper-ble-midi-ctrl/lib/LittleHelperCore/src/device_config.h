@@ -0,0 +1,135 @@
+/**
+ * @file device_config.h
+ * @brief All device settings except the button maps in one versioned, CRC protected record.
+ *
+ * @details Replaces the single values in the NVS namespaces "updateerrorcode", "updatefail",
+ * "doupdate", "fwversion", "active_map", "blename" and "wifi". The record is read with one
+ * NVS read at boot and kept in RAM, the values are read and written through the typed
+ * accessors, a setter that changes a value marks the record dirty.
+ *
+ * The record is written byte by byte, never as struct memory, like the map records
+ * (map_codec.h), so the compiler or a change of myDeviceConfig does not change what is stored:
+ *
+ *   header   magic(2, LE) version reserved payloadLength(2, LE)
+ *   payload  the DEVICE_CONFIG_FIELD_* offsets, numbers little endian, strings 0 padded
+ *   crc      CRC-32 over header and payload (4, LE)
+ *
+ * The offsets are those of the struct memory the first firmware stored, so its records read
+ * unchanged. Version 1 has no MMC device ID, its byte was padding. A record of an older
+ * version is migrated on decode, a newer, unknown or broken one is rejected and the caller
+ * falls back to its defaults.
+ */
+
+#ifndef DEVICE_CONFIG_H
+#define DEVICE_CONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEVICE_CONFIG_MAGIC 0x474C // "LG"
+#define DEVICE_CONFIG_VERSION 2
+
+#define DEVICE_CONFIG_NAME_LEN 32     // BLE name, wifi SSID, hostname
+#define DEVICE_CONFIG_AP_SSID_LEN 16  // the web UI allows 16 characters
+#define DEVICE_CONFIG_PASSWORD_LEN 64 // WPA2 passphrase max. 63
+#define DEVICE_CONFIG_MMC_ALL_CALL 0x7F // MMC device ID every receiver answers to
+
+#define DEVICE_CONFIG_HEADER_SIZE 6
+#define DEVICE_CONFIG_CRC_SIZE 4
+
+// field offsets in the payload
+#define DEVICE_CONFIG_FIELD_UPDATE_ERROR 0    // int32
+#define DEVICE_CONFIG_FIELD_FW_VERSION 4      // uint32
+#define DEVICE_CONFIG_FIELD_UPDATE_FAILURE 8
+#define DEVICE_CONFIG_FIELD_DO_UPDATE 9
+#define DEVICE_CONFIG_FIELD_ACTIVE_MAP 10
+#define DEVICE_CONFIG_FIELD_BRIGHTNESS 11
+#define DEVICE_CONFIG_FIELD_BLE_NAME 12       // DEVICE_CONFIG_NAME_LEN + 1
+#define DEVICE_CONFIG_FIELD_SSID 45           // DEVICE_CONFIG_NAME_LEN + 1
+#define DEVICE_CONFIG_FIELD_PASSWORD 78       // DEVICE_CONFIG_PASSWORD_LEN + 1
+#define DEVICE_CONFIG_FIELD_AP_SSID 143       // DEVICE_CONFIG_AP_SSID_LEN + 1
+#define DEVICE_CONFIG_FIELD_AP_PASSWORD 160   // DEVICE_CONFIG_PASSWORD_LEN + 1
+#define DEVICE_CONFIG_FIELD_HOSTNAME 225      // DEVICE_CONFIG_NAME_LEN + 1
+#define DEVICE_CONFIG_FIELD_MMC_DEVICE_ID 258 // version 2
+#define DEVICE_CONFIG_PAYLOAD_SIZE 260        // both versions, the rest is 0
+
+#define DEVICE_CONFIG_RECORD_SIZE (DEVICE_CONFIG_HEADER_SIZE + DEVICE_CONFIG_PAYLOAD_SIZE + DEVICE_CONFIG_CRC_SIZE)
+
+// the values in RAM, strings are 0 terminated
+struct myDeviceConfig {
+  int32_t updateErrorCode;
+  uint32_t fwVersion;
+  uint8_t updateFailure;
+  uint8_t doUpdate;
+  uint8_t activeMap;
+  uint8_t ledBrightness;
+  char bleName[DEVICE_CONFIG_NAME_LEN + 1];
+  char ssid[DEVICE_CONFIG_NAME_LEN + 1];
+  char password[DEVICE_CONFIG_PASSWORD_LEN + 1];
+  char apSsid[DEVICE_CONFIG_AP_SSID_LEN + 1];
+  char apPassword[DEVICE_CONFIG_PASSWORD_LEN + 1];
+  char hostname[DEVICE_CONFIG_NAME_LEN + 1];
+  uint8_t mmcDeviceId; // 0 - 126 one device, 0x7F all call
+};
+
+class DeviceConfig {
+public:
+  DeviceConfig();
+
+  /**
+   * @brief Load a stored record.
+   * @return false if the record is missing, broken or of an unknown version, the values are unchanged then
+   */
+  bool decode(const uint8_t* record, size_t len);
+
+  // write the current values as record, buf must hold DEVICE_CONFIG_RECORD_SIZE bytes, returns the size
+  size_t encode(uint8_t* buf) const;
+
+  bool dirty() const { return _dirty; }
+  void markDirty() { _dirty = true; }
+  void clearDirty() { _dirty = false; }
+
+  // ~ typed accessors ~
+  int32_t updateErrorCode() const { return _data.updateErrorCode; }
+  void setUpdateErrorCode(int32_t code) { set(_data.updateErrorCode, code); }
+  uint32_t fwVersion() const { return _data.fwVersion; }
+  void setFwVersion(uint32_t version) { set(_data.fwVersion, version); }
+  bool updateFailure() const { return _data.updateFailure; }
+  void setUpdateFailure(bool failure) { set(_data.updateFailure, (uint8_t)failure); }
+  bool doUpdate() const { return _data.doUpdate; }
+  void setDoUpdate(bool update) { set(_data.doUpdate, (uint8_t)update); }
+  uint8_t activeMap() const { return _data.activeMap; }
+  void setActiveMap(uint8_t map) { set(_data.activeMap, map); }
+  uint8_t ledBrightness() const { return _data.ledBrightness; }
+  void setLedBrightness(uint8_t brightness) { set(_data.ledBrightness, brightness); }
+  uint8_t mmcDeviceId() const { return _data.mmcDeviceId; }
+  void setMmcDeviceId(uint8_t id) { set(_data.mmcDeviceId, (uint8_t)(id & 0x7F)); }
+
+  const char* bleName() const { return _data.bleName; }
+  bool setBleName(const char* name) { return setString(_data.bleName, sizeof(_data.bleName), name); }
+  const char* ssid() const { return _data.ssid; }
+  bool setSsid(const char* ssid) { return setString(_data.ssid, sizeof(_data.ssid), ssid); }
+  const char* password() const { return _data.password; }
+  bool setPassword(const char* password) { return setString(_data.password, sizeof(_data.password), password); }
+  const char* apSsid() const { return _data.apSsid; }
+  bool setApSsid(const char* ssid) { return setString(_data.apSsid, sizeof(_data.apSsid), ssid); }
+  const char* apPassword() const { return _data.apPassword; }
+  bool setApPassword(const char* password) { return setString(_data.apPassword, sizeof(_data.apPassword), password); }
+  const char* hostname() const { return _data.hostname; }
+  bool setHostname(const char* hostname) { return setString(_data.hostname, sizeof(_data.hostname), hostname); }
+
+private:
+  template <typename T>
+  void set(T& field, T value) {
+    if (field == value) return;
+    field = value;
+    _dirty = true;
+  }
+  // false if the value does not fit, the field is unchanged then
+  bool setString(char* field, size_t size, const char* value);
+
+  myDeviceConfig _data;
+  bool _dirty;
+};
+
+#endif // DEVICE_CONFIG_H
@@ -0,0 +1,51 @@
+/**
+ * @file edge_debouncer.cpp
+ * @brief Timestamp based debounce of GPIO edges.
+ */
+
+#include "edge_debouncer.h"
+
+EdgeDebouncer::EdgeDebouncer(uint32_t debounceUs) : _debounceUs(debounceUs) {
+  for (uint8_t i = 0; i < EDGE_DEBOUNCE_MAX_BUTTONS; i++) {
+    _edgeUs[i] = 0;
+    _level[i] = 1; // buttons are active low
+    _pending[i] = false;
+  }
+}
+
+void EdgeDebouncer::reset(uint8_t btn, uint8_t level, uint32_t timeUs) {
+  if (btn >= EDGE_DEBOUNCE_MAX_BUTTONS) return;
+  _level[btn] = level ? 1 : 0;
+  _edgeUs[btn] = timeUs - _debounceUs;
+  _pending[btn] = false;
+}
+
+bool EdgeDebouncer::onEdge(uint8_t btn, uint8_t level, uint32_t timeUs) {
+  if (btn >= EDGE_DEBOUNCE_MAX_BUTTONS) return false;
+  level = level ? 1 : 0;
+
+  if ((uint32_t)(timeUs - _edgeUs[btn]) < _debounceUs) {
+    _pending[btn] = true; // bounce, check the final level when the window is over
+    return false;
+  }
+  if (level == _level[btn]) return false;
+
+  _level[btn] = level;
+  _edgeUs[btn] = timeUs;
+  _pending[btn] = true;
+  return true;
+}
+
+bool EdgeDebouncer::settle(uint8_t btn, uint8_t level, uint32_t nowUs) {
+  if (btn >= EDGE_DEBOUNCE_MAX_BUTTONS || !_pending[btn]) return false;
+  if ((uint32_t)(nowUs - _edgeUs[btn]) < _debounceUs) return false;
+
+  _pending[btn] = false;
+  level = level ? 1 : 0;
+  if (level == _level[btn]) return false;
+
+  _level[btn] = level;
+  _edgeUs[btn] = nowUs;
+  _pending[btn] = true;
+  return true;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file edge_debouncer.h
+ * @brief Timestamp based debounce of GPIO edges.
+ *
+ * @details The first edge after a quiet period is accepted at once (no added latency),
+ * further edges within the debounce window are treated as contact bounce. When the
+ * window is over, settle() compares the real pin level with the accepted one and
+ * accepts a missed final edge.
+ */
+
+#ifndef EDGE_DEBOUNCER_H
+#define EDGE_DEBOUNCER_H
+
+#include <stdint.h>
+
+#define EDGE_DEBOUNCE_MAX_BUTTONS 8
+#define EDGE_DEBOUNCE_US 5000 // 5 ms
+
+class EdgeDebouncer {
+public:
+  explicit EdgeDebouncer(uint32_t debounceUs = EDGE_DEBOUNCE_US);
+
+  // set the level of a button without debounce, for example at boot
+  void reset(uint8_t btn, uint8_t level, uint32_t timeUs);
+
+  /**
+   * @brief Feed one edge as seen by the ISR.
+   *
+   * @return true if the edge changed the debounced level
+   */
+  bool onEdge(uint8_t btn, uint8_t level, uint32_t timeUs);
+
+  /**
+   * @brief Accept the real pin level once the debounce window is over.
+   *
+   * @return true if the debounced level changed
+   */
+  bool settle(uint8_t btn, uint8_t level, uint32_t nowUs);
+
+  // true while a button is inside its debounce window and needs a settle() call
+  bool pending(uint8_t btn) const { return btn < EDGE_DEBOUNCE_MAX_BUTTONS && _pending[btn]; }
+
+  uint8_t level(uint8_t btn) const { return btn < EDGE_DEBOUNCE_MAX_BUTTONS ? _level[btn] : 1; }
+
+  // time of the last accepted edge in us
+  uint32_t edgeTime(uint8_t btn) const { return btn < EDGE_DEBOUNCE_MAX_BUTTONS ? _edgeUs[btn] : 0; }
+
+  uint32_t debounceUs() const { return _debounceUs; }
+
+private:
+  uint32_t _debounceUs;
+  uint32_t _edgeUs[EDGE_DEBOUNCE_MAX_BUTTONS];
+  uint8_t _level[EDGE_DEBOUNCE_MAX_BUTTONS];
+  bool _pending[EDGE_DEBOUNCE_MAX_BUTTONS];
+};
+
+#endif // EDGE_DEBOUNCER_H
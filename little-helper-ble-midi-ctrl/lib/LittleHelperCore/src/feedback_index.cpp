@@ -0,0 +1,82 @@
+/**
+ * @file feedback_index.cpp
+ * @brief DAW feedback: incoming Note and CC messages set the toggle state of the buttons bound to them.
+ */
+
+#include "feedback_index.h"
+
+#include <string.h>
+
+#define FEEDBACK_KEY_CC 0x80
+
+FeedbackIndex::FeedbackIndex() : _numKeys(0), _matched(0), _unmatched(0) {
+  memset(_buttons, 0, sizeof(_buttons));
+  memset(_values, FEEDBACK_UNKNOWN, sizeof(_values));
+}
+
+int16_t FeedbackIndex::keyOf(const myMapButton& btn) {
+  if (btn.btnFunction != BTN_TOGGLE || btn.btnMacro) return -1;
+  uint16_t channel = (btn.btnMidiChannel & 0x0F) << 8;
+  if (btn.btnMidiFunction == MIDI_NOTE) return channel | (btn.btnMidiNote & 0x7F);
+  if (btn.btnMidiFunction == MIDI_CC) return channel | FEEDBACK_KEY_CC | (btn.btnMidiCC & 0x7F);
+  return -1;
+}
+
+void FeedbackIndex::rebuild(const myMapButton* buttons, uint8_t numButtons) {
+  for (uint8_t k = 0; k < _numKeys; k++) _buttons[_keys[k]] = 0;
+  _numKeys = 0;
+  if (numButtons > MIDI_ACTION_MAX_BUTTONS) numButtons = MIDI_ACTION_MAX_BUTTONS;
+  for (uint8_t b = 0; b < numButtons; b++) {
+    int16_t key = keyOf(buttons[b]);
+    if (key < 0) continue;
+    if (_buttons[key] == 0) _keys[_numKeys++] = key;
+    _buttons[key] |= 1 << b;
+  }
+}
+
+uint8_t FeedbackIndex::receive(const uint8_t* bytes, uint8_t len, uint8_t& value) {
+  if (len != 3) return 0;
+  uint8_t kind = bytes[0] & 0xF0;
+  uint16_t key = (bytes[0] & 0x0F) << 8 | (bytes[1] & 0x7F);
+  if (kind == 0xB0) {
+    key |= FEEDBACK_KEY_CC;
+    value = bytes[2] & 0x7F;
+  } else if (kind == 0x90 || kind == 0x80) {
+    value = kind == 0x90 ? bytes[2] & 0x7F : 0; // Note On with velocity 0 is a Note Off too
+  } else {
+    return 0;
+  }
+  _values[key] = value;
+  uint8_t buttons = _buttons[key];
+  if (buttons) _matched++;
+  else _unmatched++;
+  return buttons;
+}
+
+uint8_t FeedbackIndex::stateOf(const myMapButton& btn, uint8_t value) {
+  if (btn.btnMidiFunction == MIDI_NOTE) return value ? BTN_ON : BTN_OFF;
+  if (value == btn.btnMidiCCValueStateOn) return BTN_ON;
+  if (value == btn.btnMidiCCValueStateOff) return BTN_OFF;
+  return value >= 64 ? BTN_ON : BTN_OFF;
+}
+
+void FeedbackIndex::keep(const myMapButton* buttons, const uint8_t* states, uint8_t numButtons) {
+  for (uint8_t b = 0; b < numButtons; b++) {
+    const myMapButton& btn = buttons[b];
+    int16_t key = keyOf(btn);
+    if (key < 0) continue;
+    bool on = states[b] == BTN_ON;
+    if (btn.btnMidiFunction == MIDI_NOTE) {
+      _values[key] = on ? (btn.btnMidiVelocity ? btn.btnMidiVelocity & 0x7F : 127) : 0;
+    } else {
+      _values[key] = (on ? btn.btnMidiCCValueStateOn : btn.btnMidiCCValueStateOff) & 0x7F;
+    }
+  }
+}
+
+void FeedbackIndex::applyTo(const myMapButton* buttons, uint8_t* states, uint8_t numButtons) const {
+  for (uint8_t b = 0; b < numButtons; b++) {
+    int16_t key = keyOf(buttons[b]);
+    if (key >= 0 && _values[key] != FEEDBACK_UNKNOWN) states[b] = stateOf(buttons[b], _values[key]);
+  }
+}
@@ -0,0 +1,74 @@
+/**
+ * @file feedback_index.h
+ * @brief DAW feedback: incoming Note and CC messages set the toggle state of the buttons bound to them.
+ *
+ * @details A DAW with feedback (Ardour: Generic MIDI, "Enable Feedback") sends the state of
+ * a binding whenever it changes, record arm or loop changed in the DAW itself included.
+ * The index has one entry per (channel, Note/CC, number), 4096 in all:
+ *
+ *   buttons  the toggle buttons of the active map bound to the key, bit per button
+ *   value    the value the key had last, from the DAW or from a map that was left
+ *
+ * rebuild() sets the buttons of the active map after every compile of the action table, so
+ * an incoming message is two indexed reads no matter how many maps there are. The map that
+ * is left keeps its toggle states in the values (keep()), the map that is activated takes
+ * its toggle states from them (applyTo()).
+ *
+ * Indexed are toggle buttons (BTN_TOGGLE) sending a Note or a CC and playing no macro. A CC
+ * is on at btnMidiCCValueStateOn, off at btnMidiCCValueStateOff, any other value is on from 64.
+ * A Note is on with a Note On of velocity > 0.
+ *
+ * Not thread safe, the caller serializes rebuild() with the other calls.
+ */
+
+#ifndef FEEDBACK_INDEX_H
+#define FEEDBACK_INDEX_H
+
+#include <stdint.h>
+#include "button_config.h"
+#include "midi_action_table.h"
+
+#define FEEDBACK_KEYS (16 * 2 * 128) // channel x Note/CC x number
+#define FEEDBACK_UNKNOWN 0xFF        // no value for this key yet
+
+static_assert(MIDI_ACTION_MAX_BUTTONS <= 8, "the buttons of a key are a uint8_t bit mask");
+
+class FeedbackIndex {
+public:
+  FeedbackIndex();
+
+  // index the toggle buttons of the active map, after every compile()
+  void rebuild(const myMapButton* buttons, uint8_t numButtons);
+
+  /**
+   * @brief One incoming message, the value is kept for its key.
+   * @param value set to the value of a Note or CC, 0 for a Note Off
+   * @return the buttons of the active map bound to it, bit per button, 0 for none or no Note / CC
+   */
+  uint8_t receive(const uint8_t* bytes, uint8_t len, uint8_t& value);
+
+  // the toggle state a value means for this button, BTN_ON or BTN_OFF
+  static uint8_t stateOf(const myMapButton& btn, uint8_t value);
+
+  // the toggle states of a map that is left, for the maps bound to the same keys
+  void keep(const myMapButton* buttons, const uint8_t* states, uint8_t numButtons);
+
+  // set the toggle states of a map from the known values, the others are left as they are
+  void applyTo(const myMapButton* buttons, uint8_t* states, uint8_t numButtons) const;
+
+  uint32_t matched() const { return _matched; }     // messages for a button of the active map
+  uint32_t unmatched() const { return _unmatched; } // Note and CC messages for none
+
+private:
+  // the key of a toggle button, -1 if the button is not indexed
+  static int16_t keyOf(const myMapButton& btn);
+
+  uint8_t _buttons[FEEDBACK_KEYS];
+  uint8_t _values[FEEDBACK_KEYS];
+  uint16_t _keys[MIDI_ACTION_MAX_BUTTONS]; // keys with buttons, cleared by the next rebuild()
+  uint8_t _numKeys;
+  uint32_t _matched;
+  uint32_t _unmatched;
+};
+
+#endif // FEEDBACK_INDEX_H
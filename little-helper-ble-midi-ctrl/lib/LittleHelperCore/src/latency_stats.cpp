@@ -0,0 +1,81 @@
+/**
+ * @file latency_stats.cpp
+ * @brief Log scale latency histograms of the button -> BLE-MIDI path.
+ */
+
+#include "latency_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t highestBit(uint32_t v) {
+  return 31 - __builtin_clz(v);
+}
+
+void LatencyHistogram::reset() {
+  memset(_buckets, 0, sizeof(_buckets));
+  _count = 0;
+  _max = 0;
+}
+
+uint8_t LatencyHistogram::bucket(uint32_t us) {
+  if (us < 8) return us;
+  uint8_t octave = highestBit(us);
+  uint8_t sub = (us >> (octave - 2)) & 3;
+  return 8 + (octave - 3) * 4 + sub;
+}
+
+uint32_t LatencyHistogram::bucketUpper(uint8_t index) {
+  if (index < 8) return index;
+  uint8_t octave = 3 + (index - 8) / 4;
+  uint8_t sub = (index - 8) % 4;
+  uint32_t lower = (uint32_t)(4 + sub) << (octave - 2);
+  return lower + ((uint32_t)1 << (octave - 2)) - 1;
+}
+
+void LatencyHistogram::add(uint32_t us) {
+  _buckets[bucket(us)]++;
+  _count++;
+  if (us > _max) _max = us;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t p) const {
+  if (_count == 0) return 0;
+  uint32_t rank = (uint32_t)(((uint64_t)_count * p + 99) / 100);
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += _buckets[i];
+    if (seen >= rank) {
+      uint32_t upper = bucketUpper(i);
+      return upper < _max ? upper : _max;
+    }
+  }
+  return _max;
+}
+
+void LatencyStats::add(const myLatencySample& sample) {
+  for (uint8_t s = 0; s < LATENCY_STAGES; s++) {
+    if (sample.stageUs[s]) _stages[s].add(sample.stageUs[s]);
+  }
+}
+
+void LatencyStats::reset() {
+  for (uint8_t s = 0; s < LATENCY_STAGES; s++) _stages[s].reset();
+}
+
+const char* LatencyStats::stageName(uint8_t stage) {
+  switch (stage) {
+    case LATENCY_HANDLE: return "edge->handleEvent";
+    case LATENCY_SEND: return "edge->MIDI send";
+    case LATENCY_NOTIFY: return "edge->BLE notify";
+    default: return "?";
+  }
+}
+
+size_t LatencyStats::format(uint8_t stage, char* buf, size_t size) const {
+  const LatencyHistogram& h = _stages[stage];
+  int n = snprintf(buf, size, "%s n=%u p50=%uus p99=%uus max=%uus", stageName(stage),
+    (unsigned)h.count(), (unsigned)h.percentile(50), (unsigned)h.percentile(99), (unsigned)h.max());
+  if (n < 0) return 0;
+  return (size_t)n < size ? (size_t)n : size - 1;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file latency_stats.h
+ * @brief Log scale latency histograms of the button -> BLE-MIDI path.
+ *
+ * @details Every button event that sends MIDI becomes one myLatencySample with three
+ * stages, all measured from the GPIO edge: handleEvent() entry, the packet handed to the
+ * BLE stack and the notify completion reported by the stack. The histograms have 4 buckets
+ * per power of two (max. 25% error), so p50/p99 need no sample storage and no allocation.
+ * Samples are meant to be collected in a SpscQueue by the producing task and added here by
+ * the task that reports them.
+ */
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LATENCY_BUCKETS 124 // 0..7 us exact, then 4 buckets per power of two up to 2^32 us
+
+enum my_latency_stage {
+  LATENCY_HANDLE = 0, // edge -> handleEvent()
+  LATENCY_SEND,       // edge -> packet handed to the BLE stack
+  LATENCY_NOTIFY,     // edge -> notify completion
+  LATENCY_STAGES
+};
+
+struct myLatencySample {
+  uint32_t edgeUs;                 // esp_timer time of the edge
+  uint32_t stageUs[LATENCY_STAGES]; // time since the edge, 0 = stage not reached
+  bool packetEnd;                  // last event in its BLE packet
+};
+
+class LatencyHistogram {
+public:
+  LatencyHistogram() { reset(); }
+
+  void reset();
+  void add(uint32_t us);
+
+  uint32_t count() const { return _count; }
+  uint32_t max() const { return _max; }
+
+  // upper bound of the bucket holding the p-th percentile (0..100), never above max()
+  uint32_t percentile(uint8_t p) const;
+
+  static uint8_t bucket(uint32_t us);
+  static uint32_t bucketUpper(uint8_t index);
+
+private:
+  uint32_t _buckets[LATENCY_BUCKETS];
+  uint32_t _count;
+  uint32_t _max;
+};
+
+class LatencyStats {
+public:
+  void add(const myLatencySample& sample);
+  void reset();
+
+  const LatencyHistogram& stage(uint8_t stage) const { return _stages[stage]; }
+
+  // one line "handle n=.. p50=..us p99=..us max=..us" of a stage, returns the length
+  size_t format(uint8_t stage, char* buf, size_t size) const;
+
+  static const char* stageName(uint8_t stage);
+
+private:
+  LatencyHistogram _stages[LATENCY_STAGES];
+};
+
+#endif // LATENCY_STATS_H
@@ -0,0 +1,62 @@
+/**
+ * @file led_compositor.cpp
+ * @brief Composes the status LED from posted layers, rendered by the LED task.
+ */
+
+#include "led_compositor.h"
+
+LedCompositor::LedCompositor()
+  : _base(0), _overlay(LED_NO_COLOR), _activity(LED_NO_COLOR), _flash(LED_NO_COLOR), _brightness(0), _blinkCount(0),
+    _blinkRestart(false), _blinkStart(0), _flashColor(LED_NO_COLOR), _flashStart(0), _last({ 0, 0 }), _first(true) {
+}
+
+void LedCompositor::setBlinkCount(uint8_t count) {
+  _blinkCount.store(count, std::memory_order_relaxed);
+  _blinkRestart.store(true, std::memory_order_relaxed);
+}
+
+void LedCompositor::flash(uint32_t color) {
+  _flash.store(color & 0xFFFFFF, std::memory_order_relaxed);
+}
+
+bool LedCompositor::render(uint32_t nowMs, myLedFrame& frame) {
+
+  uint32_t color = _base.load(std::memory_order_relaxed);
+  uint8_t brightness = _brightness.load(std::memory_order_relaxed);
+
+  uint32_t flash = _flash.exchange(LED_NO_COLOR, std::memory_order_relaxed);
+  if (flash != LED_NO_COLOR) {
+    _flashColor = flash;
+    _flashStart = nowMs;
+  }
+  if (_flashColor != LED_NO_COLOR) {
+    if (nowMs - _flashStart < LED_FLASH_MS) color = _flashColor;
+    else _flashColor = LED_NO_COLOR;
+  }
+
+  uint32_t overlay = _overlay.load(std::memory_order_relaxed);
+  if (overlay != LED_NO_COLOR) color = overlay;
+
+  uint32_t activity = _activity.load(std::memory_order_relaxed);
+  if (activity != LED_NO_COLOR) {
+    color = (nowMs / LED_ACTIVITY_PHASE_MS) & 1 ? 0 : activity;
+  }
+
+  // map blink: idle, then count x (dim, bright)
+  if (_blinkRestart.exchange(false, std::memory_order_relaxed)) _blinkStart = nowMs - LED_BLINK_IDLE_MS;
+  uint8_t blinks = _blinkCount.load(std::memory_order_relaxed);
+  if (blinks) {
+    uint32_t cycle = LED_BLINK_IDLE_MS + 2u * blinks * LED_BLINK_PHASE_MS;
+    uint32_t t = (nowMs - _blinkStart) % cycle;
+    if (t >= LED_BLINK_IDLE_MS && ((t - LED_BLINK_IDLE_MS) / LED_BLINK_PHASE_MS) % 2 == 0) {
+      brightness = brightness < 2 ? 0 : brightness / 3;
+    }
+  }
+
+  frame.color = color;
+  frame.brightness = brightness;
+  bool changed = _first || frame != _last;
+  _first = false;
+  _last = frame;
+  return changed;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file led_compositor.h
+ * @brief Composes the status LED from posted layers, rendered by the LED task.
+ *
+ * @details Callers only post what the LED should show: a base color (connection and map
+ * state), an overlay color (button held), a short flash (DAW feedback), an activity
+ * pattern (OTA), the brightness and the map blink count. Posting is a few atomic stores and safe from any task. The LED task
+ * calls render() at a fixed frame rate and only pushes the frame to the strip when it
+ * differs from the last one, so no caller ever waits for the WS2812 transfer.
+ *
+ * Priority: activity > overlay > flash > base. The map blink dims the brightness to 1/3 for
+ * 2 x count phases of 200ms every 5s, like the former blinkActiveMaps().
+ */
+
+#ifndef LED_COMPOSITOR_H
+#define LED_COMPOSITOR_H
+
+#include <stdint.h>
+#include <atomic>
+
+#define LED_FRAME_MS 20          // 50 fps
+#define LED_BLINK_IDLE_MS 5000   // pause between two map blink sequences
+#define LED_BLINK_PHASE_MS 200   // one dim or bright phase of the map blink
+#define LED_ACTIVITY_PHASE_MS 100
+#define LED_FLASH_MS 150         // one flash, starts with the next frame
+#define LED_NO_COLOR 0xFF000000  // overlay / activity off
+
+struct myLedFrame {
+  uint32_t color; // 0xRRGGBB
+  uint8_t brightness;
+  bool operator==(const myLedFrame& o) const { return color == o.color && brightness == o.brightness; }
+  bool operator!=(const myLedFrame& o) const { return !(*this == o); }
+};
+
+class LedCompositor {
+public:
+  LedCompositor();
+
+  // ~ post, any task ~
+  void setBase(uint32_t color) { _base.store(color, std::memory_order_relaxed); }
+  void setOverlay(uint32_t color) { _overlay.store(color, std::memory_order_relaxed); }
+  void clearOverlay() { _overlay.store(LED_NO_COLOR, std::memory_order_relaxed); }
+  // show color for LED_FLASH_MS, a new flash starts over
+  void flash(uint32_t color);
+  void setActivity(uint32_t color) { _activity.store(color, std::memory_order_relaxed); }
+  void clearActivity() { _activity.store(LED_NO_COLOR, std::memory_order_relaxed); }
+  void setBrightness(uint8_t brightness) { _brightness.store(brightness, std::memory_order_relaxed); }
+  // blink count pairs (dim, bright) every 5s, 0 = off, a new count starts with the blink right away
+  void setBlinkCount(uint8_t count);
+
+  uint32_t base() const { return _base.load(std::memory_order_relaxed); }
+
+  // ~ LED task ~
+  /**
+   * @brief Compose the frame for nowMs.
+   * @return true if the frame differs from the one returned last time (needs a show)
+   */
+  bool render(uint32_t nowMs, myLedFrame& frame);
+
+private:
+  std::atomic<uint32_t> _base;
+  std::atomic<uint32_t> _overlay;
+  std::atomic<uint32_t> _activity;
+  std::atomic<uint32_t> _flash; // LED_NO_COLOR = no new flash
+  std::atomic<uint8_t> _brightness;
+  std::atomic<uint8_t> _blinkCount;
+  std::atomic<bool> _blinkRestart;
+
+  // render state, LED task only
+  uint32_t _blinkStart;
+  uint32_t _flashColor;
+  uint32_t _flashStart;
+  myLedFrame _last;
+  bool _first;
+};
+
+#endif // LED_COMPOSITOR_H
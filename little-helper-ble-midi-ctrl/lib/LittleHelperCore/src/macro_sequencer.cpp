@@ -0,0 +1,172 @@
+/**
+ * @file macro_sequencer.cpp
+ * @brief Macros: one button press plays a timed sequence of MIDI messages.
+ */
+
+#include "macro_sequencer.h"
+#include "crc32.h"
+
+#include <string.h>
+
+#define MACRO_MAGIC_0 'L'
+#define MACRO_MAGIC_1 'Q'
+#define MACRO_HEADER_SIZE 4
+#define MACRO_CRC_SIZE 4
+
+static_assert(MACRO_PLAYERS <= TIMER_WHEEL_TIMERS, "one timer per playing macro");
+
+MacroSequencer::MacroSequencer(MidiOutput& output)
+  : _out(output), _nowMs(0), _started(0), _steps(0), _dropped(0), _maxLateMs(0) {
+  memset(_players, 0, sizeof(_players));
+}
+
+bool MacroSequencer::start(uint8_t number, const myMacro& macro, uint32_t nowMs) {
+  if (number == 0 || number > MACRO_COUNT || macro.steps == 0 || macro.steps > MACRO_MAX_STEPS) return false;
+  if (_wheel.idle()) _wheel.reset(nowMs);
+  uint8_t p = MACRO_PLAYERS;
+  for (uint8_t i = 0; i < MACRO_PLAYERS; i++) {
+    if (_players[i].number == number) {
+      _wheel.cancel(i);
+      p = i;
+      break;
+    }
+    if (_players[i].number == 0 && p == MACRO_PLAYERS) p = i;
+  }
+  if (p == MACRO_PLAYERS) {
+    _dropped++;
+    return false;
+  }
+  _players[p].number = number;
+  _players[p].next = 0;
+  _players[p].macro = macro;
+  _started++;
+  _nowMs = nowMs;
+  play(p, nowMs);
+  return true;
+}
+
+void MacroSequencer::stop(uint8_t number) {
+  for (uint8_t i = 0; i < MACRO_PLAYERS; i++) {
+    if (_players[i].number != number) continue;
+    _wheel.cancel(i);
+    _players[i].number = 0;
+  }
+}
+
+void MacroSequencer::stopAll() {
+  _wheel.reset(_nowMs);
+  for (myPlayer& player : _players) player.number = 0;
+}
+
+void MacroSequencer::run(uint32_t nowMs) {
+  _nowMs = nowMs;
+  _wheel.advance(nowMs, fire, this);
+}
+
+void MacroSequencer::fire(void* context, uint8_t tag, uint32_t dueTick) {
+  MacroSequencer* self = (MacroSequencer*)context;
+  uint32_t lateMs = self->_nowMs - dueTick;
+  if (lateMs > self->_maxLateMs) self->_maxLateMs = lateMs;
+  self->play(tag, dueTick);
+}
+
+void MacroSequencer::play(uint8_t p, uint32_t dueMs) {
+  myPlayer& player = _players[p];
+  const myMacro& macro = player.macro;
+  // the step at next is due now, the following ones as long as they have no delay
+  do {
+    const myMacroStep& step = macro.step[player.next++];
+    if (step.len) _out.send(step.bytes, step.len, (uint16_t)dueMs);
+    _steps++;
+  } while (player.next < macro.steps && macro.step[player.next].delayMs == 0);
+
+  if (player.next >= macro.steps || !_wheel.schedule(dueMs + macro.step[player.next].delayMs, p)) {
+    player.number = 0;
+  }
+}
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static uint16_t get16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// one complete message: a status byte first, a SysEx ends with F7
+static bool validStep(const myMacroStep& step) {
+  if (step.len == 0 || step.len > MIDI_ACTION_MAX_BYTES || !(step.bytes[0] & 0x80)) return false;
+  if (step.bytes[0] == 0xF0) return step.bytes[step.len - 1] == 0xF7;
+  return true;
+}
+
+size_t encodeMacros(const myMacro* macros, uint8_t count, uint8_t* buf, size_t size) {
+  size_t len = MACRO_HEADER_SIZE;
+  for (uint8_t m = 0; m < count; m++) {
+    len += 1;
+    for (uint8_t s = 0; s < macros[m].steps && s < MACRO_MAX_STEPS; s++) len += 3 + macros[m].step[s].len;
+  }
+  if (len + MACRO_CRC_SIZE > size) return 0;
+
+  uint8_t* p = buf;
+  *p++ = MACRO_MAGIC_0;
+  *p++ = MACRO_MAGIC_1;
+  *p++ = MACRO_RECORD_VERSION;
+  *p++ = count;
+  for (uint8_t m = 0; m < count; m++) {
+    uint8_t steps = macros[m].steps < MACRO_MAX_STEPS ? macros[m].steps : MACRO_MAX_STEPS;
+    *p++ = steps;
+    for (uint8_t s = 0; s < steps; s++) {
+      const myMacroStep& step = macros[m].step[s];
+      put16(p, step.delayMs);
+      p[2] = step.len;
+      memcpy(p + 3, step.bytes, step.len);
+      p += 3 + step.len;
+    }
+  }
+  put32(p, crc32(buf, len));
+  return len + MACRO_CRC_SIZE;
+}
+
+bool decodeMacros(const uint8_t* record, size_t len, myMacro* macros, uint8_t count) {
+  if (len < MACRO_HEADER_SIZE + MACRO_CRC_SIZE || record[0] != MACRO_MAGIC_0 || record[1] != MACRO_MAGIC_1
+    || record[2] != MACRO_RECORD_VERSION || crc32(record, len - MACRO_CRC_SIZE) != get32(record + len - MACRO_CRC_SIZE)) {
+    return false;
+  }
+  // decoded into a copy, a broken macro must not leave half changed macros
+  myMacro decoded[MACRO_COUNT];
+  memset(decoded, 0, sizeof(decoded));
+  const uint8_t* p = record + MACRO_HEADER_SIZE;
+  const uint8_t* end = record + len - MACRO_CRC_SIZE;
+  for (uint8_t m = 0; m < record[3]; m++) {
+    if (p >= end) return false;
+    uint8_t steps = *p++;
+    if (steps > MACRO_MAX_STEPS) return false;
+    myMacro macro;
+    memset(&macro, 0, sizeof(macro));
+    macro.steps = steps;
+    for (uint8_t s = 0; s < steps; s++) {
+      if (end - p < 3 || p[2] > MIDI_ACTION_MAX_BYTES || end - p < 3 + p[2]) return false;
+      myMacroStep& step = macro.step[s];
+      step.delayMs = get16(p);
+      step.len = p[2];
+      memcpy(step.bytes, p + 3, step.len);
+      if (!validStep(step)) return false;
+      p += 3 + step.len;
+    }
+    if (m < count && m < MACRO_COUNT) decoded[m] = macro; // macros of a newer firmware are skipped
+  }
+  if (p != end) return false;
+  uint8_t n = count < MACRO_COUNT ? count : MACRO_COUNT;
+  memcpy(macros, decoded, n * sizeof(myMacro));
+  return true;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file macro_sequencer.h
+ * @brief Macros: one button press plays a timed sequence of MIDI messages.
+ *
+ * @details A button with btnMacro 1 .. MACRO_COUNT starts that macro instead of sending its
+ * own message (MidiActionTable, myEngineResult::macro). The steps are played from a
+ * TimerWheel with a 1 ms tick, the caller runs it every tick while busy(), so a playing
+ * macro never blocks the button scan. A step is due at the due time of the step before plus
+ * its delay, late ticks do not add up, and it carries its due time as MIDI timestamp.
+ *
+ * Macros are stored as one record:
+ *
+ *   header  'L' 'Q' version count
+ *   macro   steps, per step delayMs(2, LE) len bytes[len]
+ *   crc     CRC-32 over header and macros (4, LE)
+ */
+
+#ifndef MACRO_SEQUENCER_H
+#define MACRO_SEQUENCER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "midi_engine.h"
+#include "timer_wheel.h"
+
+#define MACRO_COUNT 7 // btnMacro 1 .. 7, 0 = the button sends its own message
+#define MACRO_MAX_STEPS 8
+#define MACRO_PLAYERS 4 // macros playing at the same time
+#define MACRO_RECORD_VERSION 1
+#define MACRO_RECORD_MAX_SIZE (4 + MACRO_COUNT * (1 + MACRO_MAX_STEPS * (3 + MIDI_ACTION_MAX_BYTES)) + 4)
+
+struct myMacroStep {
+  uint16_t delayMs; // after the step before, the first step after the press
+  uint8_t len;      // one complete MIDI message
+  uint8_t bytes[MIDI_ACTION_MAX_BYTES];
+};
+
+struct myMacro {
+  uint8_t steps;
+  myMacroStep step[MACRO_MAX_STEPS];
+};
+
+class MacroSequencer {
+public:
+  explicit MacroSequencer(MidiOutput& output);
+
+  /**
+   * @brief Play a copy of the macro, the steps without delay are sent right away.
+   * @param number 1 .. MACRO_COUNT, a macro still playing starts over
+   * @return false if all players are busy or the macro has no steps
+   */
+  bool start(uint8_t number, const myMacro& macro, uint32_t nowMs);
+  void stop(uint8_t number);
+  void stopAll();
+
+  // send the steps due at nowMs, call every tick while busy()
+  void run(uint32_t nowMs);
+  bool busy() const { return !_wheel.idle(); }
+
+  uint32_t started() const { return _started; }
+  uint32_t steps() const { return _steps; }
+  uint32_t dropped() const { return _dropped; } // starts without a free player
+  uint32_t maxLateMs() const { return _maxLateMs; }
+
+private:
+  struct myPlayer {
+    uint8_t number; // 0 = free
+    uint8_t next;   // next step
+    myMacro macro;
+  };
+
+  static void fire(void* context, uint8_t tag, uint32_t dueTick);
+  // send the steps from next on up to the next one with a delay, which is scheduled
+  void play(uint8_t player, uint32_t dueMs);
+
+  MidiOutput& _out;
+  TimerWheel _wheel;
+  myPlayer _players[MACRO_PLAYERS];
+  uint32_t _nowMs;
+  uint32_t _started;
+  uint32_t _steps;
+  uint32_t _dropped;
+  uint32_t _maxLateMs;
+};
+
+// the macros as record, 0 if buf is too small
+size_t encodeMacros(const myMacro* macros, uint8_t count, uint8_t* buf, size_t size);
+// a record into the macros, which are only changed if the whole record is valid
+bool decodeMacros(const uint8_t* record, size_t len, myMacro* macros, uint8_t count);
+
+#endif // MACRO_SEQUENCER_H
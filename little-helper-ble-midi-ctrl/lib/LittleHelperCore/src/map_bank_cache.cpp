@@ -0,0 +1,107 @@
+/**
+ * @file map_bank_cache.cpp
+ * @brief The few maps in RAM: the active one, the recently used ones and the prefetched neighbours.
+ */
+
+#include "map_bank_cache.h"
+
+#include <string.h>
+
+MapBankCache::MapBankCache(MapRecordStore& store, void (*defaults)(uint8_t map, myMapButton* buttons, uint8_t numButtons),
+  uint8_t numButtons)
+  : _store(&store), _defaults(defaults), _numButtons(numButtons > MIDI_ACTION_MAX_BUTTONS ? MIDI_ACTION_MAX_BUTTONS : numButtons),
+    _pinned(MAP_CACHE_FREE), _clock(0), _hits(0), _misses(0), _prefetchHits(0), _evictions(0) {
+  memset(_slots, 0, sizeof(_slots));
+  for (myCachedMap& entry : _slots) entry.map = MAP_CACHE_FREE;
+}
+
+myCachedMap* MapBankCache::find(uint8_t map) {
+  for (myCachedMap& entry : _slots) {
+    if (entry.map == map) return &entry;
+  }
+  return nullptr;
+}
+
+myCachedMap* MapBankCache::get(uint8_t map) {
+  myCachedMap* entry = find(map);
+  if (entry != nullptr) {
+    _hits++;
+    if (entry->prefetched) _prefetchHits++;
+    entry->prefetched = false;
+    entry->lastUse = ++_clock;
+    return entry;
+  }
+  _misses++;
+  return load(map, ++_clock);
+}
+
+void MapBankCache::prefetch(uint8_t map) {
+  if (map == MAP_CACHE_FREE || find(map) != nullptr) return;
+  myCachedMap* entry = load(map, _clock);
+  if (entry != nullptr) entry->prefetched = true;
+}
+
+// a free slot, else the least recently used clean one, a dirty one is written by the writer first
+myCachedMap* MapBankCache::load(uint8_t map, uint32_t lastUse) {
+  myCachedMap* victim = nullptr;
+  for (myCachedMap& entry : _slots) {
+    if (entry.map == MAP_CACHE_FREE) {
+      victim = &entry;
+      break;
+    }
+    if (entry.map == _pinned || entry.dirty || entry.writing) continue;
+    if (victim == nullptr || (int32_t)(entry.lastUse - victim->lastUse) < 0) victim = &entry;
+  }
+  if (victim == nullptr) return nullptr;
+  if (victim->map != MAP_CACHE_FREE) _evictions++;
+
+  _defaults(map, victim->buttons, _numButtons);
+  uint8_t record[MAP_BANK_SLOT_SIZE];
+  size_t len = _store->read(map, record, sizeof(record));
+  my_map_codec_result result = len ? decodeMap(record, len, map, victim->buttons, _numButtons) : MAP_CODEC_TOO_SHORT;
+  if (result != MAP_CODEC_OK && result != MAP_CODEC_MIGRATED) _defaults(map, victim->buttons, _numButtons);
+
+  victim->map = map;
+  victim->dirty = result == MAP_CODEC_MIGRATED;
+  victim->prefetched = false;
+  victim->writing = false;
+  victim->lastUse = lastUse;
+  memset(victim->states, BTN_OFF, sizeof(victim->states));
+  return victim;
+}
+
+size_t MapBankCache::beginWrite(uint8_t slot, uint8_t& map, uint8_t* record, size_t size) {
+  if (slot >= MAP_CACHE_SLOTS) return 0;
+  myCachedMap& entry = _slots[slot];
+  if (entry.map == MAP_CACHE_FREE || !entry.dirty) return 0;
+  size_t len = encodeMap(entry.buttons, _numButtons, entry.map, record, size);
+  if (len == 0) return 0;
+  map = entry.map;
+  entry.dirty = false;
+  entry.writing = true;
+  return len;
+}
+
+void MapBankCache::endWrite(uint8_t slot, bool written) {
+  if (slot >= MAP_CACHE_SLOTS) return;
+  _slots[slot].writing = false;
+  if (!written) _slots[slot].dirty = true;
+}
+
+bool MapBankCache::flush(uint8_t slot) {
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  uint8_t map;
+  size_t len = beginWrite(slot, map, record, sizeof(record));
+  if (len == 0) return slot < MAP_CACHE_SLOTS && !_slots[slot].dirty;
+  bool written = _store->write(map, record, len);
+  endWrite(slot, written);
+  return written;
+}
+
+uint32_t MapBankCache::dirtySlots() const {
+  uint32_t slots = 0;
+  for (uint8_t i = 0; i < MAP_CACHE_SLOTS; i++) {
+    if (_slots[i].map != MAP_CACHE_FREE && _slots[i].dirty) slots |= 1u << i;
+  }
+  return slots;
+}
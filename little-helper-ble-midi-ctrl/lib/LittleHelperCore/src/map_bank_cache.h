@@ -0,0 +1,94 @@
+/**
+ * @file map_bank_cache.h
+ * @brief The few maps in RAM: the active one, the recently used ones and the prefetched neighbours.
+ *
+ * @details All maps live in a MapRecordStore, the map banks or NVS. A map that is needed is decoded into one of
+ * MAP_CACHE_SLOTS slots. A full cache evicts the least recently used clean slot. A changed
+ * map stays in RAM until it is written: get() never writes, the writer copies the record
+ * with beginWrite(), writes it to the store and reports the result with endWrite(). The
+ * slot is not evicted meanwhile, so no read of that map reaches the store during its write.
+ * The active map is pinned because the compiled
+ * action table points at its button states. Prefetching the neighbours of the active map
+ * makes the next Program Change or long press switch a cache hit. A map without a valid
+ * record gets its defaults. The toggle states of a map start at BTN_OFF each time it is
+ * loaded.
+ *
+ * Not thread safe, the caller serializes the calls. The store write between beginWrite()
+ * and endWrite() needs no serialization with the others, it may take a flash erase.
+ */
+
+#ifndef MAP_BANK_CACHE_H
+#define MAP_BANK_CACHE_H
+
+#include <stdint.h>
+#include "map_bank_store.h"
+#include "midi_action_table.h"
+
+#define MAP_CACHE_SLOTS 4
+#define MAP_CACHE_FREE 0xFF
+
+struct myCachedMap {
+  uint8_t map;       // MAP_CACHE_FREE = slot unused
+  bool dirty;        // changed or migrated, not stored yet
+  bool prefetched;   // loaded ahead, not used since
+  bool writing;      // between beginWrite() and endWrite(), not evicted
+  uint32_t lastUse;
+  myMapButton buttons[MIDI_ACTION_MAX_BUTTONS];
+  uint8_t states[MIDI_ACTION_MAX_BUTTONS];
+};
+
+class MapBankCache {
+public:
+  // defaults: the settings of a map without a stored record
+  MapBankCache(MapRecordStore& store, void (*defaults)(uint8_t map, myMapButton* buttons, uint8_t numButtons),
+    uint8_t numButtons);
+
+  // read and write another store from now on, before the first get()
+  void setStore(MapRecordStore& store) { _store = &store; }
+
+  // the map, read from the store on a miss, nullptr if every other slot is pinned, dirty or
+  // being written: the dirty ones have to be written first
+  myCachedMap* get(uint8_t map);
+  // the map if it is in RAM, no read
+  myCachedMap* find(uint8_t map);
+  // read the map into a slot that is not needed more, no change of the use order of the others
+  void prefetch(uint8_t map);
+
+  // the slot of this map is never evicted, MAP_CACHE_FREE for none
+  void pin(uint8_t map) { _pinned = map; }
+
+  // copy the record of a dirty slot for the store, 0 if the slot is clean. The slot is clean
+  // from now on, a change meanwhile makes it dirty again.
+  size_t beginWrite(uint8_t slot, uint8_t& map, uint8_t* record, size_t size);
+  // the store write of beginWrite() is done, after a failed one the slot is dirty again
+  void endWrite(uint8_t slot, bool written);
+  // beginWrite(), the store write and endWrite() in one, false if the write failed
+  bool flush(uint8_t slot);
+  MapRecordStore& store() const { return *_store; }
+  // slots with a dirty map, bit per slot
+  uint32_t dirtySlots() const;
+  uint8_t slotOf(const myCachedMap* entry) const { return entry - _slots; }
+  const myCachedMap& slot(uint8_t slot) const { return _slots[slot]; }
+
+  // ~ metrics ~
+  uint32_t hits() const { return _hits; }
+  uint32_t misses() const { return _misses; }
+  uint32_t prefetchHits() const { return _prefetchHits; } // hits on a prefetched map
+  uint32_t evictions() const { return _evictions; }
+
+private:
+  myCachedMap* load(uint8_t map, uint32_t lastUse);
+
+  MapRecordStore* _store;
+  void (*_defaults)(uint8_t map, myMapButton* buttons, uint8_t numButtons);
+  uint8_t _numButtons;
+  uint8_t _pinned;
+  uint32_t _clock;
+  myCachedMap _slots[MAP_CACHE_SLOTS];
+  uint32_t _hits;
+  uint32_t _misses;
+  uint32_t _prefetchHits;
+  uint32_t _evictions;
+};
+
+#endif // MAP_BANK_CACHE_H
@@ -0,0 +1,201 @@
+/**
+ * @file map_bank_store.cpp
+ * @brief The map records of all maps in a flash partition, one fixed slot per map.
+ */
+
+#include "map_bank_store.h"
+#include "crc32.h"
+
+#include <string.h>
+
+#define MAP_BANK_MAGIC_0 'L'
+#define MAP_BANK_MAGIC_1 'B'
+#define MAP_BANK_VERSION 1
+#define MAP_BANK_NONE 0xFF
+#define MAP_BANK_CHUNK 256 // copy buffer on the stack
+
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t sectorOffset(uint8_t pair, uint8_t sector) {
+  return (2 * pair + sector) * MAP_BANK_SECTOR_SIZE;
+}
+
+static uint32_t slotOffset(uint8_t slot) {
+  return MAP_BANK_HEADER_SIZE + slot * MAP_BANK_SLOT_SIZE;
+}
+
+bool MapBankRamFlash::read(uint32_t offset, void* buf, size_t len) {
+  if (offset > _size || len > _size - offset) return false;
+  memcpy(buf, _mem + offset, len);
+  return true;
+}
+
+bool MapBankRamFlash::write(uint32_t offset, const void* buf, size_t len) {
+  if (offset > _size || len > _size - offset) return false;
+  const uint8_t* data = (const uint8_t*)buf;
+  for (size_t i = 0; i < len; i++) _mem[offset + i] &= data[i];
+  return true;
+}
+
+bool MapBankRamFlash::eraseSector(uint32_t offset) {
+  if (offset % MAP_BANK_SECTOR_SIZE || offset >= _size) return false;
+  memset(_mem + offset, 0xFF, MAP_BANK_SECTOR_SIZE);
+  return true;
+}
+
+MapBankStore::MapBankStore()
+  : _flash(nullptr), _pairs(0), _erases(0), _writes(0), _unchanged(0), _switches(0) {
+  memset(_current, MAP_BANK_NONE, sizeof(_current));
+  memset(_sequence, 0, sizeof(_sequence));
+}
+
+bool MapBankStore::readHeader(uint8_t sector, uint8_t pair, uint32_t& sequence) {
+  uint8_t header[MAP_BANK_HEADER_SIZE];
+  if (!_flash->read(sectorOffset(pair, sector), header, sizeof(header))) return false;
+  if (header[0] != MAP_BANK_MAGIC_0 || header[1] != MAP_BANK_MAGIC_1 || header[2] != MAP_BANK_VERSION
+    || header[3] != pair || crc32(header, 8) != get32(header + 8)) {
+    return false;
+  }
+  sequence = get32(header + 4);
+  return true;
+}
+
+uint16_t MapBankStore::mount(MapBankFlash* flash) {
+  _flash = flash;
+  _pairs = 0;
+  memset(_current, MAP_BANK_NONE, sizeof(_current));
+  if (flash == nullptr) return 0;
+  uint32_t pairs = flash->size() / (2 * MAP_BANK_SECTOR_SIZE);
+  _pairs = pairs > MAP_BANK_MAX_PAIRS ? MAP_BANK_MAX_PAIRS : pairs;
+
+  for (uint8_t pair = 0; pair < _pairs; pair++) {
+    uint32_t a, b;
+    bool validA = readHeader(0, pair, a), validB = readHeader(1, pair, b);
+    if (validA && validB) {
+      // the newer one, the sequence may wrap
+      _current[pair] = (int32_t)(b - a) > 0 ? 1 : 0;
+      _sequence[pair] = _current[pair] ? b : a;
+    } else if (validA || validB) {
+      _current[pair] = validA ? 0 : 1;
+      _sequence[pair] = validA ? a : b;
+    }
+  }
+  return maps();
+}
+
+bool MapBankStore::empty() const {
+  for (uint8_t pair = 0; pair < _pairs; pair++) {
+    if (_current[pair] != MAP_BANK_NONE) return false;
+  }
+  return true;
+}
+
+bool MapBankStore::format() {
+  for (uint8_t pair = 0; pair < _pairs; pair++) {
+    for (uint8_t sector = 0; sector < 2; sector++) {
+      if (!_flash->eraseSector(sectorOffset(pair, sector))) return false;
+      _erases++;
+    }
+    _current[pair] = MAP_BANK_NONE;
+    _sequence[pair] = 0;
+    _switches++;
+  }
+  return true;
+}
+
+size_t MapBankStore::read(uint8_t map, uint8_t* buf, size_t size) {
+  if (map >= maps() || buf == nullptr) return 0;
+  uint8_t pair = map / MAP_BANK_SLOTS_PER_SECTOR, slot = map % MAP_BANK_SLOTS_PER_SECTOR;
+  uint8_t record[MAP_BANK_SLOT_SIZE];
+  // a writer erases the sector that is not current, only after two switches can it be the one read
+  for (uint8_t attempt = 0; ; attempt++) {
+    uint32_t switches = _switches.load();
+    uint8_t sector = _current[pair];
+    if (sector == MAP_BANK_NONE) return 0;
+    if (!_flash->read(sectorOffset(pair, sector) + slotOffset(slot), record, sizeof(record))) return 0;
+    if (_switches.load() == switches) break;
+    if (attempt == 3) return 0;
+  }
+  // the record length is in its header, decodeMap() checks the rest
+  if (record[0] != 'L' || record[1] != 'M') return 0;
+  size_t len = MAP_CODEC_HEADER_SIZE + (record[6] | (record[7] << 8)) + MAP_CODEC_CRC_SIZE;
+  if (len > sizeof(record) || len > size) return 0;
+  memcpy(buf, record, len);
+  return len;
+}
+
+// the current sector of the pair with the slot replaced into the other sector, header last
+bool MapBankStore::copySector(uint8_t pair, uint8_t slot, const uint8_t* record, size_t len) {
+  uint8_t from = _current[pair], to = from == 0 ? 1 : 0;
+  uint32_t source = from == MAP_BANK_NONE ? 0 : sectorOffset(pair, from);
+  uint32_t target = sectorOffset(pair, to);
+  if (!_flash->eraseSector(target)) return false;
+  _erases++;
+
+  uint32_t slotStart = slotOffset(slot), slotEnd = slotStart + MAP_BANK_SLOT_SIZE;
+  uint8_t chunk[MAP_BANK_CHUNK];
+  for (uint32_t at = MAP_BANK_HEADER_SIZE; at < MAP_BANK_SECTOR_SIZE; at += sizeof(chunk)) {
+    uint32_t n = MAP_BANK_SECTOR_SIZE - at < sizeof(chunk) ? MAP_BANK_SECTOR_SIZE - at : sizeof(chunk);
+    if (from == MAP_BANK_NONE) memset(chunk, 0xFF, n);
+    else if (!_flash->read(source + at, chunk, n)) return false;
+    // the part of the chunk that is the slot of the map
+    for (uint32_t i = at < slotStart ? slotStart : at; i < at + n && i < slotEnd; i++) {
+      uint32_t k = i - slotStart;
+      chunk[i - at] = k < len ? record[k] : 0xFF;
+    }
+    bool erased = true;
+    for (uint32_t i = 0; i < n && erased; i++) erased = chunk[i] == 0xFF;
+    if (!erased && !_flash->write(target + at, chunk, n)) return false;
+  }
+
+  uint8_t header[MAP_BANK_HEADER_SIZE];
+  memset(header, 0xFF, sizeof(header));
+  uint32_t sequence = _sequence[pair] + 1;
+  header[0] = MAP_BANK_MAGIC_0;
+  header[1] = MAP_BANK_MAGIC_1;
+  header[2] = MAP_BANK_VERSION;
+  header[3] = pair;
+  put32(header + 4, sequence);
+  put32(header + 8, crc32(header, 8));
+  if (!_flash->write(target, header, sizeof(header))) return false;
+  _current[pair] = to;
+  _sequence[pair] = sequence;
+  _switches++;
+  return true;
+}
+
+bool MapBankStore::write(uint8_t map, const uint8_t* record, size_t len) {
+  if (map >= maps() || record == nullptr || len > MAP_BANK_SLOT_SIZE) return false;
+  uint8_t pair = map / MAP_BANK_SLOTS_PER_SECTOR, slot = map % MAP_BANK_SLOTS_PER_SECTOR;
+
+  if (_current[pair] != MAP_BANK_NONE) {
+    uint8_t stored[MAP_BANK_SLOT_SIZE];
+    uint32_t at = sectorOffset(pair, _current[pair]) + slotOffset(slot);
+    if (!_flash->read(at, stored, sizeof(stored))) return false;
+    if (memcmp(stored, record, len) == 0) {
+      bool rest = true;
+      for (size_t i = len; i < sizeof(stored) && rest; i++) rest = stored[i] == 0xFF;
+      if (rest) {
+        _unchanged++;
+        return true;
+      }
+    }
+    // a slot never written is programmed in place, no erase
+    bool erased = true;
+    for (size_t i = 0; i < sizeof(stored) && erased; i++) erased = stored[i] == 0xFF;
+    if (erased) {
+      if (!_flash->write(at, record, len)) return false;
+      _writes++;
+      return true;
+    }
+  }
+  if (!copySector(pair, slot, record, len)) return false;
+  _writes++;
+  return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file map_bank_store.h
+ * @brief The map records of all maps in a flash partition, one fixed slot per map.
+ *
+ * @details The partition is split into sector pairs. Each pair holds the slots of
+ * MAP_BANK_SLOTS_PER_SECTOR maps, and only one sector of a pair is current: the one with a
+ * valid header and the higher sequence number. A map is read with one flash read of its
+ * slot. A write into an empty slot programs it in place. Any other write copies the current
+ * sector with the changed slot into the other sector of the pair and writes the header
+ * last, so a power loss leaves either the old or the new sector. Each sector is erased
+ * at most once per write.
+ *
+ *   sector  header (MAP_BANK_HEADER_SIZE) then the slots of the maps
+ *   header  'L' 'B' version pair sequence(4, LE) crc(4, LE) over the first 8 bytes, 4 x 0xFF
+ *   slot    one map record (map_codec.h), 0xFF after the record and in unused slots
+ *
+ * The flash is reached through MapBankFlash, esp_partition on the device and RAM on the host.
+ * The cache reads and writes records through MapRecordStore, MapBankStore or, on units
+ * without a "banks" partition, the NVS records of the firmware before the map banks.
+ */
+
+#ifndef MAP_BANK_STORE_H
+#define MAP_BANK_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "map_codec.h"
+
+#define MAP_BANK_SECTOR_SIZE 4096
+#define MAP_BANK_HEADER_SIZE 16
+#define MAP_BANK_SLOT_SIZE 80 // MAP_CODEC_MAX_SIZE rounded up to 16
+#define MAP_BANK_SLOTS_PER_SECTOR ((MAP_BANK_SECTOR_SIZE - MAP_BANK_HEADER_SIZE) / MAP_BANK_SLOT_SIZE)
+#define MAP_BANK_MAX_PAIRS 8
+// the partition size all NUBER_OF_MAPS maps need
+#define MAP_BANK_PAIRS ((NUBER_OF_MAPS + MAP_BANK_SLOTS_PER_SECTOR - 1) / MAP_BANK_SLOTS_PER_SECTOR)
+#define MAP_BANK_PARTITION_SIZE (2 * MAP_BANK_PAIRS * MAP_BANK_SECTOR_SIZE)
+
+static_assert(MAP_CODEC_MAX_SIZE <= MAP_BANK_SLOT_SIZE, "a map record must fit into its slot");
+static_assert(MAP_BANK_PAIRS <= MAP_BANK_MAX_PAIRS, "NUBER_OF_MAPS needs more sector pairs");
+
+// raw access to the partition, offsets from its start
+class MapBankFlash {
+public:
+  virtual ~MapBankFlash() {}
+  virtual uint32_t size() const = 0;
+  virtual bool read(uint32_t offset, void* buf, size_t len) = 0;
+  virtual bool write(uint32_t offset, const void* buf, size_t len) = 0;
+  virtual bool eraseSector(uint32_t offset) = 0;
+};
+
+// flash in RAM with the rules of NOR flash: erase sets 0xFF, a write only clears bits.
+// The store without a partition (changes last until the reboot) and the host programs.
+class MapBankRamFlash : public MapBankFlash {
+public:
+  MapBankRamFlash(uint8_t* mem, uint32_t size) : _mem(mem), _size(size) {}
+  uint32_t size() const override { return _size; }
+  bool read(uint32_t offset, void* buf, size_t len) override;
+  bool write(uint32_t offset, const void* buf, size_t len) override;
+  bool eraseSector(uint32_t offset) override;
+
+private:
+  uint8_t* _mem;
+  uint32_t _size;
+};
+
+// where the map records are kept, one record per map
+class MapRecordStore {
+public:
+  virtual ~MapRecordStore() {}
+  // the record of a map into buf, 0 for no record or a read error
+  virtual size_t read(uint8_t map, uint8_t* buf, size_t size) = 0;
+  // store a record, a record equal to the stored one is not written
+  virtual bool write(uint8_t map, const uint8_t* record, size_t len) = 0;
+};
+
+class MapBankStore : public MapRecordStore {
+public:
+  MapBankStore();
+
+  /**
+   * @brief Read the sector headers of the partition.
+   * @return number of map slots, 0 without flash or if the partition is too small for one pair
+   */
+  uint16_t mount(MapBankFlash* flash);
+
+  uint16_t maps() const { return _pairs * MAP_BANK_SLOTS_PER_SECTOR; }
+  // no sector was ever written, the first boot with this partition
+  bool empty() const;
+  // erase every sector, all maps are empty afterwards (reset of the MIDI settings)
+  bool format();
+
+  // the record of a map into buf, 0 for an empty slot or a read error. Safe during a write()
+  // of another map on another task, a read that saw a sector switch is repeated.
+  size_t read(uint8_t map, uint8_t* buf, size_t size) override;
+  // store a record, a record equal to the stored one is not written
+  bool write(uint8_t map, const uint8_t* record, size_t len) override;
+
+  // ~ metrics ~
+  uint32_t erases() const { return _erases; }
+  uint32_t writes() const { return _writes; }
+  uint32_t unchanged() const { return _unchanged; }
+
+private:
+  bool readHeader(uint8_t sector, uint8_t pair, uint32_t& sequence);
+  bool copySector(uint8_t pair, uint8_t slot, const uint8_t* record, size_t len);
+
+  MapBankFlash* _flash;
+  uint8_t _pairs;
+  uint8_t _current[MAP_BANK_MAX_PAIRS];     // sector of the pair that is current, 0xFF = none yet
+  uint32_t _sequence[MAP_BANK_MAX_PAIRS];
+  uint32_t _erases;
+  uint32_t _writes;
+  uint32_t _unchanged;
+  std::atomic<uint32_t> _switches;          // counts the changes of _current, for read()
+};
+
+#endif // MAP_BANK_STORE_H
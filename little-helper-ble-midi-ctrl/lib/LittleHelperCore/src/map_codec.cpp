@@ -0,0 +1,211 @@
+/**
+ * @file map_codec.cpp
+ * @brief Stored format of one button map, independent of the myMapButton layout.
+ */
+
+#include "map_codec.h"
+#include "crc32.h"
+
+#define MAP_CODEC_MAGIC_0 'L'
+#define MAP_CODEC_MAGIC_1 'M'
+
+// version 0: the "Settings" blob, 5 x myButton with per map arrays as the ESP32 laid it out
+#define MAP_V0_BUTTONS 5
+#define MAP_V0_MAPS 4
+#define MAP_V0_BUTTON_SIZE (MAP_V0_SIZE / MAP_V0_BUTTONS)
+
+// version 1: 5 x myButtonRecord as the ESP32 laid it out, 12 bytes and a uint32 color
+#define MAP_V1_BUTTONS 5
+#define MAP_V1_BUTTON_SIZE 16
+#define MAP_V1_SIZE (MAP_V1_BUTTONS * MAP_V1_BUTTON_SIZE)
+
+// version 2: one byte per field, field offsets in one button
+#define MAP_V2_FLAGS 0
+#define MAP_V2_FUNCTION 1
+#define MAP_V2_MIDI_FUNCTION 2
+#define MAP_V2_CHANNEL 3
+#define MAP_V2_NOTE 4
+#define MAP_V2_VELOCITY 5
+#define MAP_V2_CC 6
+#define MAP_V2_CC_ON 7
+#define MAP_V2_CC_OFF 8
+#define MAP_V2_MMC 9
+#define MAP_V2_COLOR 10 // 3 bytes R G B
+
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t encodeMap(const myMapButton* buttons, uint8_t numButtons, uint8_t map, uint8_t* buf, size_t size) {
+
+  if (numButtons > MAP_CODEC_MAX_BUTTONS) numButtons = MAP_CODEC_MAX_BUTTONS;
+  uint16_t payload = numButtons * MAP_CODEC_BUTTON_SIZE;
+  size_t total = MAP_CODEC_HEADER_SIZE + payload + MAP_CODEC_CRC_SIZE;
+  if (buf == nullptr || size < total || map >= NUBER_OF_MAPS) return 0;
+
+  buf[0] = MAP_CODEC_MAGIC_0;
+  buf[1] = MAP_CODEC_MAGIC_1;
+  buf[2] = MAP_CODEC_VERSION;
+  buf[3] = map;
+  buf[4] = numButtons;
+  buf[5] = MAP_CODEC_BUTTON_SIZE;
+  buf[6] = payload & 0xFF;
+  buf[7] = payload >> 8;
+
+  uint8_t* p = buf + MAP_CODEC_HEADER_SIZE;
+  for (uint8_t b = 0; b < numButtons; b++, p += MAP_CODEC_BUTTON_SIZE) {
+    const myMapButton& btn = buttons[b];
+    p[MAP_FIELD_FLAGS] = (btn.needRelease ? MAP_FLAG_RELEASE : 0) | (btn.btnLongpress ? MAP_FLAG_LONGPRESS : 0)
+      | (btn.btnFunction == BTN_TOGGLE ? MAP_FLAG_TOGGLE : 0) | (btn.btnMidiFunction << MAP_FLAG_MIDI_SHIFT)
+      | (btn.btnMacro << MAP_FLAG_MACRO_SHIFT);
+    p[MAP_FIELD_CHANNEL] = btn.btnMidiChannel | (btn.btnMidiMMC << MAP_MMC_SHIFT);
+    p[MAP_FIELD_NOTE] = btn.btnMidiNote;
+    p[MAP_FIELD_VELOCITY] = btn.btnMidiVelocity;
+    p[MAP_FIELD_CC] = btn.btnMidiCC;
+    p[MAP_FIELD_CC_ON] = btn.btnMidiCCValueStateOn;
+    p[MAP_FIELD_CC_OFF] = btn.btnMidiCCValueStateOff;
+    p[MAP_FIELD_COLOR] = btn.btnColor;
+  }
+  put32(p, crc32(buf, MAP_CODEC_HEADER_SIZE + payload));
+  return total;
+}
+
+// one button of the payload, fields beyond buttonSize keep their value
+static void decodeButton(const uint8_t* p, uint8_t buttonSize, myMapButton& btn) {
+  if (buttonSize > MAP_FIELD_FLAGS) {
+    uint8_t flags = p[MAP_FIELD_FLAGS];
+    btn.needRelease = (flags & MAP_FLAG_RELEASE) != 0;
+    btn.btnLongpress = (flags & MAP_FLAG_LONGPRESS) != 0;
+    btn.btnFunction = flags & MAP_FLAG_TOGGLE ? BTN_TOGGLE : BTN_PUSH;
+    btn.btnMidiFunction = (flags >> MAP_FLAG_MIDI_SHIFT) & 3;
+    btn.btnMacro = flags >> MAP_FLAG_MACRO_SHIFT;
+  }
+  if (buttonSize > MAP_FIELD_CHANNEL) {
+    btn.btnMidiChannel = p[MAP_FIELD_CHANNEL];
+    btn.btnMidiMMC = p[MAP_FIELD_CHANNEL] >> MAP_MMC_SHIFT;
+  }
+  if (buttonSize > MAP_FIELD_NOTE) btn.btnMidiNote = p[MAP_FIELD_NOTE];
+  if (buttonSize > MAP_FIELD_VELOCITY) btn.btnMidiVelocity = p[MAP_FIELD_VELOCITY];
+  if (buttonSize > MAP_FIELD_CC) btn.btnMidiCC = p[MAP_FIELD_CC];
+  if (buttonSize > MAP_FIELD_CC_ON) btn.btnMidiCCValueStateOn = p[MAP_FIELD_CC_ON];
+  if (buttonSize > MAP_FIELD_CC_OFF) btn.btnMidiCCValueStateOff = p[MAP_FIELD_CC_OFF];
+  if (buttonSize > MAP_FIELD_COLOR && p[MAP_FIELD_COLOR] < BUTTON_PALETTE_SIZE) btn.btnColor = p[MAP_FIELD_COLOR];
+}
+
+// a PC button of a version before 3 sent nothing, its CC values are no Bank Select
+static void noBankSelect(myMapButton& btn) {
+  if (btn.btnMidiFunction == MIDI_PROGRAMCHANGE) btn.btnMidiCCValueStateOn = btn.btnMidiCCValueStateOff = PC_BANK_NONE;
+}
+
+// the fields every older version has one byte each, in the order of version 1
+static void decodeFields(const uint8_t* v, uint32_t color, myMapButton& btn) {
+  btn.needRelease = v[0] != 0;
+  btn.btnFunction = v[1] ? BTN_TOGGLE : BTN_PUSH;
+  btn.btnLongpress = v[2] != 0;
+  btn.btnMidiFunction = v[3];
+  btn.btnMidiChannel = v[4];
+  btn.btnMidiNote = v[5];
+  btn.btnMidiVelocity = v[6];
+  btn.btnMidiCC = v[7];
+  btn.btnMidiCCValueStateOn = v[8];
+  btn.btnMidiCCValueStateOff = v[9];
+  btn.btnMidiMMC = v[10];
+  btn.btnColor = nearestPaletteColor(color);
+  noBankSelect(btn);
+}
+
+// version 0 -> current
+static void decodeV0(const uint8_t* blob, uint8_t map, myMapButton* buttons, uint8_t numButtons) {
+  if (numButtons > MAP_V0_BUTTONS) numButtons = MAP_V0_BUTTONS;
+  for (uint8_t b = 0; b < numButtons; b++) {
+    const uint8_t* p = blob + b * MAP_V0_BUTTON_SIZE + map;
+    // gpio, then the arrays: needRelease, btnFunction, btnLongpress, btnState, (pad), btnColor
+    // uint32, btnMidiFunction, Channel, Note, Velocity, CC, CCValueStateOn, StateOff, MMC
+    const uint8_t v[11] = { p[1], p[5], p[9], p[36], p[40], p[44], p[48], p[52], p[56], p[60], p[64] };
+    decodeFields(v, get32(blob + b * MAP_V0_BUTTON_SIZE + 20 + 4 * map), buttons[b]);
+  }
+}
+
+// version 1 -> current
+static void decodeV1(const uint8_t* record, myMapButton* buttons, uint8_t numButtons) {
+  if (numButtons > MAP_V1_BUTTONS) numButtons = MAP_V1_BUTTONS;
+  for (uint8_t b = 0; b < numButtons; b++) {
+    const uint8_t* p = record + b * MAP_V1_BUTTON_SIZE;
+    decodeFields(p, get32(p + 12), buttons[b]);
+  }
+}
+
+// one button of a version 2 payload -> current, fields beyond buttonSize keep their value
+static void decodeButtonV2(const uint8_t* p, uint8_t buttonSize, myMapButton& btn) {
+  if (buttonSize > MAP_V2_FLAGS) {
+    btn.needRelease = p[MAP_V2_FLAGS] & 1;
+    btn.btnLongpress = (p[MAP_V2_FLAGS] & 2) != 0;
+  }
+  if (buttonSize > MAP_V2_FUNCTION) btn.btnFunction = p[MAP_V2_FUNCTION] ? BTN_TOGGLE : BTN_PUSH;
+  if (buttonSize > MAP_V2_MIDI_FUNCTION) btn.btnMidiFunction = p[MAP_V2_MIDI_FUNCTION];
+  if (buttonSize > MAP_V2_CHANNEL) btn.btnMidiChannel = p[MAP_V2_CHANNEL];
+  if (buttonSize > MAP_V2_NOTE) btn.btnMidiNote = p[MAP_V2_NOTE];
+  if (buttonSize > MAP_V2_VELOCITY) btn.btnMidiVelocity = p[MAP_V2_VELOCITY];
+  if (buttonSize > MAP_V2_CC) btn.btnMidiCC = p[MAP_V2_CC];
+  if (buttonSize > MAP_V2_CC_ON) btn.btnMidiCCValueStateOn = p[MAP_V2_CC_ON];
+  if (buttonSize > MAP_V2_CC_OFF) btn.btnMidiCCValueStateOff = p[MAP_V2_CC_OFF];
+  if (buttonSize > MAP_V2_MMC) btn.btnMidiMMC = p[MAP_V2_MMC];
+  if (buttonSize >= MAP_V2_COLOR + 3) {
+    btn.btnColor = nearestPaletteColor(((uint32_t)p[MAP_V2_COLOR] << 16) | (p[MAP_V2_COLOR + 1] << 8) | p[MAP_V2_COLOR + 2]);
+  }
+  noBankSelect(btn);
+}
+
+my_map_codec_result decodeMap(const uint8_t* record, size_t len, uint8_t map, myMapButton* buttons, uint8_t numButtons) {
+
+  if (record == nullptr || map >= NUBER_OF_MAPS) return MAP_CODEC_TOO_SHORT;
+
+  // versions 0 and 1 had no header, they are recognised by their size
+  bool magic = len >= 2 && record[0] == MAP_CODEC_MAGIC_0 && record[1] == MAP_CODEC_MAGIC_1;
+  if (len == MAP_V0_SIZE && !magic) {
+    if (map >= MAP_V0_MAPS) return MAP_CODEC_WRONG_MAP;
+    decodeV0(record, map, buttons, numButtons);
+    return MAP_CODEC_MIGRATED;
+  }
+  if (len == MAP_V1_SIZE && !magic) {
+    decodeV1(record, buttons, numButtons);
+    return MAP_CODEC_MIGRATED;
+  }
+
+  if (len < MAP_CODEC_HEADER_SIZE + MAP_CODEC_CRC_SIZE) return MAP_CODEC_TOO_SHORT;
+  if (!magic) return MAP_CODEC_BAD_MAGIC;
+  uint16_t payload = record[6] | (record[7] << 8);
+  if (len != (size_t)MAP_CODEC_HEADER_SIZE + payload + MAP_CODEC_CRC_SIZE) return MAP_CODEC_TOO_SHORT;
+  if (crc32(record, MAP_CODEC_HEADER_SIZE + payload) != get32(record + MAP_CODEC_HEADER_SIZE + payload)) return MAP_CODEC_BAD_CRC;
+  uint8_t version = record[2];
+  if (version != MAP_CODEC_VERSION && version != 2) return MAP_CODEC_UNKNOWN_VERSION;
+  if (record[3] != map) return MAP_CODEC_WRONG_MAP;
+
+  uint8_t storedButtons = record[4];
+  uint8_t buttonSize = record[5];
+  if ((uint32_t)storedButtons * buttonSize != payload) return MAP_CODEC_TOO_SHORT;
+
+  const uint8_t* p = record + MAP_CODEC_HEADER_SIZE;
+  for (uint8_t b = 0; b < storedButtons && b < numButtons; b++, p += buttonSize) {
+    if (version == 2) decodeButtonV2(p, buttonSize, buttons[b]);
+    else decodeButton(p, buttonSize, buttons[b]);
+  }
+  return version != MAP_CODEC_VERSION || buttonSize < MAP_CODEC_BUTTON_SIZE ? MAP_CODEC_MIGRATED : MAP_CODEC_OK;
+}
+
+const char* mapCodecResultName(my_map_codec_result result) {
+  switch (result) {
+    case MAP_CODEC_OK: return "ok";
+    case MAP_CODEC_MIGRATED: return "migrated";
+    case MAP_CODEC_TOO_SHORT: return "too short";
+    case MAP_CODEC_BAD_MAGIC: return "bad magic";
+    case MAP_CODEC_BAD_CRC: return "bad crc";
+    case MAP_CODEC_UNKNOWN_VERSION: return "unknown version";
+    case MAP_CODEC_WRONG_MAP: return "wrong map";
+    default: return "?";
+  }
+}
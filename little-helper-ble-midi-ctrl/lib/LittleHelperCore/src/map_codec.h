@@ -0,0 +1,89 @@
+/**
+ * @file map_codec.h
+ * @brief Stored format of one button map, independent of the myMapButton layout.
+ *
+ * @details A map record is written byte by byte, never as struct memory, so changes to
+ * myMapButton, NUBER_OF_MAPS or the compiler do not change what is stored.
+ *
+ *   header  'L' 'M' version map buttons buttonSize payloadLength(2, LE)
+ *   payload buttons x buttonSize bytes, see the MAP_FIELD_* offsets
+ *   crc     CRC-32 over header and payload (4, LE)
+ *
+ * Migrations run forward on decode:
+ * - version 0: the "Settings" blob of the first firmware, all 4 maps of the 5 buttons as
+ *   myButton struct memory with parallel per map arrays and a uint32 RGB color.
+ * - version 1: the first per map records, raw myButtonRecord struct memory without header.
+ * - version 2: one byte per field and the color as R G B, 13 bytes per button.
+ * - version 3: this format, flags and small values packed, the color as palette index, 8
+ *   bytes per button. RGB colors of older versions become the nearest palette color. The
+ *   macro bits of the flags came later, they are 0 in the records written before. A PC
+ *   button of an older version gets PC_BANK_NONE, that firmware sent no Bank Select.
+ * A record with a smaller buttonSize (older firmware) keeps the current values of the
+ * fields it does not have, a larger one (newer firmware) is read up to the fields known
+ * here. Buttons the record has and the device not are skipped.
+ *
+ * encodeMap() and decodeMap() work on caller buffers and never allocate.
+ */
+
+#ifndef MAP_CODEC_H
+#define MAP_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "button_config.h"
+
+#define MAP_CODEC_VERSION 3
+#define MAP_CODEC_HEADER_SIZE 8
+#define MAP_CODEC_CRC_SIZE 4
+#define MAP_CODEC_MAX_BUTTONS 8
+
+// field offsets in one button of the payload
+#define MAP_FIELD_FLAGS 0         // bit 0 needRelease, bit 1 btnLongpress, bit 2 toggle, bits 3-4 MIDI function, bits 5-7 macro
+#define MAP_FIELD_CHANNEL 1       // bits 0-3 MIDI channel, bits 4-7 MMC command
+#define MAP_FIELD_NOTE 2
+#define MAP_FIELD_VELOCITY 3
+#define MAP_FIELD_CC 4
+#define MAP_FIELD_CC_ON 5
+#define MAP_FIELD_CC_OFF 6
+#define MAP_FIELD_COLOR 7         // BUTTON_PALETTE index
+#define MAP_CODEC_BUTTON_SIZE 8
+
+#define MAP_FLAG_RELEASE 1
+#define MAP_FLAG_LONGPRESS 2
+#define MAP_FLAG_TOGGLE 4
+#define MAP_FLAG_MIDI_SHIFT 3
+#define MAP_FLAG_MACRO_SHIFT 5
+#define MAP_MMC_SHIFT 4
+
+// size of the version 0 "Settings" blob
+#define MAP_V0_SIZE 340
+
+#define MAP_CODEC_MAX_SIZE (MAP_CODEC_HEADER_SIZE + MAP_CODEC_MAX_BUTTONS * MAP_CODEC_BUTTON_SIZE + MAP_CODEC_CRC_SIZE)
+
+enum my_map_codec_result {
+  MAP_CODEC_OK = 0,
+  MAP_CODEC_MIGRATED,        // decoded from an older version, should be written again
+  MAP_CODEC_TOO_SHORT,
+  MAP_CODEC_BAD_MAGIC,
+  MAP_CODEC_BAD_CRC,
+  MAP_CODEC_UNKNOWN_VERSION,
+  MAP_CODEC_WRONG_MAP,
+};
+
+/**
+ * @brief Encode one map of the buttons.
+ * @return record size, 0 if buf is too small
+ */
+size_t encodeMap(const myMapButton* buttons, uint8_t numButtons, uint8_t map, uint8_t* buf, size_t size);
+
+/**
+ * @brief Decode a stored record into one map of the buttons.
+ *
+ * @details The buttons are only changed on MAP_CODEC_OK and MAP_CODEC_MIGRATED. A version 0
+ * blob holds maps 0 .. 3, any other map is MAP_CODEC_WRONG_MAP.
+ */
+my_map_codec_result decodeMap(const uint8_t* record, size_t len, uint8_t map, myMapButton* buttons, uint8_t numButtons);
+
+const char* mapCodecResultName(my_map_codec_result result);
+
+#endif // MAP_CODEC_H
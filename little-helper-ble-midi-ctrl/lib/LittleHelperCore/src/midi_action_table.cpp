@@ -0,0 +1,168 @@
+/**
+ * @file midi_action_table.cpp
+ * @brief Precompiled (button, event, state) -> MIDI action table of the active map.
+ */
+
+#include "midi_action_table.h"
+#include <string.h>
+
+const uint8_t MidiActionTable::_eventSlot[7] = {
+  0,    // BTN_EVENT_PRESSED
+  1,    // BTN_EVENT_RELEASED
+  0xFF, // BTN_EVENT_CLICKED
+  0xFF, // BTN_EVENT_DOUBLE_CLICKED
+  2,    // BTN_EVENT_LONG_PRESSED
+  0xFF, // BTN_EVENT_REPEAT_PRESSED
+  3,    // BTN_EVENT_LONG_RELEASED
+};
+
+// slot -> my_btn_event
+static const uint8_t __slotEvent[MIDI_ACTION_EVENTS] = {
+  BTN_EVENT_PRESSED, BTN_EVENT_RELEASED, BTN_EVENT_LONG_PRESSED, BTN_EVENT_LONG_RELEASED
+};
+
+// append one message to the buffer of the action
+static void addMessage(myMidiAction& action, const uint8_t* bytes, uint8_t len) {
+  memcpy(action.bytes + action.len, bytes, len);
+  action.msgLen[action.messages++] = len;
+  action.len += len;
+}
+
+static void setMessage(myMidiAction& action, uint8_t status, uint8_t data1, uint8_t data2) {
+  const uint8_t message[3] = { status, (uint8_t)(data1 & 0x7F), data2 > 0x7F ? (uint8_t)0x7F : data2 }; // PC allows 128 in the CC value fields
+  addMessage(action, message, sizeof(message));
+}
+
+static void setMmc(myMidiAction& action, uint8_t command, uint8_t deviceId) {
+  if (command < MMC_STOP || command > MMC_PAUSE) return;
+  const uint8_t sysex[6] = { 0xF0, 0x7F, (uint8_t)(deviceId & 0x7F), 0x06, command, 0xF7 };
+  addMessage(action, sysex, sizeof(sysex));
+}
+
+// [B0 00 msb] [B0 20 lsb] C0 program
+static void setProgramChange(myMidiAction& action, uint8_t channel, const myMapButton& btn) {
+  if (btn.btnMidiCCValueStateOn < PC_BANK_NONE) {
+    const uint8_t msb[3] = { (uint8_t)(0xB0 | channel), MIDI_CC_BANKSELECT, btn.btnMidiCCValueStateOn };
+    addMessage(action, msb, sizeof(msb));
+  }
+  if (btn.btnMidiCCValueStateOff < PC_BANK_NONE) {
+    const uint8_t lsb[3] = { (uint8_t)(0xB0 | channel), MIDI_CC_BANKSELECT + 0x20, btn.btnMidiCCValueStateOff }; // LSB of Bank Select
+    addMessage(action, lsb, sizeof(lsb));
+  }
+  const uint8_t program[2] = { (uint8_t)(0xC0 | channel), (uint8_t)(btn.btnMidiCC & 0x7F) };
+  addMessage(action, program, sizeof(program));
+}
+
+MidiActionTable::MidiActionTable() : _state(nullptr), _map(0), _numButtons(0), _mmcDeviceId(MMC_ALL_CALL) {
+  memset(_actions, 0, sizeof(_actions));
+}
+
+void MidiActionTable::compileAction(const myMapButton& btn, uint8_t event, uint8_t state, uint8_t mmcDeviceId,
+  myMidiAction& action) {
+
+  memset(&action, 0, sizeof(action));
+  action.led = LED_KEEP;
+  action.nextState = state; // stays, the engine writes it back without a branch
+  action.color = paletteColor(btn.btnColor);
+
+  bool needRelease = btn.needRelease;
+  uint8_t btnFunction = btn.btnFunction;
+  uint8_t midiFunction = btn.btnMidiFunction;
+  uint8_t channel = btn.btnMidiChannel & 0x0F;
+  uint8_t note = btn.btnMidiNote;
+  uint8_t noteOn = 0x90 | channel;
+  uint8_t noteOff = 0x80 | channel;
+  uint8_t controlChange = 0xB0 | channel;
+
+  // a macro button plays its macro on press (or release) and sends nothing itself
+  if (btn.btnMacro) {
+    if (event == BTN_EVENT_PRESSED) {
+      action.led = LED_BUTTON_COLOR;
+      if (!needRelease) action.macro = btn.btnMacro;
+    } else if (event == BTN_EVENT_RELEASED || event == BTN_EVENT_LONG_RELEASED) {
+      action.led = LED_RESTORE;
+      if (needRelease && event == BTN_EVENT_RELEASED) action.macro = btn.btnMacro;
+    }
+    return;
+  }
+
+  switch (event) {
+    case BTN_EVENT_PRESSED:
+      action.led = LED_BUTTON_COLOR;
+      if (midiFunction == MIDI_NOTE) {
+        if (btnFunction == BTN_PUSH || (btnFunction == BTN_TOGGLE && state == BTN_OFF)) {
+          setMessage(action, noteOn, note, btn.btnMidiVelocity);
+          action.nextState = BTN_ON;
+        } else if (btnFunction == BTN_TOGGLE) {
+          setMessage(action, noteOff, note, 0);
+          action.nextState = BTN_OFF;
+        }
+      } else if (midiFunction == MIDI_CC && !needRelease) {
+        if (btnFunction == BTN_PUSH || (btnFunction == BTN_TOGGLE && state == BTN_OFF)) {
+          setMessage(action, controlChange, btn.btnMidiCC, btn.btnMidiCCValueStateOn);
+          action.nextState = BTN_ON;
+        } else if (btnFunction == BTN_TOGGLE) {
+          setMessage(action, controlChange, btn.btnMidiCC, btn.btnMidiCCValueStateOff);
+          action.nextState = BTN_OFF;
+        }
+      } else if (midiFunction == MIDI_MMC && !needRelease) {
+        setMmc(action, btn.btnMidiMMC, mmcDeviceId);
+        action.nextState = BTN_ON;
+      } else if (midiFunction == MIDI_PROGRAMCHANGE && !needRelease) {
+        setProgramChange(action, channel, btn);
+        action.nextState = BTN_ON;
+      }
+      break;
+    case BTN_EVENT_RELEASED:
+      action.led = LED_RESTORE;
+      if (midiFunction == MIDI_NOTE) {
+        if (btnFunction == BTN_PUSH) {
+          setMessage(action, noteOff, note, 0);
+          action.nextState = BTN_OFF;
+        }
+      } else if (midiFunction == MIDI_CC && needRelease) {
+        setMessage(action, controlChange, btn.btnMidiCC, btn.btnMidiCCValueStateOn);
+        action.nextState = BTN_OFF;
+      } else if (midiFunction == MIDI_MMC && needRelease) {
+        setMmc(action, btn.btnMidiMMC, mmcDeviceId);
+        action.nextState = BTN_OFF;
+      } else if (midiFunction == MIDI_PROGRAMCHANGE && needRelease) {
+        setProgramChange(action, channel, btn);
+        action.nextState = BTN_OFF;
+      }
+      break;
+    case BTN_EVENT_LONG_PRESSED:
+      action.led = LED_BUTTON_COLOR;
+      if (btn.btnLongpress) {
+        if (midiFunction == MIDI_NOTE)
+          setMessage(action, noteOff, note, 0);
+        else if (midiFunction == MIDI_CC && !needRelease)
+          setMessage(action, controlChange, btn.btnMidiCC, btn.btnMidiCCValueStateOn);
+        // MMC and Program Change send nothing on a long press
+      }
+      break;
+    case BTN_EVENT_LONG_RELEASED:
+      // we can disable the note every time the button is logpress released even MidiFuction is not Note
+      action.led = LED_RESTORE;
+      setMessage(action, noteOff, note, 0);
+      break;
+    default:
+      break;
+  }
+}
+
+void MidiActionTable::compile(const myMapButton* buttons, uint8_t* states, uint8_t numButtons, uint8_t map) {
+
+  if (numButtons > MIDI_ACTION_MAX_BUTTONS) numButtons = MIDI_ACTION_MAX_BUTTONS;
+  if (map >= NUBER_OF_MAPS) map = 0;
+
+  for (uint8_t b = 0; b < numButtons; b++) {
+    for (uint8_t slot = 0; slot < MIDI_ACTION_EVENTS; slot++) {
+      compileAction(buttons[b], __slotEvent[slot], BTN_OFF, _mmcDeviceId, _actions[b][slot][BTN_OFF]);
+      compileAction(buttons[b], __slotEvent[slot], BTN_ON, _mmcDeviceId, _actions[b][slot][BTN_ON]);
+    }
+  }
+  _state = states;
+  _map = map;
+  _numButtons = numButtons;
+}
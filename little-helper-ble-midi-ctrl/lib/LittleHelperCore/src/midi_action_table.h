@@ -0,0 +1,110 @@
+/**
+ * @file midi_action_table.h
+ * @brief Precompiled (button, event, state) -> MIDI action table of the active map.
+ *
+ * @details The table is compiled from the myMapButton records of a map when the settings are loaded, changed
+ * or the active map is switched. Each record holds the ready to send MIDI bytes, the
+ * button state after the action and the LED request, so a button event is one indexed
+ * lookup and one send. compile() writes the table in place, so it runs on the task that
+ * calls lookup() (the input task in the firmware), a lookup never sees a half compiled map.
+ *
+ * MMC is a prebuilt SysEx frame with the configured device ID (setMmcDeviceId()). A
+ * Program Change button sends the program from btnMidiCC, the optional Bank Select MSB and
+ * LSB from btnMidiCCValueStateOn / Off (PC_BANK_NONE = not sent), as one buffer of up to
+ * three messages: B0 00 msb, B0 20 lsb, C0 program. The length of each message is compiled
+ * in as well, so a send is a slice of the buffer and nothing is parsed at send time.
+ */
+
+#ifndef MIDI_ACTION_TABLE_H
+#define MIDI_ACTION_TABLE_H
+
+#include <stdint.h>
+#include "button_config.h"
+
+// Button events, the values mirror AceButton::kEvent* so the firmware can pass them through.
+enum my_btn_event {
+  BTN_EVENT_PRESSED       = 0,
+  BTN_EVENT_RELEASED      = 1,
+  BTN_EVENT_CLICKED       = 2,
+  BTN_EVENT_DOUBLE_CLICKED = 3,
+  BTN_EVENT_LONG_PRESSED  = 4,
+  BTN_EVENT_REPEAT_PRESSED = 5,
+  BTN_EVENT_LONG_RELEASED = 6,
+};
+
+// What the caller should do with the status LED after an event.
+enum my_led_request {
+  LED_KEEP = 0x00,         // leave the LED as it is
+  LED_BUTTON_COLOR = 0x01, // show the button color (myEngineResult::color)
+  LED_RESTORE = 0x02,      // restore the connection / map color
+};
+
+#define MIDI_ACTION_MAX_BUTTONS 5
+#define MIDI_ACTION_MAX_BYTES 6 // MMC SysEx F0 7F <id> 06 <cmd> F7 is the longest message
+#define MIDI_ACTION_BUFFER_SIZE 8 // Bank Select MSB, LSB and Program Change in one action
+#define MIDI_ACTION_MAX_MESSAGES 3 // Bank Select MSB, LSB and Program Change
+#define MMC_ALL_CALL 0x7F // MMC device ID every receiver answers to
+#define MIDI_ACTION_EVENTS 4 // Pressed, Released, LongPressed, LongReleased
+
+struct myMidiAction {
+  uint32_t color;    // LED color for LED_BUTTON_COLOR
+  uint8_t led;       // my_led_request
+  uint8_t nextState; // my_btn_state after the event, the state of the action if it stays
+  uint8_t len;       // number of MIDI bytes, 0 = nothing to send
+  uint8_t macro;     // macro to start instead (macro_sequencer.h), 0 = none
+  uint8_t messages;  // number of messages in bytes, one send each
+  uint8_t msgLen[MIDI_ACTION_MAX_MESSAGES]; // length of each message, they follow each other in bytes
+  uint8_t bytes[MIDI_ACTION_BUFFER_SIZE]; // one or more complete messages
+};
+
+class MidiActionTable {
+public:
+  MidiActionTable();
+
+  /**
+   * @brief Compile the actions of all buttons for one map.
+   *
+   * @details Writes the table in place, call it on the task that calls lookup().
+   * @param buttons the buttons of the map
+   * @param states toggle state of each button in this map, must stay valid while the table is used
+   * @param numButtons number of buttons, at most MIDI_ACTION_MAX_BUTTONS
+   * @param map map 0 .. NUBER_OF_MAPS - 1
+   */
+  void compile(const myMapButton* buttons, uint8_t* states, uint8_t numButtons, uint8_t map);
+
+  // MMC device ID 0 - 127 (MMC_ALL_CALL) of the MMC frames, used from the next compile()
+  void setMmcDeviceId(uint8_t id) { _mmcDeviceId = id & 0x7F; }
+  uint8_t mmcDeviceId() const { return _mmcDeviceId; }
+
+  /**
+   * @brief Action for a button event in the current button state, nullptr for events without action.
+   * @param state set to the state of the button when an action is returned, like state()
+   */
+  const myMidiAction* lookup(uint8_t btnIndex, uint8_t eventType, uint8_t*& state) const {
+    if (btnIndex >= _numButtons || eventType >= sizeof(_eventSlot)) return nullptr;
+    uint8_t slot = _eventSlot[eventType];
+    if (slot == 0xFF) return nullptr;
+    state = &_state[btnIndex];
+    return _actions[btnIndex][slot] + (*state & BTN_ON); // [BTN_OFF] or [BTN_ON], no branch on the state
+  }
+
+  // button state of the compiled map, stored in the states passed to compile()
+  uint8_t* state(uint8_t btnIndex) const { return &_state[btnIndex]; }
+
+  uint8_t map() const { return _map; }
+  uint8_t numButtons() const { return _numButtons; }
+
+private:
+  static const uint8_t _eventSlot[7]; // my_btn_event -> table slot, 0xFF = event has no action
+
+  static void compileAction(const myMapButton& btn, uint8_t event, uint8_t state, uint8_t mmcDeviceId,
+    myMidiAction& action);
+
+  myMidiAction _actions[MIDI_ACTION_MAX_BUTTONS][MIDI_ACTION_EVENTS][2]; // [button][event][state]
+  uint8_t* _state; // -> states of the compiled map
+  uint8_t _map;
+  uint8_t _numButtons;
+  uint8_t _mmcDeviceId;
+};
+
+#endif // MIDI_ACTION_TABLE_H
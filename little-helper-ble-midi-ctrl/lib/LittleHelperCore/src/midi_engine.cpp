@@ -0,0 +1,22 @@
+/**
+ * @file midi_engine.cpp
+ * @brief Hardware independent button event -> MIDI engine.
+ */
+
+#include "midi_engine.h"
+
+myEngineResult MidiEngine::handleEvent(uint8_t btnIndex, uint8_t eventType, uint16_t timestampMs) {
+
+    uint8_t* state;
+    const myMidiAction* action = _actions.lookup(btnIndex, eventType, state);
+    if (action == nullptr) return { 0, LED_KEEP, 0 };
+
+    // the messages are compiled in, Bank Select and Program Change are one slice of the buffer each
+    const uint8_t* bytes = action->bytes;
+    for (uint8_t i = 0; i < action->messages; i++) {
+      _out.send(bytes, action->msgLen[i], timestampMs);
+      bytes += action->msgLen[i];
+    }
+    *state = action->nextState;
+    return { action->color, action->led, action->macro };
+}
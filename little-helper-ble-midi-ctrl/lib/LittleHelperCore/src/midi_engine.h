@@ -0,0 +1,55 @@
+/**
+ * @file midi_engine.h
+ * @brief Hardware independent button event -> MIDI engine.
+ *
+ * @details The engine takes a button event, looks up the precompiled action of the
+ * active map (MidiActionTable) and produces the MIDI message, the new button state and
+ * the LED request. All MIDI output goes through the MidiOutput interface, on the device this
+ * is backed by BLEMidiServer, on the host (env:native) by a recording stand-in.
+ * The engine never allocates memory.
+ */
+
+#ifndef MIDI_ENGINE_H
+#define MIDI_ENGINE_H
+
+#include <stdint.h>
+#include "button_config.h"
+#include "midi_action_table.h"
+
+// 8 bytes, returned in one register
+struct myEngineResult {
+  uint32_t color; // button color for LED_BUTTON_COLOR
+  uint8_t led;    // my_led_request
+  uint8_t macro;  // macro the caller should start (MacroSequencer), 0 = none
+};
+
+/**
+ * @brief MIDI sink used by the engine.
+ */
+class MidiOutput {
+public:
+  virtual ~MidiOutput() {}
+  // send one complete MIDI message (channel message or SysEx), timestampMs is the time of the button edge
+  virtual void send(const uint8_t* data, uint8_t len, uint16_t timestampMs) = 0;
+};
+
+class MidiEngine {
+public:
+  MidiEngine(MidiOutput& output, MidiActionTable& actions) : _out(output), _actions(actions) {}
+
+  /**
+   * @brief Handle one button event of the map compiled into the action table.
+   *
+   * @param btnIndex button 0 .. numButtons - 1
+   * @param eventType my_btn_event
+   * @param timestampMs time of the event (the button edge) in ms, becomes the BLE-MIDI timestamp
+   * @return LED request for the caller
+   */
+  myEngineResult handleEvent(uint8_t btnIndex, uint8_t eventType, uint16_t timestampMs);
+
+private:
+  MidiOutput& _out;
+  MidiActionTable& _actions;
+};
+
+#endif // MIDI_ENGINE_H
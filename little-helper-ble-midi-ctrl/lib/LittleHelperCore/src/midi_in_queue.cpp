@@ -0,0 +1,155 @@
+/**
+ * @file midi_in_queue.cpp
+ * @brief Incoming BLE-MIDI messages, decoded in the BT stack task and handed to the input task.
+ */
+
+#include "midi_in_queue.h"
+
+#include <string.h>
+
+static_assert(MIDI_IN_MAX_BYTES >= 3, "a channel message must fit");
+
+static uint8_t dataBytes(uint8_t status) {
+  switch (status & 0xF0) {
+    case 0x80: case 0x90: case 0xA0: case 0xB0: case 0xE0: return 2;
+    case 0xC0: case 0xD0: return 1;
+    default: break;
+  }
+  switch (status) {
+    case 0xF1: case 0xF3: return 1;
+    case 0xF2: return 2;
+    default: return 0;
+  }
+}
+
+MidiInQueue::MidiInQueue()
+  : _received(0), _dropped(0), _oversized(0), _malformed(0), _highWater(0) {
+  resetParser();
+}
+
+void MidiInQueue::resetParser() {
+  _pendingLen = 0;
+  _inSysEx = false;
+  _sysExTooLong = false;
+  _sysExTimestamp = 0;
+  _runningStatus = 0;
+}
+
+bool MidiInQueue::push(const myMidiIn& message) {
+  if (!_queue.push(message)) {
+    _dropped++;
+    return false;
+  }
+  _received++;
+  uint16_t queued = _queue.size();
+  if (queued > _highWater) _highWater = queued;
+  return true;
+}
+
+void MidiInQueue::complete(uint16_t timestamp) {
+  myMidiIn message;
+  message.timestamp = timestamp;
+  message.len = _pendingLen;
+  memcpy(message.bytes, _pending, _pendingLen);
+  push(message);
+  _pendingLen = 0;
+}
+
+bool MidiInQueue::receive(const uint8_t* packet, size_t len) {
+  if (parse(packet, len)) return true;
+  _malformed++;
+  resetParser();
+  return false;
+}
+
+bool MidiInQueue::parse(const uint8_t* packet, size_t len) {
+  // header: bit 7 set, bit 6 reserved, bits 5..0 the high timestamp bits
+  if (len < 2 || (packet[0] & 0xC0) != 0x80) return false;
+  if (!_inSysEx) _runningStatus = 0; // running status does not continue into the next packet
+
+  uint16_t high = packet[0] & 0x3F;
+  uint8_t lastLow = 0;
+  bool haveTimestamp = false;
+  uint16_t timestamp = 0;
+  size_t i = 1;
+
+  while (i < len) {
+    uint8_t b = packet[i++];
+    if (!(b & 0x80)) {
+      if (_inSysEx) { // SysEx data, also at the start of a continuation packet
+        if (_pendingLen < MIDI_IN_MAX_BYTES) _pending[_pendingLen++] = b;
+        else _sysExTooLong = true;
+        continue;
+      }
+      // running status without a new timestamp byte
+      if (_runningStatus == 0 || !haveTimestamp) return false;
+      uint8_t need = dataBytes(_runningStatus);
+      _pending[0] = _runningStatus;
+      _pending[1] = b;
+      _pendingLen = 2;
+      for (uint8_t d = 1; d < need; d++) {
+        if (i >= len || (packet[i] & 0x80)) return false;
+        _pending[_pendingLen++] = packet[i++];
+      }
+      complete(timestamp);
+      continue;
+    }
+
+    // timestamp byte, a smaller low part than the one before is one overflow into the high bits
+    uint8_t low = b & 0x7F;
+    if (haveTimestamp && low < lastLow) high = (high + 1) & 0x3F;
+    lastLow = low;
+    haveTimestamp = true;
+    timestamp = (high << 7) | low;
+    if (i >= len) return false;
+
+    uint8_t status = packet[i];
+    if (status & 0x80) {
+      i++;
+      if (status >= 0xF8) { // real time, may come between the bytes of a SysEx
+        myMidiIn message;
+        message.timestamp = timestamp;
+        message.len = 1;
+        message.bytes[0] = status;
+        push(message);
+        continue;
+      }
+      if (status == 0xF7) {
+        if (!_inSysEx) return false;
+        _inSysEx = false;
+        if (_sysExTooLong || _pendingLen >= MIDI_IN_MAX_BYTES) {
+          _oversized++;
+          _pendingLen = 0;
+          continue;
+        }
+        _pending[_pendingLen++] = 0xF7;
+        complete(_sysExTimestamp);
+        continue;
+      }
+      if (_inSysEx) return false; // a SysEx without its F7
+      if (status == 0xF0) {
+        _inSysEx = true;
+        _sysExTooLong = false;
+        _sysExTimestamp = timestamp;
+        _pending[0] = 0xF0;
+        _pendingLen = 1;
+        _runningStatus = 0;
+        continue;
+      }
+      _runningStatus = status < 0xF0 ? status : 0;
+    } else {
+      if (_inSysEx || _runningStatus == 0) return false;
+      status = _runningStatus;
+    }
+
+    uint8_t need = dataBytes(status);
+    _pending[0] = status;
+    _pendingLen = 1;
+    for (uint8_t d = 0; d < need; d++) {
+      if (i >= len || (packet[i] & 0x80)) return false;
+      _pending[_pendingLen++] = packet[i++];
+    }
+    complete(timestamp);
+  }
+  return true;
+}
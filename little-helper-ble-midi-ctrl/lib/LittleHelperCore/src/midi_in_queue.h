@@ -0,0 +1,75 @@
+/**
+ * @file midi_in_queue.h
+ * @brief Incoming BLE-MIDI messages, decoded in the BT stack task and handed to the input task.
+ *
+ * @details The BT stack task calls receive() with every packet written to the MIDI
+ * characteristic. The packet is decoded (13 bit timestamps, running status, SysEx over
+ * several packets, real time bytes between the bytes of other messages) and every complete
+ * message is pushed into a bounded SpscQueue. No locks, no allocation, the BT stack task
+ * never waits: a full queue drops the message and counts it. The input task pops the
+ * messages and routes them next to the button events.
+ *
+ * SysEx longer than MIDI_IN_MAX_BYTES (MMC and other short ones fit) is counted and dropped.
+ */
+
+#ifndef MIDI_IN_QUEUE_H
+#define MIDI_IN_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "spsc_queue.h"
+
+#define MIDI_IN_QUEUE_SIZE 64 // 1 s of MIDI clock at 120 bpm with room for a controller sweep
+#define MIDI_IN_MAX_BYTES 12
+
+struct myMidiIn {
+  uint16_t timestamp; // 13 bit BLE-MIDI timestamp of the sender
+  uint8_t len;
+  uint8_t bytes[MIDI_IN_MAX_BYTES]; // one complete message, status byte first
+};
+
+class MidiInQueue {
+public:
+  MidiInQueue();
+
+  // producer side, decode one BLE-MIDI packet and queue its messages, false if malformed
+  bool receive(const uint8_t* packet, size_t len);
+  // producer side, queue one message, false and counted if the queue is full
+  bool push(const myMidiIn& message);
+  // producer side, after a disconnect: no SysEx and running status continue into the next connection
+  void resetParser();
+
+  // consumer side
+  bool pop(myMidiIn& message) { return _queue.pop(message); }
+  bool empty() const { return _queue.empty(); }
+  static uint16_t capacity() { return MIDI_IN_QUEUE_SIZE; }
+
+  // written by the producer only, any task may read them
+  uint32_t received() const { return _received; }   // messages queued
+  uint32_t dropped() const { return _dropped; }     // messages lost to a full queue
+  uint32_t oversized() const { return _oversized; } // SysEx longer than MIDI_IN_MAX_BYTES
+  uint32_t malformed() const { return _malformed; } // packets
+  uint16_t highWater() const { return _highWater; } // most messages queued at once
+
+private:
+  // the messages of one packet, false at the first byte that breaks the packet
+  bool parse(const uint8_t* packet, size_t len);
+  void complete(uint16_t timestamp);
+
+  SpscQueue<myMidiIn, MIDI_IN_QUEUE_SIZE> _queue;
+  // parser state, across packets for SysEx and running status
+  uint8_t _pending[MIDI_IN_MAX_BYTES];
+  uint8_t _pendingLen;
+  bool _inSysEx;
+  bool _sysExTooLong;
+  uint16_t _sysExTimestamp;
+  uint8_t _runningStatus;
+
+  uint32_t _received;
+  uint32_t _dropped;
+  uint32_t _oversized;
+  uint32_t _malformed;
+  uint16_t _highWater;
+};
+
+#endif // MIDI_IN_QUEUE_H
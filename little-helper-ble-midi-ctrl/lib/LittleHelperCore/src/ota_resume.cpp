@@ -0,0 +1,99 @@
+/**
+ * @file ota_resume.cpp
+ * @brief Persisted checkpoint of a partly downloaded OTA image and the HTTP Range helpers.
+ */
+
+#include "ota_resume.h"
+#include "crc32.h"
+#include <stdio.h>
+#include <string.h>
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v; p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint16_t get16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t encodeOtaCheckpoint(const myOtaCheckpoint& checkpoint, uint8_t* buf) {
+  memset(buf, 0, OTA_CHECKPOINT_RECORD_SIZE);
+  put16(buf, OTA_CHECKPOINT_MAGIC);
+  buf[2] = OTA_CHECKPOINT_VERSION;
+  put16(buf + 4, OTA_CHECKPOINT_PAYLOAD_SIZE);
+
+  uint8_t* p = buf + OTA_CHECKPOINT_HEADER_SIZE;
+  put32(p + OTA_CHECKPOINT_FIELD_FW_VERSION, checkpoint.fwVersion);
+  put32(p + OTA_CHECKPOINT_FIELD_TOTAL, checkpoint.total);
+  put32(p + OTA_CHECKPOINT_FIELD_DONE, checkpoint.done);
+  put32(p + OTA_CHECKPOINT_FIELD_PARTITION, checkpoint.partition);
+  p[OTA_CHECKPOINT_FIELD_BOOTS] = checkpoint.boots;
+  p[OTA_CHECKPOINT_FIELD_HAS_HASH] = checkpoint.hasHash;
+  memcpy(p + OTA_CHECKPOINT_FIELD_HASH, checkpoint.expectedHash, SHA256_SIZE);
+
+  put32(p + OTA_CHECKPOINT_PAYLOAD_SIZE, crc32(buf, OTA_CHECKPOINT_HEADER_SIZE + OTA_CHECKPOINT_PAYLOAD_SIZE));
+  return OTA_CHECKPOINT_RECORD_SIZE;
+}
+
+bool decodeOtaCheckpoint(const uint8_t* record, size_t len, myOtaCheckpoint& checkpoint) {
+  if (record == nullptr || len != OTA_CHECKPOINT_RECORD_SIZE) return false;
+  if (get16(record) != OTA_CHECKPOINT_MAGIC || record[2] != OTA_CHECKPOINT_VERSION) return false;
+  if (get16(record + 4) != OTA_CHECKPOINT_PAYLOAD_SIZE) return false;
+  const uint8_t* p = record + OTA_CHECKPOINT_HEADER_SIZE;
+  if (crc32(record, OTA_CHECKPOINT_HEADER_SIZE + OTA_CHECKPOINT_PAYLOAD_SIZE) != get32(p + OTA_CHECKPOINT_PAYLOAD_SIZE)) return false;
+
+  myOtaCheckpoint read = myOtaCheckpoint();
+  read.fwVersion = get32(p + OTA_CHECKPOINT_FIELD_FW_VERSION);
+  read.total = get32(p + OTA_CHECKPOINT_FIELD_TOTAL);
+  read.done = get32(p + OTA_CHECKPOINT_FIELD_DONE);
+  read.partition = get32(p + OTA_CHECKPOINT_FIELD_PARTITION);
+  read.boots = p[OTA_CHECKPOINT_FIELD_BOOTS];
+  read.hasHash = p[OTA_CHECKPOINT_FIELD_HAS_HASH];
+  memcpy(read.expectedHash, p + OTA_CHECKPOINT_FIELD_HASH, SHA256_SIZE);
+  if (read.done > read.total) return false;
+  checkpoint = read;
+  return true;
+}
+
+uint32_t otaResumeOffset(const myOtaCheckpoint& checkpoint, uint32_t fwVersion, uint32_t total,
+  uint32_t partition, const uint8_t* expectedHash) {
+  if (checkpoint.fwVersion != fwVersion || checkpoint.total != total || checkpoint.partition != partition) return 0;
+  if (checkpoint.boots >= OTA_CHECKPOINT_MAX_BOOTS) return 0;
+  if (expectedHash != nullptr && checkpoint.hasHash && memcmp(expectedHash, checkpoint.expectedHash, SHA256_SIZE) != 0) return 0;
+  return checkpoint.done;
+}
+
+void otaRangeHeader(char* str, size_t size, uint32_t from) {
+  snprintf(str, size, "bytes=%lu-", (unsigned long)from);
+}
+
+static bool parseNumber(const char*& p, uint32_t& value) {
+  if (*p < '0' || *p > '9') return false;
+  uint64_t v = 0;
+  while (*p >= '0' && *p <= '9') {
+    v = v * 10 + (*p++ - '0');
+    if (v > 0xFFFFFFFFull) return false;
+  }
+  value = (uint32_t)v;
+  return true;
+}
+
+bool parseContentRange(const char* value, uint32_t& first, uint32_t& last, uint32_t& total) {
+  if (value == nullptr) return false;
+  while (*value == ' ') value++;
+  if (strncmp(value, "bytes ", 6) != 0) return false;
+  const char* p = value + 6;
+  while (*p == ' ') p++;
+  if (!parseNumber(p, first) || *p++ != '-') return false;
+  if (!parseNumber(p, last) || *p++ != '/') return false;
+  if (!parseNumber(p, total)) return false;
+  return first <= last && last < total;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file ota_resume.h
+ * @brief Persisted checkpoint of a partly downloaded OTA image and the HTTP Range helpers.
+ *
+ * @details While an image is written to the OTA partition the writer stores from time to
+ * time how many bytes are in flash, for which firmware version, image size and expected
+ * SHA-256. After a dropped connection or a reboot the download continues at that offset
+ * with a Range request, the hash of the bytes already in flash is rebuilt by reading them
+ * back. The checkpoint is only a hint: it is used when it matches the image the server
+ * offers now, otherwise the download starts over.
+ *
+ * Stored layout, written byte by byte like the device config record (device_config.h):
+ *
+ *   header   magic(2, LE) version reserved payloadLength(2, LE)
+ *   payload  the OTA_CHECKPOINT_FIELD_* offsets, numbers little endian
+ *   crc      CRC-32 over header and payload (4, LE)
+ *
+ * The offsets are those of the struct memory stored before, so a checkpoint written by
+ * that firmware still resumes.
+ */
+
+#ifndef OTA_RESUME_H
+#define OTA_RESUME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+#define OTA_CHECKPOINT_MAGIC 0x524F // "OR"
+#define OTA_CHECKPOINT_VERSION 1
+#define OTA_CHECKPOINT_BYTES (64 * 1024) // bytes between two checkpoint writes
+#define OTA_CHECKPOINT_MAX_BOOTS 3 // reboots that resume the same image before it is given up
+
+#define OTA_CHECKPOINT_HEADER_SIZE 6
+#define OTA_CHECKPOINT_CRC_SIZE 4
+
+// field offsets in the payload
+#define OTA_CHECKPOINT_FIELD_FW_VERSION 0 // uint32
+#define OTA_CHECKPOINT_FIELD_TOTAL 4      // uint32
+#define OTA_CHECKPOINT_FIELD_DONE 8       // uint32
+#define OTA_CHECKPOINT_FIELD_PARTITION 12 // uint32
+#define OTA_CHECKPOINT_FIELD_BOOTS 16
+#define OTA_CHECKPOINT_FIELD_HAS_HASH 17
+#define OTA_CHECKPOINT_FIELD_HASH 20      // SHA256_SIZE
+#define OTA_CHECKPOINT_PAYLOAD_SIZE (OTA_CHECKPOINT_FIELD_HASH + SHA256_SIZE)
+
+#define OTA_CHECKPOINT_RECORD_SIZE (OTA_CHECKPOINT_HEADER_SIZE + OTA_CHECKPOINT_PAYLOAD_SIZE + OTA_CHECKPOINT_CRC_SIZE)
+
+// the values in RAM
+struct myOtaCheckpoint {
+  uint32_t fwVersion;    // version being downloaded
+  uint32_t total;        // image size
+  uint32_t done;         // bytes in flash, a multiple of the block size unless == total
+  uint32_t partition;    // flash address of the OTA partition written
+  uint8_t boots;         // reboots that resumed this image
+  uint8_t hasHash;       // expectedHash is known (.sha256 next to the image)
+  uint8_t reserved[2];
+  uint8_t expectedHash[SHA256_SIZE];
+};
+
+size_t encodeOtaCheckpoint(const myOtaCheckpoint& checkpoint, uint8_t* buf);
+// false if the record is missing, broken or of an unknown version
+bool decodeOtaCheckpoint(const uint8_t* record, size_t len, myOtaCheckpoint& checkpoint);
+
+/**
+ * @brief Offset to continue the download at.
+ *
+ * @return checkpoint.done if the checkpoint belongs to this image (version, size, partition
+ * and, if both are known, the SHA-256), 0 otherwise
+ */
+uint32_t otaResumeOffset(const myOtaCheckpoint& checkpoint, uint32_t fwVersion, uint32_t total,
+  uint32_t partition, const uint8_t* expectedHash);
+
+// "bytes=<from>-"
+void otaRangeHeader(char* str, size_t size, uint32_t from);
+
+/**
+ * @brief Parse a Content-Range response header, "bytes <first>-<last>/<total>".
+ * @return false if the value is missing or malformed, a "*" total is not accepted
+ */
+bool parseContentRange(const char* value, uint32_t& first, uint32_t& last, uint32_t& total);
+
+#endif // OTA_RESUME_H
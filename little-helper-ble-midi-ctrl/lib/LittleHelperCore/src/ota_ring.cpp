@@ -0,0 +1,64 @@
+/**
+ * @file ota_ring.cpp
+ * @brief Block ring between the OTA network reader and the flash writer, and the OTA progress.
+ */
+
+#include "ota_ring.h"
+#include <stdio.h>
+
+OtaBlockRing::OtaBlockRing(uint8_t* storage, uint16_t blocks, uint16_t blockSize)
+  : _storage(storage), _blocks(blocks), _blockSize(blockSize), _head(0), _tail(0),
+    _readerStalls(0), _writerStalls(0) {
+  if (_blocks > OTA_RING_MAX_BLOCKS) _blocks = OTA_RING_MAX_BLOCKS;
+  if (_blocks == 0 || (_blocks & (_blocks - 1))) _blocks = 1; // not a power of two: run without overlap
+  for (uint16_t i = 0; i < OTA_RING_MAX_BLOCKS; i++) _len[i] = 0;
+}
+
+uint8_t* OtaBlockRing::acquire() {
+  uint16_t head = _head.load(std::memory_order_relaxed);
+  uint16_t tail = _tail.load(std::memory_order_acquire);
+  if ((uint16_t)(head - tail) >= _blocks) return nullptr;
+  return _storage + (uint32_t)(head & (_blocks - 1)) * _blockSize;
+}
+
+void OtaBlockRing::commit(uint16_t len) {
+  uint16_t head = _head.load(std::memory_order_relaxed);
+  _len[head & (_blocks - 1)] = len;
+  _head.store(head + 1, std::memory_order_release);
+}
+
+const uint8_t* OtaBlockRing::peek(uint16_t& len) {
+  uint16_t tail = _tail.load(std::memory_order_relaxed);
+  uint16_t head = _head.load(std::memory_order_acquire);
+  if (head == tail) return nullptr;
+  len = _len[tail & (_blocks - 1)];
+  return _storage + (uint32_t)(tail & (_blocks - 1)) * _blockSize;
+}
+
+void OtaBlockRing::release() {
+  _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void OtaProgress::begin(uint32_t total, uint32_t nowMs, uint32_t resumedAt) {
+  _total = total;
+  _startMs = nowMs;
+  _resumedAt = resumedAt;
+  _received.store(0, std::memory_order_relaxed);
+  _written.store(0, std::memory_order_relaxed);
+}
+
+uint8_t OtaProgress::percent() const {
+  if (_total == 0) return 0;
+  return (uint8_t)((uint64_t)(_resumedAt + writtenBytes()) * 100 / _total);
+}
+
+uint32_t OtaProgress::kbPerSecond(uint32_t nowMs) const {
+  uint32_t ms = nowMs - _startMs;
+  if (ms == 0) return 0;
+  return (uint32_t)((uint64_t)writtenBytes() * 1000 / 1024 / ms);
+}
+
+void OtaProgress::format(char* str, size_t size, uint32_t nowMs) const {
+  snprintf(str, size, "%u%% %lu/%lu KB, %lu KB/s", percent(), (unsigned long)((_resumedAt + writtenBytes()) / 1024),
+    (unsigned long)(_total / 1024), (unsigned long)kbPerSecond(nowMs));
+}
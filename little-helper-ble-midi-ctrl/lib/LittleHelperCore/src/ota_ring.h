@@ -0,0 +1,93 @@
+/**
+ * @file ota_ring.h
+ * @brief Block ring between the OTA network reader and the flash writer, and the OTA progress.
+ *
+ * @details The reader fills one block while the writer drains the ones filled before, so
+ * download and flash write overlap. One task produces, one consumes, no locks. The storage
+ * is owned by the caller and only allocated for the time of an update. A full ring stalls
+ * the reader (flash is the bottleneck), an empty one the writer (network is), the stall
+ * counters tell which one to tune.
+ */
+
+#ifndef OTA_RING_H
+#define OTA_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define OTA_RING_BLOCKS 4
+#define OTA_RING_BLOCK_SIZE 4096 // one flash sector
+#define OTA_RING_MAX_BLOCKS 16
+
+class OtaBlockRing {
+public:
+  // storage: blocks x blockSize bytes, blocks a power of two up to OTA_RING_MAX_BLOCKS
+  OtaBlockRing(uint8_t* storage, uint16_t blocks, uint16_t blockSize);
+
+  // ~ reader side ~
+  // free block to fill, nullptr if all are full
+  uint8_t* acquire();
+  // hand the acquired block with len bytes to the writer
+  void commit(uint16_t len);
+
+  // ~ writer side ~
+  // oldest filled block, nullptr if none
+  const uint8_t* peek(uint16_t& len);
+  // give the block back to the reader
+  void release();
+
+  uint16_t blockSize() const { return _blockSize; }
+  uint16_t filled() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+
+  // ~ metrics ~
+  void readerStalled() { _readerStalls++; }
+  void writerStalled() { _writerStalls++; }
+  uint32_t readerStalls() const { return _readerStalls.load(std::memory_order_relaxed); }
+  uint32_t writerStalls() const { return _writerStalls.load(std::memory_order_relaxed); }
+
+private:
+  uint8_t* _storage;
+  uint16_t _blocks;
+  uint16_t _blockSize;
+  uint16_t _len[OTA_RING_MAX_BLOCKS];
+  std::atomic<uint16_t> _head;
+  std::atomic<uint16_t> _tail;
+  std::atomic<uint32_t> _readerStalls;
+  std::atomic<uint32_t> _writerStalls;
+};
+
+/**
+ * @brief Bytes downloaded and written of one update and the resulting throughput.
+ *
+ * @details received() belongs to the reader, written() to the writer, format() may run on
+ * any task.
+ */
+class OtaProgress {
+public:
+  // resumedAt: bytes already in flash from an earlier connection, not part of the rate
+  void begin(uint32_t total, uint32_t nowMs, uint32_t resumedAt = 0);
+  void received(uint32_t bytes) { _received.fetch_add(bytes, std::memory_order_relaxed); }
+  void written(uint32_t bytes) { _written.fetch_add(bytes, std::memory_order_relaxed); }
+
+  uint32_t total() const { return _total; }
+  uint32_t receivedBytes() const { return _received.load(std::memory_order_relaxed); }
+  // bytes written since begin()
+  uint32_t writtenBytes() const { return _written.load(std::memory_order_relaxed); }
+  // of the whole image, including resumedAt
+  uint8_t percent() const;
+  // written KB/s since begin()
+  uint32_t kbPerSecond(uint32_t nowMs) const;
+
+  // "42% 512/1240 KB, 187 KB/s"
+  void format(char* str, size_t size, uint32_t nowMs) const;
+
+private:
+  uint32_t _total = 0;
+  uint32_t _startMs = 0;
+  uint32_t _resumedAt = 0;
+  std::atomic<uint32_t> _received{0};
+  std::atomic<uint32_t> _written{0};
+};
+
+#endif // OTA_RING_H
@@ -0,0 +1,56 @@
+/**
+ * @file preset_image.cpp
+ * @brief Read-only preset maps, read in place from the memory mapped "presets" partition.
+ */
+
+#include "preset_image.h"
+#include "crc32.h"
+
+#define PRESET_MAGIC_0 'L'
+#define PRESET_MAGIC_1 'P'
+
+static uint16_t get16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool PresetImage::attach(const uint8_t* data, size_t size) {
+  detach();
+  if (data == nullptr || size < PRESET_HEADER_SIZE) return false;
+  if (data[0] != PRESET_MAGIC_0 || data[1] != PRESET_MAGIC_1 || data[2] != PRESET_IMAGE_VERSION
+    || crc32(data, 12) != get32(data + 12)) {
+    return false;
+  }
+  uint16_t maps = get16(data + 4), slotSize = get16(data + 6);
+  uint32_t imageSize = get32(data + 8);
+  if (slotSize < MAP_CODEC_HEADER_SIZE + MAP_CODEC_CRC_SIZE || imageSize > size
+    || imageSize != PRESET_HEADER_SIZE + (uint32_t)maps * slotSize) {
+    return false;
+  }
+  _data = data;
+  _maps = maps;
+  _slotSize = slotSize;
+  return true;
+}
+
+const uint8_t* PresetImage::record(uint8_t map, size_t& len) const {
+  len = 0;
+  if (map >= _maps) return nullptr;
+  const uint8_t* slot = _data + PRESET_HEADER_SIZE + (uint32_t)map * _slotSize;
+  if (slot[0] == 0xFF) return nullptr;
+  // the record length is in its header, decodeMap() checks the rest
+  size_t recordLen = MAP_CODEC_HEADER_SIZE + get16(slot + 6) + MAP_CODEC_CRC_SIZE;
+  if (recordLen > _slotSize) return nullptr;
+  len = recordLen;
+  return slot;
+}
+
+my_map_codec_result PresetImage::load(uint8_t map, myMapButton* buttons, uint8_t numButtons) const {
+  size_t len;
+  const uint8_t* slot = record(map, len);
+  if (slot == nullptr) return MAP_CODEC_TOO_SHORT;
+  return decodeMap(slot, len, map, buttons, numButtons);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file preset_image.h
+ * @brief Read-only preset maps, read in place from the memory mapped "presets" partition.
+ *
+ * @details tools/mkpresets.py builds the image from a text description of the maps
+ * (configuration/presets.txt). The firmware maps the partition into the data address space
+ * and attaches it here. attach() checks the header only, so no preset is copied or decoded
+ * at boot. A map is decoded straight from its slot when the map cache needs it. The
+ * preset of a map is what the map has without a record in its bank, after a reset too.
+ *
+ *   header  'L' 'P' version 0xFF maps(2, LE) slotSize(2, LE) imageSize(4, LE)
+ *           crc(4, LE) over the first 12 bytes
+ *   slot    one map record (map_codec.h) per map from map 0 on, 0xFF after the record,
+ *           a slot starting with 0xFF has no preset
+ *
+ * The slots are checked by the CRC of their map record on decode, a broken slot keeps the
+ * defaults of the map.
+ */
+
+#ifndef PRESET_IMAGE_H
+#define PRESET_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "map_codec.h"
+
+#define PRESET_IMAGE_VERSION 1
+#define PRESET_HEADER_SIZE 16
+#define PRESET_SLOT_SIZE 80 // MAP_CODEC_MAX_SIZE rounded up to 16, what the tool writes
+
+static_assert(MAP_CODEC_MAX_SIZE <= PRESET_SLOT_SIZE, "a map record must fit into its preset slot");
+
+class PresetImage {
+public:
+  PresetImage() : _data(nullptr), _maps(0), _slotSize(0) {}
+
+  // check the header of a mapped image, false (and no presets) if it is not one
+  bool attach(const uint8_t* data, size_t size);
+  void detach() { _data = nullptr; _maps = 0; }
+
+  bool valid() const { return _data != nullptr; }
+  uint16_t maps() const { return _maps; }
+  uint32_t imageSize() const { return _maps ? PRESET_HEADER_SIZE + (uint32_t)_maps * _slotSize : 0; }
+
+  // the map record of a map in the image, nullptr without a preset
+  const uint8_t* record(uint8_t map, size_t& len) const;
+  // decode the preset of a map over buttons, MAP_CODEC_TOO_SHORT without a preset
+  my_map_codec_result load(uint8_t map, myMapButton* buttons, uint8_t numButtons) const;
+
+private:
+  const uint8_t* _data;
+  uint16_t _maps;
+  uint16_t _slotSize;
+};
+
+#endif // PRESET_IMAGE_H
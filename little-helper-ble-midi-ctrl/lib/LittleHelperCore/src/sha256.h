@@ -0,0 +1,39 @@
+/**
+ * @file sha256.h
+ * @brief SHA-256 (FIPS 180-4) over data that arrives in pieces, for OTA image verification.
+ *
+ * @details Portable and without allocation, so the host programs check the same code the
+ * device runs. The state can be rebuilt after a reboot by hashing the flash contents again.
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHA256_SIZE 32
+
+class Sha256 {
+public:
+  Sha256() { begin(); }
+
+  void begin();
+  void update(const void* data, size_t len);
+  void finish(uint8_t digest[SHA256_SIZE]);
+
+  uint64_t length() const { return _length; }
+
+private:
+  void block(const uint8_t* p);
+
+  uint32_t _state[8];
+  uint8_t _buf[64];
+  uint8_t _bufLen;
+  uint64_t _length;
+};
+
+// 64 hex digits -> 32 bytes, false if the text is no SHA-256
+bool sha256FromHex(const char* hex, uint8_t digest[SHA256_SIZE]);
+
+#endif // SHA256_H
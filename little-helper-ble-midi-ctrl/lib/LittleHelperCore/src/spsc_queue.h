@@ -0,0 +1,57 @@
+/**
+ * @file spsc_queue.h
+ * @brief Bounded lock-free single producer / single consumer queue.
+ *
+ * @details One context may push (for example a GPIO ISR or the BT stack task) and one
+ * other context may pop (the task that handles the items). No locks, no allocation,
+ * push never blocks and fails when the queue is full. Size must be a power of two.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint16_t Size>
+class SpscQueue {
+  static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+  SpscQueue() : _head(0), _tail(0) {}
+
+  // producer side
+  bool push(const T& item) {
+    uint16_t head = _head.load(std::memory_order_relaxed);
+    uint16_t tail = _tail.load(std::memory_order_acquire);
+    if ((uint16_t)(head - tail) >= Size) return false;
+    _items[head & (Size - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side
+  bool pop(T& item) {
+    uint16_t tail = _tail.load(std::memory_order_relaxed);
+    uint16_t head = _head.load(std::memory_order_acquire);
+    if (head == tail) return false;
+    item = _items[tail & (Size - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // number of queued items, exact only from the producer or consumer side
+  uint16_t size() const {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+  static uint16_t capacity() { return Size; }
+
+private:
+  T _items[Size];
+  std::atomic<uint16_t> _head;
+  std::atomic<uint16_t> _tail;
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,95 @@
+/**
+ * @file timer_wheel.cpp
+ * @brief Hashed timer wheel with a fixed pool of timers, advanced tick by tick.
+ */
+
+#include "timer_wheel.h"
+
+#include <string.h>
+
+static_assert((TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS - 1)) == 0, "TIMER_WHEEL_SLOTS must be a power of two");
+static_assert(TIMER_WHEEL_TIMERS < TIMER_WHEEL_END, "timer indexes are uint8_t");
+
+TimerWheel::TimerWheel() {
+  reset(0);
+}
+
+void TimerWheel::reset(uint32_t nowTick) {
+  memset(_slots, TIMER_WHEEL_END, sizeof(_slots));
+  for (uint8_t i = 0; i < TIMER_WHEEL_TIMERS; i++) _timers[i].next = i + 1 < TIMER_WHEEL_TIMERS ? i + 1 : TIMER_WHEEL_END;
+  _free = 0;
+  _used = 0;
+  _tick = nowTick;
+}
+
+bool TimerWheel::schedule(uint32_t dueTick, uint8_t tag) {
+  if (_free == TIMER_WHEEL_END) return false;
+  uint8_t t = _free;
+  _free = _timers[t].next;
+  _timers[t].due = dueTick;
+  _timers[t].tag = tag;
+  _timers[t].next = TIMER_WHEEL_END;
+
+  // a tick already passed goes into the next slot advance() visits
+  uint32_t slotTick = (int32_t)(dueTick - _tick) > 0 ? dueTick : _tick + 1;
+  // appended, timers of the same tick fire in the order they were scheduled
+  uint8_t* link = &_slots[slotTick & (TIMER_WHEEL_SLOTS - 1)];
+  while (*link != TIMER_WHEEL_END) link = &_timers[*link].next;
+  *link = t;
+  _used++;
+  return true;
+}
+
+uint8_t TimerWheel::cancel(uint8_t tag) {
+  uint8_t removed = 0;
+  for (uint8_t s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+    uint8_t* link = &_slots[s];
+    while (*link != TIMER_WHEEL_END) {
+      uint8_t t = *link;
+      if (_timers[t].tag != tag) {
+        link = &_timers[t].next;
+        continue;
+      }
+      *link = _timers[t].next;
+      _timers[t].next = _free;
+      _free = t;
+      _used--;
+      removed++;
+    }
+  }
+  return removed;
+}
+
+uint8_t TimerWheel::advance(uint32_t nowTick, FireFunction fire, void* context) {
+  int32_t ticks = (int32_t)(nowTick - _tick);
+  if (ticks <= 0) return 0;
+  if (_used == 0) {
+    _tick = nowTick;
+    return 0;
+  }
+  if (ticks > TIMER_WHEEL_SLOTS) ticks = TIMER_WHEEL_SLOTS; // a late call visits every slot once
+
+  // unlink the due timers first, fire() may schedule the next ones
+  struct { uint32_t due; uint8_t tag; } due[TIMER_WHEEL_TIMERS];
+  uint8_t count = 0;
+  for (int32_t i = 1; i <= ticks; i++) {
+    uint8_t* link = &_slots[(_tick + i) & (TIMER_WHEEL_SLOTS - 1)];
+    while (*link != TIMER_WHEEL_END) {
+      uint8_t t = *link;
+      if ((int32_t)(_timers[t].due - nowTick) > 0) { // a later turn
+        link = &_timers[t].next;
+        continue;
+      }
+      due[count].due = _timers[t].due;
+      due[count].tag = _timers[t].tag;
+      count++;
+      *link = _timers[t].next;
+      _timers[t].next = _free;
+      _free = t;
+      _used--;
+    }
+  }
+  _tick = nowTick;
+  for (uint8_t i = 0; i < count; i++) fire(context, due[i].tag, due[i].due);
+  return count;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hashed timer wheel with a fixed pool of timers, advanced tick by tick.
+ *
+ * @details A timer is due at an absolute tick and hangs in the slot (tick % TIMER_WHEEL_SLOTS)
+ * of the wheel. advance() visits the slots of the ticks since the last call and fires the
+ * timers that are due, a timer further away than one turn stays in its slot until its turn
+ * comes. Scheduling and firing are O(1) per timer, no allocation, no blocking. On the device
+ * a periodic esp_timer wakes the input task every tick while timers are pending, the task
+ * advances the wheel between two button scans.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+#define TIMER_WHEEL_SLOTS 64 // ticks per turn, a power of two
+#define TIMER_WHEEL_TIMERS 16
+#define TIMER_WHEEL_END 0xFF
+
+class TimerWheel {
+public:
+  // called for every due timer, dueTick is the tick it was scheduled for
+  typedef void (*FireFunction)(void* context, uint8_t tag, uint32_t dueTick);
+
+  TimerWheel();
+
+  // forget all timers, the wheel continues at nowTick
+  void reset(uint32_t nowTick);
+
+  // false if all timers are in use, a due tick in the past fires on the next advance()
+  bool schedule(uint32_t dueTick, uint8_t tag);
+  // remove the timers with the tag, returns how many
+  uint8_t cancel(uint8_t tag);
+
+  // fire the timers due up to nowTick in the order of their ticks, returns how many fired.
+  // A timer scheduled by fire() for nowTick or before fires on the next call.
+  uint8_t advance(uint32_t nowTick, FireFunction fire, void* context);
+
+  bool idle() const { return _used == 0; }
+  uint8_t used() const { return _used; }
+  uint32_t tick() const { return _tick; }
+
+private:
+  struct myTimer {
+    uint32_t due;
+    uint8_t tag;
+    uint8_t next; // next timer in the slot or the free list
+  };
+
+  myTimer _timers[TIMER_WHEEL_TIMERS];
+  uint8_t _slots[TIMER_WHEEL_SLOTS]; // first timer of each slot
+  uint8_t _free;
+  uint8_t _used;
+  uint32_t _tick; // the last advanced tick
+};
+
+#endif // TIMER_WHEEL_H
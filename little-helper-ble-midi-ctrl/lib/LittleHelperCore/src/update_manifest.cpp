@@ -0,0 +1,116 @@
+/**
+ * @file update_manifest.cpp
+ * @brief The update manifest next to the firmware images and its streaming parser.
+ */
+
+#include "update_manifest.h"
+#include <string.h>
+
+const myManifestDelta* manifestDeltaFrom(const myUpdateManifest& manifest, uint32_t fromVersion) {
+  for (uint8_t i = 0; i < manifest.deltas; i++) {
+    if (manifest.delta[i].fromVersion == fromVersion) return &manifest.delta[i];
+  }
+  return nullptr;
+}
+
+void UpdateManifestParser::begin() {
+  memset(&_manifest, 0, sizeof(_manifest));
+  _result = MANIFEST_OK;
+  _lineLen = 0;
+  _hasVersion = false;
+  _hasSize = false;
+  _bytes = 0;
+}
+
+static const char* skipSpace(const char* p) {
+  while (*p == ' ' || *p == '\t') p++;
+  return p;
+}
+
+static bool parseNumber(const char*& p, uint32_t& value) {
+  p = skipSpace(p);
+  if (*p < '0' || *p > '9') return false;
+  uint64_t v = 0;
+  while (*p >= '0' && *p <= '9') {
+    v = v * 10 + (*p++ - '0');
+    if (v > 0xFFFFFFFFull) return false;
+  }
+  value = (uint32_t)v;
+  return true;
+}
+
+// the key is the first word, *value the rest
+static bool isKey(const char* line, const char* key, const char** value) {
+  size_t len = strlen(key);
+  if (strncmp(line, key, len) != 0 || (line[len] != ' ' && line[len] != '\t')) return false;
+  *value = line + len;
+  return true;
+}
+
+bool UpdateManifestParser::parseLine() {
+  _line[_lineLen] = 0;
+  _lineLen = 0;
+  // trailing blanks and \r of a file edited on Windows
+  size_t end = strlen(_line);
+  while (end && (_line[end - 1] == ' ' || _line[end - 1] == '\t' || _line[end - 1] == '\r')) _line[--end] = 0;
+  const char* line = skipSpace(_line);
+  if (*line == 0 || *line == '#') return true;
+
+  const char* value;
+  if (isKey(line, "version", &value)) {
+    if (!parseNumber(value, _manifest.version) || *skipSpace(value)) return false;
+    _hasVersion = true;
+  } else if (isKey(line, "size", &value)) {
+    if (!parseNumber(value, _manifest.size) || *skipSpace(value) || _manifest.size == 0) return false;
+    _hasSize = true;
+  } else if (isKey(line, "sha256", &value)) {
+    value = skipSpace(value);
+    if (strlen(value) != 2 * SHA256_SIZE || !sha256FromHex(value, _manifest.hash)) return false;
+    _manifest.hasHash = true;
+  } else if (isKey(line, "delta", &value)) {
+    myManifestDelta delta;
+    if (!parseNumber(value, delta.fromVersion) || !parseNumber(value, delta.size) || *skipSpace(value)) return false;
+    if (_manifest.deltas < MANIFEST_MAX_DELTAS) _manifest.delta[_manifest.deltas++] = delta;
+  }
+  return true;
+}
+
+bool UpdateManifestParser::feed(const uint8_t* data, size_t len) {
+  if (_result != MANIFEST_OK) return false;
+  _bytes += len;
+  if (_bytes > MANIFEST_MAX_SIZE) {
+    _result = MANIFEST_TOO_LARGE;
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+    if (c == '\n') {
+      if (!parseLine()) {
+        _result = MANIFEST_BAD_LINE;
+        return false;
+      }
+    } else if ((c < ' ' && c != '\t' && c != '\r') || c == 0x7F || _lineLen >= MANIFEST_MAX_LINE - 1) {
+      _result = MANIFEST_BAD_LINE;
+      return false;
+    } else {
+      _line[_lineLen++] = c;
+    }
+  }
+  return true;
+}
+
+my_manifest_result UpdateManifestParser::finish() {
+  if (_result == MANIFEST_OK && _lineLen && !parseLine()) _result = MANIFEST_BAD_LINE; // no newline at the end
+  if (_result == MANIFEST_OK && !(_hasVersion && _hasSize)) _result = MANIFEST_INCOMPLETE;
+  return _result;
+}
+
+const char* manifestResultName(my_manifest_result result) {
+  switch (result) {
+    case MANIFEST_OK: return "ok";
+    case MANIFEST_INCOMPLETE: return "incomplete";
+    case MANIFEST_BAD_LINE: return "bad line";
+    case MANIFEST_TOO_LARGE: return "too large";
+    default: return "?";
+  }
+}
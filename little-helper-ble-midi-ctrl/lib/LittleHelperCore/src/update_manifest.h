@@ -0,0 +1,80 @@
+/**
+ * @file update_manifest.h
+ * @brief The update manifest next to the firmware images and its streaming parser.
+ *
+ * @details One small text file tells the device which version is the latest, so a check
+ * without an update costs one GET and nothing else. One field per line, '#' starts a
+ * comment, unknown keys are skipped so later firmware can add fields:
+ *
+ *   version 8                 latest firmware, s3miniV8.bin
+ *   size 1270416              bytes of the image
+ *   sha256 <64 hex digits>    of the image, optional
+ *   delta 7 99619             s3miniV7-V8.patch exists, 99619 bytes, one line per source
+ *
+ * A device on any older version goes straight to the latest one, with the patch from its
+ * own version if one is listed. The parser takes the body in pieces of any size as it
+ * comes from the network and never allocates.
+ */
+
+#ifndef UPDATE_MANIFEST_H
+#define UPDATE_MANIFEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha256.h"
+
+#define MANIFEST_MAX_DELTAS 8
+#define MANIFEST_MAX_LINE 96
+#define MANIFEST_MAX_SIZE 2048 // anything larger is not a manifest (an HTML error page ...)
+
+struct myManifestDelta {
+  uint32_t fromVersion;
+  uint32_t size; // of the patch
+};
+
+struct myUpdateManifest {
+  uint32_t version;
+  uint32_t size;
+  bool hasHash;
+  uint8_t hash[SHA256_SIZE];
+  uint8_t deltas;
+  myManifestDelta delta[MANIFEST_MAX_DELTAS];
+};
+
+enum my_manifest_result {
+  MANIFEST_OK = 0,
+  MANIFEST_INCOMPLETE,   // version or size missing
+  MANIFEST_BAD_LINE,     // a known key with a broken value, or no text
+  MANIFEST_TOO_LARGE,
+};
+
+// the patch from fromVersion to the latest version, nullptr if none is listed
+const myManifestDelta* manifestDeltaFrom(const myUpdateManifest& manifest, uint32_t fromVersion);
+
+class UpdateManifestParser {
+public:
+  UpdateManifestParser() { begin(); }
+
+  void begin();
+  // the next piece of the body, false once the manifest is broken
+  bool feed(const uint8_t* data, size_t len);
+  // end of the body, the manifest is only valid with MANIFEST_OK
+  my_manifest_result finish();
+
+  const myUpdateManifest& manifest() const { return _manifest; }
+
+private:
+  bool parseLine();
+
+  myUpdateManifest _manifest;
+  my_manifest_result _result;
+  char _line[MANIFEST_MAX_LINE];
+  uint8_t _lineLen;
+  bool _hasVersion;
+  bool _hasSize;
+  uint32_t _bytes;
+};
+
+const char* manifestResultName(my_manifest_result result);
+
+#endif // UPDATE_MANIFEST_H
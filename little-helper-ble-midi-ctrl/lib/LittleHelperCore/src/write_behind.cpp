@@ -0,0 +1,31 @@
+/**
+ * @file write_behind.cpp
+ * @brief Dirty tracking and write coalescing for settings stored in NVS.
+ */
+
+#include "write_behind.h"
+
+WriteBehind::WriteBehind(uint32_t quietMs, uint32_t maxDelayMs)
+  : _quietMs(quietMs), _maxDelayMs(maxDelayMs), _dirty(0), _lastChangeMs(0), _firstChangeMs(0),
+    _changes(0), _writes(0), _bytes(0), _skipped(0) {
+}
+
+void WriteBehind::markDirty(uint8_t record, uint32_t nowMs) {
+  if (record >= 32) return;
+  _lastChangeMs.store(nowMs, std::memory_order_relaxed);
+  uint32_t before = _dirty.fetch_or(1u << record, std::memory_order_acq_rel);
+  if (before == 0) _firstChangeMs.store(nowMs, std::memory_order_relaxed);
+  _changes.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t WriteBehind::due(uint32_t nowMs) {
+  if (_dirty.load(std::memory_order_acquire) == 0) return 0;
+  bool quiet = nowMs - _lastChangeMs.load(std::memory_order_relaxed) >= _quietMs;
+  bool overdue = nowMs - _firstChangeMs.load(std::memory_order_relaxed) >= _maxDelayMs;
+  if (!quiet && !overdue) return 0;
+  return takeAll();
+}
+
+uint32_t WriteBehind::takeAll() {
+  return _dirty.exchange(0, std::memory_order_acq_rel);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file write_behind.h
+ * @brief Dirty tracking and write coalescing for settings stored in NVS.
+ *
+ * @details The web UI marks a record (a map) dirty on every change, the writer task asks
+ * which records are due. A record is due once no change came in for the quiet time, or
+ * at the latest after the max delay, so dragging a slider ends in one write and a long
+ * drag still gets saved. markDirty() is safe from any task, due() and takeAll() belong to
+ * the one task that writes. The writer reports what it wrote for the metrics.
+ */
+
+#ifndef WRITE_BEHIND_H
+#define WRITE_BEHIND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define WRITE_BEHIND_QUIET_MS 1500
+#define WRITE_BEHIND_MAX_DELAY_MS 10000
+
+class WriteBehind {
+public:
+  WriteBehind(uint32_t quietMs = WRITE_BEHIND_QUIET_MS, uint32_t maxDelayMs = WRITE_BEHIND_MAX_DELAY_MS);
+
+  // any task, record 0..31
+  void markDirty(uint8_t record, uint32_t nowMs);
+
+  // writer task: mask of the records to write now, they are no longer dirty afterwards
+  uint32_t due(uint32_t nowMs);
+  // writer task: all dirty records regardless of time (reboot, OTA)
+  uint32_t takeAll();
+
+  bool dirty() const { return _dirty.load(std::memory_order_acquire) != 0; }
+
+  // ~ metrics, writer task ~
+  void written(size_t bytes) { _writes++; _bytes += bytes; }
+  void unchanged() { _skipped++; } // due, but the stored record was already equal
+  uint32_t writes() const { return _writes; }
+  uint32_t bytes() const { return _bytes; }
+  uint32_t skipped() const { return _skipped; }
+  uint32_t changes() const { return _changes.load(std::memory_order_relaxed); }
+
+private:
+  uint32_t _quietMs;
+  uint32_t _maxDelayMs;
+  std::atomic<uint32_t> _dirty;
+  std::atomic<uint32_t> _lastChangeMs;
+  std::atomic<uint32_t> _firstChangeMs;
+  std::atomic<uint32_t> _changes;
+  uint32_t _writes;
+  uint32_t _bytes;
+  uint32_t _skipped;
+};
+
+#endif // WRITE_BEHIND_H
@@ -0,0 +1,32 @@
+/**
+ * @file bench.h
+ * @brief Host (env:native) benchmarks of the hardware independent Little Helper code.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// heap allocations since program start, counted by the operator new in bench_main.cpp
+extern unsigned long __allocations;
+
+int benchEngine(long iterations);
+int benchBleMidi(long iterations);
+int benchTimestamps(long iterations);
+int benchLatency(long iterations);
+int benchPersist(long iterations);
+int benchConfig(long iterations);
+int benchMapCodec(long iterations);
+int benchOta(long iterations);
+int benchResume(long iterations);
+int benchDelta(long iterations);
+int benchManifest(long iterations);
+int benchWebUi(long iterations);
+int benchFields(long iterations);
+int benchRecords(long iterations);
+int benchBanks(long iterations);
+int benchPresets(long iterations);
+int benchMacros(long iterations);
+int benchMidiIn(long iterations);
+int benchFeedback(long iterations);
+
+#endif // BENCH_H
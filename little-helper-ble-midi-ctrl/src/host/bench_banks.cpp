@@ -0,0 +1,303 @@
+/**
+ * @file bench_banks.cpp
+ * @brief Host (env:native) map banks in flash and the RAM cache of hot maps: persistence, power loss, switch time.
+ *
+ * @details The flash is MapBankRamFlash with a cost model of the ESP32-S3 flash (read
+ * overhead and rate, page program, sector erase) and a power loss after a given number of
+ * program or erase operations. A set list is replayed as Program Changes: song after song,
+ * the long press partner of a song, a step back now and then and a jump to any song. A
+ * switch is what activateMap() does, cache lookup, a slot read on a miss, decode and
+ * compile. Its time is the host CPU time plus the modeled flash time, the budget is one
+ * BLE connection interval.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "bench.h"
+#include "map_bank_store.h"
+#include "map_bank_cache.h"
+#include "midi_action_table.h"
+#include "ble_midi_packet.h"
+#include "latency_stats.h"
+
+#define BANKS_BUTTONS 5
+#define BANKS_READ_OP_US 20.0     // esp_partition_read() call
+#define BANKS_READ_BYTE_US 0.05   // 20 MB/s
+#define BANKS_PROGRAM_US 700.0    // per started 256 byte page
+#define BANKS_ERASE_US 45000.0    // 4 KB sector
+
+// RAM flash that adds up the flash time and loses power after failAfter program or erase operations
+class CostFlash : public MapBankRamFlash {
+public:
+  CostFlash(uint8_t* mem, uint32_t size) : MapBankRamFlash(mem, size) {}
+
+  bool read(uint32_t offset, void* buf, size_t len) override {
+    us += BANKS_READ_OP_US + len * BANKS_READ_BYTE_US;
+    return MapBankRamFlash::read(offset, buf, len);
+  }
+  bool write(uint32_t offset, const void* buf, size_t len) override {
+    if (!operation()) return false;
+    us += ((offset % 256 + len + 255) / 256) * BANKS_PROGRAM_US;
+    return MapBankRamFlash::write(offset, buf, len);
+  }
+  bool eraseSector(uint32_t offset) override {
+    if (!operation()) return false;
+    us += BANKS_ERASE_US;
+    return MapBankRamFlash::eraseSector(offset);
+  }
+
+  double us = 0;
+  long failAfter = -1; // -1 = never
+  long operations = 0;
+
+private:
+  bool operation() {
+    if (failAfter >= 0 && operations >= failAfter) return false;
+    operations++;
+    return true;
+  }
+};
+
+static void setupMap(myMapButton* buttons, uint8_t map, uint8_t variant) {
+  memset(buttons, 0, sizeof(myMapButton) * BANKS_BUTTONS);
+  for (int b = 0; b < BANKS_BUTTONS; b++) {
+    uint8_t v = map * 5 + b + variant * 31;
+    buttons[b].btnMidiFunction = v % 4;
+    buttons[b].btnFunction = (v >> 2) & 1;
+    buttons[b].btnMidiChannel = v % 16;
+    buttons[b].btnMidiNote = v & 0x7F;
+    buttons[b].btnMidiVelocity = 100;
+    buttons[b].btnMidiCC = (v + 3) & 0x7F;
+    buttons[b].btnMidiCCValueStateOn = 127;
+    buttons[b].btnMidiMMC = MMC_PLAY;
+    buttons[b].btnColor = v % BUTTON_PALETTE_SIZE;
+  }
+}
+
+static void defaultMap(uint8_t map, myMapButton* buttons, uint8_t numButtons) {
+  setupMap(buttons, map, 0xFF);
+}
+
+static size_t storeMap(MapBankStore& store, uint8_t map, uint8_t variant) {
+  myMapButton buttons[BANKS_BUTTONS];
+  setupMap(buttons, map, variant);
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  size_t len = encodeMap(buttons, BANKS_BUTTONS, map, record, sizeof(record));
+  return store.write(map, record, len) ? len : 0;
+}
+
+// variant of the map in the store, -1 for an empty slot or a broken record
+static int storedVariant(MapBankStore& store, uint8_t map, int variants) {
+  uint8_t record[MAP_BANK_SLOT_SIZE];
+  size_t len = store.read(map, record, sizeof(record));
+  if (len == 0) return -1;
+  myMapButton loaded[BANKS_BUTTONS], expected[BANKS_BUTTONS];
+  memset(loaded, 0, sizeof(loaded)); // padding bits, decodeMap() sets the fields only
+  if (decodeMap(record, len, map, loaded, BANKS_BUTTONS) != MAP_CODEC_OK) return -1;
+  for (int v = 0; v < variants; v++) {
+    setupMap(expected, map, v);
+    if (memcmp(loaded, expected, sizeof(loaded)) == 0) return v;
+  }
+  return -1;
+}
+
+// the program changes of a set list, every song once in order with detours
+static std::vector<uint8_t> setList(long length) {
+  std::vector<uint8_t> changes;
+  uint32_t seed = 0x2468ACE;
+  uint8_t song = 0;
+  while ((long)changes.size() < length) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    uint8_t roll = seed % 100;
+    if (roll < 60) song = (song + 1) % NUBER_OF_MAPS;      // next song
+    else if (roll < 80) song ^= 1;                          // long press partner
+    else if (roll < 92) song = song ? song - 1 : 0;         // once more the one before
+    else song = (seed >> 8) % NUBER_OF_MAPS;                // any song
+    changes.push_back(song);
+  }
+  return changes;
+}
+
+struct walkResult {
+  LatencyHistogram hitUs;
+  LatencyHistogram missUs;
+  uint32_t hits = 0, misses = 0, prefetchHits = 0, overBudget = 0;
+  double maxUs = 0;
+  double prefetchFlashUs = 0; // loop(), not part of a switch
+};
+
+// activateMap() for every change, the prefetch of loop() between two changes
+static void walk(MapBankStore& store, const std::vector<uint8_t>& changes, bool prefetch, CostFlash& flash, walkResult& r) {
+  MapBankCache cache(store, defaultMap, BANKS_BUTTONS);
+  MidiActionTable actions;
+  r = walkResult();
+  for (uint8_t map : changes) {
+    double flashBefore = flash.us;
+    bool cached = cache.find(map) != nullptr;
+    auto start = std::chrono::steady_clock::now();
+    myCachedMap* entry = cache.get(map);
+    cache.pin(map);
+    actions.compile(entry->buttons, entry->states, BANKS_BUTTONS, map);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+      + flash.us - flashBefore;
+    (cached ? r.hitUs : r.missUs).add((uint32_t)(us + 0.5));
+    if (us > BLE_MIDI_DEFAULT_INTERVAL_US) r.overBudget++;
+    if (us > r.maxUs) r.maxUs = us;
+    if (prefetch) {
+      flashBefore = flash.us;
+      if (map + 1 < NUBER_OF_MAPS) cache.prefetch(map + 1);
+      if (map > 0) cache.prefetch(map - 1);
+      r.prefetchFlashUs += flash.us - flashBefore;
+    }
+  }
+  r.hits = cache.hits();
+  r.misses = cache.misses();
+  r.prefetchHits = cache.prefetchHits();
+}
+
+int benchBanks(long iterations) {
+
+  static uint8_t mem[MAP_BANK_PARTITION_SIZE];
+  memset(mem, 0xFF, sizeof(mem));
+  CostFlash flash(mem, sizeof(mem));
+  MapBankStore store;
+  bool ok = true;
+
+  // ~ store ~
+  uint16_t slots = store.mount(&flash);
+  bool mounted = slots >= NUBER_OF_MAPS && store.empty();
+  bool written = true;
+  for (int map = 0; map < NUBER_OF_MAPS; map++) written = storeMap(store, map, 0) && written;
+  uint32_t fillErases = store.erases();
+  uint32_t unchangedBefore = store.unchanged(), erasesBefore = store.erases();
+  for (int map = 0; map < NUBER_OF_MAPS; map++) storeMap(store, map, 0);
+  bool equalSkipped = store.unchanged() - unchangedBefore == NUBER_OF_MAPS && store.erases() == erasesBefore;
+
+  flash.us = 0;
+  erasesBefore = store.erases();
+  storeMap(store, 77, 1);
+  uint32_t changeErases = store.erases() - erasesBefore;
+  double changeUs = flash.us;
+
+  MapBankStore again;
+  again.mount(&flash);
+  bool persisted = !again.empty();
+  for (int map = 0; map < NUBER_OF_MAPS; map++) persisted = persisted && storedVariant(again, map, 2) == (map == 77 ? 1 : 0);
+  printf("%u slots in %u KB for %d maps, fill: %u erases, equal rewrite: %s, change: %u erase %.1f ms, after mount: %s\n",
+    slots, (unsigned)(sizeof(mem) / 1024), NUBER_OF_MAPS, fillErases, equalSkipped ? "not written" : "WRITTEN",
+    changeErases, changeUs / 1000, persisted ? "ok" : "FAIL");
+  ok = ok && mounted && written && equalSkipped && changeErases == 1 && persisted;
+
+  // ~ power loss at every operation of a change ~
+  static uint8_t image[MAP_BANK_PARTITION_SIZE];
+  memcpy(image, mem, sizeof(mem));
+  flash.operations = 0;
+  storeMap(again, 3, 1);
+  long changeOperations = flash.operations;
+  int oldKept = 0, newKept = 0, broken = 0;
+  for (long k = 0; k <= changeOperations; k++) {
+    memcpy(mem, image, sizeof(mem));
+    MapBankStore victim;
+    victim.mount(&flash);
+    flash.operations = 0;
+    flash.failAfter = k;
+    storeMap(victim, 3, 1);
+    flash.failAfter = -1;
+    MapBankStore rebooted;
+    rebooted.mount(&flash);
+    int v = storedVariant(rebooted, 3, 2);
+    bool others = true;
+    for (int map = 0; map < NUBER_OF_MAPS; map++) {
+      if (map != 3) others = others && storedVariant(rebooted, map, 2) == (map == 77 ? 1 : 0);
+    }
+    if (v == 0 && others) oldKept++;
+    else if (v == 1 && others) newKept++;
+    else broken++;
+  }
+  printf("power loss at each of %ld operations: %d old, %d new, %d broken\n", changeOperations + 1, oldKept, newKept, broken);
+  ok = ok && broken == 0 && newKept >= 1;
+
+  memcpy(mem, image, sizeof(mem));
+  store.mount(&flash);
+  MapBankStore formatted;
+  formatted.mount(&flash);
+  bool cleared = formatted.format() && formatted.empty() && storedVariant(formatted, 0, 2) == -1;
+  MapBankCache emptyCache(formatted, defaultMap, BANKS_BUTTONS);
+  myMapButton defaults[BANKS_BUTTONS];
+  defaultMap(5, defaults, BANKS_BUTTONS);
+  bool defaulted = memcmp(emptyCache.get(5)->buttons, defaults, sizeof(defaults)) == 0;
+  memcpy(mem, image, sizeof(mem));
+  store.mount(&flash);
+
+  // ~ cache ~
+  // an edited map is written when it is evicted, the pinned map never is
+  MapBankCache cache(store, defaultMap, BANKS_BUTTONS);
+  myCachedMap* edited = cache.get(10);
+  edited->buttons[0].btnMidiNote = 1;
+  edited->dirty = true;
+  cache.pin(10);
+  for (int map = 20; map < 20 + 2 * MAP_CACHE_SLOTS; map++) cache.get(map);
+  bool pinned = cache.find(10) == edited && edited->dirty;
+  // clean maps go first, get() never writes: with every slot dirty it finds no slot
+  cache.pin(MAP_CACHE_FREE);
+  for (int map = 40; map < 40 + MAP_CACHE_SLOTS - 1; map++) cache.get(map)->dirty = true;
+  uint32_t writes = store.writes() + store.unchanged();
+  bool noWriteOnMiss = cache.find(10) == edited && cache.get(50) == nullptr && store.writes() + store.unchanged() == writes;
+  // the writer copies the record, the slot stays while the store writes it, a change meanwhile
+  // keeps it dirty, a failed write makes it dirty again
+  uint8_t slot = cache.slotOf(edited), map = MAP_CACHE_FREE;
+  uint8_t record[MAP_BANK_SLOT_SIZE];
+  size_t len = cache.beginWrite(slot, map, record, sizeof(record));
+  bool copied = len && map == 10 && !edited->dirty && cache.get(50) == nullptr && cache.beginWrite(slot, map, record, sizeof(record)) == 0;
+  edited->dirty = true;
+  copied = copied && store.write(map, record, len);
+  cache.endWrite(slot, true);
+  copied = copied && edited->dirty;
+  uint8_t other = cache.slotOf(cache.find(40));
+  copied = copied && cache.beginWrite(other, map, record, sizeof(record)) && !cache.slot(other).dirty;
+  cache.endWrite(other, false);
+  copied = copied && cache.slot(other).dirty;
+  // written, the slot is clean and the next miss evicts it
+  myMapButton loaded[BANKS_BUTTONS];
+  bool evicted = cache.flush(slot) && cache.get(50) != nullptr && cache.find(10) == nullptr;
+  len = store.read(10, record, sizeof(record));
+  evicted = evicted && len && decodeMap(record, len, 10, loaded, BANKS_BUTTONS) == MAP_CODEC_OK && loaded[0].btnMidiNote == 1;
+  storeMap(store, 10, 0);
+  printf("format: %s, empty slot reads the defaults: %s, pinned map kept: %s\n", cleared ? "ok" : "FAIL",
+    defaulted ? "yes" : "no", pinned ? "yes" : "no");
+  printf("dirty map not written on a miss: %s, record copied for the writer: %s, written map evicted: %s\n",
+    noWriteOnMiss ? "yes" : "no", copied ? "yes" : "no", evicted ? "yes" : "no");
+  ok = ok && cleared && defaulted && pinned && noWriteOnMiss && copied && evicted;
+
+  // ~ set list ~
+  std::vector<uint8_t> changes = setList(iterations);
+  walkResult plain, ahead;
+  flash.us = 0;
+  walk(store, changes, false, flash, plain);
+  flash.us = 0;
+  walk(store, changes, true, flash, ahead);
+
+  printf("%ld program changes over %d maps, %d cache slots, budget %u us (BLE connection interval)\n", iterations,
+    NUBER_OF_MAPS, MAP_CACHE_SLOTS, BLE_MIDI_DEFAULT_INTERVAL_US);
+  printf("%-12s %8s %8s %10s %10s %10s %10s %8s\n", "", "hits", "misses", "prefetched", "hit p99", "miss p99", "max us", "over");
+  const walkResult* results[] = { &plain, &ahead };
+  const char* names[] = { "LRU", "LRU+prefetch" };
+  for (int i = 0; i < 2; i++) {
+    const walkResult& r = *results[i];
+    printf("%-12s %7.1f%% %7.1f%% %10u %8uus %8uus %10.1f %8u\n", names[i], 100.0 * r.hits / (r.hits + r.misses),
+      100.0 * r.misses / (r.hits + r.misses), r.prefetchHits, r.hitUs.percentile(99), r.missUs.percentile(99), r.maxUs,
+      r.overBudget);
+  }
+  printf("prefetch in loop(): %.1f ms flash reads over the set list, no flash write or erase while switching\n",
+    ahead.prefetchFlashUs / 1000);
+
+  // RAM: every map decoded vs. the cache
+  size_t allMaps = (sizeof(myMapButton) + 1) * BANKS_BUTTONS * NUBER_OF_MAPS;
+  printf("RAM: %u bytes for all maps in RAM, %u bytes cache\n", (unsigned)allMaps, (unsigned)sizeof(MapBankCache));
+  ok = ok && ahead.hits > plain.hits && ahead.overBudget == 0 && plain.overBudget == 0 && sizeof(MapBankCache) < allMaps;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
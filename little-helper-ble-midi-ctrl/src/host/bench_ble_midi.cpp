@@ -0,0 +1,240 @@
+/**
+ * @file bench_ble_midi.cpp
+ * @brief Host (env:native) checks and throughput benchmark of the BLE-MIDI packet builder.
+ *
+ * @details The packets of hand made message sequences are compared byte by byte: running
+ * status, the timestamp bytes around the 7 bit and the 13 bit wrap, a SysEx split into
+ * continuation packets and the MTU limit. Then one packet per message (one BLEMidiServer
+ * call per message as before) is compared with batching all messages of a loop pass into
+ * one packet, for the default and an extended MTU. Reports encoded messages per second,
+ * payload bytes per message and BLE notifications (packets) per message.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "bench.h"
+#include "ble_midi_packet.h"
+
+class CountingPacketSink : public BleMidiPacketSink {
+public:
+  unsigned long packets = 0;
+  unsigned long bytes = 0;
+  void sendPacket(const uint8_t*, uint8_t len) override { packets++; bytes += len; }
+};
+
+// keeps every packet for the byte checks
+class RecordingPacketSink : public BleMidiPacketSink {
+public:
+  std::vector<std::vector<uint8_t>> packets;
+  void sendPacket(const uint8_t* packet, uint8_t len) override { packets.emplace_back(packet, packet + len); }
+  bool sent(std::initializer_list<std::initializer_list<uint8_t>> expected) const {
+    if (packets.size() != expected.size()) return false;
+    size_t i = 0;
+    for (const std::initializer_list<uint8_t>& packet : expected) {
+      if (packets[i++] != std::vector<uint8_t>(packet)) return false;
+    }
+    return true;
+  }
+};
+
+static bool check(const char* name, bool ok) {
+  printf("%-44s %s\n", name, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static const uint8_t CC43[] = { 0xB0, 43, 127 }, CC44[] = { 0xB0, 44, 127 }, NOTE60[] = { 0x90, 60, 100 };
+
+static bool checkPackets() {
+  bool ok = true;
+  {
+    // time 0x105: header bits 12..7 = 2, timestamp byte bits 6..0 = 5
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 0x105);
+    builder.add(CC44, 3, 0x105);
+    builder.add(NOTE60, 3, 0x106);
+    builder.flush();
+    ok &= check("running status, new status in full", sink.sent({ { 0x82, 0x85, 0xB0, 43, 127, 0x85, 44, 127,
+      0x86, 0x90, 60, 100 } }));
+  }
+  {
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 0);
+    builder.flush();
+    builder.add(CC44, 3, 0);
+    builder.flush();
+    ok &= check("no running status into the next packet", sink.sent({ { 0x80, 0x80, 0xB0, 43, 127 },
+      { 0x80, 0x80, 0xB0, 44, 127 } }));
+  }
+  {
+    // the low 7 bits wrap inside the packet, the receiver adds one to the header bits
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 0x7F);
+    builder.add(CC44, 3, 0x80);
+    builder.flush();
+    ok &= check("timestamp 7 bit wrap in one packet", sink.sent({ { 0x80, 0xFF, 0xB0, 43, 127, 0x80, 44, 127 } }));
+  }
+  {
+    // 8191 ms -> 8192 ms is 0x1FFF -> 0, only the lower 13 bits of the time are sent
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 0x1FFF);
+    builder.add(CC44, 3, 0x2000);
+    builder.flush();
+    builder.add(NOTE60, 3, 0x2005 + 0x2000);
+    builder.flush();
+    ok &= check("timestamp 13 bit wrap", sink.sent({ { 0xBF, 0xFF, 0xB0, 43, 127, 0x80, 44, 127 },
+      { 0x80, 0x85, 0x90, 60, 100 } }));
+  }
+  {
+    // an earlier edge handled after a later one keeps its time in a packet of its own
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 10);
+    builder.add(CC44, 3, 5);
+    builder.flush();
+    ok &= check("earlier timestamp starts a new packet", sink.sent({ { 0x80, 0x8A, 0xB0, 43, 127 },
+      { 0x80, 0x85, 0xB0, 44, 127 } }));
+  }
+  {
+    // MMC play in one packet: ts F0 .. ts F7
+    static const uint8_t mmc[] = { 0xF0, 0x7F, 0x7F, 0x06, 0x02, 0xF7 };
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(CC43, 3, 3);
+    builder.add(mmc, sizeof(mmc), 3);
+    builder.add(CC44, 3, 3);
+    builder.flush();
+    ok &= check("SysEx between CCs, running status ends", sink.sent({ { 0x80, 0x83, 0xB0, 43, 127, 0x83, 0xF0, 0x7F,
+      0x7F, 0x06, 0x02, 0x83, 0xF7, 0x83, 0xB0, 44, 127 } }));
+  }
+  {
+    // 30 bytes at MTU 23 (20 byte packets): ts F0 and 17 data bytes, the header, 11 data bytes, ts F7
+    uint8_t sysEx[30];
+    sysEx[0] = 0xF0;
+    for (uint8_t i = 1; i < 29; i++) sysEx[i] = i;
+    sysEx[29] = 0xF7;
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    builder.add(sysEx, sizeof(sysEx), 0x81);
+    builder.flush();
+    ok &= check("SysEx split into a continuation packet", sink.sent({
+      { 0x81, 0x81, 0xF0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17 },
+      { 0x81, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 0x81, 0xF7 } }));
+  }
+  {
+    // 5 notes on 5 channels, 4 bytes each: 4 fit into 20 bytes at MTU 23, all 5 at MTU 185
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    for (uint16_t mtu : { 23, 185 }) {
+      builder.setMtu(mtu);
+      for (uint8_t ch = 0; ch < 5; ch++) {
+        uint8_t note[] = { (uint8_t)(0x90 | ch), 60, 100 };
+        builder.add(note, 3, 0);
+      }
+      builder.flush();
+    }
+    ok &= check("MTU 23 and 185", sink.packets.size() == 3 && sink.packets[0].size() == 17
+      && sink.packets[1].size() == 5 && sink.packets[2].size() == 21);
+  }
+  {
+    // random messages at random MTUs: no packet longer than MTU - 3, BLE_MIDI_MAX_PACKET at most
+    RecordingPacketSink sink;
+    BleMidiPacketBuilder builder(sink);
+    uint32_t r = 1;
+    bool fits = true;
+    for (int i = 0; i < 20000; i++) {
+      r = r * 1103515245 + 12345;
+      if (i % 100 == 0) {
+        uint16_t mtu = 23 + (r >> 16) % 500;
+        builder.flush();
+        builder.setMtu(mtu);
+        sink.packets.clear();
+        uint16_t limit = mtu - 3 < BLE_MIDI_MAX_PACKET ? mtu - 3 : BLE_MIDI_MAX_PACKET;
+        if (builder.maxPacket() != limit) fits = false;
+      }
+      uint8_t msg[40] = { (uint8_t)(0x80 | ((r >> 8) & 0x3F)), (uint8_t)((r >> 16) & 0x7F), (uint8_t)((r >> 24) & 0x7F) };
+      size_t len = 3;
+      if ((r & 7) == 0) {
+        msg[0] = 0xF0;
+        len = 2 + (r >> 9) % 36;
+        for (size_t k = 1; k < len - 1; k++) msg[k] = (uint8_t)((r >> k) & 0x7F);
+        msg[len - 1] = 0xF7;
+      }
+      builder.add(msg, len, (uint16_t)(i / 3));
+      for (const std::vector<uint8_t>& packet : sink.packets) fits &= packet.size() <= builder.maxPacket();
+    }
+    ok &= check("random messages never exceed MTU - 3", fits);
+  }
+  return ok;
+}
+
+struct midiPass {
+  const char* name;
+  uint8_t messages;
+  uint8_t data[8][6];
+  uint8_t len[8];
+};
+
+static const midiPass __passes[] = {
+  { "single CC", 1, { { 0xB0, 43, 127 } }, { 3 } },
+  { "5 CC chord", 5, { { 0xB0, 41, 127 }, { 0xB0, 42, 127 }, { 0xB0, 43, 127 }, { 0xB0, 44, 127 }, { 0xB0, 45, 127 } }, { 3, 3, 3, 3, 3 } },
+  { "noteOff + CC", 2, { { 0x80, 60, 0 }, { 0xB0, 64, 127 } }, { 3, 3 } },
+  { "note + CC + MMC", 3, { { 0x90, 60, 100 }, { 0xB0, 43, 127 }, { 0xF0, 0x7F, 0x7F, 0x06, 0x02, 0xF7 } }, { 3, 3, 6 } },
+};
+
+static void runPass(const midiPass& pass, uint16_t mtu, bool batched, long iterations) {
+
+  CountingPacketSink sink;
+  BleMidiPacketBuilder builder(sink);
+  builder.setMtu(mtu);
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    uint16_t timestamp = (uint16_t)(i * 3);
+    for (uint8_t m = 0; m < pass.messages; m++) {
+      builder.add(pass.data[m], pass.len[m], timestamp);
+      if (!batched) builder.flush();
+    }
+    builder.flush(); // end of loop pass
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  double messages = double(iterations) * pass.messages;
+  double seconds = std::chrono::duration<double>(stop - start).count();
+  printf("%-16s %4u %-8s %14.0f %10.2f %12.3f\n", pass.name, mtu, batched ? "batched" : "single",
+    messages / seconds, double(sink.bytes) / messages, double(sink.packets) / messages);
+}
+
+int benchBleMidi(long iterations) {
+
+  bool ok = checkPackets();
+
+  printf("%-16s %4s %-8s %14s %10s %12s\n", "pass", "mtu", "mode", "messages/s", "bytes/msg", "packets/msg");
+  for (const midiPass& pass : __passes) {
+    runPass(pass, 23, false, iterations);
+    runPass(pass, 23, true, iterations);
+    runPass(pass, 247, true, iterations);
+  }
+
+  // a SysEx larger than the packet is split into continuation packets
+  static uint8_t sysex[64];
+  sysex[0] = 0xF0;
+  for (int i = 1; i < 63; i++) sysex[i] = i & 0x7F;
+  sysex[63] = 0xF7;
+  CountingPacketSink sink;
+  BleMidiPacketBuilder builder(sink);
+  unsigned long allocBefore = __allocations;
+  builder.add(sysex, sizeof(sysex), 0);
+  builder.flush();
+  unsigned long allocations = __allocations - allocBefore;
+  printf("64 byte SysEx at mtu 23: %lu packets, %lu bytes, %lu allocations\n", sink.packets, sink.bytes, allocations);
+  ok &= sink.packets == 4 && allocations == 0;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file bench_config.cpp
+ * @brief Host (env:native) round trip, stored layout, corruption check, version 1 migration and decode time of the device config record.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "bench.h"
+#include "crc32.h"
+#include "device_config.h"
+
+// a record as the firmware before the MMC device ID wrote it, byte by byte
+static size_t encodeV1(uint8_t* record) {
+  size_t crcAt = DEVICE_CONFIG_HEADER_SIZE + DEVICE_CONFIG_PAYLOAD_SIZE;
+  memset(record, 0, crcAt + DEVICE_CONFIG_CRC_SIZE);
+  record[0] = DEVICE_CONFIG_MAGIC & 0xFF;
+  record[1] = DEVICE_CONFIG_MAGIC >> 8;
+  record[2] = 1;
+  record[4] = DEVICE_CONFIG_PAYLOAD_SIZE & 0xFF;
+  record[5] = DEVICE_CONFIG_PAYLOAD_SIZE >> 8;
+  uint8_t* p = record + DEVICE_CONFIG_HEADER_SIZE;
+  memset(p + DEVICE_CONFIG_FIELD_UPDATE_ERROR, 0xFF, 4); // -1
+  p[DEVICE_CONFIG_FIELD_FW_VERSION] = 7;
+  p[DEVICE_CONFIG_FIELD_ACTIVE_MAP] = 3;
+  p[DEVICE_CONFIG_FIELD_BRIGHTNESS] = 40;
+  strcpy((char*)p + DEVICE_CONFIG_FIELD_BLE_NAME, "LITTLE_HELPER");
+  strcpy((char*)p + DEVICE_CONFIG_FIELD_HOSTNAME, "littlehelper");
+  p[DEVICE_CONFIG_FIELD_MMC_DEVICE_ID] = 0x55; // padding in version 1, never read
+  uint32_t crc = crc32(record, crcAt);
+  for (int i = 0; i < 4; i++) record[crcAt + i] = crc >> (8 * i);
+  return crcAt + DEVICE_CONFIG_CRC_SIZE;
+}
+
+int benchConfig(long iterations) {
+
+  DeviceConfig config;
+  config.setFwVersion(8);
+  config.setActiveMap(2);
+  config.setLedBrightness(85);
+  config.setBleName("LITTLE_HELPER");
+  config.setSsid("LocalWlan");
+  config.setPassword("localWlanPassword");
+  config.setApSsid("LittleHelperAP");
+  config.setApPassword("12345678");
+  config.setHostname("littlehelper");
+  config.setMmcDeviceId(0x10);
+  bool tooLong = !config.setApSsid("an_ssid_longer_than_16");
+
+  uint8_t record[DEVICE_CONFIG_RECORD_SIZE];
+  size_t len = config.encode(record);
+
+  DeviceConfig loaded;
+  bool ok = loaded.decode(record, len) && !loaded.dirty() && loaded.fwVersion() == 8 && loaded.activeMap() == 2
+    && strcmp(loaded.hostname(), "littlehelper") == 0 && strcmp(loaded.apSsid(), "LittleHelperAP") == 0
+    && loaded.updateErrorCode() == -1 && loaded.mmcDeviceId() == 0x10 && tooLong;
+
+  // the layout does not depend on the compiler: little endian numbers at the field offsets
+  const uint8_t* payload = record + DEVICE_CONFIG_HEADER_SIZE;
+  static const uint8_t fwVersion[4] = { 8, 0, 0, 0 };
+  static const uint8_t updateError[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+  bool layout = len == 270 && record[0] == (DEVICE_CONFIG_MAGIC & 0xFF) && record[1] == DEVICE_CONFIG_MAGIC >> 8
+    && record[2] == DEVICE_CONFIG_VERSION && record[4] == DEVICE_CONFIG_PAYLOAD_SIZE % 256 && record[5] == DEVICE_CONFIG_PAYLOAD_SIZE / 256
+    && memcmp(payload + DEVICE_CONFIG_FIELD_UPDATE_ERROR, updateError, 4) == 0
+    && memcmp(payload + DEVICE_CONFIG_FIELD_FW_VERSION, fwVersion, 4) == 0
+    && payload[DEVICE_CONFIG_FIELD_ACTIVE_MAP] == 2 && payload[DEVICE_CONFIG_FIELD_BRIGHTNESS] == 85
+    && strcmp((const char*)payload + DEVICE_CONFIG_FIELD_AP_SSID, "LittleHelperAP") == 0
+    && payload[DEVICE_CONFIG_FIELD_MMC_DEVICE_ID] == 0x10 && payload[DEVICE_CONFIG_FIELD_MMC_DEVICE_ID + 1] == 0
+    && crc32(record, len - DEVICE_CONFIG_CRC_SIZE) == (uint32_t)(record[len - 4] | record[len - 3] << 8 | record[len - 2] << 16 | (uint32_t)record[len - 1] << 24);
+  ok = ok && layout;
+
+  // version 1 is migrated, the MMC device ID is the all call it sent with
+  uint8_t v1Record[DEVICE_CONFIG_RECORD_SIZE];
+  size_t v1Len = encodeV1(v1Record);
+  DeviceConfig migrated;
+  migrated.setMmcDeviceId(0x20);
+  bool migration = migrated.decode(v1Record, v1Len) && migrated.fwVersion() == 7 && migrated.activeMap() == 3
+    && migrated.ledBrightness() == 40 && strcmp(migrated.bleName(), "LITTLE_HELPER") == 0
+    && strcmp(migrated.hostname(), "littlehelper") == 0 && migrated.mmcDeviceId() == DEVICE_CONFIG_MMC_ALL_CALL;
+  ok = ok && migration;
+
+  // every single bit flip must be rejected
+  unsigned long accepted = 0;
+  for (size_t i = 0; i < len * 8; i++) {
+    record[i / 8] ^= 1 << (i % 8);
+    DeviceConfig broken;
+    if (broken.decode(record, len)) accepted++;
+    record[i / 8] ^= 1 << (i % 8);
+  }
+  DeviceConfig shortRecord;
+  bool truncated = !shortRecord.decode(record, len - 1);
+
+  unsigned long allocBefore = __allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    record[20] = (uint8_t)i; // keep the compiler from hoisting the decode
+    loaded.decode(record, len);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+
+  printf("record %u bytes, decode %.0f ns, %lu allocations, little endian layout: %s\n", (unsigned)len, ns,
+    __allocations - allocBefore, layout ? "yes" : "no");
+  printf("bit flips accepted: %lu of %u, truncated record rejected: %s\n", accepted, (unsigned)len * 8, truncated ? "yes" : "no");
+  printf("version 1 record (%u bytes) migrated: %s\n", (unsigned)v1Len, migration ? "yes" : "no");
+  ok = ok && accepted == 0 && truncated;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file bench_delta.cpp
+ * @brief Host (env:native) delta patches between the released images in bin/ vs. the full image.
+ *
+ * @details Every s3miniV<N>-V<N+1>.patch made by tools/mkdelta.py is applied to
+ * s3miniV<N>.bin through DeltaPatcher in TCP segment sized pieces, the result must be
+ * s3miniV<N+1>.bin byte for byte and match the target hash of the patch. The update time
+ * of both paths is computed from the link and flash rates, nothing sleeps: the download and
+ * flash write overlap (bench_ota), the delta adds the SHA-256 read of the running image.
+ * Broken headers, truncated patches and the wrong source image must be rejected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "bench.h"
+#include "delta_patch.h"
+#include "sha256.h"
+
+#define DELTA_SEGMENT 1460
+#define DELTA_LINK_KBPS 100     // a weak WiFi link, as in bench_resume
+#define DELTA_FLASH_KBPS 400    // erase + write
+#define DELTA_READ_KBPS 8000    // flash read of the running image
+#define DELTA_CONNECT_MS 400    // TCP + TLS handshake and the GET
+#define DELTA_MAX_VERSION 32
+
+static bool loadFile(const char* path, std::vector<uint8_t>& data) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  data.clear();
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+class VectorSource : public DeltaSource {
+public:
+  VectorSource(const std::vector<uint8_t>& data) : _data(data) {}
+  bool read(uint32_t offset, uint8_t* buf, size_t len) override {
+    if (offset + len > _data.size()) return false;
+    memcpy(buf, &_data[offset], len);
+    return true;
+  }
+private:
+  const std::vector<uint8_t>& _data;
+};
+
+// the OTA partition: what the writer would get, hashed like otaWriterTask does
+class FlashSink : public DeltaSink {
+public:
+  FlashSink(uint8_t* flash, size_t size) : _flash(flash), _size(size) {}
+  bool write(const uint8_t* data, size_t len) override {
+    if (_len + len > _size) return false;
+    memcpy(_flash + _len, data, len);
+    _sha.update(data, len);
+    _len += len;
+    return true;
+  }
+  void finish(uint8_t digest[SHA256_SIZE]) { _sha.finish(digest); }
+  size_t len() const { return _len; }
+private:
+  uint8_t* _flash;
+  size_t _size;
+  size_t _len = 0;
+  Sha256 _sha;
+};
+
+static void hashOf(const std::vector<uint8_t>& data, uint8_t digest[SHA256_SIZE]) {
+  Sha256 sha;
+  sha.update(data.data(), data.size());
+  sha.finish(digest);
+}
+
+// patch (header included) in segments as they come from the network, true if the target came out
+static bool applyPatch(const std::vector<uint8_t>& source, const std::vector<uint8_t>& patch, size_t patchLen,
+  std::vector<uint8_t>& flash, uint8_t digest[SHA256_SIZE]) {
+  myDeltaHeader header;
+  if (!decodeDeltaHeader(patch.data(), patchLen, header) || header.targetSize > flash.size()) return false;
+  VectorSource src(source);
+  FlashSink sink(flash.data(), flash.size());
+  DeltaPatcher patcher(src, sink);
+  patcher.begin(header);
+  for (size_t pos = DELTA_HEADER_SIZE; pos < patchLen && !patcher.done() && !patcher.failed(); pos += DELTA_SEGMENT) {
+    size_t n = patchLen - pos < DELTA_SEGMENT ? patchLen - pos : DELTA_SEGMENT;
+    patcher.feed(&patch[pos], n);
+  }
+  sink.finish(digest);
+  return patcher.done() && sink.len() == header.targetSize;
+}
+
+static double fullSeconds(double imageKb) {
+  double link = imageKb / DELTA_LINK_KBPS, flash = imageKb / DELTA_FLASH_KBPS;
+  return (link > flash ? link : flash) + DELTA_CONNECT_MS / 1000.0;
+}
+
+static double deltaSeconds(double patchKb, double sourceKb, double imageKb) {
+  double link = patchKb / DELTA_LINK_KBPS, flash = imageKb / DELTA_FLASH_KBPS;
+  return (link > flash ? link : flash) + sourceKb / DELTA_READ_KBPS + DELTA_CONNECT_MS / 1000.0;
+}
+
+int benchDelta(long iterations) {
+
+  const char* dir = "../bin";
+  char path[128];
+  snprintf(path, sizeof(path), "%s/s3miniV%d.bin", dir, 8);
+  FILE* probe = fopen(path, "rb");
+  if (probe == nullptr) dir = "bin";
+  else fclose(probe);
+
+  printf("%u KB/s link, %u KB/s flash write, %u ms per connection, images and patches from %s/\n",
+    DELTA_LINK_KBPS, DELTA_FLASH_KBPS, DELTA_CONNECT_MS, dir);
+  printf("%-8s %10s %10s %7s %9s %9s %9s %s\n", "update", "image KB", "patch KB", "ratio", "full s", "delta s", "apply ms", "image");
+
+  bool ok = true;
+  bool rejectsOk = false;
+  int patches = 0;
+  std::vector<uint8_t> source, target, patch;
+  for (int version = 1; version < DELTA_MAX_VERSION; version++) {
+    snprintf(path, sizeof(path), "%s/s3miniV%d-V%d.patch", dir, version, version + 1);
+    if (!loadFile(path, patch)) continue;
+    snprintf(path, sizeof(path), "%s/s3miniV%d.bin", dir, version);
+    bool haveSource = loadFile(path, source);
+    snprintf(path, sizeof(path), "%s/s3miniV%d.bin", dir, version + 1);
+    if (!haveSource || !loadFile(path, target)) continue;
+    patches++;
+
+    myDeltaHeader header;
+    uint8_t sourceHash[SHA256_SIZE], targetHash[SHA256_SIZE], digest[SHA256_SIZE];
+    hashOf(source, sourceHash);
+    hashOf(target, targetHash);
+    bool headerOk = decodeDeltaHeader(patch.data(), patch.size(), header) && header.sourceSize == source.size()
+      && memcmp(header.sourceHash, sourceHash, SHA256_SIZE) == 0 && memcmp(header.targetHash, targetHash, SHA256_SIZE) == 0;
+
+    // the OTA partition is larger than the image, as on the device
+    std::vector<uint8_t> flash(target.size() + 64 * 1024, 0xFF);
+    unsigned long allocBefore = __allocations;
+    auto start = std::chrono::steady_clock::now();
+    bool applied = true;
+    for (long i = 0; i < iterations; i++) applied = applyPatch(source, patch, patch.size(), flash, digest) && applied;
+    double applyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    unsigned long allocations = __allocations - allocBefore;
+    bool imageOk = headerOk && applied && allocations == 0 && memcmp(flash.data(), target.data(), target.size()) == 0
+      && memcmp(digest, header.targetHash, SHA256_SIZE) == 0;
+
+    double imageKb = target.size() / 1024.0, patchKb = patch.size() / 1024.0;
+    char name[16];
+    snprintf(name, sizeof(name), "V%d-V%d", version, version + 1);
+    printf("%-8s %10.0f %10.1f %6.1f%% %9.1f %9.1f %9.2f %s\n", name, imageKb, patchKb, 100.0 * patchKb / imageKb,
+      fullSeconds(imageKb), deltaSeconds(patchKb, source.size() / 1024.0, imageKb), applyMs, imageOk ? "ok" : "FAIL");
+    ok = ok && imageOk;
+
+    // broken patches must not come out as an image
+    if (!rejectsOk && patch.size() > 1000) {
+      unsigned long accepted = 0;
+      for (size_t bit = 0; bit < DELTA_HEADER_SIZE * 8; bit++) {
+        patch[bit / 8] ^= 1 << (bit % 8);
+        if (decodeDeltaHeader(patch.data(), patch.size(), header)) accepted++;
+        patch[bit / 8] ^= 1 << (bit % 8);
+      }
+      bool truncated = !applyPatch(source, patch, patch.size() - 1, flash, digest)
+        && !applyPatch(source, patch, patch.size() / 2, flash, digest);
+      // the device compares the running image with the source hash before it applies
+      std::vector<uint8_t> other(source);
+      other[other.size() / 2] ^= 1;
+      hashOf(other, digest);
+      bool wrongSource = memcmp(digest, header.sourceHash, SHA256_SIZE) != 0;
+      printf("header bit flips accepted: %lu of %u, truncated patch rejected: %s, wrong source detected: %s\n",
+        accepted, DELTA_HEADER_SIZE * 8, truncated ? "yes" : "no", wrongSource ? "yes" : "no");
+      rejectsOk = accepted == 0 && truncated && wrongSource;
+    }
+  }
+  if (patches == 0) printf("no s3miniV<N>-V<N+1>.patch found, make them with tools/mkdelta.py --all ../bin\n");
+  ok = ok && patches > 0 && rejectsOk;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,300 @@
+/**
+ * @file bench_engine.cpp
+ * @brief Host (env:native) latency micro benchmark of the button -> MIDI engine.
+ *
+ * @details Runs every button configuration (Note/CC/MMC/PC x Push/Toggle x needRelease x
+ * long press) through the MidiEngine and reports ns per event and heap allocations per
+ * event. The precompiled action table path is compared against the former branch chain
+ * of handleEvent() (legacyHandleEvent). Before that the bytes of Program Change with and
+ * without Bank Select and of MMC with a device ID are checked.
+ *
+ * Each time is the best of BENCH_ROUNDS short runs, legacy and table in turn, so a
+ * preempted run or a slower phase of the host counts for neither. The table must not be
+ * slower than legacy in total over Note, CC and MMC and with the mixed buttons, within
+ * BENCH_TOLERANCE for the noise of the host. PC is not compared, the legacy path sent
+ * nothing for it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "bench.h"
+#include "button_fields.h"
+#include "midi_engine.h"
+#include "legacy_handle_event.h"
+
+#define BENCH_ROUNDS 9 // of iterations / 3 each
+#define BENCH_TOLERANCE 1.20 // the former engine was 2 - 3 times slower
+#define MIXED_EVENTS 65536 // of the mixed buttons stream
+
+// MIDI output that only counts the bytes, so the benchmark measures the engine and not the sink
+class CountingMidiOutput : public MidiOutput {
+public:
+  unsigned long messages = 0;
+  unsigned long bytes = 0;
+  void send(const uint8_t*, uint8_t len, uint16_t) override { messages++; bytes += len; }
+};
+
+// MIDI output that keeps the messages of one event
+class RecordingMidiOutput : public MidiOutput {
+public:
+  uint8_t bytes[32];
+  uint8_t len = 0;
+  uint8_t messages = 0;
+  void send(const uint8_t* data, uint8_t n, uint16_t) override {
+    if (len + n > sizeof(bytes)) return;
+    memcpy(bytes + len, data, n);
+    len += n;
+    messages++;
+  }
+  void clear() { len = messages = 0; }
+  bool sent(const uint8_t* expected, uint8_t n, uint8_t m) const {
+    return len == n && messages == m && memcmp(bytes, expected, n) == 0;
+  }
+};
+
+static bool check(const char* name, bool ok) {
+  printf("%-44s %s\n", name, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool checkMessages() {
+  bool ok = true;
+  RecordingMidiOutput out;
+  MidiActionTable actions;
+  MidiEngine engine(out, actions);
+  myMapButton buttons[4];
+  uint8_t states[4] = {};
+  memset(buttons, 0, sizeof(buttons));
+  for (myMapButton& btn : buttons) {
+    btn.btnMidiFunction = MIDI_PROGRAMCHANGE;
+    btn.btnMidiChannel = MIDI_CH_3;
+    btn.btnMidiCC = 5; // program
+    btn.btnMidiCCValueStateOn = PC_BANK_NONE;
+    btn.btnMidiCCValueStateOff = PC_BANK_NONE;
+  }
+  buttons[1].btnMidiCCValueStateOn = 1;  // bank MSB only
+  buttons[2].btnMidiCCValueStateOn = 1;  // MSB and LSB, sent on release
+  buttons[2].btnMidiCCValueStateOff = 2;
+  buttons[2].needRelease = 1;
+  buttons[3].btnMidiFunction = MIDI_MMC;
+  buttons[3].btnMidiMMC = MMC_STOP;
+  actions.compile(buttons, states, 4, 0);
+
+  engine.handleEvent(0, BTN_EVENT_PRESSED, 0);
+  const uint8_t pc[] = { 0xC2, 5 };
+  ok &= check("PC without bank", out.sent(pc, sizeof(pc), 1));
+  out.clear();
+  engine.handleEvent(0, BTN_EVENT_RELEASED, 0);
+  ok &= check("PC sends nothing on release", out.len == 0);
+
+  out.clear();
+  engine.handleEvent(1, BTN_EVENT_PRESSED, 0);
+  const uint8_t msb[] = { 0xB2, 0x00, 1, 0xC2, 5 };
+  ok &= check("Bank Select MSB and PC", out.sent(msb, sizeof(msb), 2));
+
+  out.clear();
+  engine.handleEvent(2, BTN_EVENT_PRESSED, 0);
+  bool onPress = out.len == 0;
+  engine.handleEvent(2, BTN_EVENT_RELEASED, 0);
+  const uint8_t both[] = { 0xB2, 0x00, 1, 0xB2, 0x20, 2, 0xC2, 5 };
+  ok &= check("Bank Select MSB, LSB and PC on release", onPress && out.sent(both, sizeof(both), 3));
+
+  out.clear();
+  engine.handleEvent(3, BTN_EVENT_PRESSED, 0);
+  const uint8_t stopAll[] = { 0xF0, 0x7F, 0x7F, 0x06, MMC_STOP, 0xF7 };
+  ok &= check("MMC stop once, all call", out.sent(stopAll, sizeof(stopAll), 1));
+
+  actions.setMmcDeviceId(0x12);
+  actions.compile(buttons, states, 4, 0);
+  out.clear();
+  engine.handleEvent(3, BTN_EVENT_PRESSED, 0);
+  const uint8_t stopDevice[] = { 0xF0, 0x7F, 0x12, 0x06, MMC_STOP, 0xF7 };
+  ok &= check("MMC stop to device 0x12", out.sent(stopDevice, sizeof(stopDevice), 1));
+
+  // a CC button (values 127 / 0) made a PC button in the web UI
+  static ButtonFieldRegistry fields;
+  buttons[3].btnMidiFunction = MIDI_CC;
+  buttons[3].btnMidiCCValueStateOn = 127;
+  buttons[3].btnMidiCCValueStateOff = 0;
+  fields.setUiValue(buttons[3], 1, MIDI_PROGRAMCHANGE);
+  actions.compile(buttons, states, 4, 0);
+  out.clear();
+  engine.handleEvent(3, BTN_EVENT_PRESSED, 0);
+  ok &= check("CC made PC sends no Bank Select", out.sent(pc, sizeof(pc), 1));
+  return ok;
+}
+
+static const char* midiFunctionName(uint8_t f) {
+  switch (f) {
+    case MIDI_NOTE: return "Note";
+    case MIDI_CC: return "CC";
+    case MIDI_MMC: return "MMC";
+    case MIDI_PROGRAMCHANGE: return "PC";
+    default: return "?";
+  }
+}
+
+static void setupButton(myLegacyButton& btn, uint8_t midiFunction, uint8_t btnFunction, bool needRelease, bool longpress) {
+  memset(&btn, 0, sizeof(btn));
+  btn.btnGpio = 10;
+  for (int m = 0; m < LEGACY_MAPS; m++) {
+    btn.needRelease[m] = needRelease;
+    btn.btnFunction[m] = btnFunction;
+    btn.btnLongpress[m] = longpress;
+    btn.btnState[m] = BTN_OFF;
+    btn.btnColor[m] = 0xFF0000;
+    btn.btnMidiFunction[m] = midiFunction;
+    btn.btnMidiChannel[m] = MIDI_CH_1;
+    btn.btnMidiNote[m] = 60;
+    btn.btnMidiVelocity[m] = 100;
+    btn.btnMidiCC[m] = 43;
+    btn.btnMidiCCValueStateOn[m] = 127;
+    btn.btnMidiCCValueStateOff[m] = 0;
+    btn.btnMidiMMC[m] = MMC_PLAY;
+  }
+}
+
+static void setupButton(myMapButton& btn, uint8_t midiFunction, uint8_t btnFunction, bool needRelease, bool longpress) {
+  memset(&btn, 0, sizeof(btn));
+  btn.needRelease = needRelease;
+  btn.btnFunction = btnFunction;
+  btn.btnLongpress = longpress;
+  btn.btnColor = PALETTE_Red;
+  btn.btnMidiFunction = midiFunction;
+  btn.btnMidiChannel = MIDI_CH_1;
+  btn.btnMidiNote = 60;
+  btn.btnMidiVelocity = 100;
+  btn.btnMidiCC = 43;
+  btn.btnMidiCCValueStateOn = 127;
+  btn.btnMidiCCValueStateOff = 0;
+  btn.btnMidiMMC = MMC_PLAY;
+}
+
+// short press and long press gesture, the same sequence AceButton produces
+static const uint8_t __gesture[] = {
+  BTN_EVENT_PRESSED, BTN_EVENT_RELEASED,
+  BTN_EVENT_PRESSED, BTN_EVENT_LONG_PRESSED, BTN_EVENT_LONG_RELEASED,
+};
+static const int __gestureLen = sizeof(__gesture) / sizeof(__gesture[0]);
+
+int benchEngine(long iterations) {
+
+  bool ok = checkMessages();
+
+  CountingMidiOutput out;
+  LegacyMidiCalls legacy(out);
+  MidiActionTable actions;
+  MidiEngine engine(out, actions);
+  myLegacyButton legacyBtn;
+  myMapButton btn;
+  uint8_t state;
+
+  printf("%-5s %-6s %-7s %-9s %12s %12s %12s %10s\n",
+    "midi", "behave", "release", "longpress", "legacy ns/ev", "table ns/ev", "alloc/event", "msg/event");
+
+  double worstLegacy = 0, worstTable = 0, sumLegacy = 0, sumTable = 0;
+  unsigned long allocations = 0;
+  for (uint8_t midiFunction = MIDI_NOTE; midiFunction <= MIDI_PROGRAMCHANGE; midiFunction++) {
+    for (uint8_t btnFunction = BTN_PUSH; btnFunction <= BTN_TOGGLE; btnFunction++) {
+      for (int needRelease = 0; needRelease < 2; needRelease++) {
+        for (int longpress = 0; longpress < 2; longpress++) {
+          long perRound = iterations / 3 + 1;
+          double events = double(perRound) * __gestureLen;
+          setupButton(legacyBtn, midiFunction, btnFunction, needRelease, longpress);
+          setupButton(btn, midiFunction, btnFunction, needRelease, longpress);
+          state = BTN_OFF;
+          actions.compile(&btn, &state, 1, 0);
+          unsigned long allocBefore = __allocations;
+          double legacyNs = 0, tableNs = 0;
+          for (int round = 0; round < BENCH_ROUNDS; round++) {
+            // former branch chain
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < perRound; i++) {
+              for (int e = 0; e < __gestureLen; e++) {
+                legacyHandleEvent(legacy, &legacyBtn, __gesture[e], 0);
+              }
+            }
+            auto stop = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(stop - start).count() / events;
+            if (round == 0 || ns < legacyNs) legacyNs = ns;
+
+            // precompiled action table
+            out.messages = 0;
+            out.bytes = 0;
+            start = std::chrono::steady_clock::now();
+            for (long i = 0; i < perRound; i++) {
+              for (int e = 0; e < __gestureLen; e++) {
+                engine.handleEvent(0, __gesture[e], (uint16_t)i);
+              }
+            }
+            stop = std::chrono::steady_clock::now();
+            ns = std::chrono::duration<double, std::nano>(stop - start).count() / events;
+            if (round == 0 || ns < tableNs) tableNs = ns;
+          }
+          allocations += __allocations - allocBefore;
+
+          if (legacyNs > worstLegacy) worstLegacy = legacyNs;
+          if (tableNs > worstTable) worstTable = tableNs;
+          if (midiFunction != MIDI_PROGRAMCHANGE) {
+            sumLegacy += legacyNs;
+            sumTable += tableNs;
+          }
+          printf("%-5s %-6s %-7d %-9d %12.2f %12.2f %12.3f %10.3f\n",
+            midiFunctionName(midiFunction), btnFunction == BTN_PUSH ? "push" : "toggle", needRelease, longpress,
+            legacyNs, tableNs, double(__allocations - allocBefore) / (events * BENCH_ROUNDS), double(out.messages) / events);
+        }
+      }
+    }
+  }
+  printf("worst case: legacy %.2f ns/event, table %.2f ns/event\n", worstLegacy, worstTable);
+  ok &= check("table not slower, Note / CC / MMC", sumTable <= sumLegacy * BENCH_TOLERANCE);
+  ok &= check("table allocates nothing", allocations == 0);
+
+  // mixed: 5 buttons with different configurations and a pseudo random gesture stream,
+  // so the branch predictor can not learn a single configuration. The stream is longer than
+  // the branch history, a short one repeated is learned in part and the result depends on
+  // where the linker puts the code.
+  myLegacyButton legacyButtons[MIDI_ACTION_MAX_BUTTONS];
+  myMapButton buttons[MIDI_ACTION_MAX_BUTTONS];
+  uint8_t states[MIDI_ACTION_MAX_BUTTONS] = {};
+  for (int b = 0; b < MIDI_ACTION_MAX_BUTTONS; b++) {
+    int combo = (b * 7 + 3) % 32;
+    setupButton(legacyButtons[b], combo >> 3, (combo >> 2) & 1, (combo >> 1) & 1, combo & 1);
+    setupButton(buttons[b], combo >> 3, (combo >> 2) & 1, (combo >> 1) & 1, combo & 1);
+  }
+  static uint8_t stream[MIXED_EVENTS][2];
+  uint32_t seed = 0x1234567;
+  for (int i = 0; i < MIXED_EVENTS; i++) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    stream[i][0] = seed % MIDI_ACTION_MAX_BUTTONS;
+    stream[i][1] = __gesture[(seed >> 8) % __gestureLen];
+  }
+  long rounds = iterations / 300 / (MIXED_EVENTS / 4096) + 1;
+  double events = double(rounds) * MIXED_EVENTS;
+
+  actions.compile(buttons, states, MIDI_ACTION_MAX_BUTTONS, 0);
+  double legacyNs = 0, tableNs = 0;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (long r = 0; r < rounds; r++) {
+      for (int i = 0; i < MIXED_EVENTS; i++) legacyHandleEvent(legacy, &legacyButtons[stream[i][0]], stream[i][1], 0);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / events;
+    if (round == 0 || ns < legacyNs) legacyNs = ns;
+
+    start = std::chrono::steady_clock::now();
+    for (long r = 0; r < rounds; r++) {
+      for (int i = 0; i < MIXED_EVENTS; i++) engine.handleEvent(stream[i][0], stream[i][1], (uint16_t)i);
+    }
+    stop = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(stop - start).count() / events;
+    if (round == 0 || ns < tableNs) tableNs = ns;
+  }
+  printf("mixed 5 buttons: legacy %.2f ns/event, table %.2f ns/event\n", legacyNs, tableNs);
+  ok &= check("table not slower, mixed buttons", tableNs <= legacyNs * BENCH_TOLERANCE);
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file bench_feedback.cpp
+ * @brief Host (env:native) DAW feedback: FeedbackIndex lookups, toggle states across map switches and the LED flash.
+ *
+ * @details Builds the Ardour bindings of Little_Helper.map (record arm CC 45, loop CC 46)
+ * as toggle buttons and checks that feedback sets the toggle state, so the next press sends
+ * the opposite value, that the state follows a map switch and that the LED flashes. Then a
+ * chatty DAW (random Note / CC on all channels) is fed through the index and through a scan
+ * of every button of every map, the index must not depend on the number of maps.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "bench.h"
+#include "feedback_index.h"
+#include "led_compositor.h"
+#include "midi_engine.h"
+
+class LastMidiOutput : public MidiOutput {
+public:
+  uint8_t bytes[MIDI_ACTION_MAX_BYTES];
+  uint8_t len = 0;
+  void send(const uint8_t* data, uint8_t n, uint16_t) override {
+    memcpy(bytes, data, n);
+    len = n;
+  }
+};
+
+static myMapButton toggle(uint8_t midiFunction, uint8_t number, uint8_t color) {
+  myMapButton btn;
+  memset(&btn, 0, sizeof(btn));
+  btn.btnMidiFunction = midiFunction;
+  btn.btnFunction = BTN_TOGGLE;
+  btn.btnMidiChannel = MIDI_CH_1;
+  btn.btnMidiNote = number;
+  btn.btnMidiVelocity = 100;
+  btn.btnMidiCC = number;
+  btn.btnMidiCCValueStateOn = 127;
+  btn.btnMidiCCValueStateOff = 0;
+  btn.btnColor = color;
+  return btn;
+}
+
+static bool check(const char* name, bool ok) {
+  printf("%-44s %s\n", name, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool checkFeedback() {
+  bool ok = true;
+  FeedbackIndex index;
+  MidiActionTable table;
+  LastMidiOutput out;
+  MidiEngine engine(out, table);
+
+  // map 0: record arm, loop, a push button on CC 45 too, a Note toggle, a macro toggle
+  myMapButton map0[5] = { toggle(MIDI_CC, 45, 1), toggle(MIDI_CC, 46, 2), toggle(MIDI_CC, 45, 3), toggle(MIDI_NOTE, 60, 4),
+    toggle(MIDI_CC, 47, 5) };
+  map0[2].btnFunction = BTN_PUSH;
+  map0[4].btnMacro = 1;
+  uint8_t states0[5] = { BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF };
+  // map 1: record arm on another button
+  myMapButton map1[5] = { toggle(MIDI_CC, 20, 1), toggle(MIDI_CC, 21, 1), toggle(MIDI_CC, 22, 1), toggle(MIDI_CC, 23, 1),
+    toggle(MIDI_CC, 45, 6) };
+  uint8_t states1[5] = { BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF };
+
+  table.compile(map0, states0, 5, 0);
+  index.rebuild(map0, 5);
+
+  // record arm switched on in the DAW: CC 45 127 on channel 1
+  const uint8_t armOn[] = { 0xB0, 45, 127 };
+  uint8_t value = 0;
+  uint8_t buttons = index.receive(armOn, 3, value);
+  ok &= check("CC 45 finds the record arm toggle only", buttons == 0x01 && value == 127);
+  for (uint8_t b = 0; b < 5; b++) {
+    if (buttons & (1 << b)) *table.state(b) = FeedbackIndex::stateOf(map0[b], value);
+  }
+  engine.handleEvent(0, BTN_EVENT_PRESSED, 0);
+  ok &= check("the next press disarms (CC 45 0)", out.len == 3 && out.bytes[0] == 0xB0 && out.bytes[1] == 45 && out.bytes[2] == 0);
+
+  const uint8_t loopOther[] = { 0xB1, 46, 127 }; // channel 2
+  const uint8_t program[] = { 0xC0, 5 };
+  ok &= check("other channel and Program Change find none", index.receive(loopOther, 3, value) == 0 && index.receive(program, 2, value) == 0);
+  const uint8_t noteOn[] = { 0x90, 60, 90 }, noteZero[] = { 0x90, 60, 0 }, noteOff[] = { 0x80, 60, 64 };
+  bool notes = index.receive(noteOn, 3, value) == 0x08 && FeedbackIndex::stateOf(map0[3], value) == BTN_ON;
+  notes &= index.receive(noteZero, 3, value) == 0x08 && FeedbackIndex::stateOf(map0[3], value) == BTN_OFF;
+  notes &= index.receive(noteOff, 3, value) == 0x08 && FeedbackIndex::stateOf(map0[3], value) == BTN_OFF;
+  ok &= check("Note On, velocity 0 and Note Off", notes);
+  const uint8_t macroCc[] = { 0xB0, 47, 127 };
+  ok &= check("a macro button is not indexed", index.receive(macroCc, 3, value) == 0);
+
+  // the DAW arms again, then the map is switched: the state goes with the map
+  index.receive(armOn, 3, value);
+  states0[0] = BTN_ON;
+  index.keep(map0, states0, 5);
+  index.applyTo(map1, states1, 5);
+  table.compile(map1, states1, 5, 1);
+  index.rebuild(map1, 5);
+  ok &= check("map 1 starts armed, unknown keys stay off", states1[4] == BTN_ON && states1[0] == BTN_OFF);
+  ok &= check("after the rebuild CC 46 finds none, CC 45 button 5", index.receive(armOn, 3, value) == 0x10
+    && index.receive(loopOther, 3, value) == 0);
+
+  // disarmed on map 1 with a press, map 0 follows
+  engine.handleEvent(4, BTN_EVENT_PRESSED, 0);
+  index.keep(map1, states1, 5);
+  states0[0] = BTN_ON;
+  index.applyTo(map0, states0, 5);
+  ok &= check("a press on map 1 disarms map 0 too", states1[4] == BTN_OFF && states0[0] == BTN_OFF);
+
+  // CC values between the on and off value
+  myMapButton custom = toggle(MIDI_CC, 50, 1);
+  custom.btnMidiCCValueStateOn = 10;
+  custom.btnMidiCCValueStateOff = 100;
+  ok &= check("custom CC values, others from 64 on", FeedbackIndex::stateOf(custom, 10) == BTN_ON
+    && FeedbackIndex::stateOf(custom, 100) == BTN_OFF && FeedbackIndex::stateOf(custom, 64) == BTN_ON
+    && FeedbackIndex::stateOf(custom, 63) == BTN_OFF);
+
+  // the flash shows for LED_FLASH_MS above the base, a held button wins
+  LedCompositor led;
+  myLedFrame frame;
+  led.setBase(0x0000FF);
+  led.setBrightness(100);
+  led.render(1000, frame);
+  led.flash(0xFF0000);
+  led.render(1020, frame);
+  bool flashed = frame.color == 0xFF0000;
+  led.render(1020 + LED_FLASH_MS - 1, frame);
+  flashed &= frame.color == 0xFF0000;
+  led.render(1020 + LED_FLASH_MS, frame);
+  flashed &= frame.color == 0x0000FF;
+  led.flash(0);
+  led.render(2000, frame);
+  flashed &= frame.color == 0;
+  led.setOverlay(0x00FF00);
+  led.flash(0xFF0000);
+  led.render(2100, frame);
+  flashed &= frame.color == 0x00FF00;
+  ok &= check("LED flash, dark flash, overlay wins", flashed);
+  return ok;
+}
+
+// the naive lookup: every button of every map
+static uint32_t scanMaps(const myMapButton maps[][MIDI_ACTION_MAX_BUTTONS], uint8_t numMaps, const uint8_t* bytes) {
+  uint8_t channel = bytes[0] & 0x0F;
+  bool cc = (bytes[0] & 0xF0) == 0xB0;
+  uint32_t found = 0;
+  for (uint8_t m = 0; m < numMaps; m++) {
+    for (uint8_t b = 0; b < MIDI_ACTION_MAX_BUTTONS; b++) {
+      const myMapButton& btn = maps[m][b];
+      if (btn.btnFunction != BTN_TOGGLE || btn.btnMidiChannel != channel) continue;
+      if (cc ? btn.btnMidiFunction == MIDI_CC && btn.btnMidiCC == bytes[1]
+             : btn.btnMidiFunction == MIDI_NOTE && btn.btnMidiNote == bytes[1]) found++;
+    }
+  }
+  return found;
+}
+
+int benchFeedback(long iterations) {
+  bool ok = checkFeedback();
+
+  static myMapButton maps[NUBER_OF_MAPS][MIDI_ACTION_MAX_BUTTONS];
+  uint32_t seed = 0x6D2B79F5;
+  for (uint8_t m = 0; m < NUBER_OF_MAPS; m++) {
+    for (uint8_t b = 0; b < MIDI_ACTION_MAX_BUTTONS; b++) {
+      seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+      maps[m][b] = toggle(seed & 1 ? MIDI_CC : MIDI_NOTE, 40 + (seed >> 8) % 16, 1);
+    }
+  }
+  static uint8_t stream[4096][3];
+  for (int i = 0; i < 4096; i++) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    stream[i][0] = (seed & 1 ? 0xB0 : 0x90) | ((seed >> 1) & 0x01); // channel 1 and 2
+    stream[i][1] = 40 + (seed >> 8) % 24;
+    stream[i][2] = (seed >> 16) & 0x7F;
+  }
+
+  FeedbackIndex index;
+  index.rebuild(maps[0], MIDI_ACTION_MAX_BUTTONS);
+  unsigned long allocBefore = __allocations;
+  uint32_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long it = 0; it < iterations; it++) {
+    uint8_t value;
+    found += index.receive(stream[it & 4095], 3, value) != 0;
+  }
+  double indexNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long it = 0; it < iterations / 2; it++) index.rebuild(maps[it % NUBER_OF_MAPS], MIDI_ACTION_MAX_BUTTONS);
+  double rebuildNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (iterations / 2);
+  unsigned long allocations = __allocations - allocBefore;
+
+  static const uint8_t mapCounts[] = { 4, 32, NUBER_OF_MAPS };
+  double scanNs[3];
+  uint32_t scanned = 0;
+  for (int c = 0; c < 3; c++) {
+    long n = iterations / 16;
+    start = std::chrono::steady_clock::now();
+    for (long it = 0; it < n; it++) scanned += scanMaps(maps, mapCounts[c], stream[it & 4095]);
+    scanNs[c] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+  }
+
+  printf("index: %.1f ns/message (%u for a button of the active map), rebuild %.1f ns, %lu allocations\n", indexNs,
+    found, rebuildNs, allocations);
+  printf("scan of every button: %.1f ns with %u maps, %.1f ns with %u, %.1f ns with %u (%u found)\n", scanNs[0],
+    mapCounts[0], scanNs[1], mapCounts[1], scanNs[2], mapCounts[2], scanned);
+  ok &= allocations == 0 && found > 0 && index.matched() == found;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file bench_fields.cpp
+ * @brief Host (env:native) web UI field dispatch: one callback per field vs. the BUTTON_FIELDS registry.
+ *
+ * @details The control ids are handed out like buildWebUi() does with ESPUI, children
+ * (options, min, max) included. The legacy path is the former selectBtn...Calback: String
+ * copy of the value, toInt(), scan of __selectUiBtn for the button, store without a check into
+ * the former per map arrays (myLegacyButton) with the color looked up as RGB.
+ * The registry path is selectBtnFieldCallback(): one indexed read, parse, validate, store.
+ * Both get the same events, the registry must also reject what the widgets can not send.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "bench.h"
+#include "button_fields.h"
+#include "legacy_handle_event.h"
+
+#define FIELDS_BUTTONS 5
+
+// the ids buildWebUi() gets: 7 tabs, the active map number with min and max, then per
+// button the map number with min and max and every field with its options or min and max
+static uint16_t buildControls(ButtonFieldRegistry& fields, uint16_t ids[FIELDS_BUTTONS][FIELD_MAX_SLOTS]) {
+  uint16_t next = 1 + 7 + 3;
+  for (uint8_t b = 0; b < FIELDS_BUTTONS; b++) {
+    ids[b][0] = next;
+    fields.bindControl(next, b, 0);
+    next += 1 + 2;
+    for (uint8_t f = 0; f < BUTTON_FIELD_COUNT; f++) {
+      ids[b][1 + f] = next;
+      fields.bindControl(next, b, 1 + f);
+      next += 1 + (BUTTON_FIELDS[f].widget == FIELD_WIDGET_SELECT ? BUTTON_FIELDS[f].optionCount : 2);
+    }
+  }
+  return next;
+}
+
+// the former callbacks, field by field
+static void legacyCallback(uint16_t id, const char* value, uint8_t field, myLegacyButton* buttons,
+  const uint16_t ids[FIELDS_BUTTONS][FIELD_MAX_SLOTS], const uint8_t* activeMap) {
+  std::string copy(value); // String(sender->value)
+  uint8_t value_t = static_cast<uint8_t>(atol(copy.c_str()));
+  int active_btn = 0;
+  for (int i = 0; i < FIELDS_BUTTONS; i++) {
+    if (ids[i][1 + field] == id) {
+      active_btn = i;
+      break;
+    }
+  }
+  myLegacyButton& btn = buttons[active_btn];
+  uint8_t map = activeMap[active_btn];
+  switch (field) {
+    case 0: btn.btnMidiChannel[map] = value_t; break;
+    case 1: // and the Bank Select of setMidiFunction(), so both paths end the same
+      if ((value_t == MIDI_PROGRAMCHANGE) != (btn.btnMidiFunction[map] == MIDI_PROGRAMCHANGE)) {
+        if (value_t == MIDI_PROGRAMCHANGE) {
+          btn.btnMidiCCValueStateOn[map] = btn.btnMidiCCValueStateOff[map] = PC_BANK_NONE;
+        } else {
+          if (btn.btnMidiCCValueStateOn[map] >= PC_BANK_NONE) btn.btnMidiCCValueStateOn[map] = 127;
+          if (btn.btnMidiCCValueStateOff[map] >= PC_BANK_NONE) btn.btnMidiCCValueStateOff[map] = 0;
+        }
+      }
+      btn.btnMidiFunction[map] = value_t;
+      break;
+    case 2: btn.btnMidiCC[map] = value_t; break;
+    case 3: btn.btnMidiCCValueStateOn[map] = value_t; break;
+    case 4: btn.btnMidiCCValueStateOff[map] = value_t; break;
+    case 5: btn.btnMidiNote[map] = value_t; break;
+    case 6: btn.btnMidiMMC[map] = value_t; break;
+    case 7: btn.btnMidiVelocity[map] = value_t; break;
+    case 8: btn.btnFunction[map] = value_t; break;
+    case 9: btn.needRelease[map] = (bool)value_t; break;
+    case 10: btn.btnColor[map] = BUTTON_PALETTE[value_t]; break;
+  }
+}
+
+static my_field_result registryCallback(uint16_t id, const char* value, myMapButton maps[][FIELDS_BUTTONS],
+  const ButtonFieldRegistry& fields, const uint8_t* activeMap) {
+  uint8_t btn, slot;
+  if (!fields.findControl(id, btn, slot) || slot == 0) return FIELD_UNKNOWN;
+  return fields.setUiText(maps[activeMap[btn]][btn], slot - 1, value);
+}
+
+static bool rejects(ButtonFieldRegistry& fields, myMapButton& btn, uint8_t field, const char* text) {
+  myMapButton before = btn;
+  bool rejected = fields.setUiText(btn, field, text) != FIELD_OK;
+  return rejected && memcmp(&before, &btn, sizeof(btn)) == 0;
+}
+
+// both paths ended with the same settings in the maps the buttons had selected
+static bool sameButtons(const myLegacyButton* legacy, myMapButton maps[][FIELDS_BUTTONS], const uint8_t* activeMap) {
+  for (int b = 0; b < FIELDS_BUTTONS; b++) {
+    const myLegacyButton& l = legacy[b];
+    const myMapButton& n = maps[activeMap[b]][b];
+    uint8_t m = activeMap[b];
+    if (l.btnMidiChannel[m] != n.btnMidiChannel || l.btnMidiFunction[m] != n.btnMidiFunction
+      || l.btnMidiCC[m] != n.btnMidiCC || l.btnMidiCCValueStateOn[m] != n.btnMidiCCValueStateOn
+      || l.btnMidiCCValueStateOff[m] != n.btnMidiCCValueStateOff || l.btnMidiNote[m] != n.btnMidiNote
+      || l.btnMidiMMC[m] != n.btnMidiMMC || l.btnMidiVelocity[m] != n.btnMidiVelocity
+      || l.btnFunction[m] != n.btnFunction || l.needRelease[m] != n.needRelease
+      || l.btnColor[m] != paletteColor(n.btnColor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int benchFields(long iterations) {
+
+  static ButtonFieldRegistry fields;
+  static uint16_t ids[FIELDS_BUTTONS][FIELD_MAX_SLOTS];
+  uint16_t lastId = buildControls(fields, ids);
+  static myMapButton maps[NUBER_OF_MAPS][FIELDS_BUTTONS];
+  static myLegacyButton legacyButtons[FIELDS_BUTTONS];
+  memset(maps, 0, sizeof(maps));
+  memset(legacyButtons, 0, sizeof(legacyButtons));
+  const uint8_t activeMap[FIELDS_BUTTONS] = { 0, 1, 2, 3, 0 };
+
+  // every allowed value round trips, bit fields included
+  bool roundTrip = true;
+  for (uint8_t f = 0; f < BUTTON_FIELD_COUNT; f++) {
+    const myFieldDescriptor& d = BUTTON_FIELDS[f];
+    uint8_t count = d.widget == FIELD_WIDGET_SELECT ? d.optionCount : d.max - d.min + 1;
+    for (uint8_t i = 0; i < count; i++) {
+      int32_t v = d.widget == FIELD_WIDGET_SELECT ? d.options[i].value : d.min + i;
+      myMapButton& btn = maps[1 + i % (NUBER_OF_MAPS - 1)][1];
+      if (fields.setUiValue(btn, f, v) != FIELD_OK || fields.uiValue(btn, f) != v) roundTrip = false;
+    }
+  }
+  memset(maps, 0, sizeof(maps));
+  fields.setUiValue(maps[2][1], 10, PALETTE_Red);
+  fields.setUiValue(maps[2][1], 0, 15);
+  bool colorStored = paletteColor(maps[2][1].btnColor) == 0xFF0000 && maps[2][1].btnMidiChannel == 15
+    && maps[2][1].btnMidiMMC == 0 && maps[2][1].btnMidiFunction == 0;
+
+  // a button that becomes PC sends no Bank Select until one is set, back to CC it has CC values
+  myMapButton& pc = maps[4][2];
+  pc.btnMidiCCValueStateOn = 100;
+  pc.btnMidiCCValueStateOff = 5;
+  fields.setUiValue(pc, 1, MIDI_PROGRAMCHANGE);
+  bool pcNoBank = pc.btnMidiCCValueStateOn == PC_BANK_NONE && pc.btnMidiCCValueStateOff == PC_BANK_NONE;
+  fields.setUiValue(pc, 4, 3);
+  fields.setUiValue(pc, 1, MIDI_PROGRAMCHANGE);
+  pcNoBank = pcNoBank && pc.btnMidiCCValueStateOff == 3;
+  fields.setUiValue(pc, 1, MIDI_CC);
+  pcNoBank = pcNoBank && pc.btnMidiCCValueStateOn == 127 && pc.btnMidiCCValueStateOff == 3;
+
+  // what the widgets can not send must not reach the button
+  myMapButton& probe = maps[0][0];
+  bool validated = rejects(fields, probe, 0, "16") && rejects(fields, probe, 0, "-1")
+    && rejects(fields, probe, 5, "128") && rejects(fields, probe, 5, "300")
+    && rejects(fields, probe, 1, "4") && rejects(fields, probe, 6, "0") && rejects(fields, probe, 6, "10")
+    && rejects(fields, probe, 9, "2") && rejects(fields, probe, 10, "140")
+    && rejects(fields, probe, 2, "") && rejects(fields, probe, 2, "12x") && rejects(fields, probe, 2, "1.5")
+    && rejects(fields, probe, 2, "99999999999") && rejects(fields, probe, BUTTON_FIELD_COUNT, "1");
+  uint8_t b, s;
+  bool index = !fields.findControl(1, b, s) && !fields.findControl(FIELD_INDEX_MAX_ID, b, s)
+    && !fields.bindControl(FIELD_INDEX_MAX_ID, 0, 1) && !fields.bindControl(10, 0, FIELD_MAX_SLOTS)
+    && fields.findControl(ids[3][7], b, s) && b == 3 && s == 7;
+
+  // the legacy callbacks store an out of range value, note 300 becomes 44
+  legacyCallback(ids[0][6], "300", 5, legacyButtons, ids, activeMap);
+  bool legacyStoresBad = legacyButtons[0].btnMidiNote[0] == 44;
+
+  // the same event stream for both
+  struct event { uint16_t id; uint8_t field; char value[8]; };
+  static event events[1024];
+  uint32_t seed = 0x1234567;
+  for (event& e : events) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    uint8_t btn = seed % FIELDS_BUTTONS, f = (seed >> 8) % BUTTON_FIELD_COUNT;
+    const myFieldDescriptor& d = BUTTON_FIELDS[f];
+    int32_t v = d.widget == FIELD_WIDGET_SELECT ? d.options[(seed >> 16) % d.optionCount].value
+      : d.min + (seed >> 16) % (d.max - d.min + 1);
+    e.id = ids[btn][1 + f];
+    e.field = f;
+    snprintf(e.value, sizeof(e.value), "%ld", (long)v);
+  }
+
+  memset(legacyButtons, 0, sizeof(legacyButtons));
+  unsigned long allocBefore = __allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    const event& e = events[i & 1023];
+    legacyCallback(e.id, e.value, e.field, legacyButtons, ids, activeMap);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double legacyNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+  unsigned long legacyAllocations = __allocations - allocBefore;
+
+  memset(maps, 0, sizeof(maps));
+  unsigned long failed = 0;
+  allocBefore = __allocations;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    const event& e = events[i & 1023];
+    if (registryCallback(e.id, e.value, maps, fields, activeMap) != FIELD_OK) failed++;
+  }
+  stop = std::chrono::steady_clock::now();
+  double registryNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+  unsigned long registryAllocations = __allocations - allocBefore;
+  bool same = iterations < 1024 || sameButtons(legacyButtons, maps, activeMap);
+
+  printf("%u fields, %u control ids, index %u bytes\n", BUTTON_FIELD_COUNT, lastId - 1, (unsigned)sizeof(ButtonFieldRegistry));
+  printf("round trip: %s, color as palette index: %s, PC without bank: %s, invalid input rejected: %s, id index: %s, legacy stores note 300: %s\n",
+    roundTrip ? "ok" : "FAIL", colorStored ? "ok" : "FAIL", pcNoBank ? "ok" : "FAIL", validated ? "ok" : "FAIL",
+    index ? "ok" : "FAIL", legacyStoresBad ? "yes" : "no");
+  printf("%-10s %8s %12s\n", "dispatch", "ns", "allocations");
+  printf("%-10s %8.1f %12lu\n", "legacy", legacyNs, legacyAllocations);
+  printf("%-10s %8.1f %12lu\n", "registry", registryNs, registryAllocations);
+  printf("same buttons after %ld events: %s, registry rejected %lu valid events\n", iterations, same ? "yes" : "no", failed);
+  bool ok = roundTrip && colorStored && pcNoBank && validated && index && same && failed == 0 && registryAllocations == 0
+    && lastId < FIELD_INDEX_MAX_ID;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
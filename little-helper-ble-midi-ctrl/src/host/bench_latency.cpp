@@ -0,0 +1,72 @@
+/**
+ * @file bench_latency.cpp
+ * @brief Host (env:native) cost and accuracy of the latency instrumentation.
+ *
+ * @details Pushes samples through the SpscQueue and the LatencyStats histograms the same way
+ * the firmware does (producer task -> loop()) and reports ns per sample. The percentiles of
+ * a known distribution are checked against the exact values, the log buckets may be off by
+ * at most one bucket width (25%).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <algorithm>
+
+#include "bench.h"
+#include "latency_stats.h"
+#include "spsc_queue.h"
+
+static bool checkPercentile(const LatencyHistogram& h, const uint32_t* sorted, uint32_t n, uint8_t p) {
+  uint32_t exact = sorted[(uint32_t)(((uint64_t)n * p + 99) / 100) - 1];
+  uint32_t reported = h.percentile(p);
+  bool ok = reported >= exact && reported <= exact + exact / 4 + 1;
+  printf("p%-3u exact %8u us, reported %8u us %s\n", p, exact, reported, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+int benchLatency(long iterations) {
+
+  static SpscQueue<myLatencySample, 64> ring;
+  static uint32_t values[100000];
+  LatencyStats stats;
+  uint32_t seed = 0x9E3779B9;
+  uint32_t n = sizeof(values) / sizeof(values[0]);
+
+  // 5..15 ms with a long tail, roughly what a BLE connection interval produces
+  for (uint32_t i = 0; i < n; i++) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    uint32_t v = 5000 + seed % 10000;
+    if ((seed >> 24) == 0) v *= 8;
+    values[i] = v;
+  }
+
+  unsigned long allocBefore = __allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long it = 0; it < iterations; it++) {
+    stats.reset();
+    for (uint32_t i = 0; i < n; i++) {
+      myLatencySample sample = { 1, { values[i] / 4, values[i] / 2, values[i] }, true };
+      ring.push(sample);
+      myLatencySample out;
+      while (ring.pop(out)) stats.add(out);
+    }
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(stop - start).count() / (double(iterations) * n);
+  printf("record + histogram: %.2f ns/sample, %lu allocations\n", ns, __allocations - allocBefore);
+
+  char line[96];
+  for (uint8_t s = 0; s < LATENCY_STAGES; s++) {
+    stats.format(s, line, sizeof(line));
+    printf("%s\n", line);
+  }
+
+  std::sort(values, values + n);
+  const LatencyHistogram& notify = stats.stage(LATENCY_NOTIFY);
+  bool p50 = checkPercentile(notify, values, n, 50);
+  bool p99 = checkPercentile(notify, values, n, 99);
+  bool ok = p50 && p99 && notify.max() == values[n - 1] && notify.count() == n;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
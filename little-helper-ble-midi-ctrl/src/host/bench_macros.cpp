@@ -0,0 +1,278 @@
+/**
+ * @file bench_macros.cpp
+ * @brief Host (env:native) macros: timer wheel, macro record and step timing against a simulated clock.
+ *
+ * @details The clock is simulated in us. The esp_timer tick comes every 1 ms and wakes the
+ * input task after a wake latency, now and then the BT stack holds the core for a few ms and
+ * the ticks meanwhile become one wake. Every wake runs the sequencer like the input task
+ * does. A step is late by the time from its due time to its send, its MIDI timestamp must
+ * be the due time. Steps scheduled from the send time of the step before (instead of its due
+ * time) and a macro played with delay() in the input task are the comparison.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "bench.h"
+#include "macro_sequencer.h"
+#include "latency_stats.h"
+
+#define MACROS_TICK_US 1000
+#define MACROS_WAKE_US 40        // esp_timer -> input task running
+#define MACROS_BLOCK_PERCENT 3   // wakes that wait for the BT stack
+#define MACROS_BLOCK_MAX_US 4000
+
+struct mySentStep {
+  uint32_t sentMs;
+  uint16_t timestampMs;
+  uint8_t status;
+  uint8_t data1;
+};
+
+class RecordingOutput : public MidiOutput {
+public:
+  void send(const uint8_t* data, uint8_t len, uint16_t timestampMs) override {
+    sent.push_back({ nowMs, timestampMs, data[0], len > 1 ? data[1] : (uint8_t)0 });
+  }
+  std::vector<mySentStep> sent;
+  uint32_t nowMs = 0;
+};
+
+static uint32_t __seed = 0x13579BD;
+
+static uint32_t nextRandom() {
+  __seed ^= __seed << 13;
+  __seed ^= __seed >> 17;
+  __seed ^= __seed << 5;
+  return __seed;
+}
+
+// the time the input task runs for a tick, a tick during a longer run is merged into it
+static uint32_t wakeAfter(uint32_t tickUs) {
+  uint32_t us = tickUs + MACROS_WAKE_US / 2 + nextRandom() % MACROS_WAKE_US;
+  if (nextRandom() % 100 < MACROS_BLOCK_PERCENT) us += 1000 + nextRandom() % (MACROS_BLOCK_MAX_US - 1000);
+  return us;
+}
+
+static void step(myMacro& macro, uint16_t delayMs, uint8_t status, uint8_t data1, uint8_t data2) {
+  myMacroStep& s = macro.step[macro.steps++];
+  s.delayMs = delayMs;
+  s.len = 3;
+  s.bytes[0] = status;
+  s.bytes[1] = data1;
+  s.bytes[2] = data2;
+}
+
+// ~ timer wheel ~
+static bool checkWheel(long rounds) {
+  struct myFired { uint32_t due; };
+  std::vector<myFired> fired;
+  auto record = [](void* context, uint8_t tag, uint32_t dueTick) {
+    std::vector<myFired>* list = (std::vector<myFired>*)context;
+    list->push_back({ dueTick });
+  };
+
+  // tick by tick every timer fires at its tick, also several turns ahead
+  TimerWheel wheel;
+  wheel.reset(1000);
+  uint32_t now = 1000;
+  long scheduled = 0, exact = 0, early = 0;
+  for (long r = 0; r < rounds; r++) {
+    while (wheel.used() < TIMER_WHEEL_TIMERS - 2) {
+      wheel.schedule(now + 1 + nextRandom() % (3 * TIMER_WHEEL_SLOTS), 0);
+      scheduled++;
+    }
+    now++;
+    size_t before = fired.size();
+    wheel.advance(now, record, &fired);
+    for (size_t i = before; i < fired.size(); i++) {
+      if (fired[i].due == now) exact++;
+      if ((int32_t)(fired[i].due - now) > 0) early++;
+    }
+  }
+  long tickFired = fired.size();
+  bool tickByTick = early == 0 && exact == tickFired && tickFired > 0;
+
+  // with gaps between the calls a timer fires on the first call at or after its tick
+  fired.clear();
+  wheel.reset(now);
+  long late = 0, gapFired = 0;
+  uint32_t last = now;
+  for (long r = 0; r < rounds; r++) {
+    while (wheel.used() < TIMER_WHEEL_TIMERS / 2) wheel.schedule(now + 1 + nextRandom() % 200, 0);
+    last = now;
+    now += 1 + nextRandom() % 90;
+    fired.clear();
+    wheel.advance(now, record, &fired);
+    for (const myFired& f : fired) {
+      gapFired++;
+      if ((int32_t)(f.due - now) > 0 || (int32_t)(f.due - last) <= 0) late++;
+    }
+  }
+
+  // a full pool refuses, cancel frees
+  TimerWheel full;
+  for (int i = 0; i < TIMER_WHEEL_TIMERS; i++) full.schedule(5 + i, i % 2);
+  bool refused = !full.schedule(5, 0);
+  bool cancelled = full.cancel(1) == TIMER_WHEEL_TIMERS / 2 && full.used() == TIMER_WHEEL_TIMERS / 2;
+  fired.clear();
+  full.advance(100, record, &fired);
+  bool rest = fired.size() == TIMER_WHEEL_TIMERS / 2 && full.idle();
+
+  printf("wheel: %ld timers tick by tick, %ld early, %ld not on their tick; %ld with gaps, %ld not on the first call; "
+    "full pool refused: %s, cancel: %s\n", scheduled, early, tickFired - exact, gapFired, late,
+    refused ? "yes" : "no", cancelled && rest ? "ok" : "FAIL");
+  return tickByTick && late == 0 && refused && cancelled && rest;
+}
+
+// ~ record ~
+static bool checkRecord(const myMacro& sample) {
+  myMacro macros[MACRO_COUNT];
+  memset(macros, 0, sizeof(macros));
+  macros[0] = sample;
+  macros[6].steps = 1;
+  macros[6].step[0] = { 300, 6, { 0xF0, 0x7F, 0x7F, 0x06, MMC_PLAY, 0xF7 } };
+  uint8_t record[MACRO_RECORD_MAX_SIZE];
+  size_t len = encodeMacros(macros, MACRO_COUNT, record, sizeof(record));
+
+  myMacro loaded[MACRO_COUNT];
+  memset(loaded, 0, sizeof(loaded));
+  bool roundTrip = len && decodeMacros(record, len, loaded, MACRO_COUNT) && memcmp(loaded, macros, sizeof(macros)) == 0;
+
+  // a broken record leaves the macros as they are
+  myMacro kept[MACRO_COUNT];
+  memcpy(kept, loaded, sizeof(kept));
+  record[10] ^= 1;
+  bool badCrc = !decodeMacros(record, len, loaded, MACRO_COUNT);
+  record[10] ^= 1;
+  myMacro invalid[MACRO_COUNT];
+  memcpy(invalid, macros, sizeof(invalid));
+  invalid[6].step[0].bytes[5] = 0x00; // SysEx without F7
+  uint8_t broken[MACRO_RECORD_MAX_SIZE];
+  size_t brokenLen = encodeMacros(invalid, MACRO_COUNT, broken, sizeof(broken));
+  bool badStep = !decodeMacros(broken, brokenLen, loaded, MACRO_COUNT);
+  bool untouched = memcmp(loaded, kept, sizeof(kept)) == 0;
+  bool tooSmall = encodeMacros(macros, MACRO_COUNT, record, len - 1) == 0;
+
+  printf("record: %u bytes, round trip: %s, broken crc: %s, broken step: %s, macros kept: %s, small buffer: %s\n",
+    (unsigned)len, roundTrip ? "ok" : "FAIL", badCrc ? "rejected" : "TAKEN", badStep ? "rejected" : "TAKEN",
+    untouched ? "yes" : "no", tooSmall ? "refused" : "OVERFLOW");
+  return roundTrip && badCrc && badStep && untouched && tooSmall;
+}
+
+int benchMacros(long iterations) {
+  bool ok = true;
+  ok = checkWheel(iterations * 10) && ok;
+
+  // select next route, arm record, start transport and a few more steps to stress the wheel
+  myMacro macro;
+  memset(&macro, 0, sizeof(macro));
+  step(macro, 0, 0xB0, 112, 127);
+  step(macro, 50, 0xB0, 64, 127);
+  step(macro, 50, 0xB0, 41, 127);
+  step(macro, 7, 0xB1, 1, 0);
+  step(macro, 0, 0xB1, 2, 0);
+  step(macro, 120, 0x90, 60, 100);
+  step(macro, 1, 0x80, 60, 0);
+  step(macro, 300, 0xB0, 42, 127);
+  uint32_t durationMs = 0;
+  for (uint8_t s = 0; s < macro.steps; s++) durationMs += macro.step[s].delayMs;
+  myMacro second;
+  memset(&second, 0, sizeof(second));
+  step(second, 0, 0xB2, 20, 127);
+  step(second, 33, 0xB2, 21, 127);
+  step(second, 90, 0xB2, 22, 127);
+
+  ok = checkRecord(macro) && ok;
+
+  // ~ timing ~
+  RecordingOutput out;
+  MacroSequencer sequencer(out);
+  LatencyHistogram lateUs, pressUs;
+  uint32_t runAtUs = 0, tickUs = 0;
+  long stamped = 0, wrongStamp = 0, missing = 0;
+  uint32_t maxLateMs = 0;
+  for (long i = 0; i < iterations; i++) {
+    // a press at a wake of the input task, the macro is timed from it
+    tickUs += MACROS_TICK_US * (1 + nextRandom() % 50);
+    runAtUs = wakeAfter(tickUs);
+    uint32_t pressMs = runAtUs / 1000;
+    out.nowMs = pressMs;
+    size_t before = out.sent.size();
+    sequencer.start(1, macro, pressMs);
+    bool both = i % 4 == 0;
+    if (both) sequencer.start(2, second, pressMs);
+
+    // the esp_timer ticks until the macros are done
+    while (sequencer.busy()) {
+      tickUs += MACROS_TICK_US;
+      if (tickUs < runAtUs) continue; // merged into the wake that is still running
+      runAtUs = wakeAfter(tickUs);
+      out.nowMs = runAtUs / 1000;
+      sequencer.run(out.nowMs);
+    }
+
+    // expected due times per macro, compared in the order the steps were sent
+    uint32_t at = pressMs, at2 = pressMs;
+    uint8_t s1 = 0, s2 = 0;
+    for (size_t k = before; k < out.sent.size(); k++) {
+      const mySentStep& sent = out.sent[k];
+      uint32_t dueMs;
+      if (sent.status == 0xB2) {
+        at2 += second.step[s2++].delayMs;
+        dueMs = at2;
+      } else {
+        at += macro.step[s1++].delayMs;
+        dueMs = at;
+      }
+      stamped++;
+      if (sent.timestampMs != (uint16_t)dueMs) wrongStamp++;
+      uint32_t lateMs = sent.sentMs - dueMs;
+      lateUs.add(lateMs * 1000);
+      if (lateMs > maxLateMs) maxLateMs = lateMs;
+    }
+    if (s1 != macro.steps || s2 != (both ? second.steps : 0)) missing++;
+
+    // a press while the macro plays: the edge wakes the input task right away
+    pressUs.add(MACROS_WAKE_US / 2 + nextRandom() % MACROS_WAKE_US);
+    tickUs = runAtUs;
+  }
+
+  // the same jitter with the next step scheduled from the send of the step before
+  __seed = 0x13579BD;
+  LatencyHistogram driftMs;
+  for (long i = 0; i < iterations; i++) {
+    uint32_t nowUs = wakeAfter(MACROS_TICK_US * 1000);
+    uint32_t sentMs = nowUs / 1000, dueMs = sentMs;
+    for (uint8_t s = 1; s < macro.steps; s++) {
+      uint32_t targetMs = sentMs + macro.step[s].delayMs;
+      dueMs += macro.step[s].delayMs;
+      uint32_t tick = nowUs / MACROS_TICK_US;
+      do {
+        tick++;
+        if (tick * MACROS_TICK_US < nowUs) continue;
+        nowUs = wakeAfter(tick * MACROS_TICK_US);
+      } while (nowUs / 1000 < targetMs);
+      sentMs = nowUs / 1000;
+    }
+    driftMs.add(sentMs - dueMs);
+  }
+
+  printf("%ld macros, %ld steps sent, %u started, %u dropped, %ld incomplete\n", iterations, stamped,
+    sequencer.started(), sequencer.dropped(), missing);
+  printf("%-28s %8s %8s %8s\n", "", "p50", "p99", "max");
+  printf("%-28s %6ums %6ums %6ums\n", "step late (timer wheel)", lateUs.percentile(50) / 1000, lateUs.percentile(99) / 1000,
+    maxLateMs);
+  printf("%-28s %6ums %6ums %6ums\n", "last step off (send + delay)", driftMs.percentile(50), driftMs.percentile(99),
+    driftMs.max());
+  printf("%-28s %6uus %6uus %6uus\n", "press during a macro (wheel)", pressUs.percentile(50), pressUs.percentile(99),
+    pressUs.max());
+  printf("%-28s %6ums %6ums %6ums\n", "press during delay() macro", durationMs / 2, durationMs * 99 / 100, durationMs);
+  printf("MIDI timestamp = due time: %ld of %ld steps, late ticks do not add up over a macro\n",
+    stamped - wrongStamp, stamped);
+  ok = ok && wrongStamp == 0 && missing == 0 && sequencer.dropped() == 0 && lateUs.percentile(99) <= MACROS_BLOCK_MAX_US
+    && sequencer.maxLateMs() == maxLateMs && pressUs.max() < 1000 * durationMs && driftMs.max() > maxLateMs;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file bench_main.cpp
+ * @brief Entry point of the host (env:native) benchmarks.
+ *
+ * @details Build and run all benchmarks with: pio run -e native -t exec
+ * or run a single one: .pio/build/native/program <name> [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "bench.h"
+
+// ~ allocation counter ~
+unsigned long __allocations = 0;
+
+void* operator new(size_t size) {
+  __allocations++;
+  void* p = malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct benchEntry {
+  const char* name;
+  int (*run)(long iterations);
+  long iterations;
+};
+
+static const benchEntry __benches[] = {
+  { "engine", benchEngine, 200000 },
+  { "blemidi", benchBleMidi, 2000000 },
+  { "timestamps", benchTimestamps, 200 },
+  { "latency", benchLatency, 20 },
+  { "persist", benchPersist, 1 },
+  { "config", benchConfig, 100000 },
+  { "mapcodec", benchMapCodec, 100000 },
+  { "ota", benchOta, 256 },
+  { "resume", benchResume, 150 },
+  { "delta", benchDelta, 5 },
+  { "manifest", benchManifest, 100000 },
+  { "webui", benchWebUi, 100000 },
+  { "fields", benchFields, 1000000 },
+  { "records", benchRecords, 1000000 },
+  { "banks", benchBanks, 5000 },
+  { "presets", benchPresets, 1000 },
+  { "macros", benchMacros, 2000 },
+  { "midiin", benchMidiIn, 200000 },
+  { "feedback", benchFeedback, 2000000 },
+};
+
+int main(int argc, char** argv) {
+
+  const char* only = argc > 1 ? argv[1] : nullptr;
+  long iterations = argc > 2 ? atol(argv[2]) : 0;
+  int result = 0;
+  bool found = false;
+
+  for (const benchEntry& bench : __benches) {
+    if (only && strcmp(only, bench.name) != 0) continue;
+    found = true;
+    printf("== %s ==\n", bench.name);
+    result |= bench.run(iterations > 0 ? iterations : bench.iterations);
+    printf("\n");
+  }
+  if (!found) {
+    printf("unknown benchmark: %s\n", only);
+    return 1;
+  }
+  return result;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file bench_manifest.cpp
+ * @brief Host (env:native) update manifest parser: pieces of any size, broken manifests, timing.
+ *
+ * @details The manifest in bin/ (tools/mkmanifest.py) must parse to the SHA-256 of the
+ * latest image, and the result must not depend on how the body is split into reads.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "bench.h"
+#include "update_manifest.h"
+
+static const char* SAMPLE =
+  "# Little Helper update manifest\r\n"
+  "version 11\r\n"
+  "size 1270416\r\n"
+  "sha256 bcb725dabd6aa17ee34e7fd8fc334838001c35d7e2abb16036a23302bd1f99e8\r\n"
+  "channel beta\r\n"          // unknown to this firmware, skipped
+  "delta 10 99619\r\n"
+  "delta 8 154000\r\n"
+  "\r\n";
+
+// whole body split into reads of at most piece bytes
+static my_manifest_result parse(const char* text, size_t len, size_t piece, myUpdateManifest& manifest) {
+  UpdateManifestParser parser;
+  for (size_t pos = 0; pos < len; pos += piece) {
+    if (!parser.feed((const uint8_t*)text + pos, len - pos < piece ? len - pos : piece)) break;
+  }
+  my_manifest_result result = parser.finish();
+  manifest = parser.manifest();
+  return result;
+}
+
+static my_manifest_result parse(const char* text, myUpdateManifest& manifest) {
+  return parse(text, strlen(text), 1460, manifest);
+}
+
+int benchManifest(long iterations) {
+
+  myUpdateManifest manifest, other;
+  bool ok = true;
+
+  // every split gives the same manifest
+  bool splitsOk = true;
+  for (size_t piece = 1; piece <= strlen(SAMPLE); piece++) {
+    splitsOk = splitsOk && parse(SAMPLE, strlen(SAMPLE), piece, other) == MANIFEST_OK && other.version == 11
+      && other.size == 1270416 && other.hasHash && other.hash[0] == 0xbc && other.hash[31] == 0xe8 && other.deltas == 2;
+  }
+  // a device on V8 skips V9 and V10 and takes the V8 -> V11 patch, V9 has none
+  bool skipOk = parse(SAMPLE, manifest) == MANIFEST_OK && manifestDeltaFrom(manifest, 8) != nullptr
+    && manifestDeltaFrom(manifest, 8)->size == 154000 && manifestDeltaFrom(manifest, 9) == nullptr;
+  bool noNewline = parse("version 9\nsize 100", manifest) == MANIFEST_OK && manifest.size == 100 && !manifest.hasHash;
+
+  struct { const char* text; my_manifest_result expected; } broken[] = {
+    { "size 100\n", MANIFEST_INCOMPLETE },
+    { "version 9\n", MANIFEST_INCOMPLETE },
+    { "", MANIFEST_INCOMPLETE },
+    { "version nine\nsize 100\n", MANIFEST_BAD_LINE },
+    { "version 9 10\nsize 100\n", MANIFEST_BAD_LINE },
+    { "version 99999999999\nsize 100\n", MANIFEST_BAD_LINE },
+    { "version 9\nsize 0\n", MANIFEST_BAD_LINE },
+    { "version 9\nsize 100\nsha256 bcb725\n", MANIFEST_BAD_LINE },
+    { "version 9\nsize 100\ndelta 8\n", MANIFEST_BAD_LINE },
+    { "<html>\x01</html>\n", MANIFEST_BAD_LINE },
+  };
+  bool brokenOk = true;
+  for (auto& b : broken) {
+    my_manifest_result result = parse(b.text, manifest);
+    if (result != b.expected) {
+      printf("\"%s\": %s, expected %s\n", b.text, manifestResultName(result), manifestResultName(b.expected));
+      brokenOk = false;
+    }
+  }
+  std::string longLine = "version 9\nsize 100\n# " + std::string(MANIFEST_MAX_LINE, 'x') + "\n";
+  std::string page;
+  while (page.size() <= MANIFEST_MAX_SIZE) page += "# comment\n";
+  brokenOk = brokenOk && parse(longLine.c_str(), manifest) == MANIFEST_BAD_LINE
+    && parse(page.c_str(), manifest) == MANIFEST_TOO_LARGE;
+
+  // the published manifest
+  const char* path = "../bin/s3mini.manifest";
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) f = fopen(path = "bin/s3mini.manifest", "rb");
+  char published[MANIFEST_MAX_SIZE + 1] = "";
+  if (f) {
+    published[fread(published, 1, MANIFEST_MAX_SIZE, f)] = 0;
+    fclose(f);
+  }
+  my_manifest_result publishedResult = parse(published, other);
+  printf("%s: %s, version %lu, %lu bytes, sha256 %s, %u patch(es)\n", path, manifestResultName(publishedResult),
+    (unsigned long)other.version, (unsigned long)other.size, other.hasHash ? "yes" : "no", other.deltas);
+
+  unsigned long allocBefore = __allocations;
+  size_t len = strlen(SAMPLE);
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) parse(SAMPLE, len, 128, manifest);
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  unsigned long allocations = __allocations - allocBefore;
+
+  printf("all splits: %s, version skip: %s, no final newline: %s, broken rejected: %s\n", splitsOk ? "ok" : "FAIL",
+    skipOk ? "ok" : "FAIL", noNewline ? "ok" : "FAIL", brokenOk ? "ok" : "FAIL");
+  printf("%u byte manifest parsed in %.0f ns, %lu allocations\n", (unsigned)len, ns, allocations);
+  ok = splitsOk && skipOk && noNewline && brokenOk && publishedResult == MANIFEST_OK && allocations == 0;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file bench_mapcodec.cpp
+ * @brief Host (env:native) round trip, migration, corruption check and timing of the map record codec.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "bench.h"
+#include "map_codec.h"
+#include "crc32.h"
+
+#define MAPCODEC_BUTTONS 5
+
+static void setupButtons(myMapButton* buttons, uint8_t seed) {
+  memset(buttons, 0, sizeof(myMapButton) * MAPCODEC_BUTTONS);
+  for (int b = 0; b < MAPCODEC_BUTTONS; b++) {
+    uint8_t v = seed + b * 11;
+    buttons[b].needRelease = v & 1;
+    buttons[b].btnLongpress = (v >> 1) & 1;
+    buttons[b].btnFunction = (v >> 2) & 1;
+    buttons[b].btnMidiFunction = v % 4;
+    buttons[b].btnMidiChannel = v % 16;
+    buttons[b].btnMidiNote = v & 0x7F;
+    buttons[b].btnMidiVelocity = (v + 1) & 0x7F;
+    buttons[b].btnMidiCC = (v + 2) & 0x7F;
+    buttons[b].btnMidiCCValueStateOn = 127;
+    buttons[b].btnMidiCCValueStateOff = v & 0x3F;
+    buttons[b].btnMidiMMC = MMC_PLAY + v % 8;
+    buttons[b].btnColor = (v * 7) % BUTTON_PALETTE_SIZE;
+  }
+}
+
+// colors compare as RGB, some palette entries share one (Aqua and Cyan), a PC button migrated
+// from a version before 3 has no Bank Select
+static bool sameMap(const myMapButton* a, const myMapButton* b, bool migrated = false) {
+  for (int i = 0; i < MAPCODEC_BUTTONS; i++) {
+    bool noBank = migrated && a[i].btnMidiFunction == MIDI_PROGRAMCHANGE;
+    uint8_t on = noBank ? PC_BANK_NONE : a[i].btnMidiCCValueStateOn;
+    uint8_t off = noBank ? PC_BANK_NONE : a[i].btnMidiCCValueStateOff;
+    if (a[i].needRelease != b[i].needRelease || a[i].btnLongpress != b[i].btnLongpress
+      || a[i].btnFunction != b[i].btnFunction || a[i].btnMidiFunction != b[i].btnMidiFunction
+      || a[i].btnMidiChannel != b[i].btnMidiChannel || a[i].btnMidiNote != b[i].btnMidiNote
+      || a[i].btnMidiVelocity != b[i].btnMidiVelocity || a[i].btnMidiCC != b[i].btnMidiCC
+      || on != b[i].btnMidiCCValueStateOn || off != b[i].btnMidiCCValueStateOff
+      || a[i].btnMidiMMC != b[i].btnMidiMMC || paletteColor(a[i].btnColor) != paletteColor(b[i].btnColor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the fields of the older versions, one byte each in the order of version 1
+static void oldFields(const myMapButton& btn, uint8_t* v) {
+  const uint8_t fields[11] = { btn.needRelease, btn.btnFunction, btn.btnLongpress, btn.btnMidiFunction, btn.btnMidiChannel,
+    btn.btnMidiNote, btn.btnMidiVelocity, btn.btnMidiCC, btn.btnMidiCCValueStateOn, btn.btnMidiCCValueStateOff, btn.btnMidiMMC };
+  memcpy(v, fields, sizeof(fields));
+}
+
+static size_t finishRecord(uint8_t* record, size_t len) {
+  uint32_t crc = crc32(record, len);
+  record[len] = crc; record[len + 1] = crc >> 8; record[len + 2] = crc >> 16; record[len + 3] = crc >> 24;
+  return len + MAP_CODEC_CRC_SIZE;
+}
+
+int benchMapCodec(long iterations) {
+
+  static myMapButton maps[NUBER_OF_MAPS][MAPCODEC_BUTTONS];
+  static myMapButton loaded[MAPCODEC_BUTTONS];
+  for (uint8_t m = 0; m < NUBER_OF_MAPS; m++) setupButtons(maps[m], 7 + m * 3);
+  bool ok = true;
+
+  // round trip of every map
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  size_t len = 0;
+  for (uint8_t map = 0; map < NUBER_OF_MAPS; map++) {
+    setupButtons(loaded, 99);
+    len = encodeMap(maps[map], MAPCODEC_BUTTONS, map, record, sizeof(record));
+    my_map_codec_result result = decodeMap(record, len, map, loaded, MAPCODEC_BUTTONS);
+    if (result != MAP_CODEC_OK || memcmp(maps[map], loaded, sizeof(loaded)) != 0) {
+      printf("map %u round trip: %s\n", map, mapCodecResultName(result));
+      ok = false;
+    }
+  }
+  bool wrongMap = decodeMap(record, len, 0, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_WRONG_MAP;
+  bool tooSmall = encodeMap(maps[0], MAPCODEC_BUTTONS, 0, record, len - 1) == 0;
+
+  // version 0: the "Settings" blob, 68 bytes per button with the 4 maps as parallel arrays
+  static uint8_t v0[MAP_V0_SIZE];
+  memset(v0, 0, sizeof(v0));
+  const uint8_t v0Offsets[11] = { 1, 5, 9, 36, 40, 44, 48, 52, 56, 60, 64 };
+  for (int b = 0; b < MAPCODEC_BUTTONS; b++) {
+    uint8_t* p = v0 + b * (MAP_V0_SIZE / 5);
+    for (int m = 0; m < 4; m++) {
+      uint8_t v[11];
+      oldFields(maps[m][b], v);
+      for (int f = 0; f < 11; f++) p[v0Offsets[f] + m] = v[f];
+      uint32_t color = paletteColor(maps[m][b].btnColor);
+      p[20 + 4 * m] = color; p[21 + 4 * m] = color >> 8; p[22 + 4 * m] = color >> 16;
+    }
+  }
+  bool v0Migrated = true;
+  for (uint8_t map = 0; map < 4; map++) {
+    setupButtons(loaded, 99);
+    v0Migrated = v0Migrated && decodeMap(v0, sizeof(v0), map, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_MIGRATED
+      && sameMap(maps[map], loaded, true);
+  }
+  v0Migrated = v0Migrated && decodeMap(v0, sizeof(v0), 4, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_WRONG_MAP;
+
+  // version 1: raw 16 byte records per button as the first per map records stored them
+  const uint8_t map = 1;
+  const myMapButton* source = maps[map];
+  uint8_t v1[80];
+  memset(v1, 0, sizeof(v1));
+  for (int b = 0; b < MAPCODEC_BUTTONS; b++) {
+    uint8_t* p = v1 + b * 16;
+    oldFields(source[b], p);
+    uint32_t color = paletteColor(source[b].btnColor);
+    p[12] = color; p[13] = color >> 8; p[14] = color >> 16; p[15] = color >> 24;
+  }
+  setupButtons(loaded, 99);
+  bool v1Migrated = decodeMap(v1, sizeof(v1), map, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_MIGRATED
+    && sameMap(source, loaded, true);
+
+  // version 2: 13 bytes per button, one per field and the color as R G B
+  uint8_t v2[MAP_CODEC_HEADER_SIZE + MAPCODEC_BUTTONS * 13 + MAP_CODEC_CRC_SIZE];
+  const uint8_t v2Header[MAP_CODEC_HEADER_SIZE] = { 'L', 'M', 2, map, MAPCODEC_BUTTONS, 13, MAPCODEC_BUTTONS * 13, 0 };
+  memcpy(v2, v2Header, sizeof(v2Header));
+  for (int b = 0; b < MAPCODEC_BUTTONS; b++) {
+    uint8_t* p = v2 + MAP_CODEC_HEADER_SIZE + b * 13;
+    uint8_t v[11];
+    oldFields(source[b], v);
+    uint32_t color = paletteColor(source[b].btnColor);
+    const uint8_t fields[13] = { uint8_t(v[0] | v[2] << 1), v[1], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
+      uint8_t(color >> 16), uint8_t(color >> 8), uint8_t(color) };
+    memcpy(p, fields, sizeof(fields));
+  }
+  size_t v2Len = finishRecord(v2, MAP_CODEC_HEADER_SIZE + MAPCODEC_BUTTONS * 13);
+  setupButtons(loaded, 99);
+  bool v2Migrated = decodeMap(v2, v2Len, map, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_MIGRATED
+    && sameMap(source, loaded, true);
+
+  // an older firmware without the color field: the color keeps its current value
+  len = encodeMap(source, MAPCODEC_BUTTONS, map, record, sizeof(record));
+  uint8_t older[MAP_CODEC_MAX_SIZE];
+  const uint8_t olderSize = MAP_FIELD_COLOR;
+  memcpy(older, record, MAP_CODEC_HEADER_SIZE);
+  older[5] = olderSize;
+  older[6] = MAPCODEC_BUTTONS * olderSize;
+  older[7] = 0;
+  for (int b = 0; b < MAPCODEC_BUTTONS; b++) {
+    memcpy(older + MAP_CODEC_HEADER_SIZE + b * olderSize, record + MAP_CODEC_HEADER_SIZE + b * MAP_CODEC_BUTTON_SIZE, olderSize);
+  }
+  size_t olderLen = finishRecord(older, MAP_CODEC_HEADER_SIZE + MAPCODEC_BUTTONS * olderSize);
+  setupButtons(loaded, 99);
+  uint8_t keptColor = loaded[0].btnColor;
+  bool olderMigrated = decodeMap(older, olderLen, map, loaded, MAPCODEC_BUTTONS) == MAP_CODEC_MIGRATED
+    && loaded[0].btnMidiNote == source[0].btnMidiNote && loaded[0].btnColor == keptColor;
+
+  // every single bit flip must be rejected
+  unsigned long accepted = 0;
+  for (size_t i = 0; i < len * 8; i++) {
+    record[i / 8] ^= 1 << (i % 8);
+    my_map_codec_result result = decodeMap(record, len, map, loaded, MAPCODEC_BUTTONS);
+    if (result == MAP_CODEC_OK || result == MAP_CODEC_MIGRATED) accepted++;
+    record[i / 8] ^= 1 << (i % 8);
+  }
+
+  unsigned long allocBefore = __allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    maps[map][0].btnMidiNote = i & 0x7F; // keep the compiler from hoisting the encode
+    encodeMap(maps[map], MAPCODEC_BUTTONS, map, record, sizeof(record));
+  }
+  auto stop = std::chrono::steady_clock::now();
+  double encodeNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    decodeMap(record, len, map, loaded, MAPCODEC_BUTTONS);
+  }
+  stop = std::chrono::steady_clock::now();
+  double decodeNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+  unsigned long allocations = __allocations - allocBefore;
+
+  printf("record %u bytes for %d buttons, encode %.0f ns, decode %.0f ns, %lu allocations\n",
+    (unsigned)len, MAPCODEC_BUTTONS, encodeNs, decodeNs, allocations);
+  printf("v0 migrated: %s, v1 migrated: %s, v2 migrated: %s, older button size migrated: %s\n",
+    v0Migrated ? "yes" : "no", v1Migrated ? "yes" : "no", v2Migrated ? "yes" : "no", olderMigrated ? "yes" : "no");
+  printf("wrong map rejected: %s, small buffer rejected: %s\n", wrongMap ? "yes" : "no", tooSmall ? "yes" : "no");
+  printf("bit flips accepted: %lu of %u\n", accepted, (unsigned)len * 8);
+  ok = ok && v0Migrated && v1Migrated && v2Migrated && olderMigrated && wrongMap && tooSmall && accepted == 0 && allocations == 0;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,311 @@
+/**
+ * @file bench_midi_in.cpp
+ * @brief Host (env:native) incoming BLE-MIDI: the MidiInQueue decoder and the BT stack task -> input task handoff.
+ *
+ * @details Random message streams (channel messages, real time, SysEx over several packets)
+ * go through BleMidiPacketBuilder and are decoded by MidiInQueue and by the host
+ * BleMidiDecoder, both must agree. Hand made packets cover real time bytes inside a SysEx,
+ * running status without a timestamp byte, broken packets and SysEx too long for the queue.
+ * Then a producer thread floods the queue the way the BT stack task does while a consumer
+ * thread drains it with pauses like the input task: every message that was not counted as
+ * dropped must arrive once, in order and unchanged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "ble_midi_decoder.h"
+#include "midi_in_queue.h"
+
+static uint32_t __midiInSeed = 0x2545F491;
+
+static uint32_t nextRandom() {
+  __midiInSeed ^= __midiInSeed << 13;
+  __midiInSeed ^= __midiInSeed >> 17;
+  __midiInSeed ^= __midiInSeed << 5;
+  return __midiInSeed;
+}
+
+// every built packet goes to both decoders
+class BothDecoders : public BleMidiPacketSink {
+public:
+  BleMidiDecoder decoder;
+  MidiInQueue queue;
+  std::vector<myMidiIn> received; // drained after every packet, a packet never fills the queue
+  uint32_t packets = 0;
+  uint32_t rejected = 0;
+
+  void sendPacket(const uint8_t* packet, uint8_t len) override {
+    decoder.sendPacket(packet, len);
+    if (!queue.receive(packet, len)) rejected++;
+    myMidiIn message;
+    while (queue.pop(message)) received.push_back(message);
+    packets++;
+  }
+};
+
+// one random message, SysEx up to 24 bytes
+static size_t randomMessage(uint8_t* bytes) {
+  uint32_t r = nextRandom();
+  switch (r % 8) {
+    case 0: bytes[0] = 0xF8 + (r >> 8) % 5; return 1; // clock, start, continue, stop
+    case 1: {
+      size_t len = 3 + (r >> 8) % 22;
+      bytes[0] = 0xF0;
+      for (size_t i = 1; i < len - 1; i++) bytes[i] = nextRandom() & 0x7F;
+      bytes[len - 1] = 0xF7;
+      return len;
+    }
+    case 2: bytes[0] = 0xC0 | ((r >> 8) & 0x0F); bytes[1] = (r >> 12) & 0x7F; return 2;
+    default: {
+      static const uint8_t kinds[] = { 0x80, 0x90, 0xB0, 0xB0, 0xE0 };
+      bytes[0] = kinds[(r >> 8) % 5] | ((r >> 12) & 0x01); // two channels, so running status happens
+      bytes[1] = (r >> 16) & 0x7F;
+      bytes[2] = (r >> 24) & 0x7F;
+      return 3;
+    }
+  }
+}
+
+static bool checkDecode(long messages) {
+  BothDecoders both;
+  BleMidiPacketBuilder builder(both);
+  uint16_t timestamp = 0;
+  uint32_t compared = 0, oversized = 0, mismatches = 0;
+
+  for (long m = 0; m < messages; m++) {
+    if (m % 64 == 0) builder.setMtu(23 + nextRandom() % 80);
+    uint8_t bytes[24];
+    size_t len = randomMessage(bytes);
+    timestamp += nextRandom() % 3;
+    builder.add(bytes, len, timestamp);
+    if (m % 5 == 4) builder.flush();
+
+    // the decoder keeps BLE_MIDI_DECODER_MAX_MESSAGES, compare before it fills up
+    if (both.decoder.count() < BLE_MIDI_DECODER_MAX_MESSAGES / 2 && m + 1 < messages) continue;
+    builder.flush();
+    size_t next = 0;
+    for (uint16_t i = 0; i < both.decoder.count(); i++) {
+      const myDecodedMidi& expected = both.decoder.message(i);
+      if (expected.len > MIDI_IN_MAX_BYTES) {
+        oversized++;
+        continue;
+      }
+      if (next >= both.received.size()) {
+        mismatches++;
+        continue;
+      }
+      const myMidiIn& got = both.received[next++];
+      if (got.len != expected.len || got.timestamp != expected.timestamp || memcmp(got.bytes, expected.bytes, got.len) != 0) {
+        mismatches++;
+      }
+      compared++;
+    }
+    mismatches += both.received.size() - next;
+    both.received.clear();
+    both.decoder.clear();
+  }
+  bool ok = mismatches == 0 && both.rejected == 0 && both.decoder.errors() == 0
+    && both.queue.oversized() == oversized && both.queue.dropped() == 0;
+  printf("decode: %u packets, %u messages equal to BleMidiDecoder, %u oversized SysEx, %u mismatches %s\n",
+    both.packets, compared, oversized, mismatches, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool expectMessages(MidiInQueue& queue, const char* name, const uint8_t* packet, size_t len, bool valid,
+  const uint8_t* const* messages, const uint8_t* lens, uint8_t count) {
+  bool ok = queue.receive(packet, len) == valid;
+  for (uint8_t i = 0; i < count; i++) {
+    myMidiIn got;
+    if (!queue.pop(got) || got.len != lens[i] || memcmp(got.bytes, messages[i], lens[i]) != 0) ok = false;
+  }
+  myMidiIn extra;
+  if (queue.pop(extra)) ok = false;
+  printf("%-34s %s\n", name, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+static bool checkPackets() {
+  MidiInQueue queue;
+  bool ok = true;
+
+  // a clock inside an MMC SysEx comes out first, the SysEx stays whole
+  static const uint8_t rtInSysEx[] = { 0x80, 0x81, 0xF0, 0x7F, 0x7F, 0x82, 0xF8, 0x06, 0x02, 0x83, 0xF7 };
+  static const uint8_t clock[] = { 0xF8 };
+  static const uint8_t mmcPlay[] = { 0xF0, 0x7F, 0x7F, 0x06, 0x02, 0xF7 };
+  const uint8_t* rtOut[] = { clock, mmcPlay };
+  const uint8_t rtLens[] = { 1, 6 };
+  ok &= expectMessages(queue, "real time inside SysEx", rtInSysEx, sizeof(rtInSysEx), true, rtOut, rtLens, 2);
+
+  // ts B0 07 64, 08 65 without a timestamp byte, ts 09 66 with one
+  static const uint8_t running[] = { 0x80, 0x81, 0xB0, 0x07, 0x64, 0x08, 0x65, 0x82, 0x09, 0x66 };
+  static const uint8_t cc7[] = { 0xB0, 0x07, 0x64 }, cc8[] = { 0xB0, 0x08, 0x65 }, cc9[] = { 0xB0, 0x09, 0x66 };
+  const uint8_t* runOut[] = { cc7, cc8, cc9 };
+  const uint8_t runLens[] = { 3, 3, 3 };
+  ok &= expectMessages(queue, "running status", running, sizeof(running), true, runOut, runLens, 3);
+
+  // SysEx split over two packets, the second starts with data bytes
+  static const uint8_t split1[] = { 0x80, 0x81, 0xF0, 0x7F, 0x7F };
+  static const uint8_t split2[] = { 0x80, 0x06, 0x02, 0x82, 0xF7 };
+  ok &= expectMessages(queue, "SysEx first packet", split1, sizeof(split1), true, nullptr, nullptr, 0);
+  const uint8_t* splitOut[] = { mmcPlay };
+  const uint8_t splitLens[] = { 6 };
+  ok &= expectMessages(queue, "SysEx continuation packet", split2, sizeof(split2), true, splitOut, splitLens, 1);
+
+  // SysEx over three packets, the middle one is a header and one data byte, a Program Change follows
+  static const uint8_t three1[] = { 0x80, 0x81, 0xF0, 0x7D };
+  static const uint8_t three2[] = { 0x80, 0x01 };
+  static const uint8_t three3[] = { 0x80, 0x02, 0x82, 0xF7, 0x82, 0xC0, 0x01 };
+  static const uint8_t sysEx3[] = { 0xF0, 0x7D, 0x01, 0x02, 0xF7 };
+  static const uint8_t pc1[] = { 0xC0, 0x01 };
+  ok &= expectMessages(queue, "SysEx 1/3", three1, sizeof(three1), true, nullptr, nullptr, 0);
+  ok &= expectMessages(queue, "SysEx 2/3, header and data only", three2, sizeof(three2), true, nullptr, nullptr, 0);
+  const uint8_t* threeOut[] = { sysEx3, pc1 };
+  const uint8_t threeLens[] = { 5, 2 };
+  ok &= expectMessages(queue, "SysEx 3/3, Program Change after", three3, sizeof(three3), true, threeOut, threeLens, 2);
+
+  // the message before the broken byte is kept, the parser starts over with the next packet
+  static const uint8_t broken[] = { 0x80, 0x81, 0xC0, 0x05, 0x82, 0x90, 0x3C };
+  static const uint8_t pc5[] = { 0xC0, 0x05 };
+  const uint8_t* brokenOut[] = { pc5 };
+  const uint8_t brokenLens[] = { 2 };
+  ok &= expectMessages(queue, "truncated note", broken, sizeof(broken), false, brokenOut, brokenLens, 1);
+  static const uint8_t noStatus[] = { 0x80, 0x81, 0x07, 0x64 };
+  ok &= expectMessages(queue, "data without status", noStatus, sizeof(noStatus), false, nullptr, nullptr, 0);
+  static const uint8_t cccd[] = { 0x01, 0x00 };
+  ok &= expectMessages(queue, "notify descriptor write", cccd, sizeof(cccd), false, nullptr, nullptr, 0);
+
+  // a SysEx longer than MIDI_IN_MAX_BYTES is counted, the note after it arrives
+  uint8_t longSysEx[40] = { 0x80, 0x81, 0xF0 };
+  size_t len = 3;
+  for (uint8_t i = 0; i < MIDI_IN_MAX_BYTES + 4; i++) longSysEx[len++] = i;
+  longSysEx[len++] = 0x82;
+  longSysEx[len++] = 0xF7;
+  longSysEx[len++] = 0x83;
+  longSysEx[len++] = 0x90;
+  longSysEx[len++] = 0x3C;
+  longSysEx[len++] = 0x7F;
+  static const uint8_t noteOn[] = { 0x90, 0x3C, 0x7F };
+  const uint8_t* longOut[] = { noteOn };
+  const uint8_t longLens[] = { 3 };
+  ok &= expectMessages(queue, "oversized SysEx", longSysEx, len, true, longOut, longLens, 1);
+
+  ok &= queue.oversized() == 1 && queue.malformed() == 3 && queue.dropped() == 0;
+  printf("counters: %u received, %u oversized, %u malformed %s\n", (unsigned)queue.received(),
+    (unsigned)queue.oversized(), (unsigned)queue.malformed(), ok ? "ok" : "WRONG");
+  return ok;
+}
+
+// sequence number -> message, a CC or every 8th a SysEx, both carry 18 bits of it
+#define SEQ_MAX (1u << 18)
+
+class PacketList : public BleMidiPacketSink {
+public:
+  std::vector<uint8_t> bytes;
+  std::vector<uint32_t> offsets;
+  void sendPacket(const uint8_t* packet, uint8_t len) override {
+    offsets.push_back(bytes.size());
+    bytes.insert(bytes.end(), packet, packet + len);
+  }
+};
+
+static size_t seqMessage(uint32_t seq, uint8_t* bytes) {
+  if (seq % 8 == 7) {
+    const uint8_t sysEx[] = { 0xF0, 0x7D, (uint8_t)(seq & 0x7F), (uint8_t)((seq >> 7) & 0x7F), (uint8_t)(seq >> 14), 0xF7 };
+    memcpy(bytes, sysEx, sizeof(sysEx));
+    return sizeof(sysEx);
+  }
+  bytes[0] = 0xB0 | ((seq >> 14) & 0x0F);
+  bytes[1] = (seq >> 7) & 0x7F;
+  bytes[2] = seq & 0x7F;
+  return 3;
+}
+
+static bool seqOf(const myMidiIn& m, uint32_t& seq) {
+  if (m.len == 6 && m.bytes[0] == 0xF0 && m.bytes[1] == 0x7D && m.bytes[5] == 0xF7) {
+    seq = m.bytes[2] | (m.bytes[3] << 7) | (m.bytes[4] << 14);
+    return seq % 8 == 7;
+  }
+  if (m.len != 3 || (m.bytes[0] & 0xF0) != 0xB0) return false;
+  seq = ((m.bytes[0] & 0x0F) << 14) | (m.bytes[1] << 7) | m.bytes[2];
+  return seq % 8 != 7;
+}
+
+// One producer thread receives the packets like the BT stack task, one consumer drains the
+// queue like the input task. The producer pauses after every pacePackets packets, the
+// consumer after every pauseMessages messages, 0 = never.
+static bool flood(const char* name, const PacketList& packets, uint32_t messages, uint32_t pacePackets, uint32_t pauseMessages) {
+  MidiInQueue queue;
+  std::atomic<bool> done(false);
+  uint32_t consumed = 0, outOfOrder = 0, corrupt = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&] {
+    uint32_t next = 0;
+    for (;;) {
+      myMidiIn m;
+      if (!queue.pop(m)) {
+        if (done.load(std::memory_order_acquire) && queue.empty()) break;
+        std::this_thread::yield();
+        continue;
+      }
+      uint32_t seq;
+      if (!seqOf(m, seq)) {
+        corrupt++;
+        continue;
+      }
+      // gaps are the dropped messages, anything before the next one is wrong
+      if (seq < next) outOfOrder++;
+      next = seq + 1;
+      consumed++;
+      if (pauseMessages && consumed % pauseMessages == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  });
+
+  size_t count = packets.offsets.size();
+  for (size_t p = 0; p < count; p++) {
+    size_t end = p + 1 < count ? packets.offsets[p + 1] : packets.bytes.size();
+    queue.receive(&packets.bytes[packets.offsets[p]], end - packets.offsets[p]);
+    if (pacePackets && (p + 1) % pacePackets == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  auto produced = std::chrono::steady_clock::now();
+  done.store(true, std::memory_order_release);
+  consumer.join();
+
+  double ns = std::chrono::duration<double, std::nano>(produced - start).count() / count;
+  bool ok = queue.received() + queue.dropped() == messages && consumed == queue.received() && outOfOrder == 0
+    && corrupt == 0 && queue.malformed() == 0 && queue.highWater() <= MidiInQueue::capacity()
+    && (pauseMessages == 0 || (queue.dropped() > 0 && queue.highWater() == MidiInQueue::capacity()));
+  printf("%-8s %u messages in %u packets, %.0f ns/packet in the producer, %u consumed, %u dropped, high water %u/%u, "
+    "%u out of order, %u corrupt %s\n", name, messages, (unsigned)count, ns, consumed, (unsigned)queue.dropped(),
+    (unsigned)queue.highWater(), (unsigned)MidiInQueue::capacity(), outOfOrder, corrupt, ok ? "ok" : "WRONG");
+  return ok;
+}
+
+int benchMidiIn(long iterations) {
+  bool ok = checkDecode(20000);
+  ok &= checkPackets();
+
+  // the flood, built up front so the producer does nothing but receive()
+  PacketList packets;
+  BleMidiPacketBuilder builder(packets);
+  builder.setMtu(64);
+  uint32_t messages = iterations < (long)SEQ_MAX ? (uint32_t)iterations : SEQ_MAX;
+  for (uint32_t seq = 0; seq < messages; seq++) {
+    uint8_t bytes[8];
+    size_t len = seqMessage(seq, bytes);
+    builder.add(bytes, len, (uint16_t)(seq / 16));
+  }
+  builder.flush();
+
+  ok &= flood("flood", packets, messages, 0, 0);
+  ok &= flood("paced", packets, messages, 1, 0);       // a packet at most every 50 us, the consumer keeps up
+  ok &= flood("stalled", packets, messages, 0, 64); // the consumer stalls, the queue overflows
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file bench_ota.cpp
+ * @brief Host (env:native) OTA download -> flash write, serial vs. reader/writer threads on the block ring.
+ *
+ * @details The network delivers TCP segments at a fixed rate, the flash takes a fixed time
+ * per sector, both simulated with sleeps. The serial run reads and writes in one loop like
+ * the former justotaUpdate(), the pipelined run uses OtaBlockRing between a reader and a
+ * writer thread like otaReaderTask/otaWriterTask. The written image must match the source.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "bench.h"
+#include "crc32.h"
+#include "ota_ring.h"
+
+#define OTA_SEGMENT 1460
+#define OTA_NET_KBPS 500    // network rate
+#define OTA_FLASH_KBPS 400  // erase + write rate
+
+static void sleepFor(size_t bytes, unsigned kbps) {
+  std::this_thread::sleep_for(std::chrono::microseconds(bytes * 1000000ull / (kbps * 1024ull)));
+}
+
+// network stand-in: hands out the image in segments at OTA_NET_KBPS
+class SimStream {
+public:
+  SimStream(const std::vector<uint8_t>& image) : _image(image), _pos(0) {}
+  size_t read(uint8_t* buf, size_t size) {
+    size_t n = _image.size() - _pos;
+    if (n > OTA_SEGMENT) n = OTA_SEGMENT;
+    if (n > size) n = size;
+    sleepFor(n, OTA_NET_KBPS);
+    memcpy(buf, &_image[_pos], n);
+    _pos += n;
+    return n;
+  }
+private:
+  const std::vector<uint8_t>& _image;
+  size_t _pos;
+};
+
+// flash stand-in: OTA_FLASH_KBPS, keeps what was written
+static void flashWrite(std::vector<uint8_t>& flash, const uint8_t* data, size_t len) {
+  sleepFor(len, OTA_FLASH_KBPS);
+  flash.insert(flash.end(), data, data + len);
+}
+
+static double runSerial(const std::vector<uint8_t>& image, std::vector<uint8_t>& flash) {
+  SimStream stream(image);
+  uint8_t buff[128];
+  auto start = std::chrono::steady_clock::now();
+  while (flash.size() < image.size()) {
+    size_t n = stream.read(buff, sizeof(buff));
+    flashWrite(flash, buff, n);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double runPipelined(const std::vector<uint8_t>& image, std::vector<uint8_t>& flash, uint32_t& readerStalls, uint32_t& writerStalls) {
+  static uint8_t storage[OTA_RING_BLOCKS * OTA_RING_BLOCK_SIZE];
+  OtaBlockRing ring(storage, OTA_RING_BLOCKS, OTA_RING_BLOCK_SIZE);
+  SimStream stream(image);
+  std::atomic<bool> readerDone(false);
+  uint32_t total = image.size();
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread reader([&] {
+    uint32_t received = 0;
+    while (received < total) {
+      uint8_t* block = ring.acquire();
+      if (block == nullptr) {
+        ring.readerStalled();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        continue;
+      }
+      uint16_t want = total - received < ring.blockSize() ? total - received : ring.blockSize();
+      uint16_t len = 0;
+      while (len < want) len += stream.read(block + len, want - len);
+      ring.commit(len);
+      received += len;
+    }
+    readerDone = true;
+  });
+  while (flash.size() < total) {
+    uint16_t len;
+    const uint8_t* block = ring.peek(len);
+    if (block == nullptr) {
+      if (readerDone && ring.filled() == 0) break;
+      ring.writerStalled();
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      continue;
+    }
+    flashWrite(flash, block, len);
+    ring.release();
+  }
+  reader.join();
+  readerStalls = ring.readerStalls();
+  writerStalls = ring.writerStalls();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int benchOta(long iterations) {
+
+  // iterations = image size in KB
+  std::vector<uint8_t> image(iterations * 1024);
+  uint32_t seed = 0x2468ace;
+  for (uint8_t& b : image) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    b = seed;
+  }
+  uint32_t crc = crc32(image.data(), image.size());
+  double kb = image.size() / 1024.0;
+
+  std::vector<uint8_t> flash;
+  flash.reserve(image.size());
+  double serialS = runSerial(image, flash);
+  bool serialOk = flash.size() == image.size() && crc32(flash.data(), flash.size()) == crc;
+
+  flash.clear();
+  uint32_t readerStalls = 0, writerStalls = 0;
+  double pipeS = runPipelined(image, flash, readerStalls, writerStalls);
+  bool pipeOk = flash.size() == image.size() && crc32(flash.data(), flash.size()) == crc;
+
+  printf("network %u KB/s, flash %u KB/s, %.0f KB image, %d x %d byte blocks\n",
+    OTA_NET_KBPS, OTA_FLASH_KBPS, kb, OTA_RING_BLOCKS, OTA_RING_BLOCK_SIZE);
+  printf("%-10s %8s %8s %s\n", "mode", "seconds", "KB/s", "image");
+  printf("%-10s %8.2f %8.0f %s\n", "serial", serialS, kb / serialS, serialOk ? "ok" : "CORRUPT");
+  printf("%-10s %8.2f %8.0f %s\n", "pipelined", pipeS, kb / pipeS, pipeOk ? "ok" : "CORRUPT");
+  printf("ring stalls: reader %u, writer %u\n", readerStalls, writerStalls);
+  bool ok = serialOk && pipeOk;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
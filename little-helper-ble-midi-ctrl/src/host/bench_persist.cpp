@@ -0,0 +1,102 @@
+/**
+ * @file bench_persist.cpp
+ * @brief Host (env:native) NVS write count of typical web UI sessions, write-behind vs. per change.
+ *
+ * @details Replays web UI change traces (slider drag, clicking through one button, editing
+ * every map) through WriteBehind with a loop() pass every ms and counts the records and
+ * bytes that would be written, compared with the former full myBtnMap blob (MAP_V0_SIZE) per change.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "map_codec.h"
+#include "write_behind.h"
+
+struct uiChange {
+  uint32_t atMs;
+  uint8_t map;
+  uint8_t btn;
+  uint8_t color; // palette index
+};
+
+#define PERSIST_BUTTONS 5
+#define PERSIST_MAPS 8 // maps edited in a session, one write-behind record each
+
+// store stand-in: remembers what a record holds, equal records are not written like in MapBankStore
+struct recordStore {
+  uint8_t stored[PERSIST_MAPS][MAP_CODEC_MAX_SIZE];
+  size_t len[PERSIST_MAPS] = {};
+};
+
+
+static void runSession(const char* name, const uiChange* changes, int n) {
+
+  static myMapButton buttons[PERSIST_MAPS][PERSIST_BUTTONS];
+  memset(buttons, 0, sizeof(buttons));
+  WriteBehind writer;
+  recordStore store; // what the banks hold at boot
+  for (uint8_t map = 0; map < PERSIST_MAPS; map++) {
+    store.len[map] = encodeMap(buttons[map], PERSIST_BUTTONS, map, store.stored[map], MAP_CODEC_MAX_SIZE);
+  }
+  int next = 0;
+  uint32_t end = changes[n - 1].atMs + WRITE_BEHIND_MAX_DELAY_MS + 1;
+
+  for (uint32_t now = 0; now <= end; now++) {
+    while (next < n && changes[next].atMs == now) {
+      buttons[changes[next].map][changes[next].btn].btnColor = changes[next].color;
+      writer.markDirty(changes[next].map, now);
+      next++;
+    }
+    uint32_t maps = writer.due(now);
+    for (uint8_t map = 0; map < PERSIST_MAPS; map++) {
+      if (!(maps & (1u << map))) continue;
+      uint8_t record[MAP_CODEC_MAX_SIZE];
+      size_t len = encodeMap(buttons[map], PERSIST_BUTTONS, map, record, sizeof(record));
+      if (len == store.len[map] && memcmp(record, store.stored[map], len) == 0) {
+        writer.unchanged();
+        continue;
+      }
+      memcpy(store.stored[map], record, len);
+      store.len[map] = len;
+      writer.written(len);
+    }
+  }
+  printf("%-22s %8d %8u %8u %10u %12lu\n", name, n, (unsigned)writer.writes(), (unsigned)writer.bytes(),
+    (unsigned)writer.skipped(), (unsigned long)n * MAP_V0_SIZE);
+}
+
+int benchPersist(long) {
+
+  static uiChange changes[512];
+  printf("%-22s %8s %8s %8s %10s %12s\n", "session", "changes", "writes", "bytes", "unchanged", "bytes before");
+
+  // color slider dragged over 140 colors, one change every 30ms
+  for (int i = 0; i < 140; i++) changes[i] = { (uint32_t)(1000 + i * 30), 0, 0, (uint8_t)i };
+  runSession("slider drag", changes, 140);
+
+  // slider dragged back and forth for 25s, the max delay saves it in between
+  for (int i = 0; i < 500; i++) changes[i] = { (uint32_t)(1000 + i * 50), 1, 2, (uint8_t)(i % 40) };
+  runSession("25s drag", changes, 500);
+
+  // one button, every field of it, a change every 2s
+  for (int i = 0; i < 12; i++) changes[i] = { (uint32_t)(1000 + i * 2000), 0, 3, (uint8_t)(i + 1) };
+  runSession("edit one button", changes, 12);
+
+  // every button of every map, 3s apart
+  int n = 0;
+  for (int map = 0; map < PERSIST_MAPS; map++) {
+    for (int b = 0; b < PERSIST_BUTTONS; b++) {
+      changes[n] = { (uint32_t)(1000 + n * 3000), (uint8_t)map, (uint8_t)b, (uint8_t)(n % BUTTON_PALETTE_SIZE + 1) };
+      n++;
+    }
+  }
+  runSession("all maps", changes, n);
+
+  // a value changed and changed back within the quiet time is not written at all
+  changes[0] = { 1000, 2, 0, PALETTE_Red };
+  changes[1] = { 1400, 2, 0, 0 };
+  runSession("change + undo", changes, 2);
+  return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file bench_presets.cpp
+ * @brief Host (env:native) read-only presets: image checks and boot cost of mapping vs. copying them.
+ *
+ * @details The image is built here like tools/mkpresets.py builds it. Copying the presets at
+ * boot reads every slot with esp_partition_read() (the flash cost model of bench_banks.cpp)
+ * and decodes all maps into the heap. Mapping the partition checks the header only, a map
+ * is decoded from its slot when the map cache loads it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "bench.h"
+#include "preset_image.h"
+#include "crc32.h"
+#include "button_config.h"
+
+#define PRESETS_BUTTONS 5
+#define PRESETS_READ_OP_US 20.0   // esp_partition_read() call
+#define PRESETS_READ_BYTE_US 0.05 // 20 MB/s
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static void presetMap(myMapButton* buttons, uint8_t map) {
+  memset(buttons, 0, sizeof(myMapButton) * PRESETS_BUTTONS);
+  for (int b = 0; b < PRESETS_BUTTONS; b++) {
+    uint8_t v = map * 7 + b;
+    buttons[b].btnMidiFunction = v % 3;
+    buttons[b].btnFunction = (v >> 1) & 1;
+    buttons[b].btnMidiChannel = v % 16;
+    buttons[b].btnMidiNote = v & 0x7F;
+    buttons[b].btnMidiVelocity = 90;
+    buttons[b].btnMidiCC = (v + 5) & 0x7F;
+    buttons[b].btnMidiCCValueStateOn = 127;
+    buttons[b].btnMidiMMC = MMC_STOP;
+    buttons[b].btnColor = v % BUTTON_PALETTE_SIZE;
+  }
+}
+
+// every map with a preset but the map empty, the layout of preset_image.h
+static std::vector<uint8_t> buildImage(uint16_t maps, uint8_t empty) {
+  std::vector<uint8_t> image(PRESET_HEADER_SIZE + (size_t)maps * PRESET_SLOT_SIZE, 0xFF);
+  uint8_t* h = image.data();
+  h[0] = 'L';
+  h[1] = 'P';
+  h[2] = PRESET_IMAGE_VERSION;
+  put16(h + 4, maps);
+  put16(h + 6, PRESET_SLOT_SIZE);
+  put32(h + 8, image.size());
+  put32(h + 12, crc32(h, 12));
+  for (uint16_t map = 0; map < maps; map++) {
+    if (map == empty) continue;
+    myMapButton buttons[PRESETS_BUTTONS];
+    presetMap(buttons, map);
+    encodeMap(buttons, PRESETS_BUTTONS, map, h + PRESET_HEADER_SIZE + map * PRESET_SLOT_SIZE, PRESET_SLOT_SIZE);
+  }
+  return image;
+}
+
+static bool samePreset(const myMapButton* buttons, uint8_t map) {
+  myMapButton expected[PRESETS_BUTTONS];
+  presetMap(expected, map);
+  return memcmp(buttons, expected, sizeof(expected)) == 0;
+}
+
+int benchPresets(long iterations) {
+  bool ok = true;
+  const uint8_t empty = 9;
+  std::vector<uint8_t> image = buildImage(NUBER_OF_MAPS, empty);
+
+  // ~ image ~
+  PresetImage presets;
+  bool attached = presets.attach(image.data(), 0x10000) && presets.maps() == NUBER_OF_MAPS
+    && presets.imageSize() == image.size();
+  bool all = attached;
+  myMapButton buttons[PRESETS_BUTTONS];
+  for (int map = 0; map < NUBER_OF_MAPS && all; map++) {
+    memset(buttons, 0, sizeof(buttons));
+    my_map_codec_result result = presets.load(map, buttons, PRESETS_BUTTONS);
+    all = map == empty ? result == MAP_CODEC_TOO_SHORT : result == MAP_CODEC_OK && samePreset(buttons, map);
+  }
+  all = all && presets.load(NUBER_OF_MAPS, buttons, PRESETS_BUTTONS) == MAP_CODEC_TOO_SHORT;
+
+  // an erased partition, a broken header or a cut image is no image
+  std::vector<uint8_t> erased(image.size(), 0xFF), magic = image, header = image;
+  magic[1] = 'X';
+  header[5] ^= 1;
+  PresetImage rejected;
+  bool rejects = !rejected.attach(erased.data(), erased.size()) && !rejected.attach(magic.data(), magic.size())
+    && !rejected.attach(header.data(), header.size()) && !rejected.attach(image.data(), image.size() - 1)
+    && !rejected.valid() && rejected.load(0, buttons, PRESETS_BUTTONS) == MAP_CODEC_TOO_SHORT;
+
+  // a broken slot keeps the buttons as they are, the defaults of the map
+  std::vector<uint8_t> corrupt = image;
+  corrupt[PRESET_HEADER_SIZE + 3 * PRESET_SLOT_SIZE + MAP_CODEC_HEADER_SIZE + 2] ^= 0x40;
+  PresetImage damaged;
+  damaged.attach(corrupt.data(), corrupt.size());
+  memset(buttons, 0, sizeof(buttons));
+  myMapButton untouched[PRESETS_BUTTONS];
+  memset(untouched, 0, sizeof(untouched));
+  my_map_codec_result damagedResult = damaged.load(3, buttons, PRESETS_BUTTONS);
+  bool kept = damagedResult == MAP_CODEC_BAD_CRC && memcmp(buttons, untouched, sizeof(buttons)) == 0
+    && damaged.load(4, buttons, PRESETS_BUTTONS) == MAP_CODEC_OK;
+  printf("%u maps in %u bytes, presets read back: %s, empty slot: no preset, rejected (erased, magic, header crc, cut): %s, "
+    "broken slot: %s\n", presets.maps(), presets.imageSize(), all ? "ok" : "FAIL", rejects ? "yes" : "no",
+    mapCodecResultName(damagedResult));
+  ok = ok && attached && all && rejects && kept;
+
+  // ~ boot ~
+  // copy: esp_partition_read() of every slot and all maps decoded into the heap
+  double copyFlashUs = 0;
+  unsigned long allocBefore = __allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    std::vector<myMapButton> maps(NUBER_OF_MAPS * PRESETS_BUTTONS);
+    uint8_t slot[PRESET_SLOT_SIZE];
+    copyFlashUs += PRESETS_READ_OP_US + PRESET_HEADER_SIZE * PRESETS_READ_BYTE_US;
+    for (int map = 0; map < NUBER_OF_MAPS; map++) {
+      memcpy(slot, image.data() + PRESET_HEADER_SIZE + map * PRESET_SLOT_SIZE, sizeof(slot));
+      copyFlashUs += PRESETS_READ_OP_US + sizeof(slot) * PRESETS_READ_BYTE_US;
+      size_t len = MAP_CODEC_HEADER_SIZE + (slot[6] | (slot[7] << 8)) + MAP_CODEC_CRC_SIZE;
+      if (slot[0] != 0xFF) decodeMap(slot, len, map, &maps[map * PRESETS_BUTTONS], PRESETS_BUTTONS);
+    }
+    if (maps[PRESETS_BUTTONS].btnMidiVelocity != 90) ok = false;
+  }
+  double copyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations
+    + copyFlashUs / iterations;
+  unsigned long copyAllocations = (__allocations - allocBefore) / iterations;
+  size_t copyHeap = sizeof(myMapButton) * PRESETS_BUTTONS * NUBER_OF_MAPS;
+
+  // map: the header check of attach(), a map is decoded in place by the map cache later
+  allocBefore = __allocations;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    PresetImage mapped;
+    if (!mapped.attach(image.data(), image.size())) ok = false;
+  }
+  double attachUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+  unsigned long attachAllocations = (__allocations - allocBefore) / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    if (presets.load(i % NUBER_OF_MAPS == empty ? 0 : i % NUBER_OF_MAPS, buttons, PRESETS_BUTTONS) != MAP_CODEC_OK) ok = false;
+  }
+  double loadNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  printf("%-22s %10s %10s %12s\n", "boot", "time us", "heap B", "allocations");
+  printf("%-22s %10.1f %10u %12lu\n", "copy all presets", copyUs, (unsigned)copyHeap, copyAllocations);
+  printf("%-22s %10.2f %10u %12lu\n", "map the partition", attachUs, 0u, attachAllocations);
+  printf("decode of one preset in place on a cache miss: %.0f ns\n", loadNs);
+  ok = ok && attachAllocations == 0 && attachUs < copyUs;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file bench_records.cpp
+ * @brief Host (env:native) button settings before and after the packed per map records: lookup, RAM, stored size.
+ *
+ * @details Before: myLegacyButton, every setting an array over 4 maps and the color as RGB,
+ * the UI got the color slider position back by a linear search of the 141 entry lookup
+ * table. After: one 8 byte myMapButton per map and button, the color a palette index.
+ * The lookup is what updateUiButtonFields() does for all buttons after a map change:
+ * every field of one map as the widgets show it. Cache lines are counted at 32 bytes,
+ * the ESP32-S3 data cache line.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <set>
+
+#include "bench.h"
+#include "button_fields.h"
+#include "map_codec.h"
+#include "midi_action_table.h"
+#include "legacy_handle_event.h"
+
+#define RECORDS_BUTTONS 5
+#define RECORDS_CACHE_LINE 32
+#define RECORDS_LEGACY_TABLE 141 // the former __btnLookUpTable, 140 colors and one 0 entry
+#define RECORDS_LEGACY_FIELDS 11 // the legacy layout has the first 11 of BUTTON_FIELDS
+
+static uint32_t __legacyTable[RECORDS_LEGACY_TABLE];
+
+// the former uiValue() of the color field
+static uint8_t legacyColorIndex(uint32_t color) {
+  for (uint16_t i = 0; i < RECORDS_LEGACY_TABLE; i++) {
+    if (__legacyTable[i] == color) return i;
+  }
+  return 0;
+}
+
+// every field of one map the legacy layout has, the order of BUTTON_FIELDS
+static uint32_t legacyMapView(const myLegacyButton* buttons, uint8_t map, int32_t* values) {
+  uint32_t sum = 0;
+  for (int b = 0; b < RECORDS_BUTTONS; b++, values += BUTTON_FIELD_COUNT) {
+    const myLegacyButton& btn = buttons[b];
+    values[0] = btn.btnMidiChannel[map];
+    values[1] = btn.btnMidiFunction[map];
+    values[2] = btn.btnMidiCC[map];
+    values[3] = btn.btnMidiCCValueStateOn[map];
+    values[4] = btn.btnMidiCCValueStateOff[map];
+    values[5] = btn.btnMidiNote[map];
+    values[6] = btn.btnMidiMMC[map];
+    values[7] = btn.btnMidiVelocity[map];
+    values[8] = btn.btnFunction[map];
+    values[9] = btn.needRelease[map];
+    values[10] = legacyColorIndex(btn.btnColor[map]);
+    sum += values[10];
+  }
+  return sum;
+}
+
+static uint32_t packedMapView(const ButtonFieldRegistry& fields, const myMapButton* buttons, int32_t* values) {
+  uint32_t sum = 0;
+  for (int b = 0; b < RECORDS_BUTTONS; b++, values += BUTTON_FIELD_COUNT) {
+    for (uint8_t f = 0; f < BUTTON_FIELD_COUNT; f++) values[f] = fields.uiValue(buttons[b], f);
+    sum += values[10];
+  }
+  return sum;
+}
+
+// 32 byte lines one map of the legacy layout touches, the arrays start on a line
+static size_t legacyCacheLines(const myLegacyButton* buttons, uint8_t map) {
+  std::set<uintptr_t> lines;
+  for (int b = 0; b < RECORDS_BUTTONS; b++) {
+    const myLegacyButton& btn = buttons[b];
+    const void* fields[] = { &btn.needRelease[map], &btn.btnFunction[map], &btn.btnLongpress[map], &btn.btnState[map],
+      &btn.btnColor[map], &btn.btnMidiFunction[map], &btn.btnMidiChannel[map], &btn.btnMidiNote[map],
+      &btn.btnMidiVelocity[map], &btn.btnMidiCC[map], &btn.btnMidiCCValueStateOn[map],
+      &btn.btnMidiCCValueStateOff[map], &btn.btnMidiMMC[map] };
+    for (const void* p : fields) lines.insert((uintptr_t)p / RECORDS_CACHE_LINE);
+  }
+  return lines.size();
+}
+
+// the same for one map of the packed layout, every byte of its buttons (bit fields have no address)
+static size_t packedCacheLines(const myMapButton* buttons) {
+  std::set<uintptr_t> lines;
+  const uint8_t* bytes = (const uint8_t*)buttons;
+  for (size_t i = 0; i < sizeof(myMapButton) * RECORDS_BUTTONS; i++) lines.insert((uintptr_t)(bytes + i) / RECORDS_CACHE_LINE);
+  return lines.size();
+}
+
+int benchRecords(long iterations) {
+
+  for (uint8_t i = 0; i < BUTTON_PALETTE_SIZE; i++) __legacyTable[i] = BUTTON_PALETTE[i];
+
+  alignas(RECORDS_CACHE_LINE) static myLegacyButton legacy[RECORDS_BUTTONS];
+  alignas(RECORDS_CACHE_LINE) static myMapButton maps[NUBER_OF_MAPS][RECORDS_BUTTONS];
+  static uint8_t states[NUBER_OF_MAPS][RECORDS_BUTTONS];
+  memset(legacy, 0, sizeof(legacy));
+  memset(maps, 0, sizeof(maps));
+  memset(states, 0, sizeof(states));
+  for (int b = 0; b < RECORDS_BUTTONS; b++) {
+    for (int m = 0; m < NUBER_OF_MAPS; m++) {
+      myMapButton& btn = maps[m][b];
+      btn.btnMidiFunction = (b + m) % 4;
+      btn.btnFunction = m & 1;
+      btn.needRelease = (b >> 1) & 1;
+      btn.btnMidiChannel = m;
+      btn.btnMidiNote = 60 + b;
+      btn.btnMidiVelocity = 100;
+      btn.btnMidiCC = 43 + b;
+      btn.btnMidiCCValueStateOn = 127;
+      btn.btnMidiMMC = MMC_PLAY;
+      // the colors the default maps use are far down the list, the legacy search walks most of it
+      btn.btnColor = (PALETTE_Red + 13 * b + m) % BUTTON_PALETTE_SIZE;
+      if (m >= LEGACY_MAPS) continue;
+      legacy[b].btnMidiFunction[m] = btn.btnMidiFunction;
+      legacy[b].btnFunction[m] = btn.btnFunction;
+      legacy[b].needRelease[m] = btn.needRelease;
+      legacy[b].btnMidiChannel[m] = btn.btnMidiChannel;
+      legacy[b].btnMidiNote[m] = btn.btnMidiNote;
+      legacy[b].btnMidiVelocity[m] = btn.btnMidiVelocity;
+      legacy[b].btnMidiCC[m] = btn.btnMidiCC;
+      legacy[b].btnMidiCCValueStateOn[m] = btn.btnMidiCCValueStateOn;
+      legacy[b].btnMidiMMC[m] = btn.btnMidiMMC;
+      legacy[b].btnColor[m] = paletteColor(btn.btnColor);
+    }
+  }
+  ButtonFieldRegistry fields;
+
+  // both show the same values for the maps the legacy layout has
+  int32_t legacyValues[RECORDS_BUTTONS * FIELD_MAX_SLOTS], packedValues[RECORDS_BUTTONS * FIELD_MAX_SLOTS];
+  bool same = BUTTON_FIELD_COUNT >= RECORDS_LEGACY_FIELDS;
+  for (uint8_t m = 0; m < LEGACY_MAPS && same; m++) {
+    legacyMapView(legacy, m, legacyValues);
+    packedMapView(fields, maps[m], packedValues);
+    for (int b = 0; b < RECORDS_BUTTONS; b++) {
+      for (int f = 0; f < RECORDS_LEGACY_FIELDS; f++) {
+        int i = b * BUTTON_FIELD_COUNT + f;
+        // palette entries sharing one RGB (Aqua, Cyan) find the first
+        if (f == 10) same = same && paletteColor(legacyValues[i]) == paletteColor(packedValues[i]);
+        else same = same && legacyValues[i] == packedValues[i];
+      }
+    }
+  }
+
+  volatile uint32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) sink += legacyMapView(legacy, i & (LEGACY_MAPS - 1), legacyValues);
+  double legacyViewNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) sink += packedMapView(fields, maps[i & (NUBER_OF_MAPS - 1)], packedValues);
+  double packedViewNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) sink += legacyColorIndex(legacy[i % RECORDS_BUTTONS].btnColor[i & (LEGACY_MAPS - 1)]);
+  double legacyColorNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) sink += paletteColor(maps[i & (NUBER_OF_MAPS - 1)][i % RECORDS_BUTTONS].btnColor);
+  double packedColorNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  // map switch: compile the actions of the new map
+  MidiActionTable actions;
+  unsigned long allocBefore = __allocations;
+  start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    uint8_t m = i & (NUBER_OF_MAPS - 1);
+    actions.compile(maps[m], states[m], RECORDS_BUTTONS, m);
+  }
+  double compileNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  unsigned long allocations = __allocations - allocBefore;
+
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  size_t v3Size = encodeMap(maps[0], RECORDS_BUTTONS, 0, record, sizeof(record));
+  const size_t v2Size = MAP_CODEC_HEADER_SIZE + RECORDS_BUTTONS * 13 + MAP_CODEC_CRC_SIZE;
+  const size_t legacyRam = sizeof(legacy), packedRam = sizeof(maps) + sizeof(states);
+
+  printf("%-24s %12s %12s\n", "", "before", "after");
+  printf("%-24s %12d %12d\n", "maps", LEGACY_MAPS, NUBER_OF_MAPS);
+  printf("%-24s %12u %12u\n", "bytes per button and map", (unsigned)(sizeof(myLegacyButton) - 1) / LEGACY_MAPS,
+    (unsigned)sizeof(myMapButton) + 1);
+  printf("%-24s %12u %12u\n", "RAM all maps", (unsigned)legacyRam, (unsigned)packedRam);
+  printf("%-24s %12u %12u\n", "RAM 128 maps", (unsigned)((sizeof(myLegacyButton) - 1) / LEGACY_MAPS * 128 * RECORDS_BUTTONS),
+    (unsigned)((sizeof(myMapButton) + 1) * 128 * RECORDS_BUTTONS));
+  printf("%-24s %12u %12u\n", "cache lines per map", (unsigned)legacyCacheLines(legacy, 1), (unsigned)packedCacheLines(maps[1]));
+  printf("%-24s %12u %12u\n", "stored bytes per map", (unsigned)v2Size, (unsigned)v3Size);
+  printf("%-24s %12.1f %12.1f\n", "color lookup ns", legacyColorNs, packedColorNs);
+  printf("%-24s %12.1f %12.1f\n", "map view ns", legacyViewNs, packedViewNs);
+  printf("map switch compile %.1f ns, %lu allocations, same values: %s\n", compileNs, allocations, same ? "yes" : "no");
+  bool ok = same && packedRam / NUBER_OF_MAPS < legacyRam / LEGACY_MAPS && v3Size < v2Size && allocations == 0;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
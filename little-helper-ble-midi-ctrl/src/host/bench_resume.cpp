@@ -0,0 +1,222 @@
+/**
+ * @file bench_resume.cpp
+ * @brief Host (env:native) OTA over a flaky link: start over after every drop vs. Range resume with checkpoints.
+ *
+ * @details A 1.2 MB image is downloaded over a simulated link that drops the connection at
+ * random (seeded, the same drops for both runs). The time is computed from the link rate
+ * and a connect cost per connection, nothing sleeps. The resume run goes through the
+ * device code: checkpoint record every OTA_CHECKPOINT_BYTES, Range header and Content-Range
+ * parse, SHA-256 over the written bytes, and one reboot half way that rebuilds the hash
+ * from "flash". It also checks SHA-256 test vectors and that broken checkpoints are rejected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "bench.h"
+#include "ota_resume.h"
+#include "sha256.h"
+
+#define RESUME_IMAGE_SIZE (1200 * 1024)
+#define RESUME_LINK_KBPS 100          // a weak WiFi link
+#define RESUME_CONNECT_MS 400         // TCP + TLS handshake and the GET
+#define RESUME_BLOCK 4096
+#define RESUME_MAX_CONNECTIONS 200
+
+// drops the connection after a random number of bytes, mean meanKb
+class FlakyLink {
+public:
+  FlakyLink(uint32_t seed, uint32_t meanKb) : _seed(seed), _meanKb(meanKb) {}
+  uint32_t nextDrop() {
+    _seed ^= _seed << 13; _seed ^= _seed >> 17; _seed ^= _seed << 5;
+    return (_seed % (2 * _meanKb) + 1) * 1024;
+  }
+private:
+  uint32_t _seed;
+  uint32_t _meanKb;
+};
+
+struct resumeResult {
+  uint64_t transferred = 0;
+  uint32_t connections = 0;
+  double seconds = 0;
+  bool complete = false;
+  bool hashOk = false;
+};
+
+static double linkSeconds(uint64_t bytes, uint32_t connections) {
+  return double(bytes) / (RESUME_LINK_KBPS * 1024.0) + connections * RESUME_CONNECT_MS / 1000.0;
+}
+
+// the former justotaUpdate(): a dropped connection aborts and the next try starts at 0
+static resumeResult runRestart(const std::vector<uint8_t>& image, uint32_t meanKb) {
+  resumeResult r;
+  FlakyLink link(0x13579b, meanKb);
+  while (r.connections < RESUME_MAX_CONNECTIONS) {
+    r.connections++;
+    uint32_t drop = link.nextDrop();
+    if (drop >= image.size()) {
+      r.transferred += image.size();
+      r.complete = r.hashOk = true;
+      break;
+    }
+    r.transferred += drop;
+  }
+  r.seconds = linkSeconds(r.transferred, r.connections);
+  return r;
+}
+
+static resumeResult runResume(const std::vector<uint8_t>& image, const uint8_t* expected, uint32_t meanKb) {
+  resumeResult r;
+  FlakyLink link(0x13579b, meanKb);
+  std::vector<uint8_t> flash(image.size(), 0xFF);
+  uint8_t nvs[OTA_CHECKPOINT_RECORD_SIZE];
+  size_t nvsLen = 0;
+  const uint32_t total = image.size();
+  const uint32_t fwVersion = 9, partition = 0x210000;
+  bool rebooted = false;
+
+  Sha256 sha;
+  myOtaCheckpoint checkpoint = myOtaCheckpoint();
+  uint32_t done = 0;
+
+  while (r.connections < RESUME_MAX_CONNECTIONS && done < total) {
+
+    // power loss half way: RAM is gone, continue from the stored checkpoint
+    if (!rebooted && done > total / 2) {
+      rebooted = true;
+      myOtaCheckpoint stored;
+      done = 0;
+      sha.begin();
+      if (decodeOtaCheckpoint(nvs, nvsLen, stored)) {
+        done = otaResumeOffset(stored, fwVersion, stored.total, partition, expected);
+        checkpoint = stored;
+        sha.update(flash.data(), done);
+      }
+    }
+
+    r.connections++;
+    char range[32] = "";
+    if (done > 0) otaRangeHeader(range, sizeof(range), done);
+
+    // server side: answer the Range request
+    uint32_t first = 0;
+    if (range[0]) {
+      uint32_t from = 0;
+      sscanf(range, "bytes=%u-", &from);
+      char contentRange[64];
+      snprintf(contentRange, sizeof(contentRange), "bytes %u-%u/%u", from, total - 1, total);
+      uint32_t last, rangeTotal;
+      if (!parseContentRange(contentRange, first, last, rangeTotal) || first != done || rangeTotal != total) return r;
+    } else {
+      checkpoint = myOtaCheckpoint();
+      checkpoint.fwVersion = fwVersion;
+      checkpoint.total = total;
+      checkpoint.partition = partition;
+      checkpoint.hasHash = 1;
+      memcpy(checkpoint.expectedHash, expected, SHA256_SIZE);
+    }
+
+    uint32_t drop = link.nextDrop();
+    uint32_t end = total - first < drop ? total : first + drop;
+    r.transferred += end - first;
+
+    // whole blocks reach flash, the partial block at a drop is fetched again
+    while (done < end) {
+      uint32_t len = total - done < RESUME_BLOCK ? total - done : RESUME_BLOCK;
+      if (done + len > end) break;
+      memcpy(&flash[done], &image[done], len);
+      sha.update(&image[done], len);
+      done += len;
+      if (done - checkpoint.done >= OTA_CHECKPOINT_BYTES) {
+        checkpoint.done = done;
+        nvsLen = encodeOtaCheckpoint(checkpoint, nvs);
+      }
+    }
+    if (done < total) {
+      checkpoint.done = done;
+      nvsLen = encodeOtaCheckpoint(checkpoint, nvs);
+    }
+  }
+  r.complete = done == total;
+  uint8_t digest[SHA256_SIZE];
+  sha.finish(digest);
+  r.hashOk = r.complete && memcmp(digest, expected, SHA256_SIZE) == 0 && memcmp(flash.data(), image.data(), total) == 0;
+  r.seconds = linkSeconds(r.transferred, r.connections);
+  return r;
+}
+
+static bool hashIs(const char* text, const char* hex) {
+  Sha256 sha;
+  sha.update(text, strlen(text));
+  uint8_t digest[SHA256_SIZE], expected[SHA256_SIZE];
+  sha.finish(digest);
+  return sha256FromHex(hex, expected) && memcmp(digest, expected, SHA256_SIZE) == 0;
+}
+
+int benchResume(long iterations) {
+
+  bool vectors = hashIs("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855")
+    && hashIs("abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad")
+    && hashIs("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+  uint32_t first, last, total;
+  bool ranges = parseContentRange("bytes 1000-1999/2000", first, last, total) && first == 1000 && total == 2000
+    && !parseContentRange("bytes */2000", first, last, total)
+    && !parseContentRange("bytes 10-5/2000", first, last, total)
+    && !parseContentRange(nullptr, first, last, total);
+
+  // every single bit flip of a checkpoint must be rejected
+  myOtaCheckpoint checkpoint = myOtaCheckpoint();
+  checkpoint.fwVersion = 9;
+  checkpoint.total = RESUME_IMAGE_SIZE;
+  checkpoint.done = 65536;
+  uint8_t record[OTA_CHECKPOINT_RECORD_SIZE];
+  size_t len = encodeOtaCheckpoint(checkpoint, record);
+  // little endian at the field offsets, 65536 = 00 00 01 00
+  const uint8_t* payload = record + OTA_CHECKPOINT_HEADER_SIZE;
+  bool layout = len == 62 && record[0] == (OTA_CHECKPOINT_MAGIC & 0xFF) && record[1] == OTA_CHECKPOINT_MAGIC >> 8
+    && record[4] == OTA_CHECKPOINT_PAYLOAD_SIZE && record[5] == 0 && payload[OTA_CHECKPOINT_FIELD_FW_VERSION] == 9
+    && payload[OTA_CHECKPOINT_FIELD_DONE] == 0 && payload[OTA_CHECKPOINT_FIELD_DONE + 1] == 0
+    && payload[OTA_CHECKPOINT_FIELD_DONE + 2] == 1 && payload[OTA_CHECKPOINT_FIELD_DONE + 3] == 0;
+  unsigned long accepted = 0;
+  for (size_t i = 0; i < len * 8; i++) {
+    myOtaCheckpoint broken;
+    record[i / 8] ^= 1 << (i % 8);
+    if (decodeOtaCheckpoint(record, len, broken)) accepted++;
+    record[i / 8] ^= 1 << (i % 8);
+  }
+
+  std::vector<uint8_t> image(RESUME_IMAGE_SIZE);
+  uint32_t seed = 0x2468ace;
+  for (uint8_t& b : image) {
+    seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+    b = seed;
+  }
+  Sha256 sha;
+  sha.update(image.data(), image.size());
+  uint8_t expected[SHA256_SIZE];
+  sha.finish(expected);
+
+  printf("SHA-256 test vectors: %s, Content-Range parse: %s, checkpoint layout: %s, checkpoint bit flips accepted: %lu of %u\n",
+    vectors ? "ok" : "FAIL", ranges ? "ok" : "FAIL", layout ? "ok" : "FAIL", accepted, (unsigned)len * 8);
+  printf("%u KB image, %u KB/s link, %u ms per connection\n", RESUME_IMAGE_SIZE / 1024, RESUME_LINK_KBPS, RESUME_CONNECT_MS);
+  printf("%-12s %-8s %12s %12s %10s %s\n", "drop every", "mode", "KB sent", "connections", "seconds", "image");
+
+  bool ok = vectors && ranges && layout && accepted == 0;
+  // iterations x 2 = mean KB between two drops of the flakiest link
+  const uint32_t means[] = { (uint32_t)iterations * 8, (uint32_t)iterations * 4, (uint32_t)iterations * 2 };
+  for (uint32_t meanKb : means) {
+    resumeResult restart = runRestart(image, meanKb);
+    resumeResult resume = runResume(image, expected, meanKb);
+    printf("~%-4u KB    %-8s %12llu %12u %10.1f %s\n", meanKb, "restart", (unsigned long long)restart.transferred / 1024,
+      restart.connections, restart.seconds, restart.complete ? "ok" : "gave up");
+    printf("~%-4u KB    %-8s %12llu %12u %10.1f %s\n", meanKb, "resume", (unsigned long long)resume.transferred / 1024,
+      resume.connections, resume.seconds, resume.hashOk ? "ok" : "FAIL");
+    ok = ok && resume.hashOk;
+  }
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
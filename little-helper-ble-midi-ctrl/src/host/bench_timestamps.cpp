@@ -0,0 +1,181 @@
+/**
+ * @file bench_timestamps.cpp
+ * @brief Host (env:native) check that BLE-MIDI timestamps recover the real press spacing.
+ *
+ * @details Feeds jittered button traces through the device input path model (5 ms debounce,
+ * input task passes every 5 ms, scheduling jitter of the pass) into the MidiEngine and the
+ * BLE-MIDI packet builder, decodes the packets like a host does and compares the spacing of
+ * the decoded timestamps with the spacing of the real button edges. The timestamp taken from
+ * the edge (what the firmware does) is compared with the time the event was handled (what the
+ * library did before). Fails if the edge timestamps are off by more than the 1 ms resolution.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "bench.h"
+#include "midi_engine.h"
+#include "ble_midi_output.h"
+#include "ble_midi_decoder.h"
+
+#define TRACE_PRESSES 64
+#define TRACE_EVENTS (TRACE_PRESSES * 4)
+#define DEBOUNCE_US 5000
+#define PASS_US 5000
+
+struct traceEvent {
+  int64_t edgeUs;
+  int64_t handleUs;
+  uint8_t btn;
+  uint8_t event;
+};
+
+struct spacingError {
+  double sum = 0;
+  double worst = 0;
+  unsigned long count = 0;
+  void add(double e) {
+    if (e < 0) e = -e;
+    sum += e;
+    if (e > worst) worst = e;
+    count++;
+  }
+};
+
+static uint32_t __seed = 0x2545F491;
+static uint32_t nextRandom() {
+  __seed ^= __seed << 13; __seed ^= __seed >> 17; __seed ^= __seed << 5;
+  return __seed;
+}
+
+// 16th notes at 120 bpm played by hand (+-8 ms), every 4th a flam on a second button
+static int buildTrace(traceEvent* trace) {
+  int n = 0;
+  int64_t t = 1000000 + nextRandom() % 1000000;
+  for (int p = 0; p < TRACE_PRESSES; p++) {
+    int64_t edge = t + (int32_t)(nextRandom() % 16001) - 8000;
+    uint8_t btn = p % MIDI_ACTION_MAX_BUTTONS;
+    trace[n++] = { edge, 0, btn, BTN_EVENT_PRESSED };
+    trace[n++] = { edge + 40000 + nextRandom() % 30000, 0, btn, BTN_EVENT_RELEASED };
+    if (p % 4 == 3) {
+      uint8_t second = (btn + 2) % MIDI_ACTION_MAX_BUTTONS;
+      int64_t flam = edge + 500 + nextRandom() % 3000;
+      trace[n++] = { flam, 0, second, BTN_EVENT_PRESSED };
+      trace[n++] = { flam + 30000, 0, second, BTN_EVENT_RELEASED };
+    }
+    t += 125000;
+  }
+  return n;
+}
+
+// the input task handles an edge in the first pass after the debounce time, all buttons of a
+// pass in button order, and the pass itself runs late by the jitter of the scheduler
+static void scheduleTrace(traceEvent* trace, int n) {
+  int64_t phase = nextRandom() % PASS_US;
+  for (int i = 0; i < n; i++) {
+    int64_t settled = trace[i].edgeUs + DEBOUNCE_US;
+    int64_t pass = (settled - phase + PASS_US - 1) / PASS_US;
+    trace[i].handleUs = phase + pass * PASS_US;
+  }
+  std::sort(trace, trace + n, [](const traceEvent& a, const traceEvent& b) {
+    if (a.handleUs != b.handleUs) return a.handleUs < b.handleUs;
+    return a.btn < b.btn;
+  });
+  int64_t lastPass = -1, jitter = 0;
+  for (int i = 0; i < n; i++) {
+    if (trace[i].handleUs != lastPass) {
+      lastPass = trace[i].handleUs;
+      jitter = nextRandom() % 4000;
+    }
+    trace[i].handleUs += jitter;
+  }
+}
+
+// decoded 13 bit timestamps back to a continuous ms time, neighbours are never 4 s apart
+class spacingCheck {
+public:
+  void reset() { _first = true; }
+  void message(uint16_t timestamp, int64_t edgeUs, spacingError& error) {
+    if (_first) {
+      _time = timestamp;
+      _first = false;
+    } else {
+      int16_t diff = (int16_t)(((timestamp - _lastTimestamp) & BLE_MIDI_TIMESTAMP_MASK) << 3) >> 3;
+      _time += diff;
+      error.add(double(_time - _lastTime) - double(edgeUs - _lastEdgeUs) / 1000.0);
+    }
+    _lastTimestamp = timestamp;
+    _lastTime = _time;
+    _lastEdgeUs = edgeUs;
+  }
+private:
+  bool _first = true;
+  uint16_t _lastTimestamp = 0;
+  int64_t _time = 0;
+  int64_t _lastTime = 0;
+  int64_t _lastEdgeUs = 0;
+};
+
+static void runTrace(const traceEvent* trace, int n, bool edgeTimestamps, spacingError& error, unsigned long& decodeErrors) {
+
+  static BleMidiDecoder decoder;
+  BleMidiBatchOutput output(decoder);
+  output.builder().setMtu(23);
+  MidiActionTable actions;
+  MidiEngine engine(output, actions);
+  myMapButton buttons[MIDI_ACTION_MAX_BUTTONS];
+  uint8_t states[MIDI_ACTION_MAX_BUTTONS] = {};
+  memset(buttons, 0, sizeof(buttons));
+  for (int b = 0; b < MIDI_ACTION_MAX_BUTTONS; b++) {
+    buttons[b].btnFunction = BTN_PUSH;
+    buttons[b].btnMidiFunction = MIDI_NOTE;
+    buttons[b].btnMidiNote = 60 + b;
+    buttons[b].btnMidiVelocity = 100;
+  }
+  actions.compile(buttons, states, MIDI_ACTION_MAX_BUTTONS, 0);
+
+  // edge time of every message in the order it was sent
+  static int64_t sentEdgeUs[TRACE_EVENTS];
+  int sent = 0;
+  spacingCheck check;
+  decoder.clear();
+
+  for (int i = 0; i < n; i++) {
+    const traceEvent& ev = trace[i];
+    uint16_t timestampMs = (uint16_t)((edgeTimestamps ? ev.edgeUs : ev.handleUs) / 1000);
+    engine.handleEvent(ev.btn, ev.event, timestampMs);
+    sentEdgeUs[sent++] = ev.edgeUs;
+    if (i + 1 == n || trace[i + 1].handleUs != ev.handleUs) output.flush(); // end of the input pass
+  }
+  decodeErrors += decoder.errors();
+  if (decoder.count() != sent) decodeErrors++;
+  for (uint16_t m = 0; m < decoder.count() && m < sent; m++) {
+    check.message(decoder.message(m).timestamp, sentEdgeUs[m], error);
+  }
+}
+
+int benchTimestamps(long iterations) {
+
+  static traceEvent trace[TRACE_EVENTS];
+  spacingError handled, edge;
+  unsigned long decodeErrors = 0;
+
+  for (long i = 0; i < iterations; i++) {
+    int n = buildTrace(trace);
+    scheduleTrace(trace, n);
+    runTrace(trace, n, false, handled, decodeErrors);
+    runTrace(trace, n, true, edge, decodeErrors);
+  }
+
+  printf("%-18s %12s %12s %10s\n", "timestamp", "mean err ms", "worst ms", "intervals");
+  printf("%-18s %12.3f %12.3f %10lu\n", "handle time (old)", handled.sum / handled.count, handled.worst, handled.count);
+  printf("%-18s %12.3f %12.3f %10lu\n", "button edge", edge.sum / edge.count, edge.worst, edge.count);
+  printf("decode errors: %lu\n", decodeErrors);
+
+  // edge timestamps are truncated to ms, the spacing of two of them is off by less than 1 ms
+  bool ok = decodeErrors == 0 && edge.worst < 1.0;
+  printf("%s\n", ok ? "PASS: packet timestamps recover the edge spacing" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file bench_webui.cpp
+ * @brief Host (env:native) the lite configurator (USE_LITE_UI): page size, map API round trip, requests per edit.
+ *
+ * @details The page edits the map record it read in place and sends it back whole, like
+ * this program does here with the bytes of the GET: change one field, CRC again, decode
+ * on the "device". Requests and bytes are counted per page load and per edit, the ESPUI
+ * tree sends one websocket message per changed control instead.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "bench.h"
+#include "map_codec.h"
+#include "crc32.h"
+#include "webui_page.h"
+
+#define WEBUI_BUTTONS 5
+#define WEBUI_BUTTON_FIELDS 11 // controls of one button in the ESPUI tree and in the page
+
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// what saveMap() in web/index.html does before the POST
+static void seal(uint8_t* record) {
+  size_t len = record[6] | (record[7] << 8);
+  uint32_t crc = crc32(record, MAP_CODEC_HEADER_SIZE + len);
+  for (int k = 0; k < 4; k++) record[MAP_CODEC_HEADER_SIZE + len + k] = crc >> (8 * k);
+}
+
+int benchWebUi(long iterations) {
+
+  // gzip member: magic, deflate, and the raw size in the trailer
+  bool gzipOk = WEBUI_PAGE[0] == 0x1f && WEBUI_PAGE[1] == 0x8b && WEBUI_PAGE[2] == 8
+    && get32(WEBUI_PAGE + WEBUI_PAGE_SIZE - 4) == WEBUI_PAGE_RAW_SIZE;
+  bool layoutOk = WEBUI_MAP_CODEC_VERSION == MAP_CODEC_VERSION && WEBUI_MAP_CODEC_BUTTON_SIZE == MAP_CODEC_BUTTON_SIZE;
+
+  static myMapButton device[NUBER_OF_MAPS][WEBUI_BUTTONS];
+  memset(device, 0, sizeof(device));
+  for (int m = 0; m < NUBER_OF_MAPS; m++) {
+    for (int b = 0; b < WEBUI_BUTTONS; b++) {
+      device[m][b].btnMidiNote = 60 + b;
+      device[m][b].btnColor = PALETTE_Blue + b;
+      device[m][b].btnMidiMMC = MMC_PLAY;
+    }
+  }
+
+  // GET /api/map?m=2, edit button 3 in the page, POST it back
+  const uint8_t map = 2;
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  size_t len = encodeMap(device[map], WEBUI_BUTTONS, map, record, sizeof(record));
+  uint8_t* button = record + MAP_CODEC_HEADER_SIZE + 3 * MAP_CODEC_BUTTON_SIZE;
+  // the packed fields as edited() sets them
+  button[MAP_FIELD_FLAGS] = (button[MAP_FIELD_FLAGS] & ~(3 << MAP_FLAG_MIDI_SHIFT)) | MIDI_CC << MAP_FLAG_MIDI_SHIFT;
+  button[MAP_FIELD_CC] = 74;
+  button[MAP_FIELD_CHANNEL] = (button[MAP_FIELD_CHANNEL] & 0xF0) | 9;
+  button[MAP_FIELD_COLOR] = PALETTE_Red;
+  seal(record);
+  bool roundTrip = decodeMap(record, len, map, device[map], WEBUI_BUTTONS) == MAP_CODEC_OK
+    && device[map][3].btnMidiFunction == MIDI_CC && device[map][3].btnMidiCC == 74 && device[map][3].btnMidiChannel == 9
+    && device[map][3].btnMidiMMC == MMC_PLAY && paletteColor(device[map][3].btnColor) == 0xFF0000
+    && device[map][2].btnMidiNote == 62 && device[1][3].btnMidiNote == 63 && device[1][3].btnMidiFunction == MIDI_NOTE;
+
+  // an edit without the new CRC (a broken upload) must not reach the map
+  button[MAP_FIELD_CC] = 75;
+  bool unsealedRejected = decodeMap(record, len, map, device[map], WEBUI_BUTTONS) == MAP_CODEC_BAD_CRC
+    && device[map][3].btnMidiCC == 74;
+  seal(record);
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    len = encodeMap(device[map], WEBUI_BUTTONS, map, record, sizeof(record));
+    record[MAP_CODEC_HEADER_SIZE + MAP_FIELD_NOTE] = i & 0x7F;
+    seal(record);
+    decodeMap(record, len, map, device[map], WEBUI_BUTTONS);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  printf("page %u bytes, %u gzip (%.0f%%), gzip member: %s, map layout: %s\n", WEBUI_PAGE_RAW_SIZE, WEBUI_PAGE_SIZE,
+    100.0 * WEBUI_PAGE_SIZE / WEBUI_PAGE_RAW_SIZE, gzipOk ? "ok" : "FAIL", layoutOk ? "ok" : "run tools/mkwebui.py");
+  printf("page load: 3 requests (page, /api/state, /api/map), page again: 304\n");
+  printf("%-26s %10s %10s\n", "edit", "ESPUI msgs", "lite reqs");
+  printf("%-26s %10d %10d   (%u byte record)\n", "one field of a button", 1, 1, (unsigned)len);
+  printf("%-26s %10d %10d\n", "all fields of a button", WEBUI_BUTTON_FIELDS, 1);
+  printf("%-26s %10d %10d\n", "all buttons of a map", WEBUI_BUTTON_FIELDS * WEBUI_BUTTONS, 1);
+  printf("GET + edit + POST decode %.0f ns, round trip: %s, record without new CRC rejected: %s\n", ns,
+    roundTrip ? "ok" : "FAIL", unsealedRejected ? "yes" : "no");
+  bool ok = gzipOk && layoutOk && roundTrip && unsealedRejected;
+  printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
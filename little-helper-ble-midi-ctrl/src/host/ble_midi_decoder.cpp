@@ -0,0 +1,126 @@
+/**
+ * @file ble_midi_decoder.cpp
+ * @brief Host (env:native) BLE-MIDI packet decoder.
+ */
+
+#include "ble_midi_decoder.h"
+#include <string.h>
+
+static uint8_t dataBytes(uint8_t status) {
+  switch (status & 0xF0) {
+    case 0x80: case 0x90: case 0xA0: case 0xB0: case 0xE0: return 2;
+    case 0xC0: case 0xD0: return 1;
+    default: break;
+  }
+  switch (status) {
+    case 0xF1: case 0xF3: return 1;
+    case 0xF2: return 2;
+    default: return 0;
+  }
+}
+
+void BleMidiDecoder::clear() {
+  _count = 0;
+  _pendingLen = 0;
+  _inSysEx = false;
+  _runningStatus = 0;
+  _packets = 0;
+  _errors = 0;
+}
+
+void BleMidiDecoder::complete(uint16_t timestamp) {
+  if (_count < BLE_MIDI_DECODER_MAX_MESSAGES) {
+    myDecodedMidi& m = _messages[_count++];
+    m.timestamp = timestamp;
+    m.len = _pendingLen;
+    memcpy(m.bytes, _pending, _pendingLen);
+  }
+  _pendingLen = 0;
+}
+
+bool BleMidiDecoder::decode(const uint8_t* packet, uint8_t len) {
+
+  if (len < 2 || !(packet[0] & 0x80)) return false;
+
+  uint16_t high = packet[0] & 0x3F;
+  uint8_t lastLow = 0;
+  bool haveTimestamp = false;
+  uint16_t timestamp = 0;
+  uint16_t sysExTimestamp = 0;
+  uint8_t need = 0;
+  uint8_t i = 1;
+
+  // a SysEx continuation packet starts with data bytes right after the header
+  if (_inSysEx) {
+    while (i < len && !(packet[i] & 0x80)) {
+      if (_pendingLen < BLE_MIDI_DECODER_MAX_SYSEX) _pending[_pendingLen++] = packet[i];
+      i++;
+    }
+  } else {
+    _runningStatus = 0;
+  }
+
+  while (i < len) {
+    uint8_t b = packet[i++];
+    if (b & 0x80) {
+      // timestamp byte, followed by a status byte or by data bytes (running status)
+      uint8_t low = b & 0x7F;
+      if (haveTimestamp && low < lastLow) high = (high + 1) & 0x3F;
+      lastLow = low;
+      haveTimestamp = true;
+      timestamp = (high << 7) | low;
+      if (i >= len) return false;
+      b = packet[i];
+      if (b & 0x80) {
+        i++;
+        if (b == 0xF7) {
+          if (!_inSysEx) return false;
+          if (_pendingLen < BLE_MIDI_DECODER_MAX_SYSEX) _pending[_pendingLen++] = 0xF7;
+          _inSysEx = false;
+          complete(sysExTimestamp);
+          continue;
+        }
+        if (b == 0xF0) {
+          _inSysEx = true;
+          sysExTimestamp = timestamp;
+          _pendingLen = 0;
+          _pending[_pendingLen++] = 0xF0;
+          while (i < len && !(packet[i] & 0x80)) {
+            if (_pendingLen < BLE_MIDI_DECODER_MAX_SYSEX) _pending[_pendingLen++] = packet[i];
+            i++;
+          }
+          continue;
+        }
+        _pendingLen = 0;
+        _pending[_pendingLen++] = b;
+        if (b < 0xF0) _runningStatus = b;
+        else if (b < 0xF8) _runningStatus = 0;
+        need = dataBytes(b);
+      } else {
+        if (_runningStatus == 0) return false;
+        _pendingLen = 0;
+        _pending[_pendingLen++] = _runningStatus;
+        need = dataBytes(_runningStatus);
+      }
+      if (i + need > len) return false;
+      for (uint8_t d = 0; d < need; d++) {
+        if (packet[i] & 0x80) return false;
+        _pending[_pendingLen++] = packet[i++];
+      }
+      complete(timestamp);
+    } else {
+      // running status without a new timestamp byte
+      if (_runningStatus == 0 || !haveTimestamp) return false;
+      _pendingLen = 0;
+      _pending[_pendingLen++] = _runningStatus;
+      _pending[_pendingLen++] = b;
+      need = dataBytes(_runningStatus);
+      for (uint8_t d = 1; d < need; d++) {
+        if (i >= len || (packet[i] & 0x80)) return false;
+        _pending[_pendingLen++] = packet[i++];
+      }
+      complete(timestamp);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file ble_midi_decoder.h
+ * @brief Host (env:native) BLE-MIDI packet decoder, the receiving side of BleMidiPacketBuilder.
+ *
+ * @details Decodes packets the way a BLE-MIDI host does: the 13 bit timestamp of every
+ * message is rebuilt from the header byte and the timestamp byte in front of the message,
+ * a smaller low part than the previous one means one overflow into the high bits. Running
+ * status and SysEx continuation packets are resolved into complete messages.
+ */
+
+#ifndef BLE_MIDI_DECODER_H
+#define BLE_MIDI_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ble_midi_packet.h"
+
+#define BLE_MIDI_DECODER_MAX_MESSAGES 256
+#define BLE_MIDI_DECODER_MAX_SYSEX 128
+
+struct myDecodedMidi {
+  uint16_t timestamp; // 13 bit
+  uint8_t len;
+  uint8_t bytes[BLE_MIDI_DECODER_MAX_SYSEX];
+};
+
+class BleMidiDecoder : public BleMidiPacketSink {
+public:
+  BleMidiDecoder() { clear(); }
+
+  // decode one packet and append its messages, returns false on a malformed packet
+  bool decode(const uint8_t* packet, uint8_t len);
+
+  void sendPacket(const uint8_t* packet, uint8_t len) override {
+    if (!decode(packet, len)) _errors++;
+    _packets++;
+  }
+
+  void clear();
+
+  uint16_t count() const { return _count; }
+  const myDecodedMidi& message(uint16_t i) const { return _messages[i]; }
+  uint32_t packets() const { return _packets; }
+  uint32_t errors() const { return _errors; }
+
+private:
+  void complete(uint16_t timestamp);
+
+  myDecodedMidi _messages[BLE_MIDI_DECODER_MAX_MESSAGES];
+  uint16_t _count;
+  uint8_t _pending[BLE_MIDI_DECODER_MAX_SYSEX];
+  uint8_t _pendingLen;
+  bool _inSysEx;
+  uint8_t _runningStatus;
+  uint32_t _packets;
+  uint32_t _errors;
+};
+
+#endif // BLE_MIDI_DECODER_H
@@ -0,0 +1,115 @@
+/**
+ * @file legacy_handle_event.cpp
+ * @brief The branch chain handleEvent() used before the precompiled action table.
+ */
+
+#include "legacy_handle_event.h"
+
+uint8_t legacyHandleEvent(LegacyMidiCalls& out, myLegacyButton* myBtn, uint8_t eventType, uint8_t active_mapper) {
+    bool needRelease = myBtn->needRelease[active_mapper];
+    uint8_t btnFunction = myBtn->btnFunction[active_mapper];
+    bool btnLongpress = myBtn->btnLongpress[active_mapper];
+    uint8_t btnState = myBtn->btnState[active_mapper];
+    uint8_t btnMidiFunction = myBtn->btnMidiFunction[active_mapper];
+    uint8_t btnMidiChannel = myBtn->btnMidiChannel[active_mapper];
+    uint8_t btnMidiNote = myBtn->btnMidiNote[active_mapper];
+    uint8_t btnMidiVelocity = myBtn->btnMidiVelocity[active_mapper];
+    uint8_t btnMidiCC = myBtn->btnMidiCC[active_mapper];
+    uint8_t btnMidiCCValueStateOn = myBtn->btnMidiCCValueStateOn[active_mapper];
+    uint8_t btnMidiCCValueStateOff = myBtn->btnMidiCCValueStateOff[active_mapper];
+    uint8_t btnMidiMMC = myBtn->btnMidiMMC[active_mapper];
+
+    switch (eventType) {
+      case BTN_EVENT_PRESSED:
+        if(btnMidiFunction == MIDI_NOTE) {
+          if(btnFunction == BTN_PUSH){
+            out.noteOn(btnMidiChannel, btnMidiNote, btnMidiVelocity);
+            myBtn->btnState[active_mapper] = BTN_ON;
+          }
+          if(btnFunction == BTN_TOGGLE){
+            if(btnState == BTN_OFF){
+              out.noteOn(btnMidiChannel, btnMidiNote, btnMidiVelocity);
+              myBtn->btnState[active_mapper] = BTN_ON;
+            }
+            else if(btnState == BTN_ON){
+              out.noteOff(btnMidiChannel, btnMidiNote, 0 );
+              myBtn->btnState[active_mapper] = BTN_OFF;
+            }
+          }
+        }
+        else if(btnMidiFunction == MIDI_CC && !needRelease){
+          if(btnFunction == BTN_PUSH){
+            out.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
+            myBtn->btnState[active_mapper] = BTN_ON;
+          }
+          if(btnFunction == BTN_TOGGLE){
+            if(btnState == BTN_OFF){
+              out.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
+              myBtn->btnState[active_mapper] = BTN_ON;
+            }
+            else if(btnState == BTN_ON){
+              out.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOff);
+              myBtn->btnState[active_mapper] = BTN_OFF;
+            }
+          }
+        }
+        else if(btnMidiFunction == MIDI_MMC && !needRelease){
+          switch (btnMidiMMC) {
+          case MMC_STOP: out.mmc(MMC_STOP); out.mmc(MMC_STOP); break;
+          case MMC_PLAY: out.mmc(MMC_PLAY); break;
+          case MMC_DEFERRED_PLAY: out.mmc(MMC_DEFERRED_PLAY); break;
+          case MMC_FAST_FORWARD: out.mmc(MMC_FAST_FORWARD); break;
+          case MMC_REWIND: out.mmc(MMC_REWIND); break;
+          case MMC_RECORD_STROBE: out.mmc(MMC_RECORD_STROBE); break;
+          case MMC_RECORD_EXIT: out.mmc(MMC_RECORD_EXIT); break;
+          case MMC_RECORD_PAUSE: out.mmc(MMC_RECORD_PAUSE); break;
+          case MMC_PAUSE: out.mmc(MMC_PAUSE); break;
+          default: break;
+          }
+          myBtn->btnState[active_mapper] = BTN_ON;
+        }
+        else if(btnMidiFunction == MIDI_PROGRAMCHANGE && !needRelease) return LED_KEEP;
+        return LED_BUTTON_COLOR;
+      case BTN_EVENT_RELEASED:
+        if(btnMidiFunction == MIDI_NOTE){
+          if(btnFunction == BTN_PUSH){
+            out.noteOff(btnMidiChannel, btnMidiNote, 0 );
+            myBtn->btnState[active_mapper] = BTN_OFF;
+          }
+        }
+        else if(btnMidiFunction == MIDI_CC && needRelease){
+          out.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
+          myBtn->btnState[active_mapper] = BTN_OFF;
+        }
+        else if(btnMidiFunction == MIDI_MMC && needRelease){
+          switch (btnMidiMMC) {
+          case MMC_STOP: out.mmc(MMC_STOP); break;
+          case MMC_PLAY: out.mmc(MMC_PLAY); break;
+          case MMC_DEFERRED_PLAY: out.mmc(MMC_DEFERRED_PLAY); break;
+          case MMC_FAST_FORWARD: out.mmc(MMC_FAST_FORWARD); break;
+          case MMC_REWIND: out.mmc(MMC_REWIND); break;
+          case MMC_RECORD_STROBE: out.mmc(MMC_RECORD_STROBE); break;
+          case MMC_RECORD_EXIT: out.mmc(MMC_RECORD_EXIT); break;
+          case MMC_RECORD_PAUSE: out.mmc(MMC_RECORD_PAUSE); break;
+          case MMC_PAUSE: out.mmc(MMC_PAUSE); break;
+          default: break;
+          }
+          myBtn->btnState[active_mapper] = BTN_OFF;
+        }
+        else if(btnMidiFunction == MIDI_PROGRAMCHANGE && needRelease) return LED_KEEP;
+        return LED_RESTORE;
+      case BTN_EVENT_LONG_PRESSED:
+        if(btnLongpress){
+          if(btnMidiFunction == MIDI_NOTE)
+            out.noteOff(btnMidiChannel, btnMidiNote, 0 );
+          else if(btnMidiFunction == MIDI_CC && !needRelease)
+            out.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
+        }
+        return LED_BUTTON_COLOR;
+      case BTN_EVENT_LONG_RELEASED:
+        out.noteOff(btnMidiChannel, btnMidiNote, 0 );
+        return LED_RESTORE;
+      default:
+        return LED_KEEP;
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * @file legacy_handle_event.h
+ * @brief The branch chain handleEvent() used before the precompiled action table.
+ *
+ * @details Kept as baseline for bench_engine.cpp. It lives in its own translation unit so
+ * it is compiled under the same conditions as MidiEngine::handleEvent().
+ */
+
+#ifndef LEGACY_HANDLE_EVENT_H
+#define LEGACY_HANDLE_EVENT_H
+
+#include "midi_engine.h"
+
+#define LEGACY_MAPS 4
+
+// the former myButton: every setting as an array over the maps, 68 bytes per button
+struct myLegacyButton
+{
+  uint8_t btnGpio;
+  bool needRelease[LEGACY_MAPS];
+  uint8_t btnFunction[LEGACY_MAPS];
+  bool btnLongpress[LEGACY_MAPS];
+  uint8_t btnState[LEGACY_MAPS];
+  uint32_t btnColor[LEGACY_MAPS];
+  uint8_t btnMidiFunction[LEGACY_MAPS];
+  uint8_t btnMidiChannel[LEGACY_MAPS];
+  uint8_t btnMidiNote[LEGACY_MAPS];
+  uint8_t btnMidiVelocity[LEGACY_MAPS];
+  uint8_t btnMidiCC[LEGACY_MAPS];
+  uint8_t btnMidiCCValueStateOn[LEGACY_MAPS];
+  uint8_t btnMidiCCValueStateOff[LEGACY_MAPS];
+  uint8_t btnMidiMMC[LEGACY_MAPS];
+};
+
+// the BLEMidiServer helpers the former handleEvent() called, each builds its message and sends it
+class LegacyMidiCalls {
+public:
+  explicit LegacyMidiCalls(MidiOutput& out) : _out(out) {}
+  void noteOn(uint8_t channel, uint8_t note, uint8_t velocity) { uint8_t m[3] = { uint8_t(0x90 | channel), note, velocity }; _out.send(m, 3, 0); }
+  void noteOff(uint8_t channel, uint8_t note, uint8_t velocity) { uint8_t m[3] = { uint8_t(0x80 | channel), note, velocity }; _out.send(m, 3, 0); }
+  void controlChange(uint8_t channel, uint8_t cc, uint8_t value) { uint8_t m[3] = { uint8_t(0xB0 | channel), cc, value }; _out.send(m, 3, 0); }
+  void mmc(uint8_t command) { uint8_t m[6] = { 0xF0, 0x7F, 0x7F, 0x06, command, 0xF7 }; _out.send(m, 6, 0); }
+private:
+  MidiOutput& _out;
+};
+
+uint8_t legacyHandleEvent(LegacyMidiCalls& out, myLegacyButton* myBtn, uint8_t eventType, uint8_t active_mapper);
+
+#endif // LEGACY_HANDLE_EVENT_H
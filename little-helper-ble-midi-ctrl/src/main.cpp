@@ -16,18 +16,54 @@
  * This code is licensed under the GNU General Public License version 3 (GPL-3.0).
  */
 
-#define USE_OTA
+#ifndef LITTLE_HELPER_SIM // env:sim, src/sim has no HTTP client and no OTA partitions
+  #define USE_OTA
+#endif
+#define USE_LATENCY_STATS // edge -> handleEvent/send/notify histograms, Diagnostics tab and "latency" serial command
+// #define USE_LITE_UI // web/index.html (gzip, from flash) and a REST API of whole map records instead of the ESPUI controls
 #include "main.h"
 #include <Arduino.h>
 #include <BLEMidi.h>
 #include <FastLED.h>
 #include <AceButton.h>
 #include <Preferences.h>
+#include <BLEDevice.h>
+#include "midi_engine.h"
+#include "macro_sequencer.h"
+#include "ble_midi_output.h"
+#include "spsc_queue.h"
+#include "midi_in_queue.h"
+#include "feedback_index.h"
+#include "edge_debouncer.h"
+#include "led_compositor.h"
+#include "map_codec.h"
+#include "map_bank_store.h"
+#include "map_bank_cache.h"
+#include "preset_image.h"
+#include "write_behind.h"
+#include "device_config.h"
+#include "ota_ring.h"
+#include "ota_resume.h"
+#include "sha256.h"
+#include "delta_patch.h"
+#include "update_manifest.h"
+#include "button_fields.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_partition.h"
+#include "latency_stats.h" // histograms of the press latency (USE_LATENCY_STATS) and of the map switch
 //#include "esp32-hal-log.h"
 #include "esp_log.h"
 
 #include <DNSServer.h>
 #include <ESPUI.h>
+#ifdef USE_LITE_UI
+  #include <ESPAsyncWebServer.h>
+  #include "webui_page.h"
+  #define ESPUI_TREE false // no ESPUI controls to update
+#else
+  #define ESPUI_TREE true
+#endif
 
 #include <WiFi.h>
 
@@ -35,7 +71,7 @@
 #ifdef USE_OTA
   #include <HTTPClient.h>
   #include <WiFiClientSecure.h>
-  #include <Update.h>
+  #include "esp_ota_ops.h"
 #endif
 
 
@@ -47,9 +83,14 @@ DNSServer dnsServer;
 // // OTA Update globals
 // // Constants for server details
 #ifdef USE_OTA
-  const char* SERVER = "https://raw.githubusercontent.com"; // Your server address
+  // -DOTA_SERVER=\"http://192.168.1.10:8000\" fetches from tools/ota_server.py instead of GitHub
+  #ifndef OTA_SERVER
+    #define OTA_SERVER "https://raw.githubusercontent.com"
+  #endif
+  const char* SERVER = OTA_SERVER; // Your server address
   const int SERVER_PORT = 443; // Typically 443 for HTTPS
   const char* PATH = "/wolkstein/minimal-esp32-ble-midi-ctrl/main/bin/s3miniV"; // Path to the firmware
+  const char* MANIFEST_PATH = "/wolkstein/minimal-esp32-ble-midi-ctrl/main/bin/s3mini.manifest"; // latest version, tools/mkmanifest.py
   bool __ota_update_running = false;
 #endif
 
@@ -64,105 +105,80 @@ Preferences prefs;
 
 using namespace ace_button;
 
-// LED Strucutre
+// LED Strucutre, owned by the LED task, everybody else posts to ledCompositor
 CRGB myWS28XXLED[NUM_LEDS];
+LedCompositor ledCompositor;
+TaskHandle_t __ledTask = nullptr;
+
+// LED task: renders the posted layers every LED_FRAME_MS and shows only changed frames
+void ledTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
+  myLedFrame frame;
+  for (;;) {
+    if (ledCompositor.render(millis(), frame)) {
+      myWS28XXLED[0] = CRGB(frame.color);
+      FastLED.setBrightness(frame.brightness);
+      FastLED.show();
+    }
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LED_FRAME_MS));
+  }
+}
+
+void startLedTask() {
+  // lowest priority, a late frame only delays the LED
+  xTaskCreatePinnedToCore(ledTask, "led", 2048, nullptr, 1, &__ledTask, ARDUINO_RUNNING_CORE);
+}
+
+// base color of the active map while connected
+uint32_t mapLedColor() {
+  return __active_map % 2 == 0 ? CRGB::Green : CRGB::Purple;
+}
+
+// Buttons, the GPIO of each button
+myButton myBtnMap[5] = {
+  { 10 }, // Button 1
+  { 11 }, // Button 2
+  { 12 }, // Button 3
+  { 13 }, // Button 4
+  { 14 }, // Button 5
+};
 
-CRGB __oldLedColor;
-
-uint8_t __numBlincs = 1;
-uint32_t __oldNumBlinktime = 0;
-uint32_t __oldBlinktime = 0;
-
-// Button Structure now with n Maps, first we try 4 Maps
-myButton myBtnMap[5] = { // 5 Buttons 4 Maps Map 1 und Map 2 are short press values, Map 3 and Map 4 are long press values
-  { // Button 1
-     10,  // GPIO Pin
-     {false, false, false, false}, // Button Release
-     {BTN_PUSH, BTN_PUSH, BTN_PUSH, BTN_PUSH},// Button Function 0 = Push, 1 = Toggle
-     {false, false, false, false}, // Button Long Press
-     {BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF}, // Button State 0 = Off, 1 = On
-     {CRGB::Red, CRGB::Red, CRGB::Red, CRGB::Red}, // Button Color 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-     {MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC}, // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-     {MIDI_CH_1, MIDI_CH_1, MIDI_CH_1, MIDI_CH_1}, // Button MIDI Channel 0 - 15
-     {60, 60, 60, 60}, // Button MIDI Note 0 - 127
-     {100, 100,100, 100}, // Button MIDI Velocity 0 - 127
-     {43, 111, 43, 111}, // Button MIDI CC 0 - 127
-     {127, 127, 127, 127}, // Button MIDI CC ON Value 0 - 127
-     {0, 0, 0, 0}, // Button MIDI CC OFF Value 0 - 127
-     {MMC_REWIND, MMC_REWIND, MMC_REWIND, MMC_REWIND} // Button MIDI MMC 0 - 13
-  },
-  { // Button 2
-     11,  // GPIO Pin
-     {false, false, false, false}, // Button Release
-     {BTN_PUSH, BTN_PUSH, BTN_PUSH, BTN_PUSH},// Button Function 0 = Push, 1 = Toggle
-     {false, false, false, false}, // Button Long Press
-     {BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF}, // Button State 0 = Off, 1 = On
-     {CRGB::Yellow, CRGB::Yellow, CRGB::Yellow, CRGB::Yellow}, // Button Color 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-     {MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC}, // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-     {MIDI_CH_1, MIDI_CH_1, MIDI_CH_1, MIDI_CH_1}, // Button MIDI Channel 0 - 15
-     {61, 61, 61, 61}, // Button MIDI Note 0 - 127
-     {100, 100, 100, 100}, // Button MIDI Velocity 0 - 127
-     {42, 42, 42, 42}, // Button MIDI CC 0 - 127
-     {127, 127, 127, 127}, // Button MIDI CC ON Value 0 - 127
-     {0, 0, 0, 0}, // Button MIDI CC OFF Value 0 - 127
-     {MMC_STOP, MMC_STOP, MMC_STOP, MMC_STOP} // Button MIDI MMC 0 - 13
-  },
-  { // Button 3
-     12,  // GPIO Pin
-     {false, false, false, false}, // Button Release
-     {BTN_PUSH, BTN_PUSH, BTN_PUSH, BTN_PUSH},// Button Function 0 = Push, 1 = Toggle
-     {false, false, false, false}, // Button Long Press
-     {BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF}, // Button State 0 = Off, 1 = On
-     {CRGB::Cyan, CRGB::Cyan, CRGB::Cyan, CRGB::Cyan}, // Button Color 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-     {MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC}, // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-     {MIDI_CH_1, MIDI_CH_1, MIDI_CH_1, MIDI_CH_1}, // Button MIDI Channel 0 - 15
-     {62, 62, 62, 62}, // Button MIDI Note 0 - 127
-     {100, 100, 100, 100}, // Button MIDI Velocity 0 - 127
-     {44, 112, 44, 112}, // Button MIDI CC 0 - 127
-     {127, 127, 127, 127}, // Button MIDI CC ON Value 0 - 127
-     {0, 0, 0, 0}, // Button MIDI CC OFF Value 0 - 127
-     {MMC_STOP, MMC_STOP, MMC_STOP, MMC_STOP} // Button MIDI MMC 0 - 13
-  },
-  { // Button 4
-     13,  // GPIO Pin
-     {true, true, true, true}, // Button Release
-     {BTN_PUSH, BTN_PUSH, BTN_PUSH, BTN_PUSH},// Button Function 0 = Push, 1 = Toggle
-     {false, true, false, true}, // Button Long Press
-     {BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF}, // Button State 0 = Off, 1 = On
-     {CRGB::Aquamarine, CRGB::Aquamarine, CRGB::Aquamarine, CRGB::Aquamarine}, // Button Color 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-     {MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC}, // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-     {MIDI_CH_1, MIDI_CH_1, MIDI_CH_1, MIDI_CH_1}, // Button MIDI Channel 0 - 15
-     {62, 62, 62, 62}, // Button MIDI Note 0 - 127
-     {100, 100, 100, 100}, // Button MIDI Velocity 0 - 127
-     {45, 64, 45, 64}, // Button MIDI CC 0 - 127
-     {127, 127, 127, 127}, // Button MIDI CC ON Value 0 - 127
-     {0, 0, 0, 0}, // Button MIDI CC OFF Value 0 - 127
-     {MMC_STOP, MMC_STOP, MMC_STOP, MMC_STOP} // Button MIDI MMC 0 - 13
-  },
-  { // Button 5
-     14,  // GPIO Pin
-     {false, false, false, false}, // Button Release
-     {BTN_PUSH, BTN_PUSH, BTN_PUSH, BTN_PUSH},// Button Function 0 = Push, 1 = Toggle
-     {false, false, false, false}, // Button Long Press
-     {BTN_OFF, BTN_OFF, BTN_OFF, BTN_OFF}, // Button State 0 = Off, 1 = On
-     {CRGB::Blue, CRGB::Blue, CRGB::Blue, CRGB::Blue}, // Button Color 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-     {MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC, MIDIFUNC_CC}, // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-     {MIDI_CH_1, MIDI_CH_1, MIDI_CH_1, MIDI_CH_1}, // Button MIDI Channel 0 - 15
-     {62, 62, 62, 62}, // Button MIDI Note 0 - 127
-     {100, 100, 100, 100}, // Button MIDI Velocity 0 - 127
-     {41, 41, 41, 41}, // Button MIDI CC 0 - 127
-     {127, 127, 127, 127}, // Button MIDI CC ON Value 0 - 127
-     {0, 0, 0, 0}, // Button MIDI CC OFF Value 0 - 127
-     {MMC_STOP, MMC_STOP, MMC_STOP, MMC_STOP} // Button MIDI MMC 0 - 13
-  },
+// Macros, a button with btnMacro 1 .. MACRO_COUNT plays its macro instead of its own message.
+// Stored in the NVS namespace "macros" (loadMacros()), edited with POST /api/macros. The
+// default macro 1 is "select next route, arm record, start transport" of
+// DAW_MIDI_MAPS/ArdourAndHarrisonMixbus/midi_maps/Little_Helper.map.
+myMacro myMacros[MACRO_COUNT] = {
+  { 3, { { 0, 3, { 0xB0, 112, 127 } }, { 50, 3, { 0xB0, 64, 127 } }, { 50, 3, { 0xB0, 41, 127 } } } },
 };
 
+// One myMapButton per map and button: MIDI function, Push/Toggle, release, long press, macro,
+// channel, MMC, note, velocity, CC, CC on/off value, color. Odd maps are the long press
+// alternative of the map before (button 2 long press switches between the two).
+#define DEFAULT_MAP(cc1, cc3, cc4, long4) { \
+  { MIDI_CC, BTN_PUSH, false, false, 0, MIDI_CH_1, MMC_REWIND, 60, 100, cc1, 127, 0, PALETTE_Red }, \
+  { MIDI_CC, BTN_PUSH, false, false, 0, MIDI_CH_1, MMC_STOP, 61, 100, 42, 127, 0, PALETTE_Yellow }, \
+  { MIDI_CC, BTN_PUSH, false, false, 0, MIDI_CH_1, MMC_STOP, 62, 100, cc3, 127, 0, PALETTE_Cyan }, \
+  { MIDI_CC, BTN_PUSH, true, long4, 0, MIDI_CH_1, MMC_STOP, 62, 100, cc4, 127, 0, PALETTE_Aquamarine }, \
+  { MIDI_CC, BTN_PUSH, false, false, 0, MIDI_CH_1, MMC_STOP, 62, 100, 41, 127, 0, PALETTE_Blue }, \
+}
+
+// the read-only presets (preset_image.h), mapped from the "presets" partition by mapPresets()
+PresetImage presetImage;
+
+// the settings of a map without a stored record: its preset, else the built in defaults
+void defaultMap(uint8_t map, myMapButton* buttons, uint8_t numButtons) {
+  static const myMapButton even[5] = DEFAULT_MAP(43, 44, 45, false);
+  static const myMapButton odd[5] = DEFAULT_MAP(111, 112, 64, true);
+  memcpy(buttons, map % 2 ? odd : even, (numButtons < 5 ? numButtons : 5) * sizeof(myMapButton));
+  // decoded from flash in place, decodeMap() checks the CRC before it writes the buttons
+  presetImage.load(map, buttons, numButtons);
+}
+
+// the palette must be the FastLED colors of the same name
+#define PALETTE_CHECK(name, rgb) static_assert((uint32_t)CRGB::HTMLColorCode::name == rgb, #name " differs from FastLED");
+BUTTON_PALETTE_COLORS(PALETTE_CHECK)
+#undef PALETTE_CHECK
 
-AceButton btn1(myBtnMap[0].btnGpio); // GPIO 10
-AceButton btn2(myBtnMap[1].btnGpio); // GPIO 11
-AceButton btn3(myBtnMap[2].btnGpio); // GPIO 12
-AceButton btn4(myBtnMap[3].btnGpio); // GPIO 13
-AceButton btn5(myBtnMap[4].btnGpio); // GPIO 14
 
 myButton* getMyButton(int pin) {
     switch(pin) {
@@ -175,653 +191,1754 @@ myButton* getMyButton(int pin) {
     }
 }
 
-#ifdef USE_OTA
+// ~ Input ~
+// The buttons are not polled. A GPIO edge interrupt timestamps the edge and queues it,
+// the input task debounces the edges and lets AceButton turn the debounced levels into events.
+struct myButtonEdge {
+  uint8_t btn;     // index into myBtnMap
+  uint8_t level;   // pin level after the edge
+  uint32_t timeUs; // esp_timer time of the edge
+};
 
-void otaUpdate(Control* sender, int type) {
-  // set an boot variable into nvs to check next time boot.
-  prefs.begin("doupdate");  //Open namespace Settings
-  prefs.putBool("doupdate", true);
-  prefs.end(); // close the Settings Namespace
+SpscQueue<myButtonEdge, 32> __edgeQueue; // GPIO ISR -> input task
+volatile bool __edgeQueueOverflow = false;
+EdgeDebouncer __debouncer;
+TaskHandle_t __inputTask = nullptr;
+
+// AceButton reads the debounced level instead of the pin
+class IsrButtonConfig : public ButtonConfig {
+public:
+  int readButton(uint8_t pin) override {
+    myButton* btn = getMyButton(pin);
+    if (btn == nullptr) return HIGH;
+    return __debouncer.level(btn - myBtnMap) ? HIGH : LOW;
+  }
+};
 
-  ESPUI.updateControlValue(sender, "Update requested need Reeboot");
+IsrButtonConfig isrButtonConfig;
+
+AceButton btn1(&isrButtonConfig, myBtnMap[0].btnGpio); // GPIO 10
+AceButton btn2(&isrButtonConfig, myBtnMap[1].btnGpio); // GPIO 11
+AceButton btn3(&isrButtonConfig, myBtnMap[2].btnGpio); // GPIO 12
+AceButton btn4(&isrButtonConfig, myBtnMap[3].btnGpio); // GPIO 13
+AceButton btn5(&isrButtonConfig, myBtnMap[4].btnGpio); // GPIO 14
+
+
+#ifdef USE_LATENCY_STATS
+// ~ latency instrumentation ~
+// handleEvent() opens a sample for every press/release that sends MIDI, the packet sink
+// stamps the send time and hands the samples to the BT stack task, the notify confirmation
+// stamps the notify time and queues them for loop(), which fills the histograms.
+// Every sent packet has exactly one packetEnd entry in flight (a marker with edgeUs 0 if
+// the packet carries no sample), so the confirmations stay in step with the packets.
+myLatencySample __latencyOpen[8];                 // input task, samples of the current pass
+uint8_t __latencyOpenCount = 0;
+SpscQueue<myLatencySample, 32> __latencyInFlight; // input task -> BT stack task
+SpscQueue<myLatencySample, 64> __latencyRing;     // BT stack task -> loop()
+volatile uint32_t __latencyDropped = 0;
+LatencyStats __latencyStats;                      // loop() only
+uint16_t __latencyLabel[LATENCY_STAGES + 1];      // Diagnostics tab, last one = dropped samples
+
+// input task
+void latencyOpen(uint32_t edgeUs, uint32_t handleUs) {
+  if (__latencyOpenCount >= sizeof(__latencyOpen) / sizeof(__latencyOpen[0])) {
+    __latencyDropped++;
+    return;
+  }
+  myLatencySample& sample = __latencyOpen[__latencyOpenCount++];
+  sample.edgeUs = edgeUs;
+  sample.stageUs[LATENCY_HANDLE] = handleUs ? handleUs : 1; // 0 is a stage not reached
+  sample.stageUs[LATENCY_SEND] = 0;
+  sample.stageUs[LATENCY_NOTIFY] = 0;
+  sample.packetEnd = false;
 }
 
-void justotaUpdate() {
-
-  // reset firmware update flag
-  prefs.begin("doupdate");  //Open namespace Settings
-  prefs.putBool("doupdate", false);
-  prefs.end(); // close the Settings Namespace
-
-  __UPDATE_FAILURE = true; // set this true, while this function is running
-  prefs.begin("updatefail");  //Open namespace Settings
-  prefs.putBool("updatefail", __UPDATE_FAILURE);
-  prefs.end(); // close the Settings Namespace
-
-  if (__ota_update_running) {
-    Serial.println("OTA update already running.");
+// input task, after a packet went to the BLE stack
+void latencyPacketSent() {
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+  myLatencySample marker = {};
+  marker.packetEnd = true;
+  if (__latencyOpenCount == 0) {
+    if (__isConnected) __latencyInFlight.push(marker);
     return;
   }
-  
-  __ota_update_running = true;
-  WiFiClientSecure wifiClientSSL;
-  wifiClientSSL.setInsecure(); // Not recommended for production, better to handle certificates properly
+  for (uint8_t i = 0; i < __latencyOpenCount; i++) {
+    myLatencySample& sample = __latencyOpen[i];
+    uint32_t sendUs = nowUs - sample.edgeUs;
+    sample.stageUs[LATENCY_SEND] = sendUs ? sendUs : 1; // 0 is a stage not reached
+    sample.packetEnd = i + 1 == __latencyOpenCount;
+    if (!__isConnected || !__latencyInFlight.push(sample)) __latencyDropped++;
+  }
+  __latencyOpenCount = 0;
+}
 
-  HTTPClient https;
-  char updateURL[100];
-  snprintf(updateURL, sizeof(updateURL), "%s%s%d.bin", SERVER, PATH, __FW_VERSION + 1);
+// BT stack task, the stack confirmed one notification
+void latencyNotifyDone() {
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+  myLatencySample sample;
+  while (__latencyInFlight.pop(sample)) {
+    if (sample.edgeUs != 0) {
+      uint32_t notifyUs = nowUs - sample.edgeUs;
+      sample.stageUs[LATENCY_NOTIFY] = notifyUs ? notifyUs : 1;
+      if (!__latencyRing.push(sample)) __latencyDropped++;
+    }
+    if (sample.packetEnd) break;
+  }
+}
 
-  Serial.print("Checking for update file: ");
-  Serial.println(updateURL);
+// BT stack task, on (dis)connect nothing in flight will be confirmed anymore
+void latencyDiscardInFlight() {
+  myLatencySample sample;
+  while (__latencyInFlight.pop(sample)) {
+    if (sample.edgeUs != 0 && !__latencyRing.push(sample)) __latencyDropped++;
+  }
+}
 
-  https.begin(wifiClientSSL, updateURL); // Begin connection
+void printLatency() {
+  char line[96];
+  for (uint8_t s = 0; s < LATENCY_STAGES; s++) {
+    __latencyStats.format(s, line, sizeof(line));
+    Serial.println(line);
+  }
+  Serial.printf("dropped samples: %u\n", (unsigned)__latencyDropped);
+}
 
-  int httpCode = https.GET(); // Make the GET request
+void resetLatencyCallback(Control* sender, int type) {
+  if (type != B_UP) return;
+  __latencyStats.reset();
+  __latencyDropped = 0;
+}
 
-  Serial.print("Update status code: ");
-  Serial.println(httpCode);
+// loop(): fill the histograms, update the Diagnostics tab every second and answer
+// the serial commands "latency" and "latency reset"
+void latencyReport() {
+  myLatencySample sample;
+  while (__latencyRing.pop(sample)) __latencyStats.add(sample);
+
+  static char command[24];
+  static uint8_t commandLen = 0;
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (commandLen < sizeof(command) - 1) command[commandLen++] = c;
+      continue;
+    }
+    command[commandLen] = 0;
+    if (strcmp(command, "latency") == 0) {
+      printLatency();
+    } else if (strcmp(command, "latency reset") == 0) {
+      __latencyStats.reset();
+      __latencyDropped = 0;
+      Serial.println("latency reset");
+    }
+    commandLen = 0;
+  }
 
-  if (httpCode != HTTP_CODE_OK) {
-    Serial.println("Failed to fetch update.");
-    https.end();
-    __ota_update_running = false;
-    __UPDATE_ERROR_CODE = httpCode;
-    prefs.begin("updateerrorcode");  //Open namespace Settings
-    prefs.putInt("updateerrorcode", __UPDATE_ERROR_CODE);
-    prefs.end(); // close the Settings Namespace 
-    ESP.restart();
-    return;
+  static unsigned long lastUiUpdate = 0;
+  if (ESPUI_TREE && __configurator && millis() - lastUiUpdate > 1000) {
+    lastUiUpdate = millis();
+    char line[96];
+    for (uint8_t s = 0; s < LATENCY_STAGES; s++) {
+      __latencyStats.format(s, line, sizeof(line));
+      ESPUI.updateLabel(__latencyLabel[s], line);
+    }
+    ESPUI.updateLabel(__latencyLabel[LATENCY_STAGES], String(__latencyDropped));
   }
+}
+#endif
 
-  int contentLength = https.getSize();
-  if (contentLength <= 0) {
-    Serial.println("Invalid content length. Can't continue with update.");
-    https.end();
-    __ota_update_running = false;
-    return;
+// BLE-MIDI packets of the engine go straight to the MIDI characteristic of BLEMidiServer.
+// The library only exposes single message helpers, its packet send is a protected member
+// of the Midi base class, this accessor reaches it without patching the library.
+class BleMidiServerPacketSink : public BleMidiPacketSink {
+public:
+  void sendPacket(const uint8_t* packet, uint8_t len) override {
+    Access::send(BLEMidiServer, const_cast<uint8_t*>(packet), len);
+#ifdef USE_LATENCY_STATS
+    latencyPacketSent();
+#endif
   }
 
-  Serial.print("Server returned update file of size ");
-  Serial.print(contentLength);
-  Serial.println(" bytes");
+private:
+  struct Access : Midi {
+    static void send(Midi& midi, uint8_t* packet, uint8_t len) {
+      (midi.*(&Access::sendPacket))(packet, len);
+    }
+  };
+};
 
-  // Prepare for the update
-  Serial.print("Free heap before OTA: ");
-  Serial.println(ESP.getFreeHeap());
+// negotiated ATT MTU, written by the BT stack task, applied in the input task
+volatile uint16_t __bleMtu = BLE_MIDI_DEFAULT_MTU;
+volatile uint32_t __bleIntervalUs = BLE_MIDI_DEFAULT_INTERVAL_US; // connection interval, the map switch budget
 
+// ~ MIDI in ~
+// Every packet written to the MIDI characteristic is decoded in the BT stack task and its
+// messages go through __midiIn to the input task, which routes them between two button scans.
+// The BT stack task never takes __mapLock, writes NVS or updates the LEDs for incoming MIDI.
+MidiInQueue __midiIn; // BT stack task -> input task
+uint16_t midiInStatsLabel;
 
-  if (!Update.begin(contentLength, U_FLASH, 15, 0, NULL)) {
-      Serial.println("Not enough space to begin OTA");
-      https.end();
-      __ota_update_running = false;
-      return;
-  } else {
-      Serial.println("OTA Update started");
+// the BLE-MIDI characteristic 7772E5DB-3868-4112-A1A9-F2669D106BF3 in the byte order of esp_bt_uuid_t
+const uint8_t BLE_MIDI_CHAR_UUID[ESP_UUID_LEN_128] = {
+  0xF3, 0x6B, 0x10, 0x9D, 0x66, 0xF2, 0xA9, 0xA1, 0x12, 0x41, 0x68, 0x38, 0xDB, 0xE5, 0x72, 0x77
+};
+volatile uint16_t __midiCharHandle = 0; // its value handle, set when BLEMidiServer.begin() adds it
+
+// BT stack task, every write of the MIDI characteristic is one BLE-MIDI packet, a SysEx
+// continuation without a timestamp byte included
+void midiInWrite(const uint8_t* value, uint16_t len) {
+  __midiIn.receive(value, len);
+  if (__inputTask != nullptr && !__midiIn.empty()) xTaskNotifyGive(__inputTask);
+}
+
+void gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param) {
+  if (event == ESP_GATTS_ADD_CHAR_EVT && param->add_char.char_uuid.len == ESP_UUID_LEN_128
+    && memcmp(param->add_char.char_uuid.uuid.uuid128, BLE_MIDI_CHAR_UUID, ESP_UUID_LEN_128) == 0) {
+    __midiCharHandle = param->add_char.attr_handle;
+  }
+  // the writes of the notify descriptor have the next handle
+  if (event == ESP_GATTS_WRITE_EVT && !param->write.is_prep && param->write.handle == __midiCharHandle) {
+    midiInWrite(param->write.value, param->write.len);
   }
+  if (event == ESP_GATTS_MTU_EVT) __bleMtu = param->mtu.mtu;
+  if (event == ESP_GATTS_DISCONNECT_EVT) {
+    __bleMtu = BLE_MIDI_DEFAULT_MTU;
+    __midiIn.resetParser();
+  }
+  if (event == ESP_GATTS_CONNECT_EVT) __bleIntervalUs = param->connect.conn_params.interval * 1250; // 1.25 ms units
+#ifdef USE_LATENCY_STATS
+  if (event == ESP_GATTS_CONF_EVT) latencyNotifyDone();
+  if (event == ESP_GATTS_CONNECT_EVT || event == ESP_GATTS_DISCONNECT_EVT) latencyDiscardInFlight();
+#endif
+}
 
-  size_t written = 0; // Variable to store how many bytes have been written
-  WiFiClient *stream = https.getStreamPtr();
-  Serial.println("stream-angefordert");
-  int schleifeaussen = 0;
-  https.setTimeout(60000); // 12 Sekunden Timeout
+BleMidiServerPacketSink bleMidiPacketSink;
+BleMidiBatchOutput bleMidiOutput(bleMidiPacketSink);
+MidiActionTable midiActionTable;
+MidiEngine midiEngine(bleMidiOutput, midiActionTable);
+
+// ~ macros ~
+// The input task starts the macros and runs the sequencer, all its sends go through the same
+// batch output as the button messages. While a macro plays a periodic esp_timer wakes the
+// input task every tick, else the task sleeps until the next edge as before.
+#define MACRO_TICK_US 1000
+MacroSequencer macroSequencer(bleMidiOutput);
+esp_timer_handle_t __macroTimer = nullptr;
+bool __macroTimerRunning = false; // input task only
+
+// ~ map banks ~
+// Every map is a record (map_codec.h) in its slot of the "banks" flash partition
+// (map_bank_store.h), one map per Program Change. MAP_CACHE_SLOTS maps are in RAM
+// (map_bank_cache.h): the active map, pinned, the maps used last and the neighbours of the
+// active map, which loop() prefetches after a map switch. The input, BT stack, web server
+// and loop tasks all reach the cache, __mapLock serializes them. It is held for the RAM work
+// and the flash reads of a miss, never for a flash write: writeMapSlots() writes a copy.
+MapBankStore mapBankStore;
+MapBankCache mapBankCache(mapBankStore, defaultMap, __HW_BUTTONS);
+SemaphoreHandle_t __mapLock = nullptr;
+volatile int16_t __prefetchMap = -1; // loop() loads the neighbours of this map, -1 = none
+// the action table is compiled and read on the input task only, the other tasks ask for it
+volatile int16_t __switchMap = -1;        // the input task switches to this map, -1 = none (switchMap())
+volatile bool __compileRequested = false; // the input task compiles the active map again (requestCompile())
+LatencyHistogram __mapSwitchUs;       // activateMap(), lock, cache lookup and compile
+uint32_t __mapSwitchOverBudget = 0;   // switches longer than one BLE connection interval
+// the last switch, printed by loop(): Serial on the input task blocks it while the USB CDC buffer is full
+volatile int16_t __mapSwitchReport = -1; // map switched to, -1 = printed
+volatile uint32_t __mapSwitchLastUs = 0;
+volatile bool __mapSwitchCached = false;
+// DAW feedback (feedback_index.h): Note / CC -> toggle buttons of the active map, rebuilt with
+// every compile of the action table, under __mapLock like the cache
+FeedbackIndex feedbackIndex;
+
+// holds __mapLock while in scope, recursive, so a locked caller may call another locked function
+class MapLock {
+public:
+  MapLock() { xSemaphoreTakeRecursive(__mapLock, portMAX_DELAY); }
+  ~MapLock() { xSemaphoreGiveRecursive(__mapLock); }
+};
 
-  uint8_t buff[128] = { 0 }; // Größe des Buffers anpassen
-  size_t len = 0; // Variable to store the length of data available for reading
+class PartitionBankFlash : public MapBankFlash {
+public:
+  explicit PartitionBankFlash(const esp_partition_t* partition) : _partition(partition) {}
+  uint32_t size() const override { return _partition->size; }
+  bool read(uint32_t offset, void* buf, size_t len) override {
+    return esp_partition_read(_partition, offset, buf, len) == ESP_OK;
+  }
+  bool write(uint32_t offset, const void* buf, size_t len) override {
+    return esp_partition_write(_partition, offset, buf, len) == ESP_OK;
+  }
+  bool eraseSector(uint32_t offset) override {
+    return esp_partition_erase_range(_partition, offset, MAP_BANK_SECTOR_SIZE) == ESP_OK;
+  }
 
-  bool toggleLed = false;
-  while (https.connected() && (written < contentLength)) {
+private:
+  const esp_partition_t* _partition;
+};
 
-      len = stream->available();
-      delay(2); // Kleine Verzögerung, um dem Stream Zeit zu geben, Daten zu sammeln
+// The records "map0".."map127" in the NVS namespace "Settings", the map store of units that
+// were updated over the air from the firmware before the map banks and so have no "banks"
+// partition. It has a handle of its own, open until the reboot, the global prefs is opened
+// and closed by other tasks.
+class NvsMapStore : public MapRecordStore {
+public:
+  bool begin() { return _prefs.begin("Settings"); }
+  size_t read(uint8_t map, uint8_t* buf, size_t size) override {
+    char key[8];
+    snprintf(key, sizeof(key), "map%u", map);
+    size_t len = _prefs.getBytesLength(key);
+    if (len == 0 || len > size) return 0;
+    return _prefs.getBytes(key, buf, len) == len ? len : 0;
+  }
+  bool write(uint8_t map, const uint8_t* record, size_t len) override {
+    uint8_t stored[MAP_CODEC_MAX_SIZE];
+    if (read(map, stored, sizeof(stored)) == len && memcmp(stored, record, len) == 0) {
+      _unchanged++;
+      return true;
+    }
+    char key[8];
+    snprintf(key, sizeof(key), "map%u", map);
+    if (_prefs.putBytes(key, record, len) != len) return false;
+    _writes++;
+    return true;
+  }
+  uint32_t writes() const { return _writes; }
+  uint32_t unchanged() const { return _unchanged; }
 
-      if (len > 0) {
-          int c = stream->readBytes(buff, ((len < sizeof(buff)) ? len : sizeof(buff)));
-          if (Update.write(buff, c) != c) {
-              Serial.println("Error writing to flash. Aborting OTA.");
-              Update.abort();
-              return; // Verlässt die Funktion oder Schleife
-          }
-          
+private:
+  Preferences _prefs;
+  uint32_t _writes = 0;
+  uint32_t _unchanged = 0;
+};
 
-          written += c;
-          //Serial.printf("len: %d, written: %d\n", len, written);
-          yield(); // Ermöglicht das Ausführen von Hintergrundaufgaben, verhindert WDT-Reset
-      }
+NvsMapStore nvsMapStore;
+bool __mapsInNvs = false; // no banks partition, nvsMapStore keeps the maps
+
+// the "banks" partition of configuration/partitions.csv, without it the maps stay in NVS
+void mountMapBanks() {
+  __mapLock = xSemaphoreCreateRecursiveMutex();
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "banks");
+  if (partition == nullptr || partition->size < MAP_BANK_PARTITION_SIZE) {
+    log_e("No banks partition, the maps stay in NVS");
+    if (!nvsMapStore.begin()) log_e("Opening the NVS maps failed");
+    mapBankCache.setStore(nvsMapStore);
+    __mapsInNvs = true;
+    Serial.printf("Map banks: none, %u maps in NVS\n", NUBER_OF_MAPS);
+    return;
+  }
+  uint16_t maps = mapBankStore.mount(new PartitionBankFlash(partition));
+  Serial.printf("Map banks: %u slots for %u maps%s\n", maps, NUBER_OF_MAPS, mapBankStore.empty() ? ", empty" : "");
+}
 
-      if(toggleLed) {
-        myWS28XXLED[0] = CRGB::Purple;
-        FastLED.show();
-      } else {
-        myWS28XXLED[0] = CRGB::Black;
-        FastLED.show();
-      }
-      toggleLed = !toggleLed;
-  }
-
-  if (written == contentLength) {
-      Serial.println("Written : " + String(written) + " successfully");
-  }
-
-  if (Update.end()) {
-      Serial.println("OTA done!");
-      if (Update.isFinished()) {
-          Serial.println("Update successfully completed. Rebooting.");
-          __UPDATE_FAILURE = false; // set this true, while this function is running
-          prefs.begin("updatefail");  //Open namespace Settings
-          prefs.putBool("updatefail", __UPDATE_FAILURE);
-          prefs.end(); // close the Settings Namespace
-
-          __UPDATE_ERROR_CODE = -1;
-          prefs.begin("updateerrorcode");  //Open namespace Settings
-          prefs.putInt("updateerrorcode", __UPDATE_ERROR_CODE);
-          prefs.end(); // close the Settings Namespace 
-
-          Serial.println("OTA Done!");
-          Serial.printf("update fw version: %d\n", __FW_VERSION + 1);
-          __FW_VERSION++;
-          prefs.begin("fwversion");  //Open namespace Settings
-          prefs.putUInt("fwversion", __FW_VERSION);
-          prefs.end(); // close the Settings Namespace
-          Serial.println("Rebooting...");
-          ESP.restart();
-      } else {
-          Serial.println("Update not finished? Something went wrong!");
-          __ota_update_running = false;
-      }
+// map the "presets" partition into the data address space and check its header, the
+// presets are read in place from flash when a map is loaded, nothing is copied into the heap
+void mapPresets() {
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "presets");
+  if (partition == nullptr) {
+    log_i("No presets partition");
+    return;
+  }
+  uint32_t start = micros();
+  const void* data = nullptr;
+  spi_flash_mmap_handle_t handle; // the mapping lasts until the reboot
+  if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &data, &handle) != ESP_OK) {
+    log_e("Mapping the presets partition failed");
+    return;
+  }
+  if (presetImage.attach((const uint8_t*)data, partition->size)) {
+    Serial.printf("Presets: %u maps, %u bytes mapped in %lu us\n", presetImage.maps(), presetImage.imageSize(),
+      (unsigned long)(micros() - start));
   } else {
-      Serial.println("Error Occurred. Error #: " + String(Update.getError()));
-      __ota_update_running = false;
+    log_i("Presets partition is empty");
   }
 }
-#endif
 
-// ~ OTA ~
-// helper function to get the button configuration based on the GPIO pin and the active map
-void saveActiveMap() {
-  __numBlincs = (__active_map + 1) * 2;
-    prefs.begin("active_map"); // Open NVS namespace "Settings" in RW mode
-    prefs.putUInt("active_map", __active_map); // Store the active map
-    prefs.end(); // Close NVS
-    Serial.printf("Save Active Map: %d\n", __active_map);
-    if (__active_map %2 == 0) {
-      myWS28XXLED[0] = CRGB::Green;
-      __oldLedColor = CRGB::Green;
-    } else {
-      myWS28XXLED[0] = CRGB::Purple;
-      __oldLedColor = CRGB::Purple;
-    }
-    if(!__isConnected) myWS28XXLED[0] = CRGB::Red;
-    FastLED.show();
+// a map from the cache, read from its bank on a miss, with __mapLock held. nullptr if every
+// other slot holds changes not written yet, loop() writes them now and the next call loads it.
+myCachedMap* loadMap(uint8_t map) {
+  myCachedMap* entry = mapBankCache.get(map);
+  if (entry == nullptr) __flushSettingsRequested = true;
+  return entry;
 }
 
-// WEB UI Callbacks
-void nothing(Control* sender, int type) {
-    // Do nothing
+// compile the button actions of the active map, call after every settings change of it
+void compileActiveMap() {
+  MapLock lock;
+  myCachedMap* entry = mapBankCache.find(__active_map);
+  if (entry == nullptr) entry = loadMap(__active_map);
+  if (entry == nullptr) {
+    log_e("Map %u not loaded", __active_map);
+    return;
+  }
+  mapBankCache.pin(__active_map);
+  midiActionTable.compile(entry->buttons, entry->states, __HW_BUTTONS, __active_map);
+  feedbackIndex.rebuild(entry->buttons, __HW_BUTTONS);
 }
 
-void selectActiveMap(Control* sender, int value) {
-    uint8_t active_map = static_cast<uint8_t>(String(sender->value).toInt());
-    __active_map = active_map;
-    __numBlincs = (__active_map + 1) * 2;
-    saveActiveMap();
+// compileActiveMap() on the input task, right away on it or before it runs
+void requestCompile() {
+  if (__inputTask == nullptr || xTaskGetCurrentTaskHandle() == __inputTask) {
+    compileActiveMap();
+    return;
+  }
+  __compileRequested = true;
+  xTaskNotifyGive(__inputTask);
 }
 
-void switchShowPasswords(Control* sender, int type) {
+// ~ device settings ~
+// Everything but the button maps lives in one CRC protected record "config" in the namespace
+// "config", read once at boot. The globals keep the runtime values, deviceConfig what is stored.
+#define SETTINGS_DEVICE_CONFIG MAP_CACHE_SLOTS // write-behind record number of deviceConfig, 0 .. MAP_CACHE_SLOTS - 1 are cache slots
+
+DeviceConfig deviceConfig;
+uint32_t __configLoadUs = 0; // time of the config read at boot
+
+void saveDeviceConfig() {
+  if (!deviceConfig.dirty()) return;
+  uint8_t record[DEVICE_CONFIG_RECORD_SIZE];
+  size_t len = deviceConfig.encode(record);
+  prefs.begin("config");
+  bool ok = prefs.putBytes("config", record, len) == len;
+  prefs.end();
+  if (ok) {
+    deviceConfig.clearDirty();
+  } else {
+    log_e("Writing config failed");
+  }
+}
 
-  if(sender->value == "0") {
-    ESPUI.setInputType(wlanApPasswordTxtField, "password");
-    ESPUI.setInputType(wlanPasswordTxtField, "password");
-  } else if(sender->value == "1") {  
-    ESPUI.setInputType(wlanApPasswordTxtField, "text");
-    ESPUI.setInputType(wlanPasswordTxtField, "text");
+// the stored values of the former single key namespaces, the globals keep their defaults for missing keys
+void importLegacySettings() {
+  if (prefs.begin("updateerrorcode", true)) {
+    if (prefs.isKey("updateerrorcode")) __UPDATE_ERROR_CODE = prefs.getInt("updateerrorcode");
+    prefs.end();
+  }
+  if (prefs.begin("updatefail", true)) {
+    if (prefs.isKey("updatefail")) __UPDATE_FAILURE = prefs.getBool("updatefail");
+    prefs.end();
+  }
+  if (prefs.begin("doupdate", true)) {
+    if (prefs.isKey("doupdate")) __DO_UPDATE = prefs.getBool("doupdate");
+    prefs.end();
+  }
+  if (prefs.begin("fwversion", true)) {
+    if (prefs.isKey("fwversion")) __FW_VERSION = prefs.getUInt("fwversion");
+    prefs.end();
+  }
+  if (prefs.begin("active_map", true)) {
+    if (prefs.isKey("active_map")) __active_map = prefs.getUInt("active_map");
+    prefs.end();
+  }
+  if (prefs.begin("blename", true)) {
+    if (prefs.isKey("blename")) midiDeviceName = prefs.getString("blename");
+    prefs.end();
+  }
+  if (prefs.begin("wifi", true)) {
+    if (prefs.isKey("ssid_local")) ssid = prefs.getString("ssid_local");
+    if (prefs.isKey("password_local")) password = prefs.getString("password_local");
+    if (prefs.isKey("ssid_ap")) ap_ssid = prefs.getString("ssid_ap");
+    if (prefs.isKey("password_ap")) ap_password = prefs.getString("password_ap");
+    if (prefs.isKey("hostname")) hostname = prefs.getString("hostname");
+    if (prefs.isKey("LedBrightness")) __BRIGHTNESS = prefs.getUInt("LedBrightness");
+    prefs.end();
   }
 }
 
-void textCallBlueThoothName(Control* sender, int type)
-{
-    String value = sender->value;
+// names, wifi and LED brightness of the globals into deviceConfig
+void configFromGlobals() {
+  deviceConfig.setBleName(midiDeviceName.c_str());
+  deviceConfig.setSsid(ssid.c_str());
+  deviceConfig.setPassword(password.c_str());
+  deviceConfig.setApSsid(ap_ssid.c_str());
+  deviceConfig.setApPassword(ap_password.c_str());
+  deviceConfig.setHostname(hostname.c_str());
+  deviceConfig.setLedBrightness(__BRIGHTNESS);
+}
 
-    if(value.length() < 8) {
-      ESPUI.updateControlValue(bleNameTxtField, "Name to short");
-      return;
-    }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(bleNameTxtField, "Name contains spaces");
-      return;
-    }
-    prefs.begin("blename", false); // Open NVS namespace "bluetooth" in RW mode
-    prefs.putString("blename", value); // Store Bluetooth name
-    prefs.end(); // Close NVS
-    
+/**
+ * @brief Load deviceConfig with one NVS read and set the globals from it.
+ *
+ * @details Without a valid record the former namespaces are imported once and written as record.
+ * @param factoryReset names, wifi and LED brightness go back to the compiled in defaults
+ */
+void loadDeviceConfig(bool factoryReset) {
+  uint32_t startUs = (uint32_t)esp_timer_get_time();
+  uint8_t record[DEVICE_CONFIG_RECORD_SIZE];
+  size_t len = 0;
+  if (prefs.begin("config", true)) {
+    len = prefs.getBytes("config", record, sizeof(record));
+    prefs.end();
+  }
+  bool valid = deviceConfig.decode(record, len);
+  __configLoadUs = (uint32_t)esp_timer_get_time() - startUs;
+
+  if (factoryReset) {
+    configFromGlobals(); // still the defaults
+  }
+  if (!valid) {
+    log_i("No valid config record, importing the former settings");
+    if (!factoryReset) importLegacySettings();
+    deviceConfig.setUpdateErrorCode(__UPDATE_ERROR_CODE);
+    deviceConfig.setUpdateFailure(__UPDATE_FAILURE);
+    deviceConfig.setDoUpdate(__DO_UPDATE);
+    deviceConfig.setFwVersion(__FW_VERSION);
+    deviceConfig.setActiveMap(__active_map);
+    configFromGlobals();
+  }
+  if (!valid || factoryReset) {
+    deviceConfig.markDirty(); // write the record even if every value equals the defaults
+    saveDeviceConfig();
+  }
+
+  __UPDATE_ERROR_CODE = deviceConfig.updateErrorCode();
+  __UPDATE_FAILURE = deviceConfig.updateFailure();
+  __DO_UPDATE = deviceConfig.doUpdate();
+  __FW_VERSION = deviceConfig.fwVersion();
+  __active_map = deviceConfig.activeMap() < NUBER_OF_MAPS ? deviceConfig.activeMap() : 0;
+  midiDeviceName = deviceConfig.bleName();
+  ssid = deviceConfig.ssid();
+  password = deviceConfig.password();
+  ap_ssid = deviceConfig.apSsid();
+  ap_password = deviceConfig.apPassword();
+  hostname = deviceConfig.hostname();
+  __BRIGHTNESS = deviceConfig.ledBrightness();
+  midiActionTable.setMmcDeviceId(deviceConfig.mmcDeviceId()); // before the first compile of the active map
+
+  Serial.printf("Config: fw %u, map %u, do update %d, update fail %d, error %d, loaded in %u us\n", __FW_VERSION,
+    __active_map, __DO_UPDATE, __UPDATE_FAILURE, __UPDATE_ERROR_CODE, __configLoadUs);
 }
 
-void textCallSsidName(Control* sender, int type) {
-    String value = sender->value;
+// ~ map settings persistence ~
+// Web UI changes mark the cache slot of their map (or deviceConfig) dirty, loop() writes
+// the changed maps into their bank once the UI was quiet for a moment (write-behind). A
+// dirty map that is evicted from the cache is written first, its slot is then clean and
+// the pending write of the slot has nothing to do. Pending changes are flushed before a
+// restart and when an OTA update is requested.
+#define NVS_MAPS 8 // the records "map0".."map7" in NVS of the firmware before the map banks
+
+WriteBehind settingsWriter;
+
+// "n writes, n erases, n unchanged, n UI changes" of the map store since the boot
+void formatMapWrites(char* str, size_t size) {
+  uint32_t writes = __mapsInNvs ? nvsMapStore.writes() : mapBankStore.writes();
+  uint32_t unchanged = __mapsInNvs ? nvsMapStore.unchanged() : mapBankStore.unchanged();
+  snprintf(str, size, "%u writes, %u erases, %u unchanged, %u UI changes", (unsigned)writes,
+    (unsigned)mapBankStore.erases(), (unsigned)unchanged, (unsigned)settingsWriter.changes());
+}
 
-    if(value.length() < 8) {
-      ESPUI.updateControlValue(wlanSsidNameTxtField, "Name to short");
-      return;
+// write the dirty maps of the cache slots of the mask. __mapLock is held for the copy of the
+// record only, a map switch on the input task does not wait for the flash erase.
+void writeMapSlots(uint32_t slots) {
+  if (slots == 0) return;
+  for (uint8_t slot = 0; slot < MAP_CACHE_SLOTS; slot++) {
+    if (!(slots & (1u << slot))) continue;
+    uint8_t record[MAP_CODEC_MAX_SIZE];
+    uint8_t map;
+    size_t len;
+    {
+      MapLock lock;
+      len = mapBankCache.beginWrite(slot, map, record, sizeof(record));
     }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(wlanSsidNameTxtField, "Name contains spaces");
-      return;
+    if (len == 0) continue;
+    bool written = mapBankCache.store().write(map, record, len);
+    {
+      MapLock lock;
+      mapBankCache.endWrite(slot, written);
     }
-    prefs.begin("wifi", false); // Open NVS namespace "wifi" in RW mode
-    
-    prefs.putString("ssid_local", value); // Store SSID
-    
-    prefs.end(); // Close NVS
-    
-
+    if (!written) {
+      log_e("Writing map %u failed, retry later", map);
+      settingsWriter.markDirty(slot, millis());
+    }
+  }
+  char str[64];
+  formatMapWrites(str, sizeof(str));
+  log_i("Map bank writes: %s", str);
 }
 
-void textCallWlanPassword(Control* sender, int type) {
-    String value = sender->value;
+// every map and macro back to its defaults (reset of the MIDI settings), the NVS maps are not imported anymore
+void resetMapBanks() {
+  if (!__mapsInNvs && !mapBankStore.format()) log_e("Erasing the map banks failed");
+  prefs.begin("Settings");
+  prefs.clear();
+  prefs.end();
+  prefs.begin("macros");
+  prefs.clear();
+  prefs.end();
+}
 
-    if(value.length() < 8) {
-      ESPUI.updateControlValue(wlanPasswordTxtField, "Name to short");
-      return;
-    }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(wlanPasswordTxtField, "Name contains spaces");
-      return;
-    }  
-    prefs.begin("wifi", false);
-    
-    prefs.putString("password_local", value); // Store password
-    
+// the stored macros over the defaults of myMacros
+void loadMacros() {
+  uint8_t record[MACRO_RECORD_MAX_SIZE];
+  size_t len = 0;
+  if (prefs.begin("macros", true)) {
+    len = prefs.getBytes("macros", record, sizeof(record));
     prefs.end();
-    
-
+  }
+  if (len && !decodeMacros(record, len, myMacros, MACRO_COUNT)) log_e("Macro record broken, keeping the defaults");
 }
 
-void textCallAPSsidName(Control* sender, int type) {
-    String value = sender->value;
+// call with __mapLock held
+bool saveMacros() {
+  uint8_t record[MACRO_RECORD_MAX_SIZE];
+  size_t len = encodeMacros(myMacros, MACRO_COUNT, record, sizeof(record));
+  prefs.begin("macros");
+  bool ok = len && prefs.putBytes("macros", record, len) == len;
+  prefs.end();
+  return ok;
+}
 
-    if(value.length() > 16) {
-      ESPUI.updateControlValue(wlanApSsidTxtField, "Name to long");
-      return;
-    }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(wlanApSsidTxtField, "Name contains spaces");
-      return;
-    }
-    prefs.begin("wifi", false); // Open NVS namespace "wifi" in RW mode
-    
-    prefs.putString("ssid_ap", value); // Store SSID
-    
-    prefs.end(); // Close NVS
-    
+// one NVS map record or the v0 blob into the store, false if the write failed or the
+// record read back differs
+bool importNvsMap(MapRecordStore& store, uint8_t map, const uint8_t* record, size_t len) {
+  myMapButton buttons[5];
+  defaultMap(map, buttons, __HW_BUTTONS);
+  my_map_codec_result result = decodeMap(record, len, map, buttons, __HW_BUTTONS);
+  if (result != MAP_CODEC_OK && result != MAP_CODEC_MIGRATED) {
+    log_i("NVS map %u %s, keeping the defaults", map, mapCodecResultName(result));
+    return true;
+  }
+  uint8_t stored[MAP_CODEC_MAX_SIZE];
+  len = encodeMap(buttons, __HW_BUTTONS, map, stored, sizeof(stored));
+  uint8_t check[MAP_BANK_SLOT_SIZE];
+  return store.write(map, stored, len) && store.read(map, check, sizeof(check)) == len && memcmp(check, stored, len) == 0;
+}
 
+/**
+ * @brief The first boot with map banks moves the maps of NVS into the banks 0 .. NVS_MAPS - 1.
+ *
+ * @details The records "map0".."map7" are migrated like a map read from a bank, without any
+ * record the single "Settings" blob of older firmware is converted. NVS is cleared once
+ * every map was written and read back from its bank, else it is kept. Without a banks
+ * partition the records stay where they are, NVS is the map store (mountMapBanks()), only
+ * the blob is converted into records and removed.
+ */
+void importNvsMaps() {
+  if (!__mapsInNvs && !mapBankStore.empty()) return;
+  if (!prefs.begin("Settings", true)) return;
+  MapRecordStore& store = __mapsInNvs ? static_cast<MapRecordStore&>(nvsMapStore) : mapBankStore;
+  bool records = false, blob = false, ok = true;
+  for (uint8_t map = 0; map < NVS_MAPS; map++) {
+    char key[8];
+    snprintf(key, sizeof(key), "map%u", map);
+    uint8_t record[MAP_CODEC_MAX_SIZE];
+    size_t len = prefs.getBytesLength(key);
+    if (len == 0 || len > sizeof(record) || prefs.getBytes(key, record, len) != len) continue;
+    records = true;
+    if (!__mapsInNvs) ok = importNvsMap(store, map, record, len) && ok;
+  }
+  if (!records && prefs.getBytesLength("Settings") == MAP_V0_SIZE) {
+    log_d("Settings found, converting to map records");
+    static uint8_t v0[MAP_V0_SIZE];
+    blob = prefs.getBytes("Settings", v0, sizeof(v0)) == sizeof(v0);
+    for (uint8_t map = 0; blob && map < NVS_MAPS; map++) ok = importNvsMap(store, map, v0, sizeof(v0)) && ok;
+  }
+  prefs.end();
+  if (!ok) {
+    log_e("Moving the NVS maps failed, NVS keeps them");
+    return;
+  }
+  if (__mapsInNvs ? !blob : !(records || blob)) return;
+  log_i(__mapsInNvs ? "Settings blob converted into NVS map records" : "NVS maps moved into the map banks");
+  prefs.begin("Settings");
+  if (__mapsInNvs) {
+    prefs.remove("Settings");
+  } else {
+    prefs.clear();
+  }
+  prefs.end();
 }
 
-void textCallAPPassword(Control* sender, int type) {
-    String value = sender->value;
+// write the maps and deviceConfig (SETTINGS_DEVICE_CONFIG) of the mask
+void writeSettings(uint32_t records) {
+  writeMapSlots(records & ((1u << MAP_CACHE_SLOTS) - 1));
+  if (records & (1u << SETTINGS_DEVICE_CONFIG)) saveDeviceConfig();
+}
 
-    if(value.length() < 8) {
-      ESPUI.updateControlValue(wlanApPasswordTxtField, "Name to short");
-      return;
-    }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(wlanApPasswordTxtField, "Name contains spaces");
-      return;
-    }
-    prefs.begin("wifi", false);
-    
-    prefs.putString("password_ap", value); // Store password
-    
-    prefs.end();
-    
+// deviceConfig changed, written by loop() with the map changes
+void saveDeviceConfigLater() {
+  settingsWriter.markDirty(SETTINGS_DEVICE_CONFIG, millis());
+}
 
+// MMC device ID of the MMC frames, the active map is compiled again with it
+void setMmcDeviceId(uint8_t id) {
+  deviceConfig.setMmcDeviceId(id);
+  saveDeviceConfigLater();
+  MapLock lock;
+  midiActionTable.setMmcDeviceId(id);
+  requestCompile();
 }
 
-void textCallHostname(Control* sender, int type) {
-    String value = sender->value;
+// called by the web UI callbacks after a change of a map in the cache, with __mapLock held
+void saveSettings(myCachedMap* entry) {
+  entry->dirty = true;
+  settingsWriter.markDirty(mapBankCache.slotOf(entry), millis());
+  if (entry->map == __active_map) requestCompile();
+}
 
-    if(value.length() < 8) {
-      ESPUI.updateControlValue(hostnameTxtField, "Name to short");
-      return;
-    }
-    // Check for spaces in the string
-    if (value.indexOf(' ') >= 0) {
-      ESPUI.updateControlValue(hostnameTxtField, "Name contains spaces");
-      return;
-    }
-    WiFi.setHostname(value.c_str());
-    prefs.begin("wifi", false);
-    
-    prefs.putString("hostname", value); // Store password
-    
-    prefs.end();
-    
+// write everything that is pending now, runs in the loop task or on restart
+void flushSettings() {
+  __flushSettingsRequested = false;
+  writeSettings(settingsWriter.takeAll());
 }
 
-void textCallLedBrightness(Control* sender, int type) {
+// loop(): write the maps that are due and show the counters in the Diagnostics tab
+void persistSettings() {
+  uint32_t records;
+  if (__flushSettingsRequested) {
+    __flushSettingsRequested = false;
+    records = settingsWriter.takeAll();
+  } else {
+    records = settingsWriter.due(millis());
+  }
+  if (records == 0) return;
+  writeSettings(records);
+  if (ESPUI_TREE && __configurator) {
+    char str[64];
+    formatMapWrites(str, sizeof(str));
+    ESPUI.updateLabel(nvsStatsLabel, str);
+  }
+}
 
+// "n=.. p50=..us p99=..us max=..us" of the map switches, the budget and the cache counters
+void formatMapSwitch(char* str, size_t size) {
+  MapLock lock;
+  snprintf(str, size, "n=%u p50=%uus p99=%uus max=%uus, %u over %uus, cache %u hits (%u prefetched) %u misses",
+    (unsigned)__mapSwitchUs.count(), (unsigned)__mapSwitchUs.percentile(50), (unsigned)__mapSwitchUs.percentile(99),
+    (unsigned)__mapSwitchUs.max(), (unsigned)__mapSwitchOverBudget, (unsigned)__bleIntervalUs,
+    (unsigned)mapBankCache.hits(), (unsigned)mapBankCache.prefetchHits(), (unsigned)mapBankCache.misses());
+}
 
-    __BRIGHTNESS = sender->value.toInt();
-    FastLED.setBrightness(__BRIGHTNESS);
-    FastLED.show();
+// "n=.. dropped=.. oversized=.. malformed=.. high water ../.." of the incoming MIDI messages
+void formatMidiIn(char* str, size_t size) {
+  snprintf(str, size, "n=%u dropped=%u oversized=%u malformed=%u, high water %u/%u",
+    (unsigned)__midiIn.received(), (unsigned)__midiIn.dropped(), (unsigned)__midiIn.oversized(),
+    (unsigned)__midiIn.malformed(), (unsigned)__midiIn.highWater(), (unsigned)MidiInQueue::capacity());
+}
 
-    prefs.begin("wifi", false); // Open NVS namespace "wifi" in RW mode
-    prefs.putUInt("LedBrightness", __BRIGHTNESS); // Store password
-    
-    prefs.end();
-    
+// loop(): the MIDI in counters in the Diagnostics tab, every second while they change
+void reportMidiIn() {
+  static unsigned long lastUiUpdate = 0;
+  static uint32_t lastReceived = 0;
+  if (!ESPUI_TREE || !__configurator || millis() - lastUiUpdate < 1000) return;
+  lastUiUpdate = millis();
+  uint32_t received = __midiIn.received() + __midiIn.dropped() + __midiIn.malformed();
+  if (received == lastReceived) return;
+  lastReceived = received;
+  char str[96];
+  formatMidiIn(str, sizeof(str));
+  ESPUI.updateLabel(midiInStatsLabel, str);
 }
 
-void saveSettings() {
-    prefs.begin("Settings"); // Open NVS namespace "Settings" in RW mode
-    
-    prefs.putBytes("Settings", &myBtnMap, sizeof(myBtnMap));
-    
-    prefs.end();
-    
+// loop(): the last map switch on Serial, activateMap() runs on the input task
+void reportMapSwitch() {
+  int16_t map = __mapSwitchReport;
+  if (map < 0) return;
+  __mapSwitchReport = -1;
+  Serial.printf("Active Map: %d, %s in %lu us (BLE interval %lu us)\n", map, __mapSwitchCached ? "cached" : "from flash",
+    (unsigned long)__mapSwitchLastUs, (unsigned long)__bleIntervalUs);
 }
 
+// loop(): load the neighbours of a new active map, the next Program Change up or down and
+// the long press partner are cache hits then
+void prefetchMaps() {
+  int16_t map = __prefetchMap;
+  if (map < 0) return;
+  __prefetchMap = -1;
+  MapLock lock;
+  if (map + 1 < NUBER_OF_MAPS) mapBankCache.prefetch(map + 1);
+  if (map > 0) mapBankCache.prefetch(map - 1);
+
+  if (ESPUI_TREE && __configurator) {
+    char str[128];
+    formatMapSwitch(str, sizeof(str));
+    ESPUI.updateLabel(mapSwitchLabel, str);
+  }
+}
 
-void updateUiActiveMap(){
-    char str[10];
-    sprintf(str, "%d", __active_map); // Convert the number to a string
-    ESPUI.updateControlValue(activeMapChooser, str); // Update the control value
+#ifdef USE_OTA
+
+// set an boot variable into nvs to check next time boot.
+void requestOtaUpdate() {
+  deviceConfig.setDoUpdate(true);
+  saveDeviceConfigLater();
+  __flushSettingsRequested = true; // written by loop() now, the reboot must not lose it or pending map changes
 }
 
-// Button 1 - x Web UI Callbacks ---------
-void selectBtnMapFnc(Control* sender, int value) {
+void otaUpdate(Control* sender, int type) {
+  requestOtaUpdate();
+  ESPUI.updateControlValue(sender, "Update requested need Reeboot");
+}
 
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+// ~ streaming OTA ~
+// otaReaderTask fills the block ring from the HTTP stream, otaWriterTask drains it into the
+// OTA partition. Download and flash write overlap, justotaUpdate() only reports progress.
+// The writer hashes what it writes (SHA-256) and stores a checkpoint every
+// OTA_CHECKPOINT_BYTES. A dropped connection continues with a Range request, an update
+// interrupted by a reboot continues from the checkpoint (ota_resume.h). A delta patch from the
+// running version (delta_patch.h) is tried before the full image, the reader then turns the
+// patch into image blocks and the writer does not see a difference.
+#define OTA_READ_TIMEOUT_MS 15000 // no byte for this long ends the connection
+#define OTA_MAX_CONNECTIONS 8     // per boot, then the next boot resumes
+#define OTA_RETRY_DELAY_MS 1000   // doubled after every dropped connection, up to 8s
+
+struct myOtaJob {
+  WiFiClient* stream;
+  OtaBlockRing* ring;
+  const esp_partition_t* partition;
+  Sha256* sha;
+  myOtaCheckpoint* checkpoint;
+  DeltaPatcher* patcher = nullptr; // stream is a patch, not the image
+  uint32_t done;  // bytes in flash, the writer moves it
+  uint32_t total;
+  TaskHandle_t caller;
+  TaskHandle_t reader = nullptr;
+  TaskHandle_t writer = nullptr;
+  volatile bool readerDone = false;
+  volatile bool writerDone = false;
+  volatile bool dropped = false; // connection lost or timed out, worth a retry
+  volatile bool failed = false;  // flash error, not worth a retry
+};
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][0] == sender->id) {
-        active_btn = i;
+OtaProgress __otaProgress;
+
+void saveOtaCheckpoint(const myOtaCheckpoint& checkpoint) {
+  uint8_t record[OTA_CHECKPOINT_RECORD_SIZE];
+  size_t len = encodeOtaCheckpoint(checkpoint, record);
+  prefs.begin("config");
+  if (prefs.putBytes("otaresume", record, len) != len) log_e("Writing OTA checkpoint failed");
+  prefs.end();
+}
+
+bool loadOtaCheckpoint(myOtaCheckpoint& checkpoint) {
+  uint8_t record[OTA_CHECKPOINT_RECORD_SIZE];
+  size_t len = 0;
+  if (prefs.begin("config", true)) {
+    if (prefs.isKey("otaresume")) len = prefs.getBytes("otaresume", record, sizeof(record));
+    prefs.end();
+  }
+  return decodeOtaCheckpoint(record, len, checkpoint);
+}
+
+void clearOtaCheckpoint() {
+  prefs.begin("config");
+  prefs.remove("otaresume");
+  prefs.end();
+}
+
+// the running firmware, source of the patch copies
+class OtaPartitionSource : public DeltaSource {
+public:
+  OtaPartitionSource(const esp_partition_t* partition) : _partition(partition) {}
+  bool read(uint32_t offset, uint8_t* buf, size_t len) override {
+    return esp_partition_read(_partition, offset, buf, len) == ESP_OK;
+  }
+private:
+  const esp_partition_t* _partition;
+};
+
+// image bytes out of the patcher into the block ring, a block goes to the writer once full
+class OtaRingSink : public DeltaSink {
+public:
+  OtaRingSink(myOtaJob& job) : _job(job) {}
+  bool write(const uint8_t* data, size_t len) override {
+    OtaBlockRing& ring = *_job.ring;
+    while (len) {
+      if (_block == nullptr) {
+        if (_job.failed || _job.dropped) return false;
+        _block = ring.acquire();
+        if (_block == nullptr) {
+          ring.readerStalled();
+          ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+          continue;
+        }
+        _len = 0;
+      }
+      size_t room = ring.blockSize() - _len;
+      size_t n = room < len ? room : len;
+      memcpy(_block + _len, data, n);
+      _len += n;
+      _filled += n;
+      data += n;
+      len -= n;
+      if (_len == ring.blockSize() || _filled == _job.total) {
+        ring.commit(_len);
+        _block = nullptr;
+        xTaskNotifyGive(_job.writer);
+      }
+    }
+    return true;
+  }
+private:
+  myOtaJob& _job;
+  uint8_t* _block = nullptr;
+  uint16_t _len = 0;
+  uint32_t _filled = 0;
+};
+
+// patch bytes from the network through job.patcher, the image comes out into the ring
+void otaDeltaReader(myOtaJob& job) {
+  DeltaPatcher& patcher = *job.patcher;
+  uint8_t chunk[512];
+  uint32_t lastDataMs = millis();
+
+  while (!patcher.done() && !patcher.failed() && !job.failed && !job.dropped) {
+    int available = job.stream->available();
+    if (available <= 0) {
+      if (!job.stream->connected() || millis() - lastDataMs > OTA_READ_TIMEOUT_MS) {
+        job.dropped = true;
         break;
       }
+      vTaskDelay(1);
+      continue;
+    }
+    int n = job.stream->read(chunk, available < (int)sizeof(chunk) ? available : sizeof(chunk));
+    if (n > 0) {
+      lastDataMs = millis();
+      __otaProgress.received(n);
+      patcher.feed(chunk, n);
     }
+  }
+}
 
-  __active_map_ui_btn[active_btn] = value_t;
+void otaReaderTask(void* parameter) {
+  myOtaJob& job = *(myOtaJob*)parameter;
+  OtaBlockRing& ring = *job.ring;
+  uint32_t received = job.done;
+  uint32_t lastDataMs = millis();
+
+  if (job.patcher) otaDeltaReader(job);
+  while (!job.patcher && received < job.total && !job.failed && !job.dropped) {
+    uint8_t* block = ring.acquire();
+    if (block == nullptr) {
+      ring.readerStalled();
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+      continue;
+    }
+    // fill the whole block, a block is one flash sector for the writer
+    uint16_t len = 0;
+    uint16_t want = job.total - received < ring.blockSize() ? job.total - received : ring.blockSize();
+    while (len < want && !job.failed) {
+      int available = job.stream->available();
+      if (available <= 0) {
+        if (!job.stream->connected() || millis() - lastDataMs > OTA_READ_TIMEOUT_MS) {
+          job.dropped = true;
+          break;
+        }
+        vTaskDelay(1);
+        continue;
+      }
+      int n = job.stream->read(block + len, available < want - len ? available : want - len);
+      if (n > 0) {
+        len += n;
+        lastDataMs = millis();
+        __otaProgress.received(n);
+      }
+    }
+    if (len < want) break; // a partial block is fetched again, the checkpoints stay sector aligned
+    ring.commit(len);
+    received += len;
+    xTaskNotifyGive(job.writer);
+  }
+  job.readerDone = true;
+  xTaskNotifyGive(job.writer);
+  vTaskDelete(nullptr);
+}
 
-    // // Enable or disable the controls based on the selected map
-    // ESPUI.setEnabled(__selectUiBtn[active_btn][9], true);
-    // ESPUI.setPanelStyle(__selectUiBtn[active_btn][9], ";");
-    
-    //update the value in the settings
-    char str[10]; // Ensure this is large enough to hold the number and the null terminator
+void otaWriterTask(void* parameter) {
+  myOtaJob& job = *(myOtaJob*)parameter;
+  OtaBlockRing& ring = *job.ring;
+
+  while (job.done < job.total && !job.failed) {
+    uint16_t len;
+    const uint8_t* block = ring.peek(len);
+    if (block == nullptr) {
+      if (job.readerDone) {
+        if (ring.filled() == 0) break;
+        continue; // committed right before the reader finished
+      }
+      ring.writerStalled();
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+      continue;
+    }
+    // blocks start on a sector, erase the sector(s) before writing, also after a resume
+    uint32_t eraseLen = (len + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE;
+    if (esp_partition_erase_range(job.partition, job.done, eraseLen) != ESP_OK
+      || esp_partition_write(job.partition, job.done, block, len) != ESP_OK) {
+      job.failed = true;
+      break;
+    }
+    job.sha->update(block, len);
+    ring.release();
+    job.done += len;
+    __otaProgress.written(len);
+    xTaskNotifyGive(job.reader);
+
+    if (job.done - job.checkpoint->done >= OTA_CHECKPOINT_BYTES) {
+      job.checkpoint->done = job.done;
+      saveOtaCheckpoint(*job.checkpoint);
+    }
+  }
+  job.writerDone = true;
+  xTaskNotifyGive(job.caller);
+  vTaskDelete(nullptr);
+}
 
-    uint8_t localvalue = myBtnMap[active_btn].btnMidiChannel[value_t]; // Get the MidiChannel value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][1], str); // Update the control value
+// SHA-256 published next to the image (<image>.sha256), optional
+bool fetchImageHash(WiFiClient& client, const char* imageUrl, uint8_t hash[SHA256_SIZE]) {
+  char url[110];
+  snprintf(url, sizeof(url), "%s.sha256", imageUrl);
+  HTTPClient http;
+  http.begin(client, url);
+  bool ok = http.GET() == HTTP_CODE_OK && sha256FromHex(http.getString().c_str(), hash);
+  http.end();
+  return ok;
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiFunction[value_t]; // get the MidiFunction value from the settings
-    if(localvalue == 0){
-       // ESPUI.setEnabled(__selectUiBtn[active_btn][9], false);
+/**
+ * @brief Read the update manifest (update_manifest.h) while it downloads.
+ * @param httpCode of the GET, for the update status when there is no manifest
+ * @return true if the server has a valid manifest
+ */
+bool fetchUpdateManifest(WiFiClient& client, myUpdateManifest& manifest, int& httpCode) {
+  char url[100];
+  snprintf(url, sizeof(url), "%s%s", SERVER, MANIFEST_PATH);
+  HTTPClient http;
+  http.begin(client, url);
+  httpCode = http.GET();
+  if (httpCode != HTTP_CODE_OK) {
+    http.end();
+    return false;
+  }
+  UpdateManifestParser parser;
+  WiFiClient* stream = http.getStreamPtr();
+  uint8_t chunk[128];
+  uint32_t lastDataMs = millis();
+  while (millis() - lastDataMs < OTA_READ_TIMEOUT_MS) {
+    int n = stream->read(chunk, sizeof(chunk));
+    if (n > 0) {
+      lastDataMs = millis();
+      if (!parser.feed(chunk, n)) break;
+    } else if (!stream->connected() && stream->available() <= 0) {
+      break;
+    } else {
+      vTaskDelay(1);
     }
-    sprintf(str, "%u", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][2], str); // Update the control value
-    log_d("Active Button: %d, String: %S, Value: %u\n", active_btn, str,localvalue);
+  }
+  http.end();
+  my_manifest_result result = parser.finish();
+  Serial.printf("Update manifest %s: %s\n", url, manifestResultName(result));
+  if (result != MANIFEST_OK) return false;
+  manifest = parser.manifest();
+  return true;
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiCC[value_t]; // Get the MidiCC value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][3], str); // Update the control value
+// no update to take: remember why for the web UI and carry on as controller, no reboot
+void otaNothingToDo(int code) {
+  __UPDATE_ERROR_CODE = code;
+  deviceConfig.setUpdateErrorCode(__UPDATE_ERROR_CODE);
+  saveDeviceConfig();
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  __ota_update_running = false;
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiCCValueStateOn[value_t]; // Get the MidiCCValueStateOn value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][4], str); // Update the control value
+// hash of the bytes a former boot already wrote, to continue the SHA-256 of the image
+void rehashPartition(const esp_partition_t* partition, uint32_t len, uint8_t* buf, size_t bufSize, Sha256& sha) {
+  for (uint32_t offset = 0; offset < len; ) {
+    uint32_t n = len - offset < bufSize ? len - offset : bufSize;
+    esp_partition_read(partition, offset, buf, n);
+    sha.update(buf, n);
+    offset += n;
+  }
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiCCValueStateOff[value_t]; // Get the MidiCCValueStateOff value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][5], str); // Update the control value
+// one connection from job.done to the end of the image, returns when it ended either way
+void runOtaConnection(myOtaJob& job, OtaBlockRing& ring) {
+  job.caller = xTaskGetCurrentTaskHandle();
+  job.readerDone = job.writerDone = job.dropped = false;
+  __otaProgress.begin(job.total, millis(), job.done);
+
+  // the reader waits on the network, the writer on flash, both above loop() and below input
+  xTaskCreatePinnedToCore(otaWriterTask, "otaWrite", 4096, &job, 2, &job.writer, ARDUINO_RUNNING_CORE);
+  xTaskCreatePinnedToCore(otaReaderTask, "otaRead", 6144, &job, 2, &job.reader, 0);
+
+  char progress[64];
+  while (!job.writerDone) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    __otaProgress.format(progress, sizeof(progress), millis());
+    Serial.printf("OTA %s, ring stalls read %lu write %lu\n", progress,
+      (unsigned long)ring.readerStalls(), (unsigned long)ring.writerStalls());
+  }
+  job.dropped = job.dropped || job.done < job.total; // stops the reader if the writer ended first
+  while (!job.readerDone) delay(10);
+  while (ring.filled()) ring.release(); // blocks the writer did not take are fetched again
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiNote[value_t]; // Get the MidiNote value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][6], str); // Update the control value
+/**
+ * @brief Update with the patch from the running version to fwVersion, if the server has one.
+ * @details The patch only fits the image it was made from, the SHA-256 of the running
+ * partition is checked against the patch before anything is written. On success the
+ * partition holds the new image, job.sha its hash and expectedHash the hash the patch
+ * promises. false leaves nothing the full download relies on.
+ */
+bool runDeltaUpdate(WiFiClient& client, myOtaJob& job, uint32_t fwVersion, bool& hasHash,
+  uint8_t expectedHash[SHA256_SIZE], uint32_t& transferred) {
+
+  char url[100];
+  snprintf(url, sizeof(url), "%s%s%lu-V%lu.patch", SERVER, PATH, (unsigned long)__FW_VERSION, (unsigned long)fwVersion);
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  HTTPClient http;
+  http.begin(client, url);
+  if (running == nullptr || http.GET() != HTTP_CODE_OK) {
+    http.end();
+    return false;
+  }
+  Serial.printf("Delta patch %s, %d bytes\n", url, http.getSize());
+
+  WiFiClient* stream = http.getStreamPtr();
+  uint8_t raw[DELTA_HEADER_SIZE];
+  size_t len = 0;
+  uint32_t startMs = millis();
+  while (len < sizeof(raw) && millis() - startMs < OTA_READ_TIMEOUT_MS) {
+    int n = stream->read(raw + len, sizeof(raw) - len);
+    if (n > 0) len += n;
+    else if (!stream->connected()) break;
+    else vTaskDelay(1);
+  }
+  myDeltaHeader header;
+  if (!decodeDeltaHeader(raw, len, header) || header.sourceSize > running->size || header.targetSize > job.partition->size
+    || (hasHash && memcmp(header.targetHash, expectedHash, SHA256_SIZE) != 0)) {
+    Serial.println("Delta patch does not fit, downloading the full image");
+    http.end();
+    return false;
+  }
+  uint8_t buf[256];
+  uint8_t sourceHash[SHA256_SIZE];
+  Sha256 sourceSha;
+  rehashPartition(running, header.sourceSize, buf, sizeof(buf), sourceSha);
+  sourceSha.finish(sourceHash);
+  if (memcmp(sourceHash, header.sourceHash, SHA256_SIZE) != 0) {
+    Serial.println("Delta patch is for another image, downloading the full image");
+    http.end();
+    return false;
+  }
 
-    localvalue = myBtnMap[active_btn].btnMidiMMC[value_t]; // Get the MidiNote value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][7], str); // Update the control value
+  // the target bytes are the image bytes, a checkpoint of a dropped patch resumes as image
+  myOtaCheckpoint& checkpoint = *job.checkpoint;
+  checkpoint = myOtaCheckpoint();
+  checkpoint.fwVersion = fwVersion;
+  checkpoint.total = header.targetSize;
+  checkpoint.partition = job.partition->address;
+  checkpoint.hasHash = 1;
+  memcpy(checkpoint.expectedHash, header.targetHash, SHA256_SIZE);
+
+  OtaPartitionSource source(running);
+  OtaRingSink sink(job);
+  DeltaPatcher patcher(source, sink);
+  patcher.begin(header);
+  job.patcher = &patcher;
+  job.stream = stream;
+  job.done = 0;
+  job.total = header.targetSize;
+  job.sha->begin();
+  runOtaConnection(job, *job.ring);
+  job.patcher = nullptr;
+  transferred += __otaProgress.receivedBytes() + DELTA_HEADER_SIZE;
+  http.end();
+
+  if (!patcher.done() || job.done != header.targetSize) {
+    Serial.printf("Delta update stopped at %lu of %lu bytes, downloading the full image\n",
+      (unsigned long)job.done, (unsigned long)header.targetSize);
+    job.sha->begin();
+    job.done = 0;
+    return false;
+  }
+  hasHash = true;
+  memcpy(expectedHash, header.targetHash, SHA256_SIZE);
+  return true;
+}
 
-    localvalue = myBtnMap[active_btn].btnMidiVelocity[value_t]; // Get the MidiVelocity value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][8], str); // Update the control value
+void justotaUpdate() {
 
-    localvalue = myBtnMap[active_btn].btnFunction[value_t]; // Get the Function value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][9], str); // Update the control value
+  // reset firmware update flag
+  __DO_UPDATE = false;
+  deviceConfig.setDoUpdate(false);
+  __UPDATE_FAILURE = true; // set this true, while this function is running
+  deviceConfig.setUpdateFailure(__UPDATE_FAILURE);
+  saveDeviceConfig();
 
-    localvalue = myBtnMap[active_btn].needRelease[value_t]; // Get the NeedRelease value from the settings
-    sprintf(str, "%d", localvalue); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][10], str); // Update the control value
+  if (__ota_update_running) {
+    Serial.println("OTA update already running.");
+    return;
+  }
+  
+  __ota_update_running = true;
+  WiFiClientSecure wifiClientSSL;
+  wifiClientSSL.setInsecure(); // Not recommended for production, better to handle certificates properly
+  WiFiClient wifiClient; // plain http for the local test server
+  bool secure = strncmp(SERVER, "https:", 6) == 0;
+  WiFiClient& client = secure ? (WiFiClient&)wifiClientSSL : wifiClient;
+
+  // the manifest names the latest version, older versions are skipped. Without one the
+  // next version is probed as before.
+  myUpdateManifest manifest;
+  int manifestCode = 0;
+  bool hasManifest = fetchUpdateManifest(client, manifest, manifestCode);
+  if (hasManifest && manifest.version <= __FW_VERSION) {
+    Serial.printf("Firmware V%u is up to date (latest V%lu)\n", __FW_VERSION, (unsigned long)manifest.version);
+    otaNothingToDo(HTTP_CODE_NOT_FOUND);
+    return;
+  }
 
-    localvalue = myBtnMap[active_btn].btnColor[value_t]; // Get the Color value from the settings
+  char updateURL[100];
+  uint32_t fwVersion = hasManifest ? manifest.version : __FW_VERSION + 1;
+  snprintf(updateURL, sizeof(updateURL), "%s%s%lu.bin", SERVER, PATH, (unsigned long)fwVersion);
 
-    int colorval = 0;
-    for(int i = 0; i < 141; i++) {
-      if(__btnLookUpTable[i] == localvalue) {
-        colorval = i;
-        break;
-      }
-    }
-    sprintf(str, "%d", colorval); // Convert the number to a string
-    ESPUI.updateControlValue(__selectUiBtn[active_btn][11], str); // Update the control value
+  Serial.print("Checking for update file: ");
+  Serial.println(updateURL);
 
-}
+  const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+  uint8_t* storage = (uint8_t*)malloc(OTA_RING_BLOCKS * OTA_RING_BLOCK_SIZE);
+  if (partition == nullptr || storage == nullptr) {
+    Serial.println("No OTA partition or no memory for the OTA buffers");
+    free(storage);
+    __ota_update_running = false;
+    return;
+  }
 
-void selectBtnMidiChannelCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+  if (hasManifest && manifest.size > partition->size) {
+    Serial.println("Not enough space to begin OTA");
+    free(storage);
+    otaNothingToDo(HTTP_CODE_PAYLOAD_TOO_LARGE);
+    return;
+  }
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][1] == sender->id) {
-        active_btn = i;
+  uint8_t expectedHash[SHA256_SIZE];
+  bool hasHash = hasManifest && manifest.hasHash;
+  if (hasHash) memcpy(expectedHash, manifest.hash, SHA256_SIZE);
+  else hasHash = fetchImageHash(client, updateURL, expectedHash);
+  Serial.printf("Image SHA-256 %s\n", hasHash ? "published, verified after download" : "not published, image check only");
+
+  // continue where an earlier boot stopped, if the checkpoint belongs to this image
+  myOtaCheckpoint checkpoint;
+  Sha256 sha;
+  uint32_t done = 0;
+  uint32_t total = 0;
+  if (loadOtaCheckpoint(checkpoint)) {
+    done = otaResumeOffset(checkpoint, fwVersion, checkpoint.total, partition->address, hasHash ? expectedHash : nullptr);
+  }
+  if (done > 0) {
+    total = checkpoint.total;
+    checkpoint.boots++;
+    saveOtaCheckpoint(checkpoint);
+    rehashPartition(partition, done, storage, OTA_RING_BLOCKS * OTA_RING_BLOCK_SIZE, sha);
+    Serial.printf("Resuming OTA at %lu of %lu bytes\n", (unsigned long)done, (unsigned long)total);
+  }
+
+  OtaBlockRing ring(storage, OTA_RING_BLOCKS, OTA_RING_BLOCK_SIZE);
+  myOtaJob job;
+  job.ring = &ring;
+  job.partition = partition;
+  job.sha = &sha;
+  job.checkpoint = &checkpoint;
+
+  uint32_t startMs = millis();
+  uint32_t transferred = 0; // over the network, all connections
+  uint32_t retryDelayMs = OTA_RETRY_DELAY_MS;
+  int connections = 0;
+  int httpCode = 0;
+  bool aborted = false; // the server offers nothing this device can take
+  ledCompositor.setActivity(CRGB::Purple); // purple / black while downloading
+
+  // a patch from the running version is a fraction of the image, the full image is the fallback
+  bool tryDelta = !hasManifest || manifestDeltaFrom(manifest, __FW_VERSION) != nullptr;
+  if (done == 0 && tryDelta && runDeltaUpdate(client, job, fwVersion, hasHash, expectedHash, transferred)) {
+    done = total = job.total;
+  }
+
+  while (connections < OTA_MAX_CONNECTIONS && !job.failed && !aborted && (total == 0 || done < total)) {
+    if (connections > 0) {
+      Serial.printf("Connection lost at %lu of %lu bytes, resuming in %lu ms\n", (unsigned long)done,
+        (unsigned long)total, (unsigned long)retryDelayMs);
+      delay(retryDelayMs);
+      if (retryDelayMs < 8 * OTA_RETRY_DELAY_MS) retryDelayMs *= 2;
+    }
+    connections++;
+
+    HTTPClient https;
+    https.begin(client, updateURL);
+    const char* headers[] = { "Content-Range" };
+    https.collectHeaders(headers, 1);
+    if (done > 0) {
+      char range[32];
+      otaRangeHeader(range, sizeof(range), done);
+      https.addHeader("Range", range);
+    }
+    httpCode = https.GET();
+    Serial.print("Update status code: ");
+    Serial.println(httpCode);
+
+    if (httpCode == HTTP_CODE_PARTIAL_CONTENT) {
+      uint32_t first, last, rangeTotal;
+      if (!parseContentRange(https.header("Content-Range").c_str(), first, last, rangeTotal)
+        || first != done || rangeTotal != total) {
+        Serial.println("Range does not match the checkpoint, starting over");
+        https.end();
+        done = 0;
+        total = 0;
+        sha.begin();
+        continue;
+      }
+    } else if (httpCode == HTTP_CODE_OK) {
+      int size = https.getSize();
+      if (size <= 0) {
+        Serial.println("Invalid content length. Can't continue with update.");
+        https.end();
+        aborted = true;
+        break;
+      }
+      if (hasManifest && (uint32_t)size != manifest.size) {
+        Serial.println("Image size differs from the manifest. Can't continue with update.");
+        https.end();
+        aborted = true;
+        break;
+      }
+      if (done > 0) Serial.println("Server ignored the Range request, starting over");
+      done = 0;
+      total = size;
+      sha.begin();
+      checkpoint = myOtaCheckpoint();
+      checkpoint.fwVersion = fwVersion;
+      checkpoint.total = total;
+      checkpoint.partition = partition->address;
+      checkpoint.hasHash = hasHash;
+      if (hasHash) memcpy(checkpoint.expectedHash, expectedHash, SHA256_SIZE);
+      Serial.printf("Server returned update file of size %lu bytes\n", (unsigned long)total);
+      if (total > partition->size) {
+        Serial.println("Not enough space to begin OTA");
+        https.end();
+        aborted = true;
         break;
       }
+    } else if (httpCode > 0 && done == 0) {
+      https.end();
+      break; // no image for this version (404 ...), nothing to resume
+    } else {
+      https.end();
+      continue;
     }
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiChannel[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
+    job.stream = https.getStreamPtr();
+    job.done = done;
+    job.total = total;
+    runOtaConnection(job, ring);
+    done = job.done;
+    transferred += __otaProgress.receivedBytes();
+    https.end();
 
-}
+    if (done < total && !job.failed) {
+      checkpoint.done = done; // sector aligned, a reboot continues here
+      saveOtaCheckpoint(checkpoint);
+    }
+  }
+  free(storage);
+  ledCompositor.clearActivity();
 
-void selectBtnMidiFnc(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+  if (aborted) {
+    __ota_update_running = false;
+    return;
+  }
+  if (total == 0) {
+    Serial.println("Failed to fetch update.");
+    otaNothingToDo(httpCode);
+    return;
+  }
+  Serial.printf("OTA: %lu bytes transferred for a %lu byte image in %lu ms, %d connection(s)\n",
+    (unsigned long)transferred, (unsigned long)total, (unsigned long)(millis() - startMs), connections);
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
+  if (job.failed) {
+    Serial.println("Error writing to flash. Aborting OTA.");
+    clearOtaCheckpoint();
+    __ota_update_running = false;
+    return;
+  }
+  if (done < total) {
+    // the network is gone for now, the next boot resumes from the checkpoint
+    Serial.println("OTA incomplete, resuming after reboot");
+    deviceConfig.setDoUpdate(checkpoint.boots < OTA_CHECKPOINT_MAX_BOOTS);
+    saveDeviceConfig();
+    ESP.restart();
+    return;
+  }
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][2] == sender->id) {
-        active_btn = i;
-        break;
-      }
-    }
+  uint8_t digest[SHA256_SIZE];
+  sha.finish(digest);
+  clearOtaCheckpoint();
+  if (hasHash && memcmp(digest, expectedHash, SHA256_SIZE) != 0) {
+    Serial.println("SHA-256 of the image does not match, update discarded");
+    __ota_update_running = false;
+    return;
+  }
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiFunction[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
+  // checks the image (header, segments, its own appended hash) before it is made bootable
+  esp_err_t err = esp_ota_set_boot_partition(partition);
+  if (err == ESP_OK) {
+      Serial.println("Written : " + String(done) + " successfully");
+      Serial.println("Update successfully completed. Rebooting.");
+      __UPDATE_FAILURE = false; // set this true, while this function is running
+      __UPDATE_ERROR_CODE = -1;
+
+      Serial.println("OTA Done!");
+      Serial.printf("update fw version: %lu\n", (unsigned long)fwVersion);
+      __FW_VERSION = fwVersion;
+      deviceConfig.setUpdateFailure(__UPDATE_FAILURE);
+      deviceConfig.setUpdateErrorCode(__UPDATE_ERROR_CODE);
+      deviceConfig.setFwVersion(__FW_VERSION);
+      saveDeviceConfig();
+      Serial.println("Rebooting...");
+      ESP.restart();
+  } else {
+      Serial.println("Error Occurred. Error #: " + String(err));
+      __ota_update_running = false;
+  }
+}
+#endif
 
+// ~ OTA ~
+
+void updateUiActiveMap(){
+    char str[4];
+    snprintf(str, sizeof(str), "%u", __active_map + 1); // Convert the number to a string
+    ESPUI.updateControlValue(activeMapChooser, str); // Update the control value
 }
-// ---- hier geht es weiter
-void selectBtnMidiCCFunctionCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][3] == sender->id) {
-        active_btn = i;
-        break;
-      }
+// store the active map and show it on the LED
+void saveActiveMap() {
+  ledCompositor.setBlinkCount(__active_map + 1);
+    deviceConfig.setActiveMap(__active_map); // Store the active map
+    saveDeviceConfigLater();
+    ledCompositor.setBase(__isConnected ? mapLedColor() : (uint32_t)CRGB::Red);
+}
+
+/**
+ * @brief Switch the active map: from the cache, or from its bank on a miss, and compile it.
+ *
+ * @details The time of the switch is kept in __mapSwitchUs and compared with the BLE
+ * connection interval, a shorter switch does not hold back the next MIDI packet. loop()
+ * prefetches the neighbours of the new map. A miss evicts a clean slot only and never
+ * writes flash; with changes in every other slot loop() writes them first.
+ * Runs on the input task, which reads the action table, the other tasks call switchMap().
+ * @return false if the map could not be loaded, the active map stays
+ */
+bool activateMap(uint8_t map) {
+  if (map >= NUBER_OF_MAPS) return false;
+  uint32_t startUs = (uint32_t)esp_timer_get_time();
+  uint32_t switchUs;
+  bool cached;
+  {
+    MapLock lock;
+    cached = mapBankCache.find(map) != nullptr;
+    myCachedMap* entry = loadMap(map);
+    if (entry == nullptr) {
+      log_e("Map %u not loaded, map %u stays active", map, __active_map);
+      return false;
     }
+    // the toggle states go with the DAW state, from the map that is left to the new one
+    myCachedMap* left = mapBankCache.find(__active_map);
+    if (left != nullptr && left != entry) feedbackIndex.keep(left->buttons, left->states, __HW_BUTTONS);
+    feedbackIndex.applyTo(entry->buttons, entry->states, __HW_BUTTONS);
+    mapBankCache.pin(map);
+    __active_map = map;
+    midiActionTable.compile(entry->buttons, entry->states, __HW_BUTTONS, map);
+    feedbackIndex.rebuild(entry->buttons, __HW_BUTTONS);
+    switchUs = (uint32_t)esp_timer_get_time() - startUs;
+    __mapSwitchUs.add(switchUs);
+    if (switchUs > __bleIntervalUs) __mapSwitchOverBudget++;
+  }
+  __prefetchMap = map;
+  saveActiveMap();
+  __mapSwitchLastUs = switchUs;
+  __mapSwitchCached = cached;
+  __mapSwitchReport = map;
+  return true;
+}
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiCC[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
+// activateMap() from any task: the map is loaded into the cache here and the input task
+// switches to it, a cache hit, and shows it in the web UI. false if it could not be loaded.
+bool switchMap(uint8_t map) {
+  if (map >= NUBER_OF_MAPS) return false;
+  if (__inputTask == nullptr || xTaskGetCurrentTaskHandle() == __inputTask) {
+    if (!activateMap(map)) return false;
+    updateUiActiveMap();
+    return true;
+  }
+  {
+    MapLock lock;
+    if (loadMap(map) == nullptr) {
+      log_e("Map %u not loaded, map %u stays active", map, __active_map);
+      return false;
+    }
+  }
+  __switchMap = map;
+  xTaskNotifyGive(__inputTask);
+  return true;
 }
 
-void selectBtnCCValueMaxCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+// WEB UI Callbacks
+void nothing(Control* sender, int type) {
+    // Do nothing
+}
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][4] == sender->id) {
-        active_btn = i;
-        break;
-      }
+// the map controls show the maps from 1, like the LED blinks
+void selectActiveMap(Control* sender, int value) {
+    int32_t map;
+    if (!parseFieldNumber(sender->value.c_str(), map) || map < 1 || map > NUBER_OF_MAPS || !switchMap(map - 1)) {
+      updateUiActiveMap();
     }
+}
+
+void switchShowPasswords(Control* sender, int type) {
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiCCValueStateOn[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
+  if(sender->value == "0") {
+    ESPUI.setInputType(wlanApPasswordTxtField, "password");
+    ESPUI.setInputType(wlanPasswordTxtField, "password");
+  } else if(sender->value == "1") {  
+    ESPUI.setInputType(wlanApPasswordTxtField, "text");
+    ESPUI.setInputType(wlanPasswordTxtField, "text");
+  }
 }
 
-void selectBtnCCValueMinCalback(Control* sender, int value) {
+void textCallBlueThoothName(Control* sender, int type)
+{
+    String value = sender->value;
+
+    if(value.length() < 8) {
+      ESPUI.updateControlValue(bleNameTxtField, "Name to short");
+      return;
+    }
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(bleNameTxtField, "Name contains spaces");
+      return;
+    }
+    deviceConfig.setBleName(value.c_str()); // Store Bluetooth name
+    saveDeviceConfigLater();
     
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+}
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][5] == sender->id) {
-        active_btn = i;
-        break;
-      }
+void textCallSsidName(Control* sender, int type) {
+    String value = sender->value;
+
+    if(value.length() < 8) {
+      ESPUI.updateControlValue(wlanSsidNameTxtField, "Name to short");
+      return;
     }
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(wlanSsidNameTxtField, "Name contains spaces");
+      return;
+    }
+    deviceConfig.setSsid(value.c_str()); // Store SSID
+    saveDeviceConfigLater();
+    
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiCCValueStateOff[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
 }
 
-void selectBtnMidiNoteCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+void textCallWlanPassword(Control* sender, int type) {
+    String value = sender->value;
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][6] == sender->id) {
-        active_btn = i;
-        break;
-      }
+    if(value.length() < 8) {
+      ESPUI.updateControlValue(wlanPasswordTxtField, "Name to short");
+      return;
     }
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(wlanPasswordTxtField, "Name contains spaces");
+      return;
+    }  
+    deviceConfig.setPassword(value.c_str()); // Store password
+    saveDeviceConfigLater();
+    
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiNote[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
 }
 
-void selectBtnMMCFnc(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+void textCallAPSsidName(Control* sender, int type) {
+    String value = sender->value;
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][7] == sender->id) {
-        active_btn = i;
-        break;
-      }
+    if(value.length() > 16) {
+      ESPUI.updateControlValue(wlanApSsidTxtField, "Name to long");
+      return;
     }
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(wlanApSsidTxtField, "Name contains spaces");
+      return;
+    }
+    deviceConfig.setApSsid(value.c_str()); // Store SSID
+    saveDeviceConfigLater();
+    
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiMMC[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();  
 }
 
-void selectBtnNoteVelocityCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+void textCallAPPassword(Control* sender, int type) {
+    String value = sender->value;
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][8] == sender->id) {
-        active_btn = i;
-        break;
-      }
+    if(value.length() < 8) {
+      ESPUI.updateControlValue(wlanApPasswordTxtField, "Name to short");
+      return;
+    }
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(wlanApPasswordTxtField, "Name contains spaces");
+      return;
     }
+    deviceConfig.setApPassword(value.c_str()); // Store password
+    saveDeviceConfigLater();
+    
 
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnMidiVelocity[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
 }
 
-void selectBtnBehaveFncCalback(Control* sender, int value) {
-    
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+void textCallHostname(Control* sender, int type) {
+    String value = sender->value;
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][9] == sender->id) {
-        active_btn = i;
-        break;
-      }
+    if(value.length() < 8) {
+      ESPUI.updateControlValue(hostnameTxtField, "Name to short");
+      return;
     }
-
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].btnFunction[__active_map_ui_btn[active_btn]] = value_t;
-    saveSettings();
+    // Check for spaces in the string
+    if (value.indexOf(' ') >= 0) {
+      ESPUI.updateControlValue(hostnameTxtField, "Name contains spaces");
+      return;
+    }
+    WiFi.setHostname(value.c_str());
+    deviceConfig.setHostname(value.c_str()); // Store hostname
+    saveDeviceConfigLater();
+    
 }
 
+void textCallLedBrightness(Control* sender, int type) {
 
 
-void selectBtnTransitinCalback(Control* sender, int value) {
+    __BRIGHTNESS = sender->value.toInt();
+    ledCompositor.setBrightness(__BRIGHTNESS);
+
+    deviceConfig.setLedBrightness(__BRIGHTNESS); // Store brightness, the slider is written when released
+    saveDeviceConfigLater();
     
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
+}
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][10] == sender->id) {
-        active_btn = i;
-        break;
-      }
+void textCallMmcDeviceId(Control* sender, int type) {
+    int32_t id;
+    if (!parseFieldNumber(sender->value.c_str(), id) || id < 0 || id > 127) {
+      ESPUI.updateControlValue(mmcDeviceIdTxtField, String(deviceConfig.mmcDeviceId()));
+      return;
     }
-
-    log_d("Select: ID: %d, Value: %s, Value as int %d\n", sender->id, sender->value, value_t);
-    myBtnMap[active_btn].needRelease[__active_map_ui_btn[active_btn]] = (bool)value_t;
-    saveSettings();
+    setMmcDeviceId(id);
 }
 
-void selectBtnColorCalback(Control *sender, int type) {
 
-    uint8_t value_t = static_cast<uint8_t>(String(sender->value).toInt());
 
-    int active_btn = 0;
-    for(int i = 0; i < __HW_BUTTONS; i++) {
-      if(__selectUiBtn[i][11] == sender->id) {
-        active_btn = i;
-        break;
-      }
-    }
+// Button 1 - x Web UI Callbacks ---------
+// The per button controls come from BUTTON_FIELDS (button_fields.h), the control id leads
+// to (button, slot) through __buttonFields, slot 0 is the map select, slot 1 + n field n.
 
-    static char stylecol1[60], stylecol2[30]; 
-    
+void setUiColorStyle(uint16_t controlId, uint32_t color) {
+    static char stylecol1[60];
+    snprintf(stylecol1, sizeof(stylecol1), "border-bottom: #999 3px solid; background-color: #%06X;", (unsigned)color);
+    ESPUI.setPanelStyle(controlId, stylecol1);
+}
 
-    //uint32_t oppositeColor = 0xFFFFFF - __btnLookUpTable[value_t];
+// show the values of the map being edited of one button
+void updateUiButtonFields(uint8_t btn) {
+    char str[12]; // a long with its sign
+    myMapButton button;
+    {
+      MapLock lock; // not held while ESPUI sends
+      myCachedMap* entry = loadMap(__active_map_ui_btn[btn]);
+      if (entry == nullptr) return;
+      button = entry->buttons[btn];
+    }
+    for (uint8_t field = 0; field < BUTTON_FIELD_COUNT; field++) {
+      snprintf(str, sizeof(str), "%ld", (long)__buttonFields.uiValue(button, field));
+      ESPUI.updateControlValue(__selectUiBtn[btn][1 + field], str);
+      if (BUTTON_FIELDS[field].type == FIELD_TYPE_COLOR) setUiColorStyle(__selectUiBtn[btn][1 + field], paletteColor(button.btnColor));
+    }
+}
 
-    sprintf(stylecol1, "border-bottom: #999 3px solid; background-color: #%06X;", __btnLookUpTable[value_t] );
+void selectBtnMapFnc(Control* sender, int value) {
 
-    //sprintf(stylecol2, "background-color: #%06X;", oppositeColor);
-    
-    ESPUI.setPanelStyle(sender->id, stylecol1);
-    //ESPUI.setElementStyle(sender->id, stylecol1);
-    
-    myBtnMap[active_btn].btnColor[__active_map_ui_btn[active_btn]] = __btnLookUpTable[value_t];
-    saveSettings();
+    uint8_t btn, slot;
+    int32_t map;
+    if (!__buttonFields.findControl(sender->id, btn, slot) || !parseFieldNumber(sender->value.c_str(), map)
+      || map < 1 || map > NUBER_OF_MAPS) {
+      return;
+    }
+    log_d("Select: ID: %d, Button: %u, Map: %ld\n", sender->id, btn, (long)map);
+
+    __active_map_ui_btn[btn] = map - 1;
+    updateUiButtonFields(btn);
+}
 
+void selectBtnFieldCallback(Control* sender, int value) {
 
+    uint8_t btn, slot;
+    if (!__buttonFields.findControl(sender->id, btn, slot) || slot == 0) return;
+    uint8_t field = slot - 1;
+    my_field_result result;
+    myMapButton before, button;
+    {
+      MapLock lock; // not held while ESPUI sends
+      myCachedMap* entry = loadMap(__active_map_ui_btn[btn]);
+      if (entry == nullptr) return;
+      before = entry->buttons[btn];
+      result = __buttonFields.setUiText(entry->buttons[btn], field, sender->value.c_str());
+      if (result == FIELD_OK) saveSettings(entry);
+      button = entry->buttons[btn];
+    }
+    log_d("Field: ID: %d, Button: %u, Field: %u, Value: %s, %s\n", sender->id, btn, field, sender->value.c_str(), fieldResultName(result));
+    if (result != FIELD_OK) {
+      // show the stored value again
+      char str[12]; // a long with its sign
+      snprintf(str, sizeof(str), "%ld", (long)__buttonFields.uiValue(button, field));
+      ESPUI.updateControlValue(sender->id, str);
+      return;
+    }
+    if (BUTTON_FIELDS[field].type == FIELD_TYPE_COLOR) {
+      setUiColorStyle(sender->id, paletteColor(button.btnColor));
+    }
+    // a setter may change other fields too (Midi Function -> PC clears the Bank Select)
+    for (uint8_t other = 0; other < BUTTON_FIELD_COUNT; other++) {
+      if (other != field && __buttonFields.uiValue(before, other) != __buttonFields.uiValue(button, other)) {
+        updateUiButtonFields(btn);
+        break;
+      }
+    }
 }
 
 // ~ WEB UI Callbacks
 
 
+static_assert(AceButton::kEventPressed == BTN_EVENT_PRESSED && AceButton::kEventReleased == BTN_EVENT_RELEASED
+  && AceButton::kEventLongPressed == BTN_EVENT_LONG_PRESSED && AceButton::kEventLongReleased == BTN_EVENT_LONG_RELEASED,
+  "my_btn_event must mirror the AceButton event ids");
+
+// esp_timer task, every tick while a macro plays
+void macroTick(void* arg) {
+  xTaskNotifyGive(__inputTask);
+}
+
+// input task, the first steps go out with the messages of this pass
+void startMacro(uint8_t number, uint32_t startMs) {
+  bool started;
+  {
+    MapLock lock; // the web server task may store new macros
+    started = macroSequencer.start(number, myMacros[number - 1], startMs);
+  }
+  if (!started) log_i("Macro %u not started, %u playing", number, MACRO_PLAYERS);
+  if (macroSequencer.busy() && !__macroTimerRunning) {
+    __macroTimerRunning = esp_timer_start_periodic(__macroTimer, MACRO_TICK_US) == ESP_OK;
+  }
+}
+
 // The event handler for the button.
 void handleEvent(AceButton* button, uint8_t eventType, uint8_t /*buttonState*/) { 
     
@@ -834,217 +1951,187 @@ void handleEvent(AceButton* button, uint8_t eventType, uint8_t /*buttonState*/)
         log_d("Button %d not found\n", pin);
         return;
     }
-   
-    bool logpressevent = false;
-    if(eventType == AceButton::kEventLongPressed) {
-      logpressevent = true;
+
+    log_d("BTN: %d, Event: %d, Map:%d\n", pin, eventType, __active_map);
+
+    // Press and release carry the time of their GPIO edge, so the BLE-MIDI timestamp is the
+    // real press time and not the time the event was handled. Long press events happen now.
+    int64_t nowUs = esp_timer_get_time();
+    uint16_t eventTimeMs = (uint16_t)(nowUs / 1000);
+    bool fromEdge = eventType == AceButton::kEventPressed || eventType == AceButton::kEventReleased;
+    uint32_t sinceEdgeUs = 0; // 0 in the simulator, its tasks run in zero virtual time
+    if(fromEdge) {
+      sinceEdgeUs = (uint32_t)nowUs - __debouncer.edgeTime(myBtn - myBtnMap);
+      eventTimeMs = (uint16_t)((nowUs - sinceEdgeUs) / 1000);
+    }
+
+    if(eventType == AceButton::kEventLongPressed && pin == 11) {
+      // Button 2 is used to change the active map
+      // Switch between 2 maps. Map 1 and Map 2 or Map 3 and Map 4 and so on.
+      // This is only an Quick access to change the active map via long button press
+      // To change the active map to higer or lower maps we use Web ui or midi input commands
+      // for example midi program change. the value of program change is the active map
+      uint8_t map = __active_map;
+      if (map %2 == 0 && __isConnected) {
+        map = map + 1;
+      } else if (map > 0) {
+        map = map -1; // map 0 stays, no uint8_t overflow from 0 to 255
+      }
+      if (activateMap(map)) updateUiActiveMap();
+      return;
+    }
+
+#ifdef USE_LATENCY_STATS
+    uint32_t messagesBefore = bleMidiOutput.builder().messages();
+#endif
+    myEngineResult result = midiEngine.handleEvent(myBtn - myBtnMap, eventType, eventTimeMs);
+#ifdef USE_LATENCY_STATS
+    if (fromEdge && bleMidiOutput.builder().messages() != messagesBefore) {
+      latencyOpen(__debouncer.edgeTime(myBtn - myBtnMap), sinceEdgeUs);
+    }
+#endif
+
+    if(result.macro) {
+      startMacro(result.macro, (uint32_t)((nowUs - sinceEdgeUs) / 1000)); // timed from the press edge
+    }
+
+    if(result.led == LED_BUTTON_COLOR) {
+      ledCompositor.setOverlay(result.color);
+    } else if(result.led == LED_RESTORE) {
+      ledCompositor.clearOverlay();
+    }
+}
+
+
+void IRAM_ATTR buttonIsr(void* arg) {
+  uint8_t btn = (uint8_t)(uintptr_t)arg;
+  myButtonEdge edge = { btn, (uint8_t)digitalRead(myBtnMap[btn].btnGpio), (uint32_t)esp_timer_get_time() };
+  if (!__edgeQueue.push(edge)) __edgeQueueOverflow = true;
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(__inputTask, &higherPriorityTaskWoken);
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+/**
+ * @brief Program Change received, switches the active map
+ * 
+ * @param channel 
+ * @param program 
+ * @param timestamp 
+ */
+void onProgramChange(uint8_t channel, uint8_t program, uint16_t timestamp){
+  // program change received, on the input task: log_d, Serial could block it
+  log_d("Program Change: Channel: %d, Program: %d, Timestamp: %d", channel, program, timestamp);
+  if(program >= NUBER_OF_MAPS){
+    program = NUBER_OF_MAPS - 1;
+  }
+
+  if (activateMap(program)) updateUiActiveMap();
+}
+
+// input task, a Note or CC from the DAW sets the toggle state of the buttons of the active
+// map bound to it, a change flashes the LED in the button color (on) or dark (off)
+bool onFeedback(const myMidiIn& message) {
+  MapLock lock;
+  uint8_t value;
+  uint8_t buttons = feedbackIndex.receive(message.bytes, message.len, value);
+  if (buttons == 0) return false;
+  myCachedMap* entry = mapBankCache.find(__active_map);
+  if (entry == nullptr) return true;
+  for (uint8_t b = 0; b < midiActionTable.numButtons(); b++) {
+    if (!(buttons & (1 << b))) continue;
+    uint8_t state = FeedbackIndex::stateOf(entry->buttons[b], value);
+    if (*midiActionTable.state(b) == state) continue;
+    *midiActionTable.state(b) = state;
+    ledCompositor.flash(state == BTN_ON ? paletteColor(entry->buttons[b].btnColor) : 0);
+  }
+  return true;
+}
+
+// input task, one message from __midiIn, in the order they were received
+void routeMidiIn(const myMidiIn& message) {
+  uint8_t status = message.bytes[0];
+  if ((status & 0xF0) == 0xC0 && message.len == 2) {
+    onProgramChange(status & 0x0F, message.bytes[1], message.timestamp);
+    return;
+  }
+  if (onFeedback(message)) return;
+  // SysEx and clock are drained here and only counted in __midiIn
+  log_d("MIDI in: %02X, %u bytes", status, message.len);
+}
+
+// Input task: runs only when an edge or incoming MIDI arrives, or every 5ms while a button is down or
+// debouncing so AceButton can detect long press and double click.
+void inputTask(void* parameter) {
+  AceButton* buttons[] = { &btn1, &btn2, &btn3, &btn4, &btn5 };
+  uint32_t lastActivityUs = 0;
+  uint16_t appliedMtu = 0;
+
+  for (;;) {
+    uint32_t nowUs = (uint32_t)esp_timer_get_time();
+    bool active = (nowUs - lastActivityUs) < 2000000; // 2s after the last edge, covers long press
+    for (uint8_t i = 0; i < __HW_BUTTONS; i++) {
+      if (__debouncer.level(i) == LOW || __debouncer.pending(i)) active = true;
+    }
+    ulTaskNotifyTake(pdTRUE, active ? pdMS_TO_TICKS(5) : portMAX_DELAY);
+
+    myButtonEdge edge;
+    while (__edgeQueue.pop(edge)) {
+      __debouncer.onEdge(edge.btn, edge.level, edge.timeUs);
+      lastActivityUs = edge.timeUs;
     }
 
-    uint8_t active_mapper = __active_map;
-    // 4 Maps for each Button Map1 = Short Press, Map2 = Short Press, Map3 = Long Press, Map4 = Long Press
-    //if(logpressevent) active_mapper = __active_map + 2; // 0 = map 1, 1 = map 2, 2 = map 3, 3 = map 4
-    
-    bool needRelease = myBtn->needRelease[active_mapper];
-    log_d("BTN: %d, Map:%d, NeedRelease:%d, Test valid Gpio %d \n", pin, active_mapper, needRelease, myBtn->btnGpio);
-    uint8_t btnFunction = myBtn->btnFunction[active_mapper]; // 0 = Push, 1 = Toggle
-    bool btnLongpress = myBtn->btnLongpress[active_mapper]; // 0 = Short Press, 1 = Long Press
-    uint8_t btnState = myBtn->btnState[active_mapper]; // 0 = Off, 1 = On
-    uint32_t btnColor = myBtn->btnColor[active_mapper]; // 0 = Red, 1 = Green, 2 = Blue, 3 = Yellow, 4 = Purple, 5 = Cyan, 6 = White
-    uint8_t btnMidiFunction = myBtn->btnMidiFunction[active_mapper]; // 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-    uint8_t btnMidiChannel = myBtn->btnMidiChannel[active_mapper]; // 0 - 15  MIDI Channel
-    uint8_t btnMidiNote = myBtn->btnMidiNote[active_mapper]; // 0 - 127 MIDI Note
-    uint8_t btnMidiVelocity = myBtn->btnMidiVelocity[active_mapper]; // 0 - 127 MIDI Velocity
-    uint8_t btnMidiCC = myBtn->btnMidiCC[active_mapper]; // 0 - 127 MIDI CC
-    uint8_t btnMidiCCValueStateOn = myBtn->btnMidiCCValueStateOn[active_mapper]; // 0 - 127 MIDI CC Value State On
-    uint8_t btnMidiCCValueStateOff = myBtn->btnMidiCCValueStateOff[active_mapper]; // 0 - 127 MIDI CC Value State Off
-    uint8_t btnMidiMMC = myBtn->btnMidiMMC[active_mapper]; // 0 - 13 MIDI MMC
-
-    CRGB tmpBtncolor = (CRGB::HTMLColorCode)btnColor;
-
-    // check the current button state BTN_ON
-
-    switch (eventType) {
-      case AceButton::kEventPressed:
-        log_i("handleEvent(): BTN: %d Pressed", pin);
-        log_d("BTN: %d Pressed, Map:%d\n ", pin, __active_map);
-
-
-        if(btnMidiFunction == MIDI_NOTE) { // Note on need short press event
-          if(btnFunction == BTN_PUSH){ // Push Button
-            BLEMidiServer.noteOn(btnMidiChannel, btnMidiNote, btnMidiVelocity);
-            myBtn->btnState[active_mapper] = BTN_ON;
-          }
-          if(btnFunction == BTN_TOGGLE){ // Toggle Button
-            if(btnState == BTN_OFF){
-              BLEMidiServer.noteOn(btnMidiChannel, btnMidiNote, btnMidiVelocity);
-              myBtn->btnState[active_mapper] = BTN_ON;
-            }
-            else if(btnState == BTN_ON){
-              BLEMidiServer.noteOff(btnMidiChannel, btnMidiNote, 0 );
-              myBtn->btnState[active_mapper] = BTN_OFF;
-            }
-          }
-        }
-        else if(btnMidiFunction == MIDI_CC && !needRelease){ // CC on need short press event
-          if(btnFunction == BTN_PUSH){ // Push Button
-            BLEMidiServer.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
-            myBtn->btnState[active_mapper] = BTN_ON;
-          }
-          if(btnFunction == BTN_TOGGLE){ // Toggle Button
-            if(btnState == BTN_OFF){
-              BLEMidiServer.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
-              myBtn->btnState[active_mapper] = BTN_ON;
-            }
-            else if(btnState == BTN_ON){
-              BLEMidiServer.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOff);
-              myBtn->btnState[active_mapper] = BTN_OFF;
-            }
-          }
-        }
-        else if(btnMidiFunction == MIDI_MMC && !needRelease){
-          Serial.printf("MMC: %u\n", btnMidiMMC);
-          switch (btnMidiMMC)
-          {
-          case MMC_STOP:
-          BLEMidiServer.mmcStop();
-            BLEMidiServer.mmcStop();
-            break;
-          case MMC_PLAY:
-            BLEMidiServer.mmcPlay();
-            break;
-          case MMC_DEFERRED_PLAY:
-            BLEMidiServer.mmcDeferredPlay();
-            break;
-          case MMC_FAST_FORWARD:
-            BLEMidiServer.mmcFastForward();
-            break;
-          case MMC_REWIND:
-            BLEMidiServer.mmcRewind();
-            break;
-          case MMC_RECORD_STROBE:
-            BLEMidiServer.mmcRecordStrobe();
-            break;
-          case MMC_RECORD_EXIT:
-            BLEMidiServer.mmcRecordExit();
-            break;
-          case MMC_RECORD_PAUSE:
-            BLEMidiServer.mmcRecordPause();
-            break;
-          case MMC_PAUSE:
-            BLEMidiServer.mmcPause();
-            break;
-          default:
-            break;
-          }
-          myBtn->btnState[active_mapper] = BTN_ON;
-        }
-        else if(btnMidiFunction == MIDI_PROGRAMCHANGE && !needRelease) return; // need implementation
+    int16_t map = __switchMap;
+    if (map >= 0) {
+      __switchMap = -1;
+      if (activateMap(map)) updateUiActiveMap();
+    }
+    if (__compileRequested) {
+      __compileRequested = false;
+      compileActiveMap();
+    }
 
-        myWS28XXLED[0] = tmpBtncolor;
-        FastLED.show();
-        break;
-      case AceButton::kEventReleased:
-        log_i("handleEvent(): BTN: %d Released", pin);
-        log_d("BTN: %d Released, Map:%d\n ", pin, __active_map);
-        if(btnMidiFunction == MIDI_NOTE){ // Note on need short press event
-          if(btnFunction == BTN_PUSH){ // Push Button
-            BLEMidiServer.noteOff(btnMidiChannel, btnMidiNote, 0 ); // Note off
-            myBtn->btnState[active_mapper] = BTN_OFF;
-          }
-        }
-        else if(btnMidiFunction == MIDI_CC && needRelease){ // CC on need short press event
-          BLEMidiServer.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
-          myBtn->btnState[active_mapper] = BTN_OFF;
-        }
-        else if(btnMidiFunction == MIDI_MMC && needRelease){
-          switch (btnMidiMMC)
-          {
-          case MMC_STOP:
-            BLEMidiServer.mmcStop();
-            break;
-          case MMC_PLAY:
-            BLEMidiServer.mmcPlay();
-            break;
-          case MMC_DEFERRED_PLAY:
-            BLEMidiServer.mmcDeferredPlay();
-            break;
-          case MMC_FAST_FORWARD:
-            BLEMidiServer.mmcFastForward();
-            break;
-          case MMC_REWIND:
-            BLEMidiServer.mmcRewind();
-            break;
-          case MMC_RECORD_STROBE:
-            BLEMidiServer.mmcRecordStrobe();
-            break;
-          case MMC_RECORD_EXIT:
-            BLEMidiServer.mmcRecordExit();
-            break;
-          case MMC_RECORD_PAUSE:
-            BLEMidiServer.mmcRecordPause();
-            break;
-          case MMC_PAUSE:
-            BLEMidiServer.mmcPause();
-            break;
-          default:
-            break;
-          }
-          myBtn->btnState[active_mapper] = BTN_OFF;
-        }
-        else if(btnMidiFunction == MIDI_PROGRAMCHANGE && needRelease) return; // need implementation
-        myWS28XXLED[0] = __oldLedColor;
-        FastLED.show();
-        break;
-      case AceButton::kEventDoubleClicked:
-        log_i("handleEvent(): BTN: %d DoubleClicked", pin);
-        log_d("BTN: %d DoubleClicked, Map:%d\n ", pin, __active_map);
-        break;
-      case AceButton::kEventLongPressed:
-        // Button 2 is used to change the active map
-        // Switch between 2 maps. Map 1 and Map 2 or Map 3 and Map 4 and so on.
-        // This is only an Quick access to change the active map via long button press
-        // To change the active map to higer or lower maps we use Web ui or midi input commands
-        // for example midi program change. the value of program change is the active map
-        if(pin == 11) {
-          if (__active_map %2 == 0 && __isConnected) {
-            __active_map = __active_map + 1;
-          } else {
-            __active_map = __active_map -1;
-            if(__active_map > NUBER_OF_MAPS) __active_map = 0; // this prevent uint8_t overflow from 0 to 255
-          }
-          saveActiveMap();
-          updateUiActiveMap();
-
-          return;
-        }
-        myWS28XXLED[0] = tmpBtncolor;
-        FastLED.show();
-        log_i("handleEvent(): BTN: %d LongPressed", pin);
-        log_d("BTN: %d LongPressed, Map:%d\n ", pin, __active_map);
-        if(btnLongpress){
-          if(btnMidiFunction == MIDI_NOTE) // Note on need short press event
-            BLEMidiServer.noteOff(btnMidiChannel, btnMidiNote, 0 );
-          else if(btnMidiFunction == MIDI_CC && !needRelease) // CC on need short press event
-            BLEMidiServer.controlChange(btnMidiChannel, btnMidiCC, btnMidiCCValueStateOn);
-          else if(btnMidiFunction == MIDI_MMC && !needRelease) return; // need implementation
-          else if(btnMidiFunction == MIDI_PROGRAMCHANGE && !needRelease) return; // need implementation
-        }
+    myMidiIn midiIn;
+    while (__midiIn.pop(midiIn)) routeMidiIn(midiIn);
 
-        break;
-      case AceButton::kEventLongReleased:
-        // we can disable the note every time the button is logpress released even MidiFuction is not Note
-        BLEMidiServer.noteOff(btnMidiChannel, btnMidiNote, 0 );
-        
-        log_i("handleEvent(): BTN: %d LongReleased", pin);
-        log_d("BTN: %d LongReleased, Map:%d\n ", pin, __active_map);
-        myWS28XXLED[0] = __oldLedColor;
-        FastLED.show();
-        break;
-      default:
-        break;
+    nowUs = (uint32_t)esp_timer_get_time();
+    if (__edgeQueueOverflow) { // lost edges, take the real levels
+      __edgeQueueOverflow = false;
+      for (uint8_t i = 0; i < __HW_BUTTONS; i++) __debouncer.reset(i, digitalRead(myBtnMap[i].btnGpio), nowUs);
+    }
+    for (uint8_t i = 0; i < __HW_BUTTONS; i++) {
+      __debouncer.settle(i, digitalRead(myBtnMap[i].btnGpio), nowUs);
+    }
+
+    if (appliedMtu != __bleMtu) {
+      appliedMtu = __bleMtu;
+      bleMidiOutput.builder().setMtu(appliedMtu);
     }
+    for (uint8_t i = 0; i < __HW_BUTTONS; i++) buttons[i]->check();
+    if (macroSequencer.busy()) macroSequencer.run((uint32_t)(esp_timer_get_time() / 1000));
+    if (__macroTimerRunning && !macroSequencer.busy()) {
+      esp_timer_stop(__macroTimer);
+      __macroTimerRunning = false;
+    }
+    bleMidiOutput.flush(); // all MIDI messages of one pass go out as one BLE-MIDI packet
+  }
 }
 
+void startInputTask() {
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+  for (uint8_t i = 0; i < __HW_BUTTONS; i++) {
+    __debouncer.reset(i, digitalRead(myBtnMap[i].btnGpio), nowUs);
+  }
+  esp_timer_create_args_t macroTimer = {};
+  macroTimer.callback = macroTick;
+  macroTimer.name = "macro";
+  esp_timer_create(&macroTimer, &__macroTimer);
+  // high priority, on the application core next to the loop task
+  xTaskCreatePinnedToCore(inputTask, "input", 4096, nullptr, configMAX_PRIORITIES - 2, &__inputTask, ARDUINO_RUNNING_CORE);
+  for (uint8_t i = 0; i < __HW_BUTTONS; i++) {
+    attachInterruptArg(myBtnMap[i].btnGpio, buttonIsr, (void*)(uintptr_t)i, CHANGE);
+  }
+}
 
 /**
  * @brief connected callback
@@ -1054,16 +2141,7 @@ void connected() {
   // device is BLE MIDI connected
   log_i("Connected");
   __isConnected = true;
-  if (__active_map % 2 == 0) {
-    myWS28XXLED[0] = CRGB::Green;
-    FastLED.show();
-    __oldLedColor = CRGB::Green;
-  } else
-  {
-    myWS28XXLED[0] = CRGB::Purple;
-    __oldLedColor = CRGB::Purple;
-    FastLED.show();
-  }
+  ledCompositor.setBase(mapLedColor());
 }
 
 /**
@@ -1074,286 +2152,603 @@ void disconected() {
   // device is BLE MIDI disconnected
   log_i("Disconnected");
   __isConnected = false;
-  myWS28XXLED[0] = CRGB::Red;
-  FastLED.show();
-  __oldLedColor = CRGB::Red;
+  ledCompositor.setBase(CRGB::Red);
+}
 
+// ~ staged boot ~
+// setup() brings up the MIDI path first (config, active map, BLE, input task), WiFi, DNS and
+// the web UI follow in networkTask. Every stage is stamped so the boot to first MIDI budget
+// can be followed on the serial monitor and in the Diagnostics tab.
+#define BOOT_MAX_STAGES 12
+
+struct myBootStage {
+  const char* name;
+  uint32_t atUs;
+};
+
+myBootStage __bootStages[BOOT_MAX_STAGES];
+volatile uint8_t __bootStageCount = 0;
+uint32_t __bootFirstMidiMs = 0; // setup() done, buttons send MIDI from here on
+volatile bool __networkReady = false; // WiFi connected or hotspot up, set by networkTask
+uint16_t bootStatsLabel;
+
+// called from setup() and then from networkTask, never from both at the same time
+void bootStage(const char* name) {
+  uint32_t nowUs = (uint32_t)esp_timer_get_time();
+  uint8_t n = __bootStageCount;
+  uint32_t lastUs = n ? __bootStages[n - 1].atUs : 0;
+  Serial.printf("Boot stage %-8s %6lu ms (+%lu us)\n", name, (unsigned long)(nowUs / 1000), (unsigned long)(nowUs - lastUs));
+  if (n >= BOOT_MAX_STAGES) return;
+  __bootStages[n].name = name;
+  __bootStages[n].atUs = nowUs;
+  __bootStageCount = n + 1;
 }
 
-/**
- * @brief onProgramChange callback
- * 
- * @param channel 
- * @param program 
- * @param timestamp 
- */
-void onProgramChange(uint8_t channel, uint8_t program, uint16_t timestamp){
-  // program change received
-  Serial.printf("Program Change: Channel: %d, Program: %d, Timestamp: %d\n", channel, program, timestamp);
-  if(program > NUBER_OF_MAPS){
-    program = NUBER_OF_MAPS - 1;
+void formatBootStages(char* str, size_t size) {
+  size_t len = snprintf(str, size, "first MIDI %lu ms", (unsigned long)__bootFirstMidiMs);
+  for (uint8_t i = 0; i < __bootStageCount && len < size; i++) {
+    len += snprintf(str + len, size - len, ", %s %lu", __bootStages[i].name, (unsigned long)(__bootStages[i].atUs / 1000));
   }
+}
 
-  __active_map = program;
-  saveActiveMap();
-  updateUiActiveMap();
+// a map number 1 .. NUBER_OF_MAPS, an option per map would be NUBER_OF_MAPS controls per select
+uint16_t addMapControl(const char* label, uint8_t map, uint16_t parent, void (*callback)(Control*, int)) {
+  char value[4];
+  snprintf(value, sizeof(value), "%u", map + 1);
+  uint16_t id = ESPUI.addControl(ControlType::Number, label, value, ControlColor::Emerald, parent, callback);
+  ESPUI.addControl(Min, "", "1", None, id);
+  snprintf(value, sizeof(value), "%u", NUBER_OF_MAPS);
+  ESPUI.addControl(Max, "", value, None, id);
+  return id;
 }
 
-void blinkActiveMaps(){
+void buildWebUi() {
+
+  uint16_t tab1 = ESPUI.addControl(ControlType::Tab, "Button 1", "Button 1");
+  uint16_t tab2 = ESPUI.addControl(ControlType::Tab, "Button 2", "Button 2");
+  uint16_t tab3 = ESPUI.addControl(ControlType::Tab, "Button 3", "Button 3");
+  uint16_t tab4 = ESPUI.addControl(ControlType::Tab, "Button 4", "Button 4");
+  uint16_t tab5 = ESPUI.addControl(ControlType::Tab, "Button 5", "Button 5");
+  uint16_t tab6 = ESPUI.addControl(ControlType::Tab, "Active Map", "Active Map");
+  uint16_t tab7 = ESPUI.addControl(ControlType::Tab, "Settings", "Settings");
+
+  // Active Map Chooser
+  activeMapChooser = addMapControl("Active Map:", __active_map, tab6, &selectActiveMap);
   
-  bool numblinkfirst = false;
-  float blikBrightness = float(__BRIGHTNESS);
-  if( millis() - __oldBlinktime > 5000){
-    //Serial.printf("kk, %d %d %d \n", millis(), __numBlincs, __oldBlinktime);
-    if(__numBlincs > 0){
-
-      if(__numBlincs %2 == 0){
-        blikBrightness = float(__BRIGHTNESS / 3.0f);
-        if(__BRIGHTNESS < 2) blikBrightness = 0;
-      }
 
-      numblinkfirst = true;
-      if(millis() - __oldNumBlinktime > 200){
-        __numBlincs--;
-        //Serial.printf("Blinki : %u\n", __numBlincs);
-        FastLED.setBrightness(blikBrightness);
-        FastLED.show();
-        __oldNumBlinktime = millis();
-      }
+  // Wlan Settings and Bluethooth Settings
+
+  bleNameTxtField = ESPUI.addControl(ControlType::Text, "Bluethooth Name:", midiDeviceName.c_str(), ControlColor::Dark, tab7, &textCallBlueThoothName);
+  wlanSsidNameTxtField = ESPUI.addControl(ControlType::Text, "Wlan SSID:", ssid.c_str(), ControlColor::Dark, tab7, &textCallSsidName);
+  wlanPasswordTxtField = ESPUI.addControl(ControlType::Text, "Wlan Password:", password.c_str(), ControlColor::Dark, tab7, &textCallWlanPassword);
+  ESPUI.setInputType(wlanPasswordTxtField, "password");
+  wlanApSsidTxtField = ESPUI.addControl(ControlType::Text, "Access Point SSID:", ap_ssid.c_str(), ControlColor::Dark, tab7, &textCallAPSsidName);
+  wlanApPasswordTxtField = ESPUI.addControl(ControlType::Text, "Access Point Password:", ap_password.c_str(), ControlColor::Dark, tab7, &textCallAPPassword);
+  ESPUI.setInputType(wlanApPasswordTxtField, "password");
+  hostnameTxtField = ESPUI.addControl(ControlType::Text, "Hostname:", hostname.c_str(), ControlColor::Dark, tab7, &textCallHostname);
+  ESPUI.addControl(ControlType::Switcher, "Show Passwords", "", ControlColor::Alizarin, tab7, &switchShowPasswords);
+
+  // OTA Update
+  #ifdef USE_OTA
+  char fwv[3];
+  sprintf(fwv, "s3miniV%d", __FW_VERSION);
+  ESPUI.addControl(ControlType::Label, "Current Firmware", fwv, ControlColor::Alizarin, tab7, &nothing);
+
+  char fwupdatestr[20];
+  if(__UPDATE_FAILURE && __UPDATE_ERROR_CODE == 404){
+    sprintf(fwupdatestr, "No Update foud"); // Convert the number to a string
+  }
+  else if(__UPDATE_FAILURE) sprintf(fwupdatestr, "Update Fail, retry"); // Convert the number to a string
+  else sprintf(fwupdatestr, "Try Update"); // Convert the number to a string
+  ESPUI.addControl(ControlType::Button, "Firmware Update", fwupdatestr, ControlColor::Alizarin, tab7, &otaUpdate);
+  #endif
+
+  // Led Brightness
+  ledBrightnessTxtField = ESPUI.addControl(ControlType::Slider, "LED Brightness:", String(__BRIGHTNESS).c_str(), ControlColor::Dark, tab7, &textCallLedBrightness);
+  ESPUI.addControl(Min, "", "0", None, ledBrightnessTxtField);
+  ESPUI.addControl(Max, "", "255", None, ledBrightnessTxtField);
+
+  // MMC device ID of the MMC buttons, 127 = all devices
+  mmcDeviceIdTxtField = ESPUI.addControl(ControlType::Number, "MMC Device ID 0 - 127 (127 = all):", String(deviceConfig.mmcDeviceId()).c_str(), ControlColor::Dark, tab7, &textCallMmcDeviceId);
+  ESPUI.addControl(Min, "", "0", None, mmcDeviceIdTxtField);
+  ESPUI.addControl(Max, "", "127", None, mmcDeviceIdTxtField);
+
+  // Diagnostics: map bank writes of this session, map switch time, MIDI in, press -> notify latency, updated by loop(), boot stages
+  uint16_t tab8 = ESPUI.addControl(ControlType::Tab, "Diagnostics", "Diagnostics");
+  nvsStatsLabel = ESPUI.addControl(ControlType::Label, "Map Bank Writes", "0 writes", ControlColor::Peterriver, tab8, &nothing);
+  char mapSwitch[128];
+  formatMapSwitch(mapSwitch, sizeof(mapSwitch));
+  mapSwitchLabel = ESPUI.addControl(ControlType::Label, "Map Switch", mapSwitch, ControlColor::Peterriver, tab8, &nothing);
+  bootStatsLabel = ESPUI.addControl(ControlType::Label, "Boot Stages", "", ControlColor::Peterriver, tab8, &nothing);
+  midiInStatsLabel = ESPUI.addControl(ControlType::Label, "MIDI In", "n=0", ControlColor::Peterriver, tab8, &nothing);
+  #ifdef USE_LATENCY_STATS
+  for (uint8_t stage = 0; stage < LATENCY_STAGES; stage++) {
+    __latencyLabel[stage] = ESPUI.addControl(ControlType::Label, LatencyStats::stageName(stage), "no samples", ControlColor::Peterriver, tab8, &nothing);
+  }
+  __latencyLabel[LATENCY_STAGES] = ESPUI.addControl(ControlType::Label, "Dropped Samples", "0", ControlColor::Peterriver, tab8, &nothing);
+  ESPUI.addControl(ControlType::Button, "Latency", "Reset", ControlColor::Alizarin, tab8, &resetLatencyCallback);
+  #endif
+
+  // Buttons in a for loop, the controls of each button come from BUTTON_FIELDS
+  __buttonFields.clearControls();
 
+  for (size_t hw_B = 0; hw_B < __HW_BUTTONS; hw_B++) // HW Buttons * Ui Button Functions
+  {
+    uint16_t thistab = 0;
+    switch ( hw_B )
+    {
+      case 0:
+        thistab = tab1;
+        break;
+      case 1:
+        thistab = tab2;
+        break;
+      case 2:
+        thistab = tab3;
+        break;
+      case 3:
+        thistab = tab4;
+        break;
+      case 4:
+        thistab = tab5;
+        break;
+      default:
+        break;
     }
-    else
+    __selectUiBtn[hw_B][0] = addMapControl("Select Map:", __active_map_ui_btn[hw_B], thistab, &selectBtnMapFnc);
+    __buttonFields.bindControl(__selectUiBtn[hw_B][0], hw_B, 0);
+
+    char convertstr[12]; // a long with its sign
+    myMapButton button = {};
     {
-      numblinkfirst = false;
+      MapLock lock;
+      myCachedMap* entry = loadMap(__active_map_ui_btn[hw_B]);
+      if (entry != nullptr) button = entry->buttons[hw_B];
     }
-    
-    if(!numblinkfirst){
-        __oldBlinktime = millis();
-        __numBlincs = (__active_map + 1) * 2;
+    for (uint8_t field = 0; field < BUTTON_FIELD_COUNT; field++) {
+      const myFieldDescriptor& d = BUTTON_FIELDS[field];
+      ControlType type = d.widget == FIELD_WIDGET_SELECT ? ControlType::Select
+        : d.widget == FIELD_WIDGET_SLIDER ? ControlType::Slider : ControlType::Number;
+      snprintf(convertstr, sizeof(convertstr), "%ld", (long)__buttonFields.uiValue(button, field));
+      uint16_t id = ESPUI.addControl(type, d.label, convertstr, ControlColor::Dark, thistab, &selectBtnFieldCallback);
+      if (d.widget == FIELD_WIDGET_SELECT) {
+        for (uint8_t i = 0; i < d.optionCount; i++) {
+          snprintf(convertstr, sizeof(convertstr), "%u", (unsigned)d.options[i].value);
+          ESPUI.addControl(ControlType::Option, d.options[i].label, convertstr, ControlColor::Dark, id);
+        }
+      } else {
+        snprintf(convertstr, sizeof(convertstr), "%u", (unsigned)d.min);
+        ESPUI.addControl(Min, "", convertstr, None, id);
+        snprintf(convertstr, sizeof(convertstr), "%u", (unsigned)d.max);
+        ESPUI.addControl(Max, "", convertstr, None, id);
+      }
+      if (d.type == FIELD_TYPE_COLOR) setUiColorStyle(id, paletteColor(button.btnColor));
+
+      __selectUiBtn[hw_B][1 + field] = id;
+      if (!__buttonFields.bindControl(id, hw_B, 1 + field)) {
+        log_e("Control id %u of button %u out of the field index\n", id, (unsigned)hw_B);
+      }
     }
+  
   }
+  
 }
 
-void setup() {
+#ifdef USE_LITE_UI
+// ~ lite web UI ~
+// One gzip page from flash (web/index.html, tools/mkwebui.py) and a small REST API. A map
+// is read and written whole as map record (map_codec.h), so editing a button costs one
+// request instead of one websocket message per field, and nothing is kept per control.
+//   GET  /                  the page, 304 while the browser has it (ETag)
+//   GET  /api/state         JSON: version, active map, names, heap, boot stages
+//   GET  /api/map?m=<n>     map record of map n
+//   POST /api/map?m=<n>     map record, stored write-behind like a change in the ESPUI tree
+//   POST /api/active?m=<n>  active map
+//   POST /api/settings      form fields name ssid password apSsid apPassword hostname brightness mmcId
+//   GET  /api/macros        macro record (macro_sequencer.h)
+//   POST /api/macros        macro record, stored in NVS right away (tools/mkmacros.py)
+//   POST /api/update        firmware update on the next boot
+static_assert(WEBUI_MAP_CODEC_VERSION == MAP_CODEC_VERSION && WEBUI_MAP_CODEC_BUTTON_SIZE == MAP_CODEC_BUTTON_SIZE,
+  "web/index.html was built for another map record, run tools/mkwebui.py");
+
+AsyncWebServer* __liteServer = nullptr;
+uint32_t __liteRequests = 0;
+uint8_t* __macroUpload = nullptr; // MACRO_RECORD_MAX_SIZE while a macro record comes in
+size_t __macroUploadLen = 0;
+
+// ?m=<map>, -1 if missing or no map
+int mapParam(AsyncWebServerRequest* request) {
+  if (!request->hasParam("m")) return -1;
+  long map = request->getParam("m")->value().toInt();
+  return map >= 0 && map < NUBER_OF_MAPS ? map : -1;
+}
 
+// same rules as the text fields of the ESPUI tree, nullptr if the value is fine
+const char* checkSetting(const String& value, size_t minLen, size_t maxLen) {
+  if (value.length() < minLen) return "Name to short";
+  if (value.length() > maxLen) return "Name to long";
+  if (value.indexOf(' ') >= 0) return "Name contains spaces";
+  return nullptr;
+}
 
-  // initialize WS28xx LED in GRB order
-  FastLED.addLeds<WS2812B, WS28XX_LED_PIN, GRB>(myWS28XXLED, NUM_LEDS);
-  FastLED.setBrightness(6);
-  myWS28XXLED[0] = CRGB::Red;
-  FastLED.show();
-  __oldLedColor = CRGB::Red;
-    
-  Serial.begin(57600);
-  int timoutcounter = 0;
-  while (!Serial) {
-  delay(1000);
-    timoutcounter++;
-    if (timoutcounter > 1) {
-      break;
-    }
+size_t appendJsonString(char* str, size_t size, size_t len, const char* key, const char* value) {
+  if (len >= size) return len;
+  len += snprintf(str + len, size - len, "\"%s\":\"", key);
+  for (; *value && len + 3 < size; value++) {
+    if (*value == '"' || *value == '\\') str[len++] = '\\';
+    if ((uint8_t)*value >= 0x20) str[len++] = *value;
   }
+  return len + snprintf(str + len, size - len, "\",");
+}
 
-
-// Set log level
-// test serveral log levels without success something is broken in the library
-// there is no output on the serial monitor with all log levels.
- //esp_log_level_set("*", ESP_LOG_INFO);
-  log_i("Starting up with Loglevel Info");
-
-  // Reset only Midi Settings
-  if(digitalRead(10) == LOW && digitalRead(11) == LOW) {
-    Serial.println("Reset Midi settings!");
-    prefs.begin("Settings");  //Open namespace Settings
-    log_d("Reset settings!");
-    
-    prefs.putBytes("Settings", &myBtnMap, sizeof(myBtnMap));
-    
-    prefs.end(); // close the Settings Namespace
+void liteSendState(AsyncWebServerRequest* request) {
+  char json[640];
+  size_t len = snprintf(json, sizeof(json), "{\"fw\":%u,\"map\":%u,\"maps\":%u,\"buttons\":%u,\"brightness\":%u,\"mmcId\":%u,",
+    __FW_VERSION, __active_map, NUBER_OF_MAPS, __HW_BUTTONS, __BRIGHTNESS, deviceConfig.mmcDeviceId());
+  len = appendJsonString(json, sizeof(json), len, "name", deviceConfig.bleName());
+  len = appendJsonString(json, sizeof(json), len, "ssid", deviceConfig.ssid());
+  len = appendJsonString(json, sizeof(json), len, "apSsid", deviceConfig.apSsid());
+  len = appendJsonString(json, sizeof(json), len, "hostname", deviceConfig.hostname());
+  char boot[160];
+  formatBootStages(boot, sizeof(boot));
+  len = appendJsonString(json, sizeof(json), len, "boot", boot);
+  char midiIn[96];
+  formatMidiIn(midiIn, sizeof(midiIn));
+  len = appendJsonString(json, sizeof(json), len, "midiIn", midiIn);
+  if (len < sizeof(json)) {
+    snprintf(json + len, sizeof(json) - len, "\"heap\":%u,\"minHeap\":%u,\"requests\":%lu}",
+      ESP.getFreeHeap(), ESP.getMinFreeHeap(), (unsigned long)__liteRequests);
   }
+  request->send(200, "application/json", json);
+}
 
-  // reset all the settings
-  if(digitalRead(10) == LOW && digitalRead(12) == LOW) {
-    //reset settings
-    prefs.begin("Settings");  //Open namespace Settings
-    log_d("Reset settings!");
-    
-    prefs.putBytes("Settings", &myBtnMap, sizeof(myBtnMap));
-    
-    prefs.end(); // close the Settings Namespace
-    
-
-    prefs.begin("blename", false); // Open NVS namespace "blename" in RW mode
-    log_d("Reset blename!");
-    
-    prefs.putString("blename", midiDeviceName); // Save the default name
-    
-    prefs.end(); // Close NVS namespace "blename"
-    
+void liteSendMap(AsyncWebServerRequest* request) {
+  int map = mapParam(request);
+  if (map < 0) {
+    request->send(400, "text/plain", "no such map");
+    return;
+  }
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+  size_t len = 0;
+  {
+    MapLock lock;
+    myCachedMap* entry = loadMap(map);
+    if (entry != nullptr) len = encodeMap(entry->buttons, __HW_BUTTONS, map, record, sizeof(record));
+  }
+  if (len == 0) {
+    request->send(500, "text/plain", "map not loaded");
+    return;
+  }
+  // copied into the response, the record on the stack is gone before the last TCP ack
+  AsyncResponseStream* response = request->beginResponseStream("application/octet-stream");
+  response->write(record, len);
+  request->send(response);
+}
 
-    prefs.begin("wifi", false); // Open NVS namespace "wifi" in RW mode
-    log_d("Reset wifi!");
-    
-    prefs.putString("ssid_local", ssid); // Save the default name
-    
-    prefs.putString("password_local", password); // Save the default name
-    
-    prefs.putString("ssid_ap", ap_ssid); // Save the default name
-    
-    prefs.putString("password_ap", ap_password); // Save the default name
-    
-    prefs.putString("hostname", hostname); // Save the default name
+// POST /api/map body of one request, the request frees it (_tempObject)
+struct myMapUpload {
+  size_t len;
+  uint8_t record[MAP_CODEC_MAX_SIZE];
+};
 
-    prefs.putUInt("LedBrightness", __BRIGHTNESS); // Save the default name
-    
-    prefs.end(); // Close NVS namespace "wifi"
-    
+// body of POST /api/map, may come in pieces, never called for an empty body
+void liteMapBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+  if (index == 0 && request->_tempObject == nullptr && total <= MAP_CODEC_MAX_SIZE) {
+    myMapUpload* upload = (myMapUpload*)malloc(sizeof(myMapUpload));
+    if (upload != nullptr) upload->len = 0;
+    request->_tempObject = upload;
   }
+  myMapUpload* upload = (myMapUpload*)request->_tempObject;
+  if (upload == nullptr || index != upload->len || index + len > sizeof(upload->record)) return;
+  memcpy(upload->record + index, data, len);
+  upload->len = index + len;
+}
 
-  prefs.begin("updateerrorcode");  //Open namespace Settings
-  if (not prefs.isKey("updateerrorcode")) {
-    Serial.println("do updateerrorcode not found, saving updateerrorcode");
-    prefs.putInt("updateerrorcode", __UPDATE_ERROR_CODE);
-  } else {
-    log_d("updateerrorcode found, loading");
-    __UPDATE_ERROR_CODE = prefs.getInt("updateerrorcode");
-    Serial.printf("Fail Errorcode: %d\n", __UPDATE_ERROR_CODE);
+void liteStoreMap(AsyncWebServerRequest* request) {
+  int map = mapParam(request);
+  const myMapUpload* upload = (const myMapUpload*)request->_tempObject;
+  if (map < 0 || request->contentLength() > MAP_CODEC_MAX_SIZE) {
+    request->send(400, "text/plain", map < 0 ? "no such map" : "record too large");
+    return;
   }
-  prefs.end(); // close the Settings Namespace 
-
-
-  prefs.begin("updatefail");  //Open namespace Settings
-  if (not prefs.isKey("updatefail")) {
-    Serial.println("do updatefail not found, saving updatefail");
-    prefs.putBool("updatefail", __UPDATE_FAILURE);
-  } else {
-    log_d("update fail found, loading");
-    __UPDATE_FAILURE = prefs.getBool("updatefail");
-    Serial.printf("Fail Update: %d\n", __UPDATE_FAILURE);
+  if (upload == nullptr || upload->len != request->contentLength()) {
+    request->send(400, "text/plain", "no record");
+    return;
+  }
+  MapLock lock;
+  myCachedMap* entry = loadMap(map);
+  if (entry == nullptr) {
+    request->send(500, "text/plain", "map not loaded");
+    return;
   }
-  prefs.end(); // close the Settings Namespace 
+  // decoded into a copy first, a broken record must not leave a half changed map
+  myMapButton edited[MIDI_ACTION_MAX_BUTTONS];
+  memcpy(edited, entry->buttons, sizeof(edited));
+  my_map_codec_result result = decodeMap(upload->record, upload->len, map, edited, __HW_BUTTONS);
+  if (result != MAP_CODEC_OK && result != MAP_CODEC_MIGRATED) {
+    request->send(400, "text/plain", mapCodecResultName(result));
+    return;
+  }
+  memcpy(entry->buttons, edited, sizeof(edited));
+  memset(entry->states, BTN_OFF, sizeof(entry->states));
+  saveSettings(entry);
+  request->send(204);
+}
 
-  prefs.begin("doupdate");  //Open namespace Settings
-  if (not prefs.isKey("doupdate")) {
-    Serial.println("do update not found, saving doupdate");
-    prefs.putBool("doupdate", __DO_UPDATE);
-  } else {
-    log_d("do update found, loading");
-    __DO_UPDATE = prefs.getBool("doupdate");
-    Serial.printf("Do Update: %d\n", __DO_UPDATE);
+void liteSendMacros(AsyncWebServerRequest* request) {
+  uint8_t record[MACRO_RECORD_MAX_SIZE];
+  size_t len;
+  {
+    MapLock lock;
+    len = encodeMacros(myMacros, MACRO_COUNT, record, sizeof(record));
   }
-  prefs.end(); // close the Settings Namespace 
+  // copied like the map record, it needs more than one TCP segment
+  AsyncResponseStream* response = request->beginResponseStream("application/octet-stream");
+  response->write(record, len);
+  request->send(response);
+}
 
-  prefs.begin("fwversion");  //Open namespace Settings
-  //prefs.putUInt("fwversion", 1);// uncomment to reset internel firmware version
-  if (not prefs.isKey("fwversion")) {
-    Serial.println("firmware version not found, saving current version nr.");
-    prefs.putUInt("fwversion", __FW_VERSION);
-  } else {
-    log_d("firmware version found, loading version number");
-    __FW_VERSION = prefs.getUInt("fwversion");
-    Serial.printf("FW Version: %d\n", __FW_VERSION);
+// body of POST /api/macros, may come in pieces, the buffer exists only during the upload
+void liteMacrosBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+  if (index == 0) {
+    free(__macroUpload);
+    __macroUpload = total <= MACRO_RECORD_MAX_SIZE ? (uint8_t*)malloc(MACRO_RECORD_MAX_SIZE) : nullptr;
+    __macroUploadLen = 0;
   }
-  prefs.end(); // close the Settings Namespace
+  if (__macroUpload == nullptr || index + len > MACRO_RECORD_MAX_SIZE) return;
+  memcpy(__macroUpload + index, data, len);
+  __macroUploadLen = index + len;
+}
 
-  prefs.begin("Settings");  //Open namespace Settings
- 
-  if (not prefs.isKey("Settings")) {
-    log_d("Settings not found, saving default settings");
-    prefs.putBytes("Settings", &myBtnMap, sizeof(myBtnMap));
-  } else {
-    log_d("Settings found, loading settings");
-    prefs.getBytes("Settings", &myBtnMap, sizeof(myBtnMap));
+void liteStoreMacros(AsyncWebServerRequest* request) {
+  bool ok;
+  {
+    MapLock lock; // the input task copies a macro when it starts it
+    ok = __macroUpload != nullptr && decodeMacros(__macroUpload, __macroUploadLen, myMacros, MACRO_COUNT) && saveMacros();
   }
-  
-  prefs.end(); // close the Settings Namespace
+  free(__macroUpload);
+  __macroUpload = nullptr;
+  if (!ok) {
+    request->send(400, "text/plain", "broken or too large macro record");
+    return;
+  }
+  request->send(204);
+}
 
-  prefs.begin("active_map");  //Open namespace Settings
-  if (not prefs.isKey("active_map")) {
-    Serial.println("active_map not found, saving default active_map");
-    prefs.putUInt("active_map", __active_map);
-  } else {
-    log_d("active_map found, loading map");
-    __active_map = prefs.getUInt("active_map");
-    Serial.printf("active_map: %d\n", __active_map);
+void liteStoreActiveMap(AsyncWebServerRequest* request) {
+  int map = mapParam(request);
+  if (map < 0) {
+    request->send(400, "text/plain", "no such map");
+    return;
   }
-  prefs.end(); // close the Settings Namespace
-  
+  if (!switchMap(map)) {
+    request->send(500, "text/plain", "map not loaded");
+    return;
+  }
+  request->send(204);
+}
 
-  prefs.begin("blename", false); // Open NVS namespace "blename" in RW mode
-  
-  if (not prefs.isKey("blename")) {
-    log_d("blename not found");
-    prefs.putString("blename", midiDeviceName); // Save the default name
-  } else {
-    midiDeviceName = prefs.getString("blename"); // 
-    log_d("blename found, loading settings: value: %S\n", midiDeviceName.c_str());
+void liteStoreSettings(AsyncWebServerRequest* request) {
+  struct { const char* name; size_t minLen; size_t maxLen; bool (DeviceConfig::*set)(const char*); } fields[] = {
+    { "name", 8, DEVICE_CONFIG_NAME_LEN, &DeviceConfig::setBleName },
+    { "ssid", 8, DEVICE_CONFIG_NAME_LEN, &DeviceConfig::setSsid },
+    { "password", 8, DEVICE_CONFIG_PASSWORD_LEN - 1, &DeviceConfig::setPassword },
+    { "apSsid", 0, DEVICE_CONFIG_AP_SSID_LEN, &DeviceConfig::setApSsid },
+    { "apPassword", 8, DEVICE_CONFIG_PASSWORD_LEN - 1, &DeviceConfig::setApPassword },
+    { "hostname", 8, DEVICE_CONFIG_NAME_LEN, &DeviceConfig::setHostname },
+  };
+  // all fields are checked before any is taken
+  for (auto& field : fields) {
+    if (!request->hasParam(field.name, true)) continue;
+    const char* error = checkSetting(request->getParam(field.name, true)->value(), field.minLen, field.maxLen);
+    if (error) {
+      request->send(400, "text/plain", String(field.name) + ": " + error);
+      return;
+    }
   }
-  
-  prefs.end(); // Close NVS namespace "blename"
-  
+  int32_t mmcId = deviceConfig.mmcDeviceId();
+  if (request->hasParam("mmcId", true)
+    && (!parseFieldNumber(request->getParam("mmcId", true)->value().c_str(), mmcId) || mmcId < 0 || mmcId > 127)) {
+    request->send(400, "text/plain", "mmcId: 0 - 127");
+    return;
+  }
+  for (auto& field : fields) {
+    if (request->hasParam(field.name, true)) (deviceConfig.*field.set)(request->getParam(field.name, true)->value().c_str());
+  }
+  if (request->hasParam("hostname", true)) WiFi.setHostname(deviceConfig.hostname());
+  if (request->hasParam("brightness", true)) {
+    long brightness = request->getParam("brightness", true)->value().toInt();
+    __BRIGHTNESS = brightness < 0 ? 0 : brightness > 255 ? 255 : brightness;
+    ledCompositor.setBrightness(__BRIGHTNESS);
+    deviceConfig.setLedBrightness(__BRIGHTNESS);
+  }
+  if (mmcId != deviceConfig.mmcDeviceId()) setMmcDeviceId(mmcId);
+  saveDeviceConfigLater();
+  request->send(204);
+}
 
-  prefs.begin("wifi", false); // Open NVS namespace "wifi" in RW mode
-  if (not prefs.isKey("ssid_local")) {
-    log_d("ssid_local not found");
-    prefs.putString("ssid_local", ssid); // Save the default name
-  } else {
-    ssid = prefs.getString("ssid_local"); // 
-    log_d("ssid_local found, loading settings: value: %S\n", ssid.c_str());
+void startLiteUi() {
+  __liteServer = new AsyncWebServer(80);
+  __liteServer->on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
+    __liteRequests++;
+    if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == WEBUI_PAGE_ETAG) {
+      request->send(304);
+      return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse_P(200, "text/html", WEBUI_PAGE, WEBUI_PAGE_SIZE);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", WEBUI_PAGE_ETAG);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+  });
+  __liteServer->on("/api/state", HTTP_GET, [](AsyncWebServerRequest* request) { __liteRequests++; liteSendState(request); });
+  __liteServer->on("/api/map", HTTP_GET, [](AsyncWebServerRequest* request) { __liteRequests++; liteSendMap(request); });
+  __liteServer->on("/api/map", HTTP_POST, [](AsyncWebServerRequest* request) { __liteRequests++; liteStoreMap(request); },
+    nullptr, liteMapBody);
+  __liteServer->on("/api/active", HTTP_POST, [](AsyncWebServerRequest* request) { __liteRequests++; liteStoreActiveMap(request); });
+  __liteServer->on("/api/macros", HTTP_GET, [](AsyncWebServerRequest* request) { __liteRequests++; liteSendMacros(request); });
+  __liteServer->on("/api/macros", HTTP_POST, [](AsyncWebServerRequest* request) { __liteRequests++; liteStoreMacros(request); },
+    nullptr, liteMacrosBody);
+  __liteServer->on("/api/settings", HTTP_POST, [](AsyncWebServerRequest* request) { __liteRequests++; liteStoreSettings(request); });
+#ifdef USE_OTA
+  __liteServer->on("/api/update", HTTP_POST, [](AsyncWebServerRequest* request) {
+    __liteRequests++;
+    requestOtaUpdate();
+    request->send(200, "text/plain", "Update requested need Reeboot");
+  });
+#endif
+  // captive portal: every other URL shows the page
+  __liteServer->onNotFound([](AsyncWebServerRequest* request) { request->redirect("/"); });
+  __liteServer->begin();
+}
+#endif
+
+// WiFi station or hotspot, DNS and the web UI. The waits for the connection run here and no
+// longer hold back BLE-MIDI, loop() serves DNS and the UI labels once __configurator is set.
+void networkTask(void* parameter) {
+  bool tryStation = parameter != nullptr;
+
+  WiFi.setHostname(hostname.c_str());
+
+  if(tryStation) {
+    // try to connect to existing network
+    WiFi.begin(ssid.c_str(), password.c_str());
+    log_d("\n\nTry to connect to existing network");
   }
-  
-  if (not prefs.isKey("password_local")) {
-    log_d("password_local not found");
-    prefs.putString("password_local", password); // Save the default name
-  } else {
-    password = prefs.getString("password_local"); // 
-    log_d("password_local found, loading settings: value: %S\n", password.c_str());
+
+  {
+      uint8_t timeout = 10;
+
+      // Wait for connection, 5s timeout
+      do
+      {
+          delay(500);
+          log_d(".");
+          timeout--;
+      } while (timeout && WiFi.status() != WL_CONNECTED);
+
+      Serial.printf("Local Ip Address: %s\n", WiFi.localIP().toString().c_str());
+
+      if(WiFi.status() != WL_CONNECTED && __DO_UPDATE){
+        Serial.println("Configure Local network first!");
+      }
+      // not connected -> create hotspot
+      if (WiFi.status() != WL_CONNECTED && !__DO_UPDATE)
+      {
+          log_d("\n\nCreating hotspot");
+
+          WiFi.mode(WIFI_AP);
+          delay(100);
+          WiFi.softAPConfig(apIP, apIP, IPAddress(255, 255, 255, 0));
+
+          char local_ap_ssid[25];
+          char local_ap_password[30];
+          snprintf(local_ap_ssid, 26, "%s-%08X", ap_ssid.c_str(), (unsigned)ESP.getEfuseMac());
+          snprintf(local_ap_password, 31, "%s", ap_password.c_str() );
+          WiFi.softAP(local_ap_ssid, local_ap_password);
+
+          timeout = 5;
+
+          do
+          {
+              delay(500);
+              log_d(".");
+              timeout--;
+          } while (timeout);
+      }
   }
-  
-  if (not prefs.isKey("ssid_ap")) {
-    log_d("ssid_ap not found");
-    prefs.putString("ssid_ap", ap_ssid); // Save the default name
-  } else {
-    ap_ssid = prefs.getString("ssid_ap"); // 
-    log_d("ssid_ap found, loading settings: value: %S\n", ap_ssid.c_str());
+  bootStage("wifi");
+  __networkReady = true;
+
+  if(!__DO_UPDATE){
+    dnsServer.start(DNS_PORT, "LittleHelper", apIP);
+    bootStage("dns");
+
+    log_d("\n\nWiFi parameters:");
+    log_d("Mode: ");
+    log_d("%S\n", WiFi.getMode() == WIFI_AP ? "Station" : "Client");
+    log_d("IP address: ");
+    log_d("%S\n", WiFi.getMode() == WIFI_AP ? WiFi.softAPIP() : WiFi.localIP());
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+#ifdef USE_LITE_UI
+    startLiteUi();
+    bootStage("webui");
+#else
+    ESPUI.setVerbosity(Verbosity::Quiet);
+    buildWebUi();
+    ESPUI.begin("Little Helper Web UI");
+    bootStage("webui");
+
+    char str[160];
+    formatBootStages(str, sizeof(str));
+    ESPUI.updateLabel(bootStatsLabel, str);
+#endif
+    // the heap the configurator keeps, the number to compare ESPUI and USE_LITE_UI with
+    uint32_t heapAfter = ESP.getFreeHeap();
+    Serial.printf("Web UI: %ld bytes heap, %lu bytes free\n", (long)(heapBefore - heapAfter), (unsigned long)heapAfter);
+    __configurator = true;
   }
-  
-  if (not prefs.isKey("password_ap")) {
-    log_d("password_ap not found");
-    prefs.putString("password_ap", ap_password); // Save the default name
-  } else {
-    ap_password = prefs.getString("password_ap"); // 
-    log_d("password_ap found, loading settings: value: %S\n", ap_password.c_str());
+  vTaskDelete(nullptr);
+}
+
+void startNetworkTask(bool tryStation) {
+  // same priority as loop(), WiFi itself runs on the other core
+  xTaskCreatePinnedToCore(networkTask, "network", 8192, tryStation ? (void*)1 : nullptr, 1, nullptr, ARDUINO_RUNNING_CORE);
+}
+
+void setup() {
+
+  // no wait for a serial monitor, output before it is attached is lost
+  Serial.begin(57600);
+  bootStage("start");
+
+  // initialize WS28xx LED in GRB order
+  FastLED.addLeds<WS2812B, WS28XX_LED_PIN, GRB>(myWS28XXLED, NUM_LEDS);
+  ledCompositor.setBrightness(6);
+  ledCompositor.setBase(CRGB::Red);
+  startLedTask();
+  bootStage("led");
+
+
+// Set log level
+// test serveral log levels without success something is broken in the library
+// there is no output on the serial monitor with all log levels.
+ //esp_log_level_set("*", ESP_LOG_INFO);
+  log_i("Starting up with Loglevel Info");
+
+  mapPresets();
+  mountMapBanks();
+
+  // Reset only Midi Settings
+  if(digitalRead(10) == LOW && digitalRead(11) == LOW) {
+    Serial.println("Reset Midi settings!");
+    log_d("Reset settings!");
+    resetMapBanks(); // every map reads its defaults
   }
-  
-  if (not prefs.isKey("hostname")) {
-    log_d("hostname not found");
-    prefs.putString("hostname", hostname); // Save the default name
-  } else {
-    hostname = prefs.getString("hostname"); // 
-    log_d("hostname found, loading settings: value: %S\n", hostname.c_str());
+
+  // reset all the settings
+  bool factoryReset = digitalRead(10) == LOW && digitalRead(12) == LOW;
+  if(factoryReset) {
+    //reset settings
+    log_d("Reset settings!");
+    resetMapBanks(); // every map reads its defaults
   }
 
-  if (not prefs.isKey("LedBrightness")) {
-    log_d("LedBrightness not found");
-    prefs.putUInt("LedBrightness", __BRIGHTNESS); // Save the default name
-  } else {
-    Serial.printf("LedBrightness found: %d\n", prefs.getUInt("LedBrightness"));
-    __BRIGHTNESS = prefs.getUInt("LedBrightness"); // 
-    log_d("LedBrightness found, loading settings: value: %d\n", __BRIGHTNESS);
-  } 
-  
-  prefs.end(); // Close NVS namespace "wifi"
-  
-  FastLED.setBrightness(__BRIGHTNESS);
-  FastLED.show();
+  loadDeviceConfig(factoryReset);
+  loadMacros();
+  importNvsMaps();
+  esp_register_shutdown_handler(flushSettings); // ESP.restart() writes pending changes first
 
-  log_d("Testdate from settings: %d \n", myBtnMap[4].btnMidiCC[3]);
+  ledCompositor.setBrightness(__BRIGHTNESS);
 
+  compileActiveMap(); // the other maps are read on demand, the neighbours by loop()
+  __prefetchMap = __active_map;
+  bootStage("config");
 
 
-  // Button uses the built-in pull up register.
-  // The button is connected to GPIO 0.
+
+  // Buttons have external pull up resistors.
   pinMode(myBtnMap[0].btnGpio, INPUT);
   pinMode(myBtnMap[1].btnGpio, INPUT);
   pinMode(myBtnMap[2].btnGpio, INPUT);
@@ -1363,284 +2758,49 @@ void setup() {
 
 
    // Configure the ButtonConfig with the event handler.
-  ButtonConfig* buttonConfig = ButtonConfig::getSystemButtonConfig();
+  ButtonConfig* buttonConfig = &isrButtonConfig;
   buttonConfig->setEventHandler(handleEvent);
+  buttonConfig->setDebounceDelay(0); // edges are debounced with timestamps in the input task
   buttonConfig->setFeature(ButtonConfig::kFeatureDoubleClick);
   buttonConfig->setFeature(ButtonConfig::kFeatureLongPress);
   buttonConfig->setLongPressDelay(1500);
   buttonConfig->setFeature(ButtonConfig::kFeatureRepeatPress);
   buttonConfig->setFeature(ButtonConfig::kFeatureSuppressAfterLongPress); 
 
-  log_d("warte 0.1s");
-  delay(100);
-  //----------------------------------------------------------------
-  if((digitalRead(13) == LOW && digitalRead(14) == LOW) || __DO_UPDATE) {
-    myWS28XXLED[0] = CRGB::Blue;
-    if(__DO_UPDATE) myWS28XXLED[0] = CRGB::Yellow;
-    FastLED.show();
-    log_d("Start Wifi");
-    if(!__DO_UPDATE){
-      __configurator = true;
-      ESPUI.setVerbosity(Verbosity::VerboseJSON);
-    }
-    else
-    {
-      __configurator = false;
-    }
-
-    WiFi.setHostname(hostname.c_str());
-
-    if(digitalRead(12) == HIGH || __DO_UPDATE) {
-      // try to connect to existing network
-      WiFi.begin(ssid.c_str(), password.c_str());
-      log_d("\n\nTry to connect to existing network");
-    }
-
-    {
-        uint8_t timeout = 10;
-
-        // Wait for connection, 5s timeout
-        do
-        {
-            delay(500);
-            log_d(".");
-            timeout--;
-        } while (timeout && WiFi.status() != WL_CONNECTED);
-
-        Serial.printf("Local Ip Address: %s\n", WiFi.localIP().toString().c_str());
-
-        if(WiFi.status() != WL_CONNECTED && __DO_UPDATE){
-          Serial.println("Configure Local network first!");
-        }
-        // not connected -> create hotspot
-        if (WiFi.status() != WL_CONNECTED && !__DO_UPDATE)
-        {
-            log_d("\n\nCreating hotspot");
-
-            WiFi.mode(WIFI_AP);
-            delay(100);
-            WiFi.softAPConfig(apIP, apIP, IPAddress(255, 255, 255, 0));
-
-            char local_ap_ssid[25];
-            char local_ap_password[30];
-            snprintf(local_ap_ssid, 26, "%S-%08X", ap_ssid.c_str(), ESP.getEfuseMac());
-            snprintf(local_ap_password, 31, "%S", ap_password.c_str() );
-            WiFi.softAP(local_ap_ssid, local_ap_password);
-
-            timeout = 5;
-
-            do
-            {
-                delay(500);
-                log_d(".");
-                timeout--;
-            } while (timeout);
-        }
-    }
-
-    if(!__DO_UPDATE){
-
-      dnsServer.start(DNS_PORT, "LittleHelper", apIP);
-
-      log_d("\n\nWiFi parameters:");
-      log_d("Mode: ");
-      log_d("%S\n", WiFi.getMode() == WIFI_AP ? "Station" : "Client");
-      log_d("IP address: ");
-      log_d("%S\n", WiFi.getMode() == WIFI_AP ? WiFi.softAPIP() : WiFi.localIP());
-
-      ESPUI.setVerbosity(Verbosity::Quiet);
-
-      uint16_t tab1 = ESPUI.addControl(ControlType::Tab, "Button 1", "Button 1");
-      uint16_t tab2 = ESPUI.addControl(ControlType::Tab, "Button 2", "Button 2");
-      uint16_t tab3 = ESPUI.addControl(ControlType::Tab, "Button 3", "Button 3");
-      uint16_t tab4 = ESPUI.addControl(ControlType::Tab, "Button 4", "Button 4");
-      uint16_t tab5 = ESPUI.addControl(ControlType::Tab, "Button 5", "Button 5");
-      uint16_t tab6 = ESPUI.addControl(ControlType::Tab, "Active Map", "Active Map");
-      uint16_t tab7 = ESPUI.addControl(ControlType::Tab, "Settings", "Settings");
-
-      // Active Map Chooser
-      char activeMapString[10];
-      sprintf(activeMapString, "%d", __active_map); // Convert the number to a string
-      activeMapChooser = ESPUI.addControl(ControlType::Select, "Active Map:", activeMapString, ControlColor::Emerald, tab6, &selectActiveMap);
-      ESPUI.addControl(ControlType::Option, "Map 1", "0", ControlColor::Dark, activeMapChooser);
-      ESPUI.addControl(ControlType::Option, "Map 2", "1", ControlColor::Dark, activeMapChooser);
-      ESPUI.addControl(ControlType::Option, "Map 3", "2", ControlColor::Dark, activeMapChooser);
-      ESPUI.addControl(ControlType::Option, "Map 4", "3", ControlColor::Dark, activeMapChooser);
-      
-
-      // Wlan Settings and Bluethooth Settings
-
-      bleNameTxtField = ESPUI.addControl(ControlType::Text, "Bluethooth Name:", midiDeviceName.c_str(), ControlColor::Dark, tab7, &textCallBlueThoothName);
-      wlanSsidNameTxtField = ESPUI.addControl(ControlType::Text, "Wlan SSID:", ssid.c_str(), ControlColor::Dark, tab7, &textCallSsidName);
-      wlanPasswordTxtField = ESPUI.addControl(ControlType::Text, "Wlan Password:", password.c_str(), ControlColor::Dark, tab7, &textCallWlanPassword);
-      ESPUI.setInputType(wlanPasswordTxtField, "password");
-      wlanApSsidTxtField = ESPUI.addControl(ControlType::Text, "Access Point SSID:", ap_ssid.c_str(), ControlColor::Dark, tab7, &textCallAPSsidName);
-      wlanApPasswordTxtField = ESPUI.addControl(ControlType::Text, "Access Point Password:", ap_password.c_str(), ControlColor::Dark, tab7, &textCallAPPassword);
-      ESPUI.setInputType(wlanApPasswordTxtField, "password");
-      hostnameTxtField = ESPUI.addControl(ControlType::Text, "Hostname:", hostname.c_str(), ControlColor::Dark, tab7, &textCallHostname);
-      ESPUI.addControl(ControlType::Switcher, "Show Passwords", "", ControlColor::Alizarin, tab7, &switchShowPasswords);
-
-      // OTA Update
-      #ifdef USE_OTA
-      char fwv[3];
-      sprintf(fwv, "s3miniV%d", __FW_VERSION);
-      ESPUI.addControl(ControlType::Label, "Current Firmware", fwv, ControlColor::Alizarin, tab7, &nothing);
-
-      char fwupdatestr[10];
-      if(__UPDATE_FAILURE && __UPDATE_ERROR_CODE == 404){
-        sprintf(fwupdatestr, "No Update foud"); // Convert the number to a string
-      }
-      else if(__UPDATE_FAILURE) sprintf(fwupdatestr, "Update Fail, retry"); // Convert the number to a string
-      else sprintf(fwupdatestr, "Try Update"); // Convert the number to a string
-      ESPUI.addControl(ControlType::Button, "Firmware Update", fwupdatestr, ControlColor::Alizarin, tab7, &otaUpdate);
-      #endif
-
-      // Led Brightness
-      ledBrightnessTxtField = ESPUI.addControl(ControlType::Slider, "LED Brightness:", String(__BRIGHTNESS).c_str(), ControlColor::Dark, tab7, &textCallLedBrightness);
-      ESPUI.addControl(Min, "", "0", None, ledBrightnessTxtField);
-      ESPUI.addControl(Max, "", "255", None, ledBrightnessTxtField);
-
-      // Buttons in a for loop
-      
-      for (size_t hw_B = 0; hw_B < __HW_BUTTONS; hw_B++) // HW Buttons * Ui Button Functions
-      {
-        uint16_t thistab = 0;
-        switch ( hw_B )
-        {
-          case 0:
-            thistab = tab1;
-            break;
-          case 1:
-            thistab = tab2;
-            break;
-          case 2:
-            thistab = tab3;
-            break;
-          case 3:
-            thistab = tab4;
-            break;
-          case 4:
-            thistab = tab5;
-            break;
-          default:
-            break;
-        }
-        //HW Button 1
-        // __selectUiBtn[5][8]
-        // [5] = HW Button 1 -5
-        // [8] = Ui Button 1 - 8
-        __selectUiBtn[hw_B][0] = ESPUI.addControl(ControlType::Select, "Select Map:", "", ControlColor::Emerald, thistab, &selectBtnMapFnc);
-        ESPUI.addControl(ControlType::Option, "Map 1", "0", ControlColor::Dark, __selectUiBtn[hw_B][0]);
-        ESPUI.addControl(ControlType::Option, "Map 2", "1", ControlColor::Dark, __selectUiBtn[hw_B][0]);
-        ESPUI.addControl(ControlType::Option, "Map 3", "2", ControlColor::Dark, __selectUiBtn[hw_B][0]);
-        ESPUI.addControl(ControlType::Option, "Map 4", "3", ControlColor::Dark, __selectUiBtn[hw_B][0]);
-
-        char convertstr[10];
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiChannel[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][1] = ESPUI.addControl(ControlType::Number, "Midi Channel 0 - 15:", convertstr, ControlColor::Dark, thistab, &selectBtnMidiChannelCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][1]);
-        ESPUI.addControl(Max, "", "15", None, __selectUiBtn[hw_B][1]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiFunction[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][2] = ESPUI.addControl(ControlType::Select, "Midi Function:", convertstr, ControlColor::Dark, thistab, &selectBtnMidiFnc);
-        // Button MIDI Function 0 = Note, 1 = CC, 2 = MMC, 3 = Program Change
-        ESPUI.addControl(ControlType::Option, "Note", "0", ControlColor::Dark, __selectUiBtn[hw_B][2]);
-        ESPUI.addControl(ControlType::Option, "CC", "1", ControlColor::Dark, __selectUiBtn[hw_B][2]);
-        ESPUI.addControl(ControlType::Option, "MMC", "2", ControlColor::Dark, __selectUiBtn[hw_B][2]);
-        ESPUI.addControl(ControlType::Option, "PC", "3", ControlColor::Dark, __selectUiBtn[hw_B][2]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiCC[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][3] = ESPUI.addControl(ControlType::Number, "Midi CC 0 - 127:", convertstr, ControlColor::Dark, thistab, &selectBtnMidiCCFunctionCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][3]);
-        ESPUI.addControl(Max, "", "127", None, __selectUiBtn[hw_B][3]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiCCValueStateOn[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][4] = ESPUI.addControl(ControlType::Number, "Midi CC Value On 0 - 127:", convertstr, ControlColor::Dark, thistab, &selectBtnCCValueMaxCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][4]);
-        ESPUI.addControl(Max, "", "127", None, __selectUiBtn[hw_B][4]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiCCValueStateOff[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][5] = ESPUI.addControl(ControlType::Number, "Midi CC Value Off 0 - 127:", convertstr, ControlColor::Dark, thistab, &selectBtnCCValueMinCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][5]);
-        ESPUI.addControl(Max, "", "127", None, __selectUiBtn[hw_B][5]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiNote[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][6] = ESPUI.addControl(ControlType::Number, "Midi Note 0 - 127:", convertstr, ControlColor::Dark, thistab, &selectBtnMidiNoteCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][6]);
-        ESPUI.addControl(Max, "", "127", None, __selectUiBtn[hw_B][6]);
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiMMC[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][7] = ESPUI.addControl(ControlType::Select, "MMC Function:", convertstr, ControlColor::Dark, thistab, &selectBtnMMCFnc);
-        ESPUI.addControl(ControlType::Option, "STOP", "1", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "PLAY", "2", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "DEFERRED PLAY", "3", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "FAST FORWARD", "4", ControlColor::Dark, __selectUiBtn[hw_B][7]);      
-        ESPUI.addControl(ControlType::Option, "REWIND", "5", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "RECORD STROBE", "6", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "RECORD EXIT", "7", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "RECORD PAUSE", "8", ControlColor::Dark, __selectUiBtn[hw_B][7]);
-        ESPUI.addControl(ControlType::Option, "PAUSE", "9", ControlColor::Dark, __selectUiBtn[hw_B][7]);      
-
-        sprintf(convertstr, "%d", myBtnMap[hw_B].btnMidiVelocity[__active_map_ui_btn[hw_B]]); // Convert the number to a string
-        __selectUiBtn[hw_B][8] = ESPUI.addControl(ControlType::Number, "Midi Note Velocity 0 - 127:", convertstr, ControlColor::Dark, thistab, &selectBtnNoteVelocityCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][8]);
-        ESPUI.addControl(Max, "", "127", None, __selectUiBtn[hw_B][8]);
-
-        __selectUiBtn[hw_B][9] = ESPUI.addControl(ControlType::Select, "Button behave: Midi Note only", "", ControlColor::Dark, thistab, &selectBtnBehaveFncCalback);
-        ESPUI.addControl(ControlType::Option, "Push", "0", ControlColor::Dark, __selectUiBtn[hw_B][9]);
-        ESPUI.addControl(ControlType::Option, "Toggle", "1", ControlColor::Dark, __selectUiBtn[hw_B][9]);
-
-        __selectUiBtn[hw_B][10] = ESPUI.addControl(ControlType::Select, "Button Transition: Midi Note excluded", "", ControlColor::Dark, thistab, &selectBtnTransitinCalback);
-        ESPUI.addControl(ControlType::Option, "Push", "0", ControlColor::Dark, __selectUiBtn[hw_B][10]);
-        ESPUI.addControl(ControlType::Option, "Release", "1", ControlColor::Dark, __selectUiBtn[hw_B][10]);
-
-        uint32_t color = myBtnMap[hw_B].btnColor[__active_map_ui_btn[hw_B]];
-        int colorval = 0;
-        for(int i = 0; i < 141; i++) {
-          if(__btnLookUpTable[i] == color) {
-            colorval = i;
-            break;
-          }
-        }
-        sprintf(convertstr, "%d", colorval); // Convert the number to a string  
-        __selectUiBtn[hw_B][11] = ESPUI.addControl(ControlType::Slider, "Button Color:", convertstr, ControlColor::Dark, thistab, &selectBtnColorCalback);
-        ESPUI.addControl(Min, "", "0", None, __selectUiBtn[hw_B][11]);
-        ESPUI.addControl(Max, "", "139", None, __selectUiBtn[hw_B][11]);
-        static char stylecol1[60];
-        sprintf(stylecol1, "border-bottom: #999 3px solid; background-color: #%06X;", color );   
-        ESPUI.setPanelStyle(__selectUiBtn[hw_B][11], stylecol1);
-      
-      }
-      
-      ESPUI.begin("Little Helper Web UI");
-    }
+  // configurator or update mode, the buttons are read now, WiFi starts after BLE
+  bool startNetwork = (digitalRead(13) == LOW && digitalRead(14) == LOW) || __DO_UPDATE;
+  bool tryStation = digitalRead(12) == HIGH || __DO_UPDATE;
+  if(startNetwork) {
+    ledCompositor.setBase(__DO_UPDATE ? CRGB::Yellow : CRGB::Blue);
   }
 
-  __numBlincs = (__active_map + 1) * 2;
+  ledCompositor.setBlinkCount(__active_map + 1);
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   log_i("Starting BLE MIDI server");
+  BLEDevice::setCustomGattsHandler(gattsEventHandler);
   BLEMidiServer.begin(midiDeviceName.c_str());
+  BLEDevice::setMTU(BLE_MIDI_MAX_PACKET + 3); // allow the central to negotiate a larger MTU
   //BLEMidiServer.enableDebugging();
   BLEMidiServer.setOnConnectCallback(connected);
   BLEMidiServer.setOnDisconnectCallback(disconected);
-  // BLEMidiServer.setNoteOnCallback(onNoteOn);
-  // BLEMidiServer.setNoteOffCallback(onNoteOff);
-  // BLEMidiServer.setControlChangeCallback(onControlChange);
-  BLEMidiServer.setProgramChangeCallback(onProgramChange);
+  // no message callbacks, gattsEventHandler queues every incoming message for the input task
+  bootStage("ble");
+
+  startInputTask();
+  bootStage("input");
+  __bootFirstMidiMs = millis();
+  Serial.printf("Boot to first MIDI: %lu ms (config read %u us)\n", (unsigned long)__bootFirstMidiMs, __configLoadUs);
 
+  if(startNetwork) {
+    log_d("Start Wifi");
+    startNetworkTask(tryStation);
+  }
 }
 
 void loop() {
 
-  // Call the button service routine every loop.
-  btn1.check();
-  btn2.check();
-  btn3.check();
-  btn4.check();
-  btn5.check();
-
   static long oldTime = 0;
   if(__configurator) {
     if (millis() - oldTime > 50){ 
@@ -1649,11 +2809,17 @@ void loop() {
     }
   }
 
-  if(__DO_UPDATE) justotaUpdate();
+  persistSettings();
+  prefetchMaps();
+  reportMapSwitch();
+  reportMidiIn();
+
+#ifdef USE_OTA
+  if(__DO_UPDATE && __networkReady) justotaUpdate();
+#endif
 
-  blinkActiveMaps();
+#ifdef USE_LATENCY_STATS
+  latencyReport();
+#endif
   delay(1);
 }
-
-
-
@@ -0,0 +1,126 @@
+/**
+ * @file sim_acebutton.cpp
+ * @brief Host simulator: the AceButton event detection of standins/AceButton.h.
+ */
+
+#include <AceButton.h>
+#include "sim_kernel.h"
+
+namespace ace_button {
+
+static const char* const EVENT_NAMES[] = { "Pressed", "Released", "Clicked", "DoubleClicked", "LongPressed",
+  "RepeatPressed", "LongReleased" };
+
+ButtonConfig* ButtonConfig::getSystemButtonConfig() {
+  static ButtonConfig systemConfig;
+  return &systemConfig;
+}
+
+void AceButton::init(uint8_t pin, uint8_t defaultReleasedState, uint8_t id) {
+  _pin = pin;
+  _releasedState = defaultReleasedState;
+  _id = id;
+  _lastState = kButtonStateUnknown;
+  _debouncing = _pressed = _longPressed = _repeatPressed = _clicked = false;
+}
+
+void AceButton::check() {
+  uint16_t now = (uint16_t)_config->getClock();
+  uint8_t state = (uint8_t)_config->readButton(_pin);
+  if (!debounced(now, state)) return;
+  if (_lastState == kButtonStateUnknown) { // the first reading is no change
+    _lastState = state;
+    return;
+  }
+  if (state != _releasedState) {
+    if (isFeature(ButtonConfig::kFeatureLongPress)) checkLongPress(now);
+    if (isFeature(ButtonConfig::kFeatureRepeatPress)) checkRepeatPress(now);
+  }
+  if (state != _lastState) {
+    _lastState = state;
+    if (state != _releasedState) checkPressed(now);
+    else checkReleased(now);
+  }
+}
+
+// a new level counts once it was read for the debounce delay
+bool AceButton::debounced(uint16_t now, uint8_t state) {
+  if (_config->getDebounceDelay() == 0 || state == _lastState) {
+    _debouncing = false;
+    return true;
+  }
+  if (!_debouncing || state != _debouncingState) {
+    _debouncing = true;
+    _debouncingState = state;
+    _debounceStart = now;
+    return false;
+  }
+  if ((uint16_t)(now - _debounceStart) < _config->getDebounceDelay()) return false;
+  _debouncing = false;
+  return true;
+}
+
+void AceButton::checkLongPress(uint16_t now) {
+  if (!_pressed || _longPressed) return;
+  if ((uint16_t)(now - _pressTime) >= _config->getLongPressDelay()) {
+    _longPressed = true;
+    handleEvent(kEventLongPressed);
+  }
+}
+
+void AceButton::checkRepeatPress(uint16_t now) {
+  if (!_pressed) return;
+  if (!_repeatPressed) {
+    if ((uint16_t)(now - _pressTime) < _config->getRepeatPressDelay()) return;
+    _repeatPressed = true;
+  } else if ((uint16_t)(now - _repeatTime) < _config->getRepeatPressInterval()) {
+    return;
+  }
+  _repeatTime = now;
+  handleEvent(kEventRepeatPressed);
+}
+
+void AceButton::checkPressed(uint16_t now) {
+  _pressed = true;
+  _pressTime = now;
+  handleEvent(kEventPressed);
+}
+
+void AceButton::checkReleased(uint16_t now) {
+  if (isFeature(ButtonConfig::kFeatureClick) || isFeature(ButtonConfig::kFeatureDoubleClick)) checkClicked(now);
+  bool wasLongPressed = _longPressed;
+  bool wasRepeatPressed = _repeatPressed;
+  _pressed = _longPressed = _repeatPressed = false;
+  if (wasLongPressed && isFeature(ButtonConfig::kFeatureSuppressAfterLongPress)) {
+    handleEvent(kEventLongReleased);
+    return;
+  }
+  if (wasRepeatPressed && isFeature(ButtonConfig::kFeatureSuppressAfterRepeatPress)) return;
+  handleEvent(kEventReleased);
+}
+
+// a release within the click delay of the press is a click, a second click within the
+// double click delay of the first a double click
+void AceButton::checkClicked(uint16_t now) {
+  if (!_pressed || (uint16_t)(now - _pressTime) >= _config->getClickDelay()) {
+    _clicked = false;
+    return;
+  }
+  if (isFeature(ButtonConfig::kFeatureDoubleClick) && _clicked
+      && (uint16_t)(now - _clickTime) < _config->getDoubleClickDelay()) {
+    _clicked = false;
+    handleEvent(kEventDoubleClicked);
+    return;
+  }
+  _clicked = true;
+  _clickTime = now;
+  if (isFeature(ButtonConfig::kFeatureClick)) handleEvent(kEventClicked);
+}
+
+void AceButton::handleEvent(uint8_t eventType) {
+  if (__simVerbose) simTrace("button", "%u %s", _pin, EVENT_NAMES[eventType]);
+  ButtonConfig::EventHandler handler = _config->getEventHandler();
+  if (handler != nullptr) handler(this, eventType, _lastState);
+}
+
+} // namespace ace_button
@@ -0,0 +1,180 @@
+/**
+ * @file sim_arduino.cpp
+ * @brief Host simulator: time, GPIO, Serial, log and ESP of the Arduino core stand-in, shutdown handlers.
+ */
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "sim_kernel.h"
+
+#define SIM_PINS 49 // GPIO 0 .. 48 of the ESP32-S3
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ~ time ~
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(simNowUs() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)simNowUs();
+}
+
+void delay(uint32_t ms) {
+  vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+void yield() {
+  vTaskDelay(0);
+}
+
+// ~ GPIO ~
+// the buttons have external pull ups, every pin reads HIGH until the script pulls it low
+
+struct myPinInterrupt {
+  void (*handler)(void*);
+  void* arg;
+  int mode;
+};
+
+static uint8_t __pinLevel[SIM_PINS];
+static myPinInterrupt __pinInterrupt[SIM_PINS];
+static bool __pinsInit = [] {
+  memset(__pinLevel, HIGH, sizeof(__pinLevel));
+  return true;
+}();
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < SIM_PINS ? __pinLevel[pin] : LOW;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+  if (pin < SIM_PINS) __pinInterrupt[pin] = { handler, arg, mode };
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < SIM_PINS) __pinInterrupt[pin] = {};
+}
+
+void simSetPin(uint8_t pin, int level) {
+  if (pin >= SIM_PINS || __pinLevel[pin] == level) return;
+  __pinLevel[pin] = level;
+  const myPinInterrupt& isr = __pinInterrupt[pin];
+  if (isr.handler == nullptr) return;
+  if (isr.mode == CHANGE || (isr.mode == RISING && level == HIGH) || (isr.mode == FALLING && level == LOW)) {
+    isr.handler(isr.arg);
+  }
+}
+
+// ~ log ~
+
+void simLog(char level, const char* format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  size_t len = strlen(line);
+  while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = 0;
+  simTrace("log", "%c %s", level, line);
+}
+
+// ~ Serial ~
+
+static std::string __serialLine;   // printed, up to the next newline
+static std::deque<char> __serialIn; // typed by the script
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  return write((const uint8_t*)buf, (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (c == '\n') {
+    simTrace("serial", "%s", __serialLine.c_str());
+    __serialLine.clear();
+  } else if (c != '\r') {
+    __serialLine += (char)c;
+  }
+  return 1;
+}
+
+int HardwareSerial::available() {
+  return (int)__serialIn.size();
+}
+
+int HardwareSerial::read() {
+  if (__serialIn.empty()) return -1;
+  char c = __serialIn.front();
+  __serialIn.pop_front();
+  return (uint8_t)c;
+}
+
+int HardwareSerial::peek() {
+  return __serialIn.empty() ? -1 : (uint8_t)__serialIn.front();
+}
+
+void simSerialInput(const char* line) {
+  while (*line) __serialIn.push_back(*line++);
+  __serialIn.push_back('\n');
+}
+
+// ~ ESP ~
+// fixed numbers, a trace must not depend on the host
+
+static std::vector<shutdown_handler_t> __shutdownHandlers;
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler) {
+  for (shutdown_handler_t registered : __shutdownHandlers) {
+    if (registered == handler) return ESP_ERR_INVALID_STATE;
+  }
+  __shutdownHandlers.push_back(handler);
+  return ESP_OK;
+}
+
+void simShutdown() {
+  for (auto it = __shutdownHandlers.rbegin(); it != __shutdownHandlers.rend(); ++it) (*it)();
+}
+
+void EspClass::restart() {
+  simShutdown();
+  simTrace("restart", "ESP.restart()");
+  simExit(true);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return 200 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return 180 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return 110 * 1024;
+}
+
+uint64_t EspClass::getEfuseMac() {
+  return 0x0000A1B2C3D4E5F6ULL;
+}
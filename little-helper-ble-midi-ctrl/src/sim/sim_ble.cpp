@@ -0,0 +1,138 @@
+/**
+ * @file sim_ble.cpp
+ * @brief Host simulator: BLEMidiServer and the GATT server events, with the central of the script on the other end.
+ *
+ * @details A notification is sent at the next connection event, the stack confirms it then
+ * (ESP_GATTS_CONF_EVT). The central subscribes to the notifications when it connects, a
+ * write of the notify descriptor, and writes its packets into the MIDI characteristic. The events go to the library callbacks first, then to the custom
+ * GATT handler, in the order of BLEDevice::gattServerEventHandler().
+ */
+
+#include <BLEDevice.h>
+#include <BLEMidi.h>
+#include <string.h>
+#include <vector>
+#include "sim_kernel.h"
+
+#define BLE_DEFAULT_MTU 23
+#define BLE_MIDI_HANDLE 42 // value of the MIDI characteristic, its notify descriptor is the next handle
+
+// 7772E5DB-3868-4112-A1A9-F2669D106BF3 in the byte order of esp_bt_uuid_t
+static const uint8_t BLE_MIDI_UUID[ESP_UUID_LEN_128] = {
+  0xF3, 0x6B, 0x10, 0x9D, 0x66, 0xF2, 0xA9, 0xA1, 0x12, 0x41, 0x68, 0x38, 0xDB, 0xE5, 0x72, 0x77
+};
+
+BLEMidiServerClass BLEMidiServer;
+
+static gatts_event_handler __gattsHandler = nullptr;
+static uint16_t __localMtu = BLE_DEFAULT_MTU;
+static void (*__onConnect)() = nullptr;
+static void (*__onDisconnect)() = nullptr;
+static bool __connected = false;
+static uint32_t __connection = 0; // count of connections, confirmations of an old one are dropped
+static uint64_t __connectedUs = 0;
+static uint32_t __intervalUs = 0;
+
+static void gattsEvent(esp_gatts_cb_event_t event, esp_ble_gatts_cb_param_t& param) {
+  if (__gattsHandler != nullptr) __gattsHandler(event, 0, &param);
+}
+
+void BLEDevice::setCustomGattsHandler(gatts_event_handler handler) {
+  __gattsHandler = handler;
+}
+
+int BLEDevice::setMTU(uint16_t mtu) {
+  __localMtu = mtu;
+  return 0;
+}
+
+uint16_t BLEDevice::getMTU() {
+  return __localMtu;
+}
+
+void BLEMidiServerClass::begin(const std::string& deviceName) {
+  esp_ble_gatts_cb_param_t param = {};
+  param.add_char.attr_handle = BLE_MIDI_HANDLE;
+  param.add_char.char_uuid.len = ESP_UUID_LEN_128;
+  memcpy(param.add_char.char_uuid.uuid.uuid128, BLE_MIDI_UUID, ESP_UUID_LEN_128);
+  gattsEvent(ESP_GATTS_ADD_CHAR_EVT, param);
+  simTrace("ble", "advertising \"%s\"", deviceName.c_str());
+}
+
+bool BLEMidiServerClass::isConnected() {
+  return __connected;
+}
+
+void BLEMidiServerClass::setOnConnectCallback(void (*callback)()) {
+  __onConnect = callback;
+}
+
+void BLEMidiServerClass::setOnDisconnectCallback(void (*callback)()) {
+  __onDisconnect = callback;
+}
+
+void BLEMidiServerClass::sendPacket(uint8_t* packet, uint8_t packetSize) {
+  char hex[3 * 256];
+  size_t len = 0;
+  for (uint8_t i = 0; i < packetSize; i++) len += snprintf(hex + len, sizeof(hex) - len, i ? " %02X" : "%02X", packet[i]);
+  if (!__connected) { // the library drops it
+    simTrace("midi", "%s (not connected)", hex);
+    return;
+  }
+  __simCounts.midiPackets++;
+  __simCounts.midiBytes += packetSize;
+  simTrace("midi", "%s", hex);
+  // confirmed at the next connection event
+  uint64_t sinceConnectUs = simNowUs() - __connectedUs;
+  uint64_t eventUs = __connectedUs + (sinceConnectUs / __intervalUs + 1) * __intervalUs;
+  uint32_t connection = __connection;
+  simAt(eventUs, [connection] {
+    if (!__connected || connection != __connection) return;
+    esp_ble_gatts_cb_param_t param = {};
+    gattsEvent(ESP_GATTS_CONF_EVT, param);
+  });
+}
+
+void simBleConnect(uint32_t intervalUs, uint16_t mtu) {
+  if (__connected) return;
+  __connected = true;
+  __connection++;
+  __connectedUs = simNowUs();
+  __intervalUs = intervalUs / 1250 * 1250; // 1.25 ms units
+  if (__intervalUs == 0) __intervalUs = 7500;
+  if (__onConnect != nullptr) __onConnect();
+  esp_ble_gatts_cb_param_t param = {};
+  param.connect.conn_params.interval = __intervalUs / 1250;
+  param.connect.conn_params.timeout = 400;
+  gattsEvent(ESP_GATTS_CONNECT_EVT, param);
+  if (mtu > BLE_DEFAULT_MTU) {
+    param = {};
+    param.mtu.mtu = mtu < __localMtu ? mtu : __localMtu;
+    gattsEvent(ESP_GATTS_MTU_EVT, param);
+  }
+  uint8_t subscribe[2] = { 0x01, 0x00 };
+  param = {};
+  param.write.handle = BLE_MIDI_HANDLE + 1;
+  param.write.len = sizeof(subscribe);
+  param.write.value = subscribe;
+  gattsEvent(ESP_GATTS_WRITE_EVT, param);
+}
+
+void simBleDisconnect() {
+  if (!__connected) return;
+  __connected = false;
+  if (__onDisconnect != nullptr) __onDisconnect();
+  esp_ble_gatts_cb_param_t param = {};
+  param.disconnect.reason = 0x13; // remote user terminated connection
+  gattsEvent(ESP_GATTS_DISCONNECT_EVT, param);
+}
+
+void simBleWrite(const uint8_t* packet, uint16_t len) {
+  if (!__connected) return;
+  std::vector<uint8_t> value(packet, packet + len);
+  esp_ble_gatts_cb_param_t param = {};
+  param.write.handle = BLE_MIDI_HANDLE;
+  param.write.len = len;
+  param.write.value = value.data();
+  gattsEvent(ESP_GATTS_WRITE_EVT, param);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file sim_flash.cpp
+ * @brief Host simulator: the "banks" and "presets" partitions in RAM with NOR flash semantics.
+ *
+ * @details A script can take a partition away, like on a unit updated over the air from a
+ * firmware with another partition table.
+ */
+
+#include <esp_partition.h>
+#include <string.h>
+#include <vector>
+#include "sim_kernel.h"
+
+// label, subtype, address and size as in configuration/partitions.csv
+static esp_partition_t __banks = { ESP_PARTITION_TYPE_DATA, 0x40, 0x290000, 0x10000, "banks" };
+static esp_partition_t __presets = { ESP_PARTITION_TYPE_DATA, 0x41, 0x2A0000, 0x10000, "presets" };
+static std::vector<uint8_t> __banksMem(0x10000, 0xFF);
+static std::vector<uint8_t> __presetsMem(0x10000, 0xFF);
+
+static std::vector<uint8_t>* memOf(const esp_partition_t* partition) {
+  if (partition == &__banks) return &__banksMem;
+  if (partition == &__presets) return &__presetsMem;
+  return nullptr;
+}
+
+static bool __removed[2]; // banks, presets
+
+bool simRemovePartition(const char* label) {
+  if (strcmp(label, __banks.label) == 0) __removed[0] = true;
+  else if (strcmp(label, __presets.label) == 0) __removed[1] = true;
+  else return false;
+  return true;
+}
+
+void simLoadPresets(const uint8_t* data, size_t len) {
+  memcpy(__presetsMem.data(), data, len < __presetsMem.size() ? len : __presetsMem.size());
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+  const char* label) {
+  for (esp_partition_t* partition : { &__banks, &__presets }) {
+    if (__removed[partition == &__banks ? 0 : 1]) continue;
+    if (type != partition->type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != partition->subtype) continue;
+    if (label != nullptr && strcmp(label, partition->label) != 0) continue;
+    return partition;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+  std::vector<uint8_t>* mem = memOf(partition);
+  if (mem == nullptr || dst == nullptr) return ESP_ERR_INVALID_ARG;
+  if (offset > mem->size() || size > mem->size() - offset) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, mem->data() + offset, size);
+  return ESP_OK;
+}
+
+// NOR flash: a write clears bits, only an erase sets them again
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+  std::vector<uint8_t>* mem = memOf(partition);
+  if (mem == nullptr || src == nullptr) return ESP_ERR_INVALID_ARG;
+  if (offset > mem->size() || size > mem->size() - offset) return ESP_ERR_INVALID_SIZE;
+  const uint8_t* bytes = (const uint8_t*)src;
+  for (size_t i = 0; i < size; i++) (*mem)[offset + i] &= bytes[i];
+  __simCounts.flashWrites++;
+  char blob[48];
+  simFormatBlob(blob, sizeof(blob), src, size);
+  simTrace("flash", "write %s +0x%05zX %s", partition->label, offset, blob);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  std::vector<uint8_t>* mem = memOf(partition);
+  if (mem == nullptr) return ESP_ERR_INVALID_ARG;
+  if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_SIZE;
+  if (offset > mem->size() || size > mem->size() - offset) return ESP_ERR_INVALID_SIZE;
+  memset(mem->data() + offset, 0xFF, size);
+  simTrace("flash", "erase %s +0x%05zX %zu bytes", partition->label, offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+  spi_flash_mmap_memory_t memory, const void** out, spi_flash_mmap_handle_t* handle) {
+  (void)memory;
+  std::vector<uint8_t>* mem = memOf(partition);
+  if (mem == nullptr || out == nullptr) return ESP_ERR_INVALID_ARG;
+  if (offset > mem->size() || size > mem->size() - offset) return ESP_ERR_INVALID_SIZE;
+  *out = mem->data() + offset;
+  if (handle != nullptr) *handle = 1;
+  return ESP_OK;
+}
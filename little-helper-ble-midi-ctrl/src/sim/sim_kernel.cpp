@@ -0,0 +1,394 @@
+/**
+ * @file sim_kernel.cpp
+ * @brief Host simulator: virtual clock, FreeRTOS tasks on threads, esp_timer and the trace.
+ *
+ * @details One mutex guards the kernel state, the task that runs holds the baton
+ * (__current). A task that blocks picks the next one and waits on its own condition
+ * variable until it is picked again. The firmware code itself runs outside of the mutex,
+ * but never two tasks at a time.
+ */
+
+#include <stdarg.h>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "sim_kernel.h"
+
+#define SIM_TICK_US 1000 // 1 ms FreeRTOS tick
+
+mySimCounts __simCounts = {};
+bool __simVerbose = false;
+
+// ~ tasks ~
+
+struct mySimTask {
+  const char* name;
+  TaskFunction_t fn;
+  void* arg;
+  UBaseType_t priority;
+  std::condition_variable wake;
+  bool ready = true;
+  bool deleted = false;
+  uint64_t readySeq = 0;   // FIFO among the ready tasks of one priority
+  uint64_t wakeUs = SIM_NEVER;
+  bool waitsForNotify = false;
+  uint32_t notifyValue = 0;
+};
+
+struct mySimMutex {
+  mySimTask* owner = nullptr;
+  uint32_t depth = 0;
+  std::vector<mySimTask*> waiters;
+};
+
+struct mySimCallback {
+  uint64_t atUs;
+  uint64_t seq;
+  std::function<void()> fn;
+  bool operator>(const mySimCallback& other) const {
+    return atUs != other.atUs ? atUs > other.atUs : seq > other.seq;
+  }
+};
+
+static std::mutex __kernelLock;
+static std::vector<mySimTask*> __tasks; // in creation order
+static mySimTask* __current = nullptr;
+static uint64_t __nowUs = 0;
+static uint64_t __seq = 0;
+static bool __inCallback = false;
+static std::priority_queue<mySimCallback, std::vector<mySimCallback>, std::greater<mySimCallback>> __callbacks;
+
+uint64_t simNowUs() {
+  return __nowUs;
+}
+
+bool simInCallback() {
+  return __inCallback;
+}
+
+void simAt(uint64_t atUs, std::function<void()> fn) {
+  __callbacks.push({ atUs < __nowUs ? __nowUs : atUs, ++__seq, std::move(fn) });
+}
+
+static void makeReady(mySimTask* task) {
+  task->ready = true;
+  task->readySeq = ++__seq;
+  task->wakeUs = SIM_NEVER;
+  task->waitsForNotify = false;
+}
+
+// the ready task of highest priority, the one ready longest first
+static mySimTask* pickReady() {
+  mySimTask* best = nullptr;
+  for (mySimTask* task : __tasks) {
+    if (!task->ready || task->deleted) continue;
+    if (best == nullptr || task->priority > best->priority
+        || (task->priority == best->priority && task->readySeq < best->readySeq)) {
+      best = task;
+    }
+  }
+  return best;
+}
+
+// hand the baton from the running task to next, returns when self runs again
+static void switchTo(mySimTask* self, mySimTask* next) {
+  if (next == self) return;
+  __simCounts.switches++;
+  std::unique_lock<std::mutex> lock(__kernelLock);
+  __current = next;
+  next->wake.notify_one();
+  self->wake.wait(lock, [self] { return __current == self; });
+}
+
+// the running task blocked or yields: run the next ready task, while there is none the
+// clock jumps to the next wake up or callback
+static void schedule() {
+  mySimTask* self = __current;
+  for (;;) {
+    mySimTask* next = pickReady();
+    if (next != nullptr) {
+      switchTo(self, next);
+      return;
+    }
+    uint64_t nextUs = __callbacks.empty() ? SIM_NEVER : __callbacks.top().atUs;
+    for (mySimTask* task : __tasks) {
+      if (!task->deleted && task->wakeUs < nextUs) nextUs = task->wakeUs;
+    }
+    if (nextUs == SIM_NEVER) {
+      fprintf(stderr, "sim: every task waits forever and nothing is scheduled\n");
+      simExit(false);
+    }
+    if (nextUs > __nowUs) __nowUs = nextUs;
+    while (!__callbacks.empty() && __callbacks.top().atUs <= __nowUs) {
+      std::function<void()> fn = __callbacks.top().fn;
+      __callbacks.pop();
+      __inCallback = true;
+      fn();
+      __inCallback = false;
+    }
+    for (mySimTask* task : __tasks) {
+      if (!task->ready && !task->deleted && task->wakeUs <= __nowUs) makeReady(task);
+    }
+  }
+}
+
+// block the running task until wakeUs or a notify / mutex give makes it ready
+static void block(uint64_t wakeUs) {
+  __current->ready = false;
+  __current->wakeUs = wakeUs;
+  schedule();
+}
+
+// after a task was made ready: run it now if it has a higher priority than the running task
+static void preemptIfHigher() {
+  if (__inCallback) return;
+  mySimTask* next = pickReady();
+  if (next != nullptr && next->priority > __current->priority) switchTo(__current, next);
+}
+
+static uint64_t deadline(TickType_t ticks) {
+  return ticks == portMAX_DELAY ? SIM_NEVER : __nowUs + (uint64_t)ticks * SIM_TICK_US;
+}
+
+static void taskMain(mySimTask* task) {
+  {
+    std::unique_lock<std::mutex> lock(__kernelLock);
+    task->wake.wait(lock, [task] { return __current == task; });
+  }
+  task->fn(task->arg);
+  vTaskDelete(nullptr); // a FreeRTOS task must not return, it would abort on the device
+}
+
+void simKernelStart() {
+  mySimTask* loopTask = new mySimTask();
+  loopTask->name = "loopTask";
+  loopTask->priority = 1; // Arduino-ESP32 loopTask
+  loopTask->readySeq = ++__seq;
+  __tasks.push_back(loopTask);
+  __current = loopTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg,
+  UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  (void)stackSize;
+  (void)core;
+  mySimTask* task = new mySimTask();
+  task->name = name;
+  task->fn = fn;
+  task->arg = arg;
+  task->priority = priority;
+  task->readySeq = ++__seq;
+  __tasks.push_back(task);
+  if (handle != nullptr) *handle = task;
+  std::thread(taskMain, task).detach();
+  preemptIfHigher();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackSize, void* arg, UBaseType_t priority,
+  TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackSize, arg, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+  mySimTask* task = handle ? (mySimTask*)handle : __current;
+  task->deleted = true;
+  task->ready = false;
+  if (task == __current) schedule(); // never returns, a deleted task is not picked again
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == 0) {
+    __current->readySeq = ++__seq; // yield to the ready tasks of the same priority
+    schedule();
+    return;
+  }
+  block(deadline(ticks));
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+  uint64_t wakeUs = (uint64_t)(*previousWake + increment) * SIM_TICK_US;
+  *previousWake += increment;
+  if (wakeUs > __nowUs) block(wakeUs);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(__nowUs / SIM_TICK_US);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return __current;
+}
+
+void xTaskNotifyGive(TaskHandle_t handle) {
+  mySimTask* task = (mySimTask*)handle;
+  task->notifyValue++;
+  if (task->waitsForNotify) makeReady(task);
+  preemptIfHigher();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t* higherPriorityTaskWoken) {
+  mySimTask* task = (mySimTask*)handle;
+  task->notifyValue++;
+  if (!task->waitsForNotify) return;
+  makeReady(task);
+  if (higherPriorityTaskWoken != nullptr && task->priority > __current->priority) *higherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  mySimTask* self = __current;
+  if (self->notifyValue == 0 && ticks != 0) {
+    self->waitsForNotify = true;
+    block(deadline(ticks));
+    self->waitsForNotify = false;
+  }
+  uint32_t value = self->notifyValue;
+  if (value) self->notifyValue = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new mySimMutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t handle, TickType_t ticks) {
+  mySimMutex* mutex = (mySimMutex*)handle;
+  mySimTask* self = __current;
+  if (__inCallback) {
+    fprintf(stderr, "sim: mutex taken outside of a task\n");
+    simExit(false);
+  }
+  uint64_t until = deadline(ticks);
+  while (mutex->owner != nullptr && mutex->owner != self) {
+    if (__nowUs >= until) return pdFALSE;
+    mutex->waiters.push_back(self);
+    block(until);
+    for (size_t i = 0; i < mutex->waiters.size(); i++) {
+      if (mutex->waiters[i] == self) mutex->waiters.erase(mutex->waiters.begin() + i);
+    }
+  }
+  mutex->owner = self;
+  mutex->depth++;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t handle) {
+  mySimMutex* mutex = (mySimMutex*)handle;
+  if (mutex->owner != __current) return pdFALSE;
+  if (--mutex->depth) return pdTRUE;
+  mutex->owner = nullptr;
+  // the waiter of highest priority takes it next
+  mySimTask* next = nullptr;
+  for (mySimTask* waiter : mutex->waiters) {
+    if (next == nullptr || waiter->priority > next->priority) next = waiter;
+  }
+  if (next != nullptr) {
+    makeReady(next);
+    preemptIfHigher();
+  }
+  return pdTRUE;
+}
+
+// ~ esp_timer ~
+// the callbacks run as timed callbacks, dispatched like ESP_TIMER_TASK without a task of its own
+
+struct simTimer {
+  esp_timer_cb_t callback;
+  void* arg;
+  uint64_t periodUs;
+  uint32_t generation; // a stop or restart makes the armed callback stale
+  bool running;
+};
+
+static void armTimer(simTimer* timer, uint64_t atUs) {
+  uint32_t generation = timer->generation;
+  simAt(atUs, [timer, generation, atUs] {
+    if (!timer->running || timer->generation != generation) return;
+    if (timer->periodUs) armTimer(timer, atUs + timer->periodUs);
+    else timer->running = false;
+    timer->callback(timer->arg);
+  });
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)__nowUs;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  if (args == nullptr || args->callback == nullptr || handle == nullptr) return ESP_ERR_INVALID_ARG;
+  *handle = new simTimer{ args->callback, args->arg, 0, 0, false };
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+  if (timer->running) return ESP_ERR_INVALID_STATE;
+  timer->running = true;
+  timer->periodUs = 0;
+  timer->generation++;
+  armTimer(timer, __nowUs + timeoutUs);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+  if (timer->running) return ESP_ERR_INVALID_STATE;
+  if (periodUs == 0) return ESP_ERR_INVALID_ARG;
+  timer->running = true;
+  timer->periodUs = periodUs;
+  timer->generation++;
+  armTimer(timer, __nowUs + periodUs);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer->running) return ESP_ERR_INVALID_STATE;
+  timer->running = false;
+  timer->generation++;
+  return ESP_OK;
+}
+
+// ~ trace ~
+
+static FILE* __trace = stdout;
+static std::vector<std::string> __traceLines; // for simTraceContains()
+
+void simTraceOpen(FILE* file) {
+  __trace = file;
+}
+
+void simTrace(const char* kind, const char* format, ...) {
+  char line[512];
+  int len = snprintf(line, sizeof(line), "%6llu.%03u %-6s ", (unsigned long long)(__nowUs / 1000),
+    (unsigned)(__nowUs % 1000), kind);
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line + len, sizeof(line) - len, format, args);
+  va_end(args);
+  fprintf(__trace, "%s\n", line);
+  __traceLines.push_back(line);
+}
+
+bool simTraceContains(const char* text) {
+  for (const std::string& line : __traceLines) {
+    if (line.find(text) != std::string::npos) return true;
+  }
+  return false;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+void simFormatBlob(char* str, size_t size, const void* data, size_t len) {
+  snprintf(str, size, "%zu bytes crc32 %08X", len, crc32((const uint8_t*)data, len));
+}
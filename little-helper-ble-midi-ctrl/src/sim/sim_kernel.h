@@ -0,0 +1,79 @@
+/**
+ * @file sim_kernel.h
+ * @brief Host simulator (env:sim): virtual clock, FreeRTOS tasks on threads, timed callbacks and the trace.
+ *
+ * @details Every firmware task is a thread, but only one of them runs at a time. A task runs
+ * until it blocks (vTaskDelay, ulTaskNotifyTake, a taken mutex) or wakes a task of higher
+ * priority, then the kernel hands over to the ready task of highest priority, the one that is
+ * ready longest first. When every task is blocked the clock jumps to the next wake up or timed
+ * callback. The firmware runs in zero virtual time, a run does not depend on the host and two
+ * runs of the same script write the same trace.
+ *
+ * Timed callbacks (simAt()) stand for everything that is not a firmware task: GPIO edges of
+ * the script, writes of the BLE central, notify confirmations, esp_timer. They run between two
+ * tasks, like an ISR or a task of higher priority than the firmware's, and must not block.
+ */
+
+#ifndef SIM_KERNEL_H
+#define SIM_KERNEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+
+#define SIM_NEVER UINT64_MAX
+
+// virtual time since boot
+uint64_t simNowUs();
+
+// run fn at atUs (not before now), callbacks of the same time run in the order they were added
+void simAt(uint64_t atUs, std::function<void()> fn);
+
+// true while a timed callback runs, FreeRTOS calls do not switch tasks then
+bool simInCallback();
+
+// the main thread becomes the Arduino loop task, call once before setup()
+void simKernelStart();
+
+// ~ trace ~
+// one line per output: "<ms since boot> <kind> <text>", written to the trace file
+void simTraceOpen(FILE* file);
+void simTrace(const char* kind, const char* format, ...) __attribute__((format(printf, 2, 3)));
+// "<bytes> bytes crc32 <crc>" of a written blob, the trace of NVS and flash writes
+void simFormatBlob(char* str, size_t size, const void* data, size_t len);
+// true if a line of the trace so far has text in it, the expectations of a script
+bool simTraceContains(const char* text);
+
+// ~ stand-in hooks ~
+// the script changes a pin, an attached interrupt runs if the level changed
+void simSetPin(uint8_t pin, int level);
+// a line typed into the serial monitor
+void simSerialInput(const char* line);
+// a central connects, disconnects or writes a BLE-MIDI packet
+void simBleConnect(uint32_t intervalUs, uint16_t mtu);
+void simBleDisconnect();
+void simBleWrite(const uint8_t* packet, uint16_t len);
+// the contents of the "presets" partition, before setup()
+void simLoadPresets(const uint8_t* data, size_t len);
+// a partition of configuration/partitions.csv the device does not have, before setup()
+bool simRemovePartition(const char* label);
+// a blob already in NVS, before setup()
+void simNvsPutBlob(const char* space, const char* key, const uint8_t* data, size_t len);
+// the handlers of esp_register_shutdown_handler(), ESP.restart() calls them before the end
+void simShutdown();
+// print the counts of the run, flush the trace and exit, the device is off
+[[noreturn]] void simExit(bool restart);
+
+// ~ counters of the run, for the summary ~
+struct mySimCounts {
+  uint32_t midiPackets;
+  uint32_t midiBytes;
+  uint32_t ledFrames;
+  uint32_t nvsWrites;
+  uint32_t flashWrites;
+  uint32_t switches; // task switches
+};
+extern mySimCounts __simCounts;
+extern bool __simVerbose; // the AceButton events into the trace (-v)
+
+#endif // SIM_KERNEL_H
@@ -0,0 +1,15 @@
+/**
+ * @file sim_led.cpp
+ * @brief Host simulator: FastLED.show() writes the frame of the status LED into the trace.
+ */
+
+#include <FastLED.h>
+#include "sim_kernel.h"
+
+CFastLED FastLED;
+
+void CFastLED::show() {
+  if (_leds == nullptr || _numLeds < 1) return;
+  __simCounts.ledFrames++;
+  simTrace("led", "#%02X%02X%02X %u", _leds[0].r, _leds[0].g, _leds[0].b, _brightness);
+}
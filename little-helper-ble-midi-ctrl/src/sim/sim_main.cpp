@@ -0,0 +1,313 @@
+/**
+ * @file sim_main.cpp
+ * @brief Host simulator (env:sim): runs src/main.cpp on Linux against a script of button edges and incoming MIDI.
+ *
+ * @details Usage: sim [-o trace.txt] [--presets presets.bin] [-v] script.txt|-
+ *
+ * The script has one event per line, '#' starts a comment:
+ *
+ *   <time> press <button>              button 1 .. 5 pressed, its GPIO goes low
+ *   <time> release <button>
+ *   <time> tap <button> [ms]           press, release after ms (100)
+ *   <time> connect [interval ms] [mtu] a central connects (7.5 ms, no MTU exchange)
+ *   <time> disconnect
+ *   <time> midi <hex bytes>            one message from the central in a BLE-MIDI packet of its own
+ *   <time> packet <hex bytes>          a raw BLE-MIDI packet written by the central
+ *   <time> serial <text>               a line typed into the serial monitor
+ *   <time> expect <text>               a line of the trace up to now has the text in it
+ *   <time> expect-no <text>            no line of the trace up to now has the text in it
+ *   <time> end                         the end of the run (default 3 s after the last event)
+ *   0 no-partition <label>             the device has no such partition
+ *   0 nvs <namespace>/<key> <hex>      a blob the device has in NVS
+ *
+ * <time> is in ms since boot with up to 3 decimals, or +ms after the event before. A button
+ * pressed at time 0 is held at power on, setup() reads it. The trace has one line per
+ * output: MIDI packets as notified, LED frames, NVS puts, flash writes, serial lines and the
+ * input events, each with the virtual time in ms. The run ends with a summary on stderr, an
+ * expectation that failed is printed there too and the exit code is 1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include "button_config.h"
+#include "sim_kernel.h"
+
+#define SIM_TAIL_MS 3000     // the run goes on this long after the last event
+#define SIM_TAP_MS 100
+#define SIM_INTERVAL_MS 7.5  // connection interval of the central
+#define SIM_MAX_PACKET 512
+
+void setup();
+void loop();
+extern myButton myBtnMap[5];
+
+static std::chrono::steady_clock::time_point __wallStart;
+static FILE* __traceFile = stdout;
+static const char* __scriptPath = "";
+static uint32_t __expectations = 0;
+static uint32_t __failed = 0; // expectations
+
+void simExit(bool restart) {
+  fflush(__traceFile);
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - __wallStart).count();
+  double simS = simNowUs() / 1e6;
+  fprintf(stderr, "sim: %.3f s%s in %.3f s wall (%.0fx), %u MIDI packets (%u bytes), %u LED frames, "
+    "%u NVS writes, %u flash writes, %u task switches\n", simS, restart ? " up to ESP.restart()" : "", wallS,
+    wallS > 0 ? simS / wallS : 0.0, __simCounts.midiPackets, __simCounts.midiBytes, __simCounts.ledFrames,
+    __simCounts.nvsWrites, __simCounts.flashWrites, __simCounts.switches);
+  if (__expectations) fprintf(stderr, "sim: %u of %u expectations failed\n", __failed, __expectations);
+  fflush(stderr);
+  std::_Exit(__failed ? 1 : 0); // the task threads wait for the baton forever, nothing to join
+}
+
+// ~ script ~
+
+struct myScriptError {
+  int line;
+  std::string text;
+};
+
+static std::vector<std::string> split(const std::string& line) {
+  std::vector<std::string> words;
+  size_t pos = 0;
+  while ((pos = line.find_first_not_of(" \t\r\n", pos)) != std::string::npos) {
+    size_t end = line.find_first_of(" \t\r\n", pos);
+    words.push_back(line.substr(pos, end - pos));
+    pos = end;
+  }
+  return words;
+}
+
+static bool parseNumber(const std::string& str, double& value) {
+  char* end = nullptr;
+  value = strtod(str.c_str(), &end);
+  return !str.empty() && *end == 0 && value >= 0;
+}
+
+// hex bytes, "B0 2D 7F" or "B02D7F"
+static bool parseHex(const std::vector<std::string>& words, size_t first, std::vector<uint8_t>& bytes) {
+  for (size_t w = first; w < words.size(); w++) {
+    const std::string& word = words[w];
+    if (word.size() % 2) return false;
+    for (size_t i = 0; i < word.size(); i += 2) {
+      char* end = nullptr;
+      std::string pair = word.substr(i, 2);
+      long value = strtol(pair.c_str(), &end, 16);
+      if (*end != 0) return false;
+      bytes.push_back((uint8_t)value);
+    }
+  }
+  return !bytes.empty() && bytes.size() <= SIM_MAX_PACKET;
+}
+
+static std::string hexOf(const std::vector<uint8_t>& bytes) {
+  std::string str;
+  char hex[4];
+  for (size_t i = 0; i < bytes.size(); i++) {
+    snprintf(hex, sizeof(hex), i ? " %02X" : "%02X", bytes[i]);
+    str += hex;
+  }
+  return str;
+}
+
+// one message in a BLE-MIDI packet of its own, timestamped with the time it is written
+static std::vector<uint8_t> blePacket(const std::vector<uint8_t>& message) {
+  uint16_t timestamp = (uint16_t)((simNowUs() / 1000) & 0x1FFF);
+  uint8_t header = 0x80 | (timestamp >> 7);
+  uint8_t stamp = 0x80 | (timestamp & 0x7F);
+  std::vector<uint8_t> packet = { header, stamp };
+  packet.insert(packet.end(), message.begin(), message.end());
+  if (message.size() > 1 && message.front() == 0xF0 && message.back() == 0xF7) {
+    packet.insert(packet.end() - 1, stamp); // the end of a SysEx has a timestamp of its own
+  }
+  return packet;
+}
+
+static uint8_t buttonPin(const std::vector<std::string>& words, int line) {
+  long button = words.size() > 2 ? strtol(words[2].c_str(), nullptr, 10) : 0;
+  if (button < 1 || button > 5) throw myScriptError{ line, "button 1 .. 5 expected" };
+  return myBtnMap[button - 1].btnGpio;
+}
+
+static void pinEvent(uint64_t atUs, uint8_t pin, int level, const std::string& name) {
+  simAt(atUs, [pin, level, name] {
+    simTrace("in", "%s", name.c_str());
+    simSetPin(pin, level);
+  });
+}
+
+// schedule the events of the script, presses at time 0 are applied at once, returns the end of the run
+static uint64_t loadScript(FILE* file) {
+  char buf[1024];
+  int line = 0;
+  uint64_t lastUs = 0;   // time of the event before, for +ms
+  uint64_t latestUs = 0; // the last thing that happens, a release of a tap included
+  uint64_t endUs = SIM_NEVER;
+  while (fgets(buf, sizeof(buf), file)) {
+    line++;
+    std::string text = buf;
+    size_t comment = text.find('#');
+    if (comment != std::string::npos) text.erase(comment);
+    std::vector<std::string> words = split(text);
+    if (words.empty()) continue;
+    if (words.size() < 2) throw myScriptError{ line, "<time> <event> expected" };
+
+    bool relative = words[0][0] == '+';
+    double ms;
+    if (!parseNumber(words[0].substr(relative ? 1 : 0), ms)) throw myScriptError{ line, "time in ms expected" };
+    uint64_t atUs = (relative ? lastUs : 0) + (uint64_t)(ms * 1000 + 0.5);
+    if (atUs < lastUs) throw myScriptError{ line, "time goes back" };
+    lastUs = atUs;
+    if (atUs > latestUs) latestUs = atUs;
+    std::string event = words[1];
+    std::string name = text.substr(text.find(event, text.find(words[0]) + words[0].size()));
+    while (!name.empty() && (name.back() == '\n' || name.back() == '\r' || name.back() == ' ')) name.pop_back();
+
+    if (event == "press" || event == "release") {
+      uint8_t pin = buttonPin(words, line);
+      int level = event == "press" ? LOW : HIGH;
+      if (atUs == 0 && level == LOW) {
+        simTrace("in", "%s (held at power on)", name.c_str());
+        simSetPin(pin, LOW);
+      } else {
+        pinEvent(atUs, pin, level, name);
+      }
+    } else if (event == "tap") {
+      uint8_t pin = buttonPin(words, line);
+      double holdMs = SIM_TAP_MS;
+      if (words.size() > 3 && !parseNumber(words[3], holdMs)) throw myScriptError{ line, "tap length in ms expected" };
+      uint64_t releaseUs = atUs + (uint64_t)(holdMs * 1000 + 0.5);
+      pinEvent(atUs, pin, LOW, "press " + words[2]);
+      pinEvent(releaseUs, pin, HIGH, "release " + words[2]);
+      if (releaseUs > latestUs) latestUs = releaseUs;
+    } else if (event == "connect") {
+      double intervalMs = SIM_INTERVAL_MS, mtu = 23;
+      if (words.size() > 2 && !parseNumber(words[2], intervalMs)) throw myScriptError{ line, "interval in ms expected" };
+      if (words.size() > 3 && !parseNumber(words[3], mtu)) throw myScriptError{ line, "MTU expected" };
+      uint32_t intervalUs = (uint32_t)(intervalMs * 1000 + 0.5);
+      simAt(atUs, [name, intervalUs, mtu] {
+        simTrace("in", "%s", name.c_str());
+        simBleConnect(intervalUs, (uint16_t)mtu);
+      });
+    } else if (event == "disconnect") {
+      simAt(atUs, [name] {
+        simTrace("in", "%s", name.c_str());
+        simBleDisconnect();
+      });
+    } else if (event == "midi" || event == "packet") {
+      std::vector<uint8_t> bytes;
+      if (!parseHex(words, 2, bytes)) throw myScriptError{ line, "hex bytes expected" };
+      bool raw = event == "packet";
+      if (!raw && !(bytes[0] & 0x80)) throw myScriptError{ line, "a MIDI message starts with a status byte" };
+      simAt(atUs, [bytes, raw] {
+        std::vector<uint8_t> packet = raw ? bytes : blePacket(bytes);
+        simTrace("in", "%s %s", raw ? "packet" : "midi", hexOf(packet).c_str());
+        simBleWrite(packet.data(), (uint16_t)packet.size());
+      });
+    } else if (event == "serial") {
+      std::string input = name.size() > 7 ? name.substr(7) : std::string();
+      simAt(atUs, [input] {
+        simTrace("in", "serial %s", input.c_str());
+        simSerialInput(input.c_str());
+      });
+    } else if (event == "expect" || event == "expect-no") {
+      bool present = event == "expect";
+      std::string expected = name.substr(event.size());
+      expected.erase(0, expected.find_first_not_of(' '));
+      if (expected.empty()) throw myScriptError{ line, "text expected" };
+      __expectations++;
+      simAt(atUs, [line, present, expected] {
+        if (simTraceContains(expected.c_str()) == present) return;
+        __failed++;
+        fprintf(stderr, "%s:%d: %s \"%s\" in the trace at %.3f ms\n", __scriptPath, line,
+          present ? "no" : "unexpected", expected.c_str(), simNowUs() / 1000.0);
+      });
+    } else if (event == "no-partition") {
+      if (atUs != 0) throw myScriptError{ line, "no-partition at time 0 only" };
+      if (words.size() != 3 || !simRemovePartition(words[2].c_str())) throw myScriptError{ line, "banks or presets expected" };
+      simTrace("in", "%s", name.c_str());
+    } else if (event == "nvs") {
+      if (atUs != 0) throw myScriptError{ line, "nvs at time 0 only" };
+      size_t slash = words.size() > 2 ? words[2].find('/') : std::string::npos;
+      if (slash == std::string::npos) throw myScriptError{ line, "<namespace>/<key> expected" };
+      std::vector<uint8_t> bytes;
+      if (!parseHex(words, 3, bytes)) throw myScriptError{ line, "hex bytes expected" };
+      simNvsPutBlob(words[2].substr(0, slash).c_str(), words[2].substr(slash + 1).c_str(), bytes.data(), bytes.size());
+      simTrace("in", "nvs %s %s", words[2].c_str(), hexOf(bytes).c_str());
+    } else if (event == "end") {
+      endUs = atUs;
+      break;
+    } else {
+      throw myScriptError{ line, "unknown event \"" + event + "\"" };
+    }
+  }
+  return endUs != SIM_NEVER ? endUs : latestUs + SIM_TAIL_MS * 1000ull;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: sim [-o trace.txt] [--presets presets.bin] [-v] script.txt|-\n");
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  const char* scriptPath = nullptr;
+  const char* tracePath = nullptr;
+  const char* presetsPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) tracePath = argv[++i];
+    else if (strcmp(argv[i], "--presets") == 0 && i + 1 < argc) presetsPath = argv[++i];
+    else if (strcmp(argv[i], "-v") == 0) __simVerbose = true;
+    else if (scriptPath == nullptr && (argv[i][0] != '-' || argv[i][1] == 0)) scriptPath = argv[i];
+    else usage();
+  }
+  if (scriptPath == nullptr) usage();
+
+  if (tracePath != nullptr) {
+    __traceFile = fopen(tracePath, "w");
+    if (__traceFile == nullptr) {
+      perror(tracePath);
+      return 1;
+    }
+  }
+  simTraceOpen(__traceFile);
+
+  if (presetsPath != nullptr) {
+    FILE* file = fopen(presetsPath, "rb");
+    if (file == nullptr) {
+      perror(presetsPath);
+      return 1;
+    }
+    std::vector<uint8_t> image(0x10000);
+    size_t len = fread(image.data(), 1, image.size(), file);
+    fclose(file);
+    simLoadPresets(image.data(), len);
+  }
+
+  __scriptPath = scriptPath;
+  FILE* script = strcmp(scriptPath, "-") == 0 ? stdin : fopen(scriptPath, "r");
+  if (script == nullptr) {
+    perror(scriptPath);
+    return 1;
+  }
+  simKernelStart();
+  uint64_t endUs;
+  try {
+    endUs = loadScript(script);
+  } catch (const myScriptError& error) {
+    fprintf(stderr, "%s:%d: %s\n", scriptPath, error.line, error.text.c_str());
+    return 2;
+  }
+  if (script != stdin) fclose(script);
+  simAt(endUs, [] { simExit(false); });
+
+  // the Arduino loop task
+  __wallStart = std::chrono::steady_clock::now();
+  setup();
+  for (;;) loop();
+}
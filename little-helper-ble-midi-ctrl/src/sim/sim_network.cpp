@@ -0,0 +1,71 @@
+/**
+ * @file sim_network.cpp
+ * @brief Host simulator: WiFi and ESPUI of the configurator, the hotspot and the web UI start go into the trace.
+ */
+
+#include <ESPUI.h>
+#include <WiFi.h>
+#include "sim_kernel.h"
+
+WiFiClass WiFi;
+ESPUIClass ESPUI;
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+  (void)password;
+  _mode = WIFI_STA;
+  _status = WL_DISCONNECTED; // no access point in range
+  simTrace("wifi", "station \"%s\", no access point", ssid);
+  return _status;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+  _status = WL_DISCONNECTED;
+  if (wifiOff) _mode = WIFI_OFF;
+  return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  _mode = mode;
+  return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet) {
+  (void)gateway;
+  (void)subnet;
+  _apIP = local;
+  return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* password) {
+  (void)password;
+  simTrace("wifi", "hotspot \"%s\" %s", ssid, _apIP.toString().c_str());
+  return true;
+}
+
+uint16_t ESPUIClass::addControl(ControlType type, const char* label, const String& value, ControlColor color,
+  uint16_t parentControl, Callback callback) {
+  (void)type;
+  (void)label;
+  (void)value;
+  (void)color;
+  (void)parentControl;
+  (void)callback;
+  return _controls++;
+}
+
+void ESPUIClass::updateControlValue(uint16_t id, const String& value, int clientId) {
+  (void)id;
+  (void)value;
+  (void)clientId;
+}
+
+void ESPUIClass::updateControlValue(Control* control, const String& value, int clientId) {
+  if (control != nullptr) control->value = value;
+  (void)clientId;
+}
+
+void ESPUIClass::begin(const char* title, const char* username, const char* password, uint16_t port) {
+  (void)username;
+  (void)password;
+  simTrace("webui", "\"%s\" with %u controls on port %u", title, _controls, port);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file sim_nvs.cpp
+ * @brief Host simulator: Preferences on an NVS in RAM, every write is a line of the trace.
+ */
+
+#include <map>
+#include <string>
+#include <Preferences.h>
+#include "sim_kernel.h"
+
+#define NVS_KEY_MAX_LEN 15 // NVS_KEY_NAME_MAX_SIZE - 1, for keys and namespaces
+
+struct myNvsValue {
+  char type; // 'b' bool, 'i' int32, 'u' uint32, 's' string, 'x' blob
+  std::string data;
+};
+
+typedef std::map<std::string, myNvsValue> myNvsNamespace;
+
+static std::map<std::string, myNvsNamespace> __nvs;
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+  (void)partitionLabel;
+  if (_started) return false;
+  if (name == nullptr || strlen(name) > NVS_KEY_MAX_LEN) {
+    simTrace("nvs", "begin %s: namespace name too long", name ? name : "(null)");
+    return false;
+  }
+  if (readOnly && __nvs.find(name) == __nvs.end()) return false; // nvs_open: ESP_ERR_NVS_NOT_FOUND
+  __nvs[name];
+  _name = name;
+  _readOnly = readOnly;
+  _started = true;
+  return true;
+}
+
+void Preferences::end() {
+  _started = false;
+}
+
+bool Preferences::clear() {
+  if (!_started || _readOnly) return false;
+  __nvs[_name].clear();
+  __simCounts.nvsWrites++;
+  simTrace("nvs", "clear %s", _name.c_str());
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!_started || _readOnly || key == nullptr) return false;
+  if (__nvs[_name].erase(key) == 0) return false;
+  __simCounts.nvsWrites++;
+  simTrace("nvs", "remove %s/%s", _name.c_str(), key);
+  return true;
+}
+
+bool Preferences::isKey(const char* key) {
+  return _started && key != nullptr && __nvs[_name].count(key) != 0;
+}
+
+size_t Preferences::freeEntries() {
+  return _started ? 630 : 0; // 5 pages of 126 entries, the nvs partition of configuration/partitions.csv
+}
+
+size_t Preferences::put(const char* key, char type, const void* value, size_t len) {
+  if (!_started || _readOnly || key == nullptr) return 0;
+  if (strlen(key) > NVS_KEY_MAX_LEN) {
+    simTrace("nvs", "put %s/%s: key too long", _name.c_str(), key);
+    return 0;
+  }
+  myNvsValue& entry = __nvs[_name][key];
+  entry.type = type;
+  entry.data.assign((const char*)value, len);
+  __simCounts.nvsWrites++;
+  switch (type) {
+    case 'b': simTrace("nvs", "put %s/%s bool %u", _name.c_str(), key, *(const uint8_t*)value); break;
+    case 'i': simTrace("nvs", "put %s/%s i32 %d", _name.c_str(), key, *(const int32_t*)value); break;
+    case 'u': simTrace("nvs", "put %s/%s u32 %u", _name.c_str(), key, *(const uint32_t*)value); break;
+    default: {
+      char blob[48];
+      simFormatBlob(blob, sizeof(blob), value, len);
+      simTrace("nvs", "put %s/%s %s %s", _name.c_str(), key, type == 's' ? "str" : "blob", blob);
+    }
+  }
+  return len;
+}
+
+void simNvsPutBlob(const char* space, const char* key, const uint8_t* data, size_t len) {
+  myNvsValue& entry = __nvs[space][key];
+  entry.type = 'x';
+  entry.data.assign((const char*)data, len);
+}
+
+const std::string* Preferences::get(const char* key, char type) {
+  if (!_started || key == nullptr) return nullptr;
+  myNvsNamespace& space = __nvs[_name];
+  auto it = space.find(key);
+  if (it == space.end() || it->second.type != type) return nullptr;
+  return &it->second.data;
+}
+
+size_t Preferences::putBool(const char* key, bool value) {
+  uint8_t v = value;
+  return put(key, 'b', &v, 1);
+}
+
+size_t Preferences::putInt(const char* key, int32_t value) {
+  return put(key, 'i', &value, 4);
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  return put(key, 'u', &value, 4);
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  if (value == nullptr) return 0;
+  return put(key, 's', value, strlen(value));
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (value == nullptr || len == 0) return 0;
+  return put(key, 'x', value, len);
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+  const std::string* data = get(key, 'b');
+  return data ? (*data)[0] != 0 : defaultValue;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+  const std::string* data = get(key, 'i');
+  int32_t value = defaultValue;
+  if (data) memcpy(&value, data->data(), 4);
+  return value;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  const std::string* data = get(key, 'u');
+  uint32_t value = defaultValue;
+  if (data) memcpy(&value, data->data(), 4);
+  return value;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  const std::string* data = get(key, 's');
+  return data ? String(*data) : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  const std::string* data = get(key, 'x');
+  return data ? data->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  const std::string* data = get(key, 'x');
+  if (data == nullptr || buf == nullptr || data->size() > maxLen) return 0; // as the library, no partial read
+  memcpy(buf, data->data(), data->size());
+  return data->size();
+}
@@ -0,0 +1,130 @@
+/**
+ * @file AceButton.h
+ * @brief Host simulator stand-in: the event detection of bxparks/AceButton 1.10 the firmware relies on.
+ *
+ * @details check() follows the library: the first reading only initializes the button,
+ * Pressed on the press, LongPressed after the long press delay, RepeatPressed after the
+ * repeat delay and then every repeat interval, on the release Clicked / DoubleClicked if it
+ * was short and Released, or LongReleased instead with kFeatureSuppressAfterLongPress after
+ * a long press. Times are uint16_t milliseconds of getClock() as in the library. The
+ * debounce delay is honoured, the firmware sets it to 0 and debounces the edges itself.
+ */
+
+#ifndef SIM_ACEBUTTON_H
+#define SIM_ACEBUTTON_H
+
+#include <Arduino.h>
+
+namespace ace_button {
+
+class AceButton;
+
+class ButtonConfig {
+public:
+  typedef void (*EventHandler)(AceButton* button, uint8_t eventType, uint8_t buttonState);
+
+  static const uint16_t kFeatureClick = 0x01;
+  static const uint16_t kFeatureDoubleClick = 0x02;
+  static const uint16_t kFeatureLongPress = 0x04;
+  static const uint16_t kFeatureRepeatPress = 0x08;
+  static const uint16_t kFeatureSuppressAfterClick = 0x10;
+  static const uint16_t kFeatureSuppressAfterDoubleClick = 0x20;
+  static const uint16_t kFeatureSuppressAfterLongPress = 0x40;
+  static const uint16_t kFeatureSuppressAfterRepeatPress = 0x80;
+  static const uint16_t kFeatureSuppressClickBeforeDoubleClick = 0x100;
+
+  virtual ~ButtonConfig() {}
+
+  virtual unsigned long getClock() { return millis(); }
+  virtual int readButton(uint8_t pin) { return digitalRead(pin); }
+
+  void setEventHandler(EventHandler handler) { _handler = handler; }
+  EventHandler getEventHandler() const { return _handler; }
+  void setFeature(uint16_t feature) { _features |= feature; }
+  void clearFeature(uint16_t feature) { _features &= ~feature; }
+  bool isFeature(uint16_t feature) const { return _features & feature; }
+
+  void setDebounceDelay(uint16_t ms) { _debounceDelay = ms; }
+  void setClickDelay(uint16_t ms) { _clickDelay = ms; }
+  void setDoubleClickDelay(uint16_t ms) { _doubleClickDelay = ms; }
+  void setLongPressDelay(uint16_t ms) { _longPressDelay = ms; }
+  void setRepeatPressDelay(uint16_t ms) { _repeatPressDelay = ms; }
+  void setRepeatPressInterval(uint16_t ms) { _repeatPressInterval = ms; }
+  uint16_t getDebounceDelay() const { return _debounceDelay; }
+  uint16_t getClickDelay() const { return _clickDelay; }
+  uint16_t getDoubleClickDelay() const { return _doubleClickDelay; }
+  uint16_t getLongPressDelay() const { return _longPressDelay; }
+  uint16_t getRepeatPressDelay() const { return _repeatPressDelay; }
+  uint16_t getRepeatPressInterval() const { return _repeatPressInterval; }
+
+  static ButtonConfig* getSystemButtonConfig();
+
+private:
+  EventHandler _handler = nullptr;
+  uint16_t _features = 0;
+  uint16_t _debounceDelay = 20;
+  uint16_t _clickDelay = 200;
+  uint16_t _doubleClickDelay = 400;
+  uint16_t _longPressDelay = 1000;
+  uint16_t _repeatPressDelay = 1000;
+  uint16_t _repeatPressInterval = 200;
+};
+
+class AceButton {
+public:
+  static const uint8_t kEventPressed = 0;
+  static const uint8_t kEventReleased = 1;
+  static const uint8_t kEventClicked = 2;
+  static const uint8_t kEventDoubleClicked = 3;
+  static const uint8_t kEventLongPressed = 4;
+  static const uint8_t kEventRepeatPressed = 5;
+  static const uint8_t kEventLongReleased = 6;
+  static const uint8_t kButtonStateUnknown = 127;
+
+  explicit AceButton(uint8_t pin = 0, uint8_t defaultReleasedState = HIGH, uint8_t id = 0)
+    : AceButton(ButtonConfig::getSystemButtonConfig(), pin, defaultReleasedState, id) {}
+  explicit AceButton(ButtonConfig* buttonConfig, uint8_t pin = 0, uint8_t defaultReleasedState = HIGH, uint8_t id = 0)
+    : _config(buttonConfig) {
+    init(pin, defaultReleasedState, id);
+  }
+
+  void init(uint8_t pin = 0, uint8_t defaultReleasedState = HIGH, uint8_t id = 0);
+  void setButtonConfig(ButtonConfig* buttonConfig) { _config = buttonConfig; }
+  ButtonConfig* getButtonConfig() const { return _config; }
+  uint8_t getPin() const { return _pin; }
+  uint8_t getId() const { return _id; }
+  uint8_t getLastButtonState() const { return _lastState; }
+
+  // read the button and send the events that are due
+  void check();
+
+private:
+  bool isFeature(uint16_t feature) const { return _config->isFeature(feature); }
+  bool debounced(uint16_t now, uint8_t state);
+  void checkLongPress(uint16_t now);
+  void checkRepeatPress(uint16_t now);
+  void checkPressed(uint16_t now);
+  void checkReleased(uint16_t now);
+  void checkClicked(uint16_t now);
+  void handleEvent(uint8_t eventType);
+
+  ButtonConfig* _config;
+  uint8_t _pin = 0;
+  uint8_t _id = 0;
+  uint8_t _releasedState = HIGH;
+  uint8_t _lastState = kButtonStateUnknown;
+  uint8_t _debouncingState = kButtonStateUnknown;
+  bool _debouncing = false;
+  bool _pressed = false;
+  bool _longPressed = false;
+  bool _repeatPressed = false;
+  bool _clicked = false;
+  uint16_t _debounceStart = 0;
+  uint16_t _pressTime = 0;
+  uint16_t _repeatTime = 0;
+  uint16_t _clickTime = 0;
+};
+
+} // namespace ace_button
+
+#endif // SIM_ACEBUTTON_H
@@ -0,0 +1,118 @@
+/**
+ * @file Arduino.h
+ * @brief Host simulator stand-in: the Arduino-ESP32 core as far as the firmware uses it.
+ *
+ * @details millis(), micros() and delay() run on the virtual clock of sim_kernel.cpp. The
+ * GPIOs are levels set by the script, Serial prints go into the trace line by line and the
+ * script types into it. log_e, log_w and log_i go into the trace, log_d and log_v are
+ * compiled out as in the device build (CORE_DEBUG_LEVEL=3).
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "WString.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+typedef uint8_t byte;
+
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// ~ time ~
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void yield();
+
+// ~ GPIO ~
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// ~ log ~
+void simLog(char level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+#define log_e(format, ...) simLog('E', format, ##__VA_ARGS__)
+#define log_w(format, ...) simLog('W', format, ##__VA_ARGS__)
+#define log_i(format, ...) simLog('I', format, ##__VA_ARGS__)
+#define log_d(format, ...) do {} while (0)
+#define log_v(format, ...) do {} while (0)
+
+// ~ Serial ~
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(const String& str) { return write(str.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value) { return printf("%d", value); }
+  size_t print(unsigned value) { return printf("%u", value); }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(unsigned long value) { return printf("%lu", value); }
+  size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+  template <typename T>
+  size_t println(const T& value) { return print(value) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { (void)ms; }
+};
+
+// the lines printed go to the trace ("serial"), the script types into the receive buffer
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  explicit operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() {}
+};
+
+extern HardwareSerial Serial;
+
+// ~ chip ~
+class EspClass {
+public:
+  // calls the shutdown handlers and ends the run, the simulator does not boot again
+  [[noreturn]] void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac();
+};
+
+extern EspClass ESP;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,98 @@
+/**
+ * @file BLEDevice.h
+ * @brief Host simulator stand-in: the GATT server events of the BLE stack the firmware hooks into.
+ *
+ * @details The central of the script (sim_ble.cpp) raises the events with the parameters
+ * the firmware reads: ADD_CHAR of the MIDI characteristic, CONNECT with the connection
+ * interval, MTU, WRITE of the MIDI characteristic and of its notify descriptor, CONF once
+ * per notification and DISCONNECT.
+ */
+
+#ifndef SIM_BLEDEVICE_H
+#define SIM_BLEDEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  ESP_GATTS_REG_EVT = 0,
+  ESP_GATTS_READ_EVT = 1,
+  ESP_GATTS_WRITE_EVT = 2,
+  ESP_GATTS_EXEC_WRITE_EVT = 3,
+  ESP_GATTS_MTU_EVT = 4,
+  ESP_GATTS_CONF_EVT = 5,
+  ESP_GATTS_ADD_CHAR_EVT = 9,
+  ESP_GATTS_CONNECT_EVT = 14,
+  ESP_GATTS_DISCONNECT_EVT = 15,
+} esp_gatts_cb_event_t;
+
+typedef uint8_t esp_gatt_if_t;
+
+#define ESP_UUID_LEN_16 2
+#define ESP_UUID_LEN_128 16
+
+typedef struct {
+  uint16_t len;
+  union {
+    uint16_t uuid16;
+    uint32_t uuid32;
+    uint8_t uuid128[ESP_UUID_LEN_128];
+  } uuid;
+} esp_bt_uuid_t;
+
+typedef union {
+  struct {
+    uint16_t conn_id;
+    uint32_t trans_id;
+    uint8_t bda[6];
+    uint16_t handle;
+    uint16_t offset;
+    bool need_rsp;
+    bool is_prep;
+    uint16_t len;
+    uint8_t* value;
+  } write;
+  struct {
+    uint16_t conn_id;
+    uint16_t mtu;
+  } mtu;
+  struct {
+    int status;
+    uint16_t attr_handle;
+    uint16_t service_handle;
+    esp_bt_uuid_t char_uuid;
+  } add_char;
+  struct {
+    int status;
+    uint16_t conn_id;
+    uint16_t handle;
+    uint16_t len;
+    uint8_t* value;
+  } conf;
+  struct {
+    uint16_t conn_id;
+    uint8_t link_role;
+    uint8_t remote_bda[6];
+    struct {
+      uint16_t interval; // 1.25 ms units
+      uint16_t latency;
+      uint16_t timeout;  // 10 ms units
+    } conn_params;
+  } connect;
+  struct {
+    uint16_t conn_id;
+    uint8_t remote_bda[6];
+    int reason;
+  } disconnect;
+} esp_ble_gatts_cb_param_t;
+
+typedef void (*gatts_event_handler)(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
+
+class BLEDevice {
+public:
+  static void setCustomGattsHandler(gatts_event_handler handler);
+  static int setMTU(uint16_t mtu);
+  static uint16_t getMTU();
+};
+
+#endif // SIM_BLEDEVICE_H
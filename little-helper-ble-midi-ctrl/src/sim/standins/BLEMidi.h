@@ -0,0 +1,40 @@
+/**
+ * @file BLEMidi.h
+ * @brief Host simulator stand-in: BLEMidiServer of max22/ESP32-BLE-MIDI, recording every notification.
+ *
+ * @details sendPacket() is the notification of the MIDI characteristic: the packet goes into
+ * the trace ("midi") with the time it was sent and the central confirms it one connection
+ * interval later (ESP_GATTS_CONF_EVT). Without a connection the library drops the packet,
+ * the trace keeps it marked "not connected". The message helpers of the library are not
+ * used by the firmware and are left out.
+ */
+
+#ifndef SIM_BLEMIDI_H
+#define SIM_BLEMIDI_H
+
+#include <stdint.h>
+#include <string>
+
+class Midi {
+public:
+  virtual ~Midi() {}
+
+protected:
+  virtual void sendPacket(uint8_t* packet, uint8_t packetSize) = 0;
+};
+
+class BLEMidiServerClass : public Midi {
+public:
+  void begin(const std::string& deviceName);
+  bool isConnected();
+  void setOnConnectCallback(void (*callback)());
+  void setOnDisconnectCallback(void (*callback)());
+  void enableDebugging() {}
+
+protected:
+  void sendPacket(uint8_t* packet, uint8_t packetSize) override;
+};
+
+extern BLEMidiServerClass BLEMidiServer;
+
+#endif // SIM_BLEMIDI_H
@@ -0,0 +1,24 @@
+/**
+ * @file DNSServer.h
+ * @brief Host simulator stand-in: the captive portal DNS server, no client ever asks.
+ */
+
+#ifndef SIM_DNSSERVER_H
+#define SIM_DNSSERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+class DNSServer {
+public:
+  bool start(uint16_t port, const String& domainName, const IPAddress& resolvedIP) {
+    (void)port;
+    (void)domainName;
+    (void)resolvedIP;
+    return true;
+  }
+  void processNextRequest() {}
+  void stop() {}
+};
+
+#endif // SIM_DNSSERVER_H
@@ -0,0 +1,65 @@
+/**
+ * @file ESPUI.h
+ * @brief Host simulator stand-in: ESPUI without a web server, controls get ids and keep nothing else.
+ *
+ * @details The configurator builds its tree as on the device, so the ids of the controls
+ * and the field registry are the same. No browser connects, the callbacks are never called.
+ */
+
+#ifndef SIM_ESPUI_H
+#define SIM_ESPUI_H
+
+#include <Arduino.h>
+
+enum ControlType : uint8_t {
+  Title, Pad, PadWithCenter, Button, Label, Switcher, Slider, Number, Text, Graph, GraphPoint, Tab, Select, Option,
+  Min, Max, Step, Gauge, Accel, Separator, Time, UpdateOffset = 100
+};
+
+enum ControlColor : uint8_t { Turquoise, Emerald, Peterriver, Wetasphalt, Sunflower, Carrot, Alizarin, Dark, None = 0xFF };
+
+enum class Verbosity : uint8_t { Quiet = 0, Verbose, VerboseJSON };
+
+#define B_DOWN -1
+#define B_UP 1
+#define S_ACTIVE -7
+#define S_INACTIVE 7
+#define SL_VALUE 8
+#define N_VALUE 9
+#define T_VALUE 10
+#define S_VALUE 11
+
+class Control {
+public:
+  static const uint16_t noParent = 0xFFFF;
+  ControlType type;
+  uint16_t id;
+  const char* label;
+  String value;
+  ControlColor color;
+  uint16_t parentControl;
+};
+
+class ESPUIClass {
+public:
+  typedef void (*Callback)(Control* sender, int type);
+
+  uint16_t addControl(ControlType type, const char* label, const String& value = String(""),
+    ControlColor color = ControlColor::Turquoise, uint16_t parentControl = Control::noParent, Callback callback = nullptr);
+  void updateControlValue(uint16_t id, const String& value, int clientId = -1);
+  void updateControlValue(Control* control, const String& value, int clientId = -1);
+  void updateLabel(uint16_t id, const String& value) { updateControlValue(id, value); }
+  void setInputType(uint16_t id, const String& type) { (void)id; (void)type; }
+  void setPanelStyle(uint16_t id, const String& style, int clientId = -1) { (void)id; (void)style; (void)clientId; }
+  void setElementStyle(uint16_t id, const String& style, int clientId = -1) { (void)id; (void)style; (void)clientId; }
+  void setEnabled(uint16_t id, bool enabled = true, int clientId = -1) { (void)id; (void)enabled; (void)clientId; }
+  void setVerbosity(Verbosity verbosity) { (void)verbosity; }
+  void begin(const char* title, const char* username = nullptr, const char* password = nullptr, uint16_t port = 80);
+
+private:
+  uint16_t _controls = 0;
+};
+
+extern ESPUIClass ESPUI;
+
+#endif // SIM_ESPUI_H
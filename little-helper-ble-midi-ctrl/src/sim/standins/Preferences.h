@@ -0,0 +1,51 @@
+/**
+ * @file Preferences.h
+ * @brief Host simulator stand-in: Preferences on an NVS in RAM, every write goes into the trace.
+ *
+ * @details Keys are typed as in NVS, a get of another type than the key was put with finds
+ * nothing. begin() of a namespace that was never written fails read-only, as nvs_open()
+ * does. Every put, remove and clear is one "nvs" line of the trace, blobs and strings with
+ * their length and CRC32, the NVS is empty at the start of every run.
+ */
+
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+  size_t freeEntries();
+
+  size_t putBool(const char* key, bool value);
+  size_t putInt(const char* key, int32_t value);
+  size_t putUInt(const char* key, uint32_t value);
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+  bool getBool(const char* key, bool defaultValue = false);
+  int32_t getInt(const char* key, int32_t defaultValue = 0);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+  // a put of a value with its NVS type, false if read-only or not begun
+  size_t put(const char* key, char type, const void* value, size_t len);
+  // the value of a key with this type, nullptr if there is none
+  const std::string* get(const char* key, char type);
+
+  std::string _name;
+  bool _started = false;
+  bool _readOnly = false;
+};
+
+#endif // SIM_PREFERENCES_H
@@ -0,0 +1,60 @@
+/**
+ * @file WString.h
+ * @brief Host simulator stand-in: the Arduino String, the part the firmware uses, on std::string.
+ */
+
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+#include <stdlib.h>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char* str) : _str(str ? str : "") {}
+  String(const std::string& str) : _str(str) {}
+  explicit String(char c) : _str(1, c) {}
+  explicit String(int value) : _str(std::to_string(value)) {}
+  explicit String(unsigned value) : _str(std::to_string(value)) {}
+  explicit String(long value) : _str(std::to_string(value)) {}
+  explicit String(unsigned long value) : _str(std::to_string(value)) {}
+  explicit String(unsigned char value) : _str(std::to_string(value)) {}
+
+  const char* c_str() const { return _str.c_str(); }
+  unsigned length() const { return _str.size(); }
+  bool isEmpty() const { return _str.empty(); }
+  long toInt() const { return atol(_str.c_str()); }
+  int indexOf(char c, unsigned from = 0) const {
+    size_t pos = _str.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  String substring(unsigned from, unsigned to = ~0u) const {
+    if (from > _str.size()) return String();
+    return String(_str.substr(from, to < from ? 0 : to - from));
+  }
+  bool startsWith(const String& prefix) const { return _str.compare(0, prefix._str.size(), prefix._str) == 0; }
+  void trim() {
+    size_t begin = _str.find_first_not_of(" \t\r\n");
+    size_t end = _str.find_last_not_of(" \t\r\n");
+    _str = begin == std::string::npos ? std::string() : _str.substr(begin, end - begin + 1);
+  }
+  char operator[](unsigned i) const { return i < _str.size() ? _str[i] : 0; }
+
+  String& operator+=(const String& other) { _str += other._str; return *this; }
+  String& operator+=(const char* other) { _str += other ? other : ""; return *this; }
+  String& operator+=(char c) { _str += c; return *this; }
+
+  friend String operator+(const String& a, const String& b) { return String(a._str + b._str); }
+  friend String operator+(const String& a, const char* b) { return String(a._str + (b ? b : "")); }
+  friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b._str); }
+  friend bool operator==(const String& a, const String& b) { return a._str == b._str; }
+  friend bool operator==(const String& a, const char* b) { return a._str == (b ? b : ""); }
+  friend bool operator!=(const String& a, const String& b) { return a._str != b._str; }
+  friend bool operator!=(const String& a, const char* b) { return a._str != (b ? b : ""); }
+
+private:
+  std::string _str;
+};
+
+#endif // SIM_WSTRING_H
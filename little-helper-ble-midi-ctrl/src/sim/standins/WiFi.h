@@ -0,0 +1,50 @@
+/**
+ * @file WiFi.h
+ * @brief Host simulator stand-in: WiFi without a network, a station never connects, the hotspot starts.
+ */
+
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{ a, b, c, d } {}
+  uint8_t operator[](int i) const { return _bytes[i]; }
+  String toString() const {
+    char str[16];
+    snprintf(str, sizeof(str), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return String(str);
+  }
+
+private:
+  uint8_t _bytes[4] = { 0, 0, 0, 0 };
+};
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+class WiFiClass {
+public:
+  wl_status_t begin(const char* ssid, const char* password = nullptr);
+  wl_status_t status() { return _status; }
+  bool disconnect(bool wifiOff = false);
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode() { return _mode; }
+  bool setHostname(const char* hostname) { (void)hostname; return true; }
+  bool softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet);
+  bool softAP(const char* ssid, const char* password = nullptr);
+  IPAddress localIP() { return IPAddress(); }
+  IPAddress softAPIP() { return _apIP; }
+
+private:
+  wl_status_t _status = WL_IDLE_STATUS;
+  wifi_mode_t _mode = WIFI_OFF;
+  IPAddress _apIP;
+};
+
+extern WiFiClass WiFi;
+
+#endif // SIM_WIFI_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_log.h
+ * @brief Host simulator stand-in: the firmware logs with the log_x macros of Arduino.h only.
+ */
+
+#ifndef SIM_ESP_LOG_H
+#define SIM_ESP_LOG_H
+
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE } esp_log_level_t;
+
+static inline void esp_log_level_set(const char* tag, esp_log_level_t level) { (void)tag; (void)level; }
+
+#endif // SIM_ESP_LOG_H
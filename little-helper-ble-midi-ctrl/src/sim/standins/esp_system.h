@@ -0,0 +1,15 @@
+/**
+ * @file esp_system.h
+ * @brief Host simulator stand-in: shutdown handlers, called by ESP.restart() and at the end of a run.
+ */
+
+#ifndef SIM_ESP_SYSTEM_H
+#define SIM_ESP_SYSTEM_H
+
+#include "esp_err.h"
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler);
+
+#endif // SIM_ESP_SYSTEM_H
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Make a delta patch from one Little Helper firmware image to the next.
+
+    python3 tools/mkdelta.py ../bin/s3miniV7.bin ../bin/s3miniV8.bin [-o ../bin/s3miniV7-V8.patch]
+    python3 tools/mkdelta.py --all ../bin
+
+--all makes a patch for every pair of consecutive images s3miniV<N>.bin -> s3miniV<N+1>.bin
+in the directory. The device asks for s3miniV<running>-V<next>.patch next to the images
+and applies it while downloading, see lib/LittleHelperCore/src/delta_patch.h for the format.
+Every patch is applied again here and compared with the target before it is written.
+"""
+
+import argparse
+import hashlib
+import os
+import re
+import struct
+import sys
+import zlib
+
+MIN_MATCH = 12
+OP_END, OP_COPY, OP_INSERT = 0, 1, 2
+VERSION = 1
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value) << 1) - 1
+
+
+def diff(source, target):
+    """Greedy copy/insert: every MIN_MATCH window of the source is indexed, the target is
+    matched left to right and every match is extended as far as it goes. Continuing right
+    after the previous copy is preferred, it costs one byte of offset."""
+    index = {}
+    for i in range(len(source) - MIN_MATCH, -1, -1):
+        index[source[i:i + MIN_MATCH]] = i  # lowest offset wins
+    ops = []
+    pos = literal = 0
+    next_source = 0
+    while pos < len(target):
+        window = target[pos:pos + MIN_MATCH]
+        if len(window) == MIN_MATCH and source[next_source:next_source + MIN_MATCH] == window:
+            match = next_source
+        else:
+            match = index.get(window) if len(window) == MIN_MATCH else None
+        if match is None:
+            pos += 1
+            continue
+        length = MIN_MATCH
+        while pos + length < len(target) and match + length < len(source) and target[pos + length] == source[match + length]:
+            length += 1
+        if pos > literal:
+            ops.append((OP_INSERT, literal, pos))
+        ops.append((OP_COPY, match, length))
+        pos += length
+        literal = pos
+        next_source = match + length
+    if literal < len(target):
+        ops.append((OP_INSERT, literal, len(target)))
+    return ops
+
+
+def encode(source, target, ops):
+    header = b"LHDP" + bytes([VERSION, 0, 0, 0]) + struct.pack("<II", len(source), len(target))
+    header += hashlib.sha256(source).digest() + hashlib.sha256(target).digest()
+    header += struct.pack("<I", zlib.crc32(header) & 0xFFFFFFFF)
+    body = bytearray()
+    source_pos = 0
+    for op, a, b in ops:
+        if op == OP_COPY:
+            body += bytes([OP_COPY]) + varint(zigzag(a - source_pos)) + varint(b)
+            source_pos = a + b
+        else:
+            body += bytes([OP_INSERT]) + varint(b - a) + target[a:b]
+    body.append(OP_END)
+    return header + bytes(body)
+
+
+def apply(source, patch):
+    """Reference applier, the same steps as DeltaPatcher."""
+    if patch[:4] != b"LHDP" or zlib.crc32(patch[:80]) & 0xFFFFFFFF != struct.unpack("<I", patch[80:84])[0]:
+        raise ValueError("bad header")
+    target_size = struct.unpack("<I", patch[12:16])[0]
+    out = bytearray()
+    pos, source_pos = 84, 0
+
+    def read_varint():
+        nonlocal pos
+        value = shift = 0
+        while True:
+            byte = patch[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op == OP_COPY:
+            delta = read_varint()
+            offset = source_pos + ((delta >> 1) ^ -(delta & 1))
+            length = read_varint()
+            out += source[offset:offset + length]
+            source_pos = offset + length
+        elif op == OP_INSERT:
+            length = read_varint()
+            out += patch[pos:pos + length]
+            pos += length
+        else:
+            raise ValueError("bad op %d" % op)
+    if len(out) != target_size:
+        raise ValueError("wrong target size")
+    return bytes(out)
+
+
+def make(source_path, target_path, out_path):
+    with open(source_path, "rb") as f:
+        source = f.read()
+    with open(target_path, "rb") as f:
+        target = f.read()
+    patch = encode(source, target, diff(source, target))
+    if apply(source, patch) != target:
+        sys.exit("patch check failed for %s" % out_path)
+    with open(out_path, "wb") as f:
+        f.write(patch)
+    print("%s: %d bytes, %.1f%% of %s (%d bytes)" % (os.path.basename(out_path), len(patch),
+          100.0 * len(patch) / len(target), os.path.basename(target_path), len(target)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", nargs="?", help="image of the running version")
+    parser.add_argument("target", nargs="?", help="image of the next version")
+    parser.add_argument("-o", "--output", help="patch file, default <source>-V<n>.patch next to the images")
+    parser.add_argument("--all", metavar="DIR", help="patch every consecutive pair of s3miniV<N>.bin in DIR")
+    args = parser.parse_args()
+
+    if args.all:
+        versions = sorted(int(m.group(1)) for m in (re.match(r"^s3miniV(\d+)\.bin$", f) for f in os.listdir(args.all)) if m)
+        for version in versions:
+            if version + 1 in versions:
+                make(os.path.join(args.all, "s3miniV%d.bin" % version), os.path.join(args.all, "s3miniV%d.bin" % (version + 1)),
+                     os.path.join(args.all, "s3miniV%d-V%d.patch" % (version, version + 1)))
+        return
+    if not args.source or not args.target:
+        parser.error("source and target image, or --all DIR")
+    output = args.output
+    if not output:
+        target_version = re.search(r"V(\d+)\.bin$", args.target)
+        base = os.path.splitext(args.source)[0]
+        output = "%s-V%s.patch" % (base, target_version.group(1) if target_version else "next")
+    make(args.source, args.target, output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Build the macro record (macro_sequencer.h) from a text description of the macros.
+
+    python3 tools/mkmacros.py [configuration/macros.txt] [macros.bin]
+    curl --data-binary @macros.bin http://<device>/api/macros
+
+The description has one statement per line, # starts a comment:
+
+    macro 1                  the steps of macro 1 follow (1 .. MACRO_COUNT)
+    step 0 cc 112 127        right after the press: CC 112 value 127 on channel 1
+    step 50 ch 2 note 60 100 50 ms after the step before: note on 60 velocity 100, channel 2
+    step 200 mmc play        200 ms later: MMC play
+
+Messages: note <n> <velocity>, noteoff <n>, cc <n> <value>, pc <n>, mmc <stop|play|...>.
+A macro not described has no steps. The layout and limits come from the #defines of
+macro_sequencer.h and midi_action_table.h, the MMC names from button_config.h.
+"""
+
+import os
+import re
+import struct
+import sys
+import zlib
+
+
+def defines(*paths):
+    values = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                match = re.match(r"^#define\s+(\w+)\s+(\d+)\b", line)
+                if match:
+                    values[match.group(1)] = int(match.group(2))
+    return values
+
+
+def mmc_commands(path):
+    with open(path) as f:
+        return {name.lower(): int(value, 16) for name, value in re.findall(r"\bMMC_(\w+)\s*=\s*(0x[0-9A-Fa-f]+)", f.read())}
+
+
+class Description:
+    def __init__(self, v, mmc):
+        self.v = v
+        self.mmc = mmc
+        self.macros = [[] for _ in range(v["MACRO_COUNT"])]
+        self.current = None
+        self.line = 0
+
+    def fail(self, message):
+        sys.exit("line %d: %s" % (self.line, message))
+
+    def number(self, words, low, high):
+        if not words or not re.match(r"^\d+$", words[0]):
+            self.fail("number expected")
+        value = int(words.pop(0))
+        if not low <= value <= high:
+            self.fail("%d is not in %d..%d" % (value, low, high))
+        return value
+
+    def message(self, words):
+        channel = 0
+        if words and words[0].lower() == "ch":
+            words.pop(0)
+            channel = self.number(words, 1, 16) - 1
+        if not words:
+            self.fail("message expected")
+        kind = words.pop(0).lower()
+        if kind == "note":
+            data = [0x90 | channel, self.number(words, 0, 127), self.number(words, 0, 127)]
+        elif kind == "noteoff":
+            data = [0x80 | channel, self.number(words, 0, 127), 0]
+        elif kind == "cc":
+            data = [0xB0 | channel, self.number(words, 0, 127), self.number(words, 0, 127)]
+        elif kind == "pc":
+            data = [0xC0 | channel, self.number(words, 0, 127)]
+        elif kind == "mmc":
+            if not words or words[0].lower() not in self.mmc:
+                self.fail("mmc needs one of " + ", ".join(self.mmc))
+            data = [0xF0, 0x7F, 0x7F, 0x06, self.mmc[words.pop(0).lower()], 0xF7]
+        else:
+            self.fail("unknown message '%s'" % kind)
+        if words:
+            self.fail("unexpected '%s'" % " ".join(words))
+        return bytes(data)
+
+    def parse(self, text):
+        for self.line, line in enumerate(text.splitlines(), 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            statement = words.pop(0).lower()
+            if statement == "macro":
+                number = self.number(words, 1, len(self.macros))
+                if self.macros[number - 1]:
+                    self.fail("macro %d is described twice" % number)
+                self.current = self.macros[number - 1]
+            elif statement == "step":
+                if self.current is None:
+                    self.fail("step before the first macro")
+                if len(self.current) >= self.v["MACRO_MAX_STEPS"]:
+                    self.fail("more than %d steps" % self.v["MACRO_MAX_STEPS"])
+                delay = self.number(words, 0, 65535)
+                self.current.append((delay, self.message(words)))
+            else:
+                self.fail("unknown statement '%s'" % statement)
+
+
+def encode(v, macros):
+    record = bytes([ord("L"), ord("Q"), v["MACRO_RECORD_VERSION"], len(macros)])
+    for steps in macros:
+        record += bytes([len(steps)])
+        for delay, data in steps:
+            record += struct.pack("<HB", delay, len(data)) + data
+    return record + struct.pack("<I", zlib.crc32(record))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, "..")
+    source = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "configuration", "macros.txt")
+    target = sys.argv[2] if len(sys.argv) > 2 else "macros.bin"
+    core = os.path.join(root, "lib", "LittleHelperCore", "src")
+    v = defines(os.path.join(core, "macro_sequencer.h"), os.path.join(core, "midi_action_table.h"))
+
+    description = Description(v, mmc_commands(os.path.join(core, "button_config.h")))
+    with open(source) as f:
+        description.parse(f.read())
+    record = encode(v, description.macros)
+    with open(target, "wb") as f:
+        f.write(record)
+    print("%s: %d macros with steps, %d bytes" % (target, sum(1 for m in description.macros if m), len(record)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Write the update manifest for the Little Helper firmware images.
+
+    python3 tools/mkmanifest.py [../bin]
+
+Writes <dir>/s3mini.manifest for the highest s3miniV<N>.bin in the directory: version,
+size, SHA-256 and one delta line for every s3miniV<M>-V<N>.patch found (tools/mkdelta.py).
+Run it after adding a release and its patches, the device reads the manifest before it
+downloads anything, see lib/LittleHelperCore/src/update_manifest.h.
+"""
+
+import hashlib
+import os
+import re
+import sys
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    bin_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "..", "..", "bin")
+    files = os.listdir(bin_dir)
+    versions = [int(m.group(1)) for m in (re.match(r"^s3miniV(\d+)\.bin$", f) for f in files) if m]
+    if not versions:
+        sys.exit("no s3miniV<N>.bin in %s" % bin_dir)
+    latest = max(versions)
+    with open(os.path.join(bin_dir, "s3miniV%d.bin" % latest), "rb") as f:
+        image = f.read()
+
+    lines = ["# Little Helper update manifest, made by tools/mkmanifest.py",
+             "version %d" % latest,
+             "size %d" % len(image),
+             "sha256 %s" % hashlib.sha256(image).hexdigest()]
+    patches = []
+    for name in files:
+        match = re.match(r"^s3miniV(\d+)-V%d\.patch$" % latest, name)
+        if match:
+            patches.append((int(match.group(1)), name))
+    patches.sort()
+    for source, name in patches:
+        lines.append("delta %d %d" % (source, os.path.getsize(os.path.join(bin_dir, name))))
+
+    path = os.path.join(bin_dir, "s3mini.manifest")
+    with open(path, "w", newline="\n") as f:
+        f.write("\n".join(lines) + "\n")
+    print("%s: version %d, %d bytes, %d patch(es)" % (path, latest, len(image), len(patches)))
+
+
+if __name__ == "__main__":
+    main()
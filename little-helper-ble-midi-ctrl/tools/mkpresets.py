@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""Build the image of the read-only "presets" partition from a text description of the maps.
+
+    python3 tools/mkpresets.py [configuration/presets.txt] [presets.bin]
+
+The description has one statement per line, # starts a comment:
+
+    default ch 2 velocity 90       fields of the buttons that follow, until the next default
+    map 1                          the buttons of map 1 follow (maps count from 1 like the UI)
+    map 3-8                        the same buttons for the maps 3 to 8
+    button 1 cc 43 color Red       button 1 sends CC 43, a button not listed gets the defaults
+
+Button fields: note <0-127>, cc <0-127>, mmc <stop|play|...>, pc <program> [<bank msb> [<bank lsb>]]
+(the MIDI function and its value, a PC without bank sends no Bank Select), ch <1-16>, velocity, on, off <0-127> (CC values), push, toggle, release, longpress,
+macro <0-7> (0 = none, see tools/mkmacros.py), color <name of button_palette.h>. A map not described has no preset, the firmware uses its
+built in defaults for it.
+
+The records are encoded like encodeMap() in map_codec.cpp, the layout comes from the
+#defines of map_codec.h, preset_image.h and button_config.h. Write the image into the
+partition with the esptool command the script prints.
+"""
+
+import os
+import re
+import struct
+import sys
+import zlib
+
+
+def defines(*paths):
+    values = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                match = re.match(r"^#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b", line)
+                if match:
+                    values[match.group(1)] = int(match.group(2), 0)
+    return values
+
+
+def palette(path):
+    with open(path) as f:
+        return [name for name, _ in re.findall(r"\bX\((\w+),\s*0x([0-9A-Fa-f]{6})\)", f.read())]
+
+
+def mmc_commands(path):
+    with open(path) as f:
+        return {name.lower(): int(value, 16) for name, value in re.findall(r"\bMMC_(\w+)\s*=\s*(0x[0-9A-Fa-f]+)", f.read())}
+
+
+def partition_offset(path, name):
+    if not os.path.exists(path):
+        return None
+    with open(path) as f:
+        for line in f:
+            cells = [c.strip() for c in line.split("#")[0].split(",")]
+            if len(cells) >= 5 and cells[0] == name:
+                return int(cells[3], 0), int(cells[4], 0)
+    return None
+
+
+class Description:
+    FUNCTIONS = {"note": 0, "cc": 1, "mmc": 2, "pc": 3}
+
+    def __init__(self, colors, mmc, maps, buttons, bank_none):
+        self.colors = colors
+        self.bank_none = bank_none
+        self.mmc = mmc
+        self.max_maps = maps
+        self.buttons = buttons
+        self.defaults = {"function": 1, "macro": 0, "toggle": 0, "release": 0, "longpress": 0, "ch": 0, "mmc": mmc["stop"],
+                         "note": 60, "velocity": 100, "cc": 0, "on": 127, "off": 0, "color": colors.index("Blue")}
+        self.maps = {}
+        self.current = []
+        self.line = 0
+
+    def fail(self, message):
+        sys.exit("line %d: %s" % (self.line, message))
+
+    def number(self, words, low, high):
+        if not words or not re.match(r"^\d+$", words[0]):
+            self.fail("number expected")
+        value = int(words.pop(0))
+        if not low <= value <= high:
+            self.fail("%d is not in %d..%d" % (value, low, high))
+        return value
+
+    def fields(self, words, button):
+        while words:
+            key = words.pop(0).lower()
+            if key in ("note", "cc"):
+                button["function"] = self.FUNCTIONS[key]
+                button[key] = self.number(words, 0, 127)
+            elif key == "mmc":
+                if not words or words[0].lower() not in self.mmc:
+                    self.fail("mmc needs one of " + ", ".join(self.mmc))
+                button["function"] = self.FUNCTIONS["mmc"]
+                button["mmc"] = self.mmc[words.pop(0).lower()]
+            elif key == "pc":
+                # program in the CC field, Bank Select MSB / LSB in the CC values, 128 = not sent
+                button["function"] = self.FUNCTIONS["pc"]
+                button["cc"] = self.number(words, 0, 127)
+                button["on"] = button["off"] = self.bank_none
+                if words and words[0].isdigit():
+                    button["on"] = self.number(words, 0, 127)
+                    if words and words[0].isdigit():
+                        button["off"] = self.number(words, 0, 127)
+            elif key == "ch":
+                button["ch"] = self.number(words, 1, 16) - 1
+            elif key in ("velocity", "on", "off"):
+                button[key] = self.number(words, 0, 127)
+            elif key in ("push", "toggle"):
+                button["toggle"] = int(key == "toggle")
+            elif key in ("release", "longpress"):
+                button[key] = 1
+            elif key == "macro":
+                button["macro"] = self.number(words, 0, 7)
+            elif key == "color":
+                if not words or words[0] not in self.colors:
+                    self.fail("unknown color, use a name of button_palette.h")
+                button["color"] = self.colors.index(words.pop(0))
+            else:
+                self.fail("unknown field '%s'" % key)
+
+    def parse(self, text):
+        for self.line, line in enumerate(text.splitlines(), 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            statement = words.pop(0).lower()
+            if statement == "default":
+                self.fields(words, self.defaults)
+            elif statement == "map":
+                match = re.match(r"^(\d+)(?:-(\d+))?$", words[0] if len(words) == 1 else "")
+                if not match:
+                    self.fail("map <n> or map <first>-<last> expected")
+                first = int(match.group(1))
+                last = int(match.group(2) or first)
+                if not 1 <= first <= last <= self.max_maps:
+                    self.fail("maps are 1..%d" % self.max_maps)
+                self.current = list(range(first - 1, last))
+                for m in self.current:
+                    if m in self.maps:
+                        self.fail("map %d is described twice" % (m + 1))
+                    self.maps[m] = [dict(self.defaults) for _ in range(self.buttons)]
+            elif statement == "button":
+                if not self.current:
+                    self.fail("button before the first map")
+                b = self.number(words, 1, self.buttons) - 1
+                button = dict(self.defaults)
+                self.fields(words, button)
+                for m in self.current:
+                    self.maps[m][b] = dict(button)
+            else:
+                self.fail("unknown statement '%s'" % statement)
+
+
+def encode_map(v, index, buttons):
+    payload = bytearray()
+    for b in buttons:
+        flags = (v["MAP_FLAG_RELEASE"] if b["release"] else 0) | (v["MAP_FLAG_LONGPRESS"] if b["longpress"] else 0) \
+            | (v["MAP_FLAG_TOGGLE"] if b["toggle"] else 0) | (b["function"] << v["MAP_FLAG_MIDI_SHIFT"]) \
+            | (b["macro"] << v["MAP_FLAG_MACRO_SHIFT"])
+        fields = [0] * v["MAP_CODEC_BUTTON_SIZE"]
+        fields[v["MAP_FIELD_FLAGS"]] = flags
+        fields[v["MAP_FIELD_CHANNEL"]] = b["ch"] | (b["mmc"] << v["MAP_MMC_SHIFT"])
+        fields[v["MAP_FIELD_NOTE"]] = b["note"]
+        fields[v["MAP_FIELD_VELOCITY"]] = b["velocity"]
+        fields[v["MAP_FIELD_CC"]] = b["cc"]
+        fields[v["MAP_FIELD_CC_ON"]] = b["on"]
+        fields[v["MAP_FIELD_CC_OFF"]] = b["off"]
+        fields[v["MAP_FIELD_COLOR"]] = b["color"]
+        payload += bytes(fields)
+    record = bytes([ord("L"), ord("M"), v["MAP_CODEC_VERSION"], index, len(buttons), v["MAP_CODEC_BUTTON_SIZE"]])
+    record += struct.pack("<H", len(payload)) + payload
+    return record + struct.pack("<I", zlib.crc32(record))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, "..")
+    source = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "configuration", "presets.txt")
+    target = sys.argv[2] if len(sys.argv) > 2 else "presets.bin"
+    core = os.path.join(root, "lib", "LittleHelperCore", "src")
+    v = defines(os.path.join(core, "map_codec.h"), os.path.join(core, "preset_image.h"), os.path.join(core, "button_config.h"))
+    buttons = 5  # __HW_BUTTONS
+
+    description = Description(palette(os.path.join(core, "button_palette.h")),
+                              mmc_commands(os.path.join(core, "button_config.h")), v["NUBER_OF_MAPS"], buttons,
+                              v["PC_BANK_NONE"])
+    with open(source) as f:
+        description.parse(f.read())
+    if not description.maps:
+        sys.exit("%s: no map described" % source)
+
+    # slots up to the last described map, the maps after it have no preset
+    slot = v["PRESET_SLOT_SIZE"]
+    count = max(description.maps) + 1
+    slots = bytearray(b"\xff" * (slot * count))
+    for m, described in description.maps.items():
+        record = encode_map(v, m, described)
+        slots[m * slot:m * slot + len(record)] = record
+    header = bytes([ord("L"), ord("P"), v["PRESET_IMAGE_VERSION"], 0xFF])
+    header += struct.pack("<HHI", count, slot, v["PRESET_HEADER_SIZE"] + len(slots))
+    header += struct.pack("<I", zlib.crc32(header))
+    header += b"\xff" * (v["PRESET_HEADER_SIZE"] - len(header))
+    image = header + slots
+
+    partition = partition_offset(os.path.join(root, "configuration", "partitions.csv"), "presets")
+    if partition and len(image) > partition[1]:
+        sys.exit("%d bytes do not fit into the presets partition of %d bytes" % (len(image), partition[1]))
+    with open(target, "wb") as f:
+        f.write(image)
+    print("%s: %d maps with a preset, %d slots, %d bytes" % (target, len(description.maps), count, len(image)))
+    if partition:
+        print("flash with: esptool.py --chip esp32s3 write_flash 0x%x %s" % (partition[0], target))
+
+
+if __name__ == "__main__":
+    main()
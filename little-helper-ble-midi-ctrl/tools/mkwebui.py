@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Build the lite configurator page into a header for the firmware.
+
+    python3 tools/mkwebui.py [web/index.html] [include/webui_page.h]
+
+Fills the {{NAME}} values of the page from the #defines of map_codec.h and button_config.h
+and {{BUTTON_PALETTE}} from the color list of button_palette.h, drops indentation and comment lines, gzips it and writes it as a C array with its size and
+ETag. Run it after changing web/index.html or the map record layout and commit both files.
+"""
+
+import gzip
+import os
+import re
+import sys
+import zlib
+
+
+def defines(*paths):
+    values = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                match = re.match(r"^#define\s+(\w+)\s+(\d+)\b", line)
+                if match:
+                    values[match.group(1)] = match.group(2)
+    return values
+
+
+def palette(path):
+    with open(path) as f:
+        colors = re.findall(r"\bX\((\w+),\s*0x([0-9A-Fa-f]{6})\)", f.read())
+    return "[" + ",".join('["%s","%s"]' % (name, rgb.lower()) for name, rgb in colors) + "]"
+
+
+def minify(html):
+    lines = []
+    in_comment = False
+    for line in html.splitlines():
+        line = line.strip()
+        if line.startswith("<!--"):
+            in_comment = "-->" not in line
+            continue
+        if in_comment:
+            in_comment = "-->" not in line
+            continue
+        if line and not line.startswith("// "):
+            lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, "..")
+    source = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "web", "index.html")
+    target = sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, "include", "webui_page.h")
+    core = os.path.join(root, "lib", "LittleHelperCore", "src")
+    values = defines(os.path.join(core, "map_codec.h"), os.path.join(core, "button_config.h"))
+    values["BUTTON_PALETTE"] = palette(os.path.join(core, "button_palette.h"))
+
+    with open(source) as f:
+        html = f.read()
+
+    def fill(match):
+        if match.group(1) not in values:
+            sys.exit("%s: unknown value {{%s}}" % (source, match.group(1)))
+        return values[match.group(1)]
+
+    page = minify(re.sub(r"\{\{(\w+)\}\}", fill, html)).encode()
+    packed = gzip.compress(page, compresslevel=9, mtime=0)
+    etag = "%08x" % zlib.crc32(packed)
+
+    out = ["// generated by tools/mkwebui.py from web/index.html, do not edit",
+           "",
+           "#ifndef WEBUI_PAGE_H",
+           "#define WEBUI_PAGE_H",
+           "",
+           "#include <stdint.h>",
+           "#ifndef PROGMEM",
+           "#define PROGMEM",
+           "#endif",
+           "",
+           "#define WEBUI_PAGE_SIZE %d      // gzip" % len(packed),
+           "#define WEBUI_PAGE_RAW_SIZE %d" % len(page),
+           "#define WEBUI_PAGE_ETAG \"\\\"%s\\\"\"" % etag,
+           "// map record layout the page was built for, checked against map_codec.h",
+           "#define WEBUI_MAP_CODEC_VERSION %s" % values["MAP_CODEC_VERSION"],
+           "#define WEBUI_MAP_CODEC_BUTTON_SIZE %s" % values["MAP_CODEC_BUTTON_SIZE"],
+           "",
+           "const uint8_t WEBUI_PAGE[] PROGMEM = {"]
+    for i in range(0, len(packed), 16):
+        out.append("  " + ", ".join("0x%02x" % b for b in packed[i:i + 16]) + ",")
+    out += ["};", "", "#endif // WEBUI_PAGE_H", ""]
+    with open(target, "w", newline="\n") as f:
+        f.write("\n".join(out))
+    print("%s: %d bytes, %d gzip, ETag %s" % (os.path.normpath(target), len(page), len(packed), etag))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Local stand-in for the GitHub OTA download of the Little Helper.
+
+Serves the firmware images in bin/ (s3miniV*.bin) under the same path the firmware
+requests from raw.githubusercontent.com, so OTA throughput and resume can be measured
+and tuned on the bench. <image>.sha256 is served with the SHA-256 of the image, Range
+requests are answered with 206 Partial Content. Delta patches made by tools/mkdelta.py
+(s3miniV<N>-V<N+1>.patch) and the manifest of tools/mkmanifest.py (s3mini.manifest) are
+served from the same directory. Build the firmware with
+
+    build_flags = ... -DOTA_SERVER=\\"http://<this pc>:8000\\"
+
+and start
+
+    python3 tools/ota_server.py [--port 8000] [--bin ../bin] [--rate 0] [--chunk 1460]
+                                [--drop-after 0] [--drop-rate 0] [--no-range]
+
+--rate limits the send rate in KB/s (0 = unlimited) to mimic a slow network, --chunk
+is the size of each socket write. A flaky link is mimicked by --drop-after (close every
+connection after this many KB) and --drop-rate (chance to close the connection after
+each chunk). --no-range ignores Range headers like a server without resume support.
+Every transfer is logged with its range, time and KB/s.
+"""
+
+import argparse
+import hashlib
+import http.server
+import os
+import random
+import re
+import socketserver
+import time
+
+IMAGE_PATH = re.compile(r"^/(?:.*/)?(s3miniV\d+\.bin|s3miniV\d+-V\d+\.patch|s3mini\.manifest)(\.sha256)?$")
+RANGE = re.compile(r"^bytes=(\d+)-(\d*)$")
+
+
+class OtaHandler(http.server.BaseHTTPRequestHandler):
+    bin_dir = "."
+    rate = 0
+    chunk = 1460
+    drop_after = 0
+    drop_rate = 0.0
+    use_range = True
+
+    def do_GET(self):
+        match = IMAGE_PATH.match(self.path)
+        path = os.path.join(self.bin_dir, match.group(1)) if match else None
+        if path is None or not os.path.isfile(path):
+            self.send_error(404, "no such image")
+            return
+        if match.group(2):
+            self.send_hash(path)
+            return
+
+        size = os.path.getsize(path)
+        first, last = 0, size - 1
+        partial = False
+        requested = RANGE.match(self.headers.get("Range", ""))
+        if requested and self.use_range:
+            first = int(requested.group(1))
+            if requested.group(2):
+                last = min(int(requested.group(2)), size - 1)
+            if first > last:
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % size)
+                self.end_headers()
+                return
+            partial = True
+
+        length = last - first + 1
+        self.send_response(206 if partial else 200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(length))
+        self.send_header("Accept-Ranges", "bytes")
+        if partial:
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (first, last, size))
+        self.end_headers()
+
+        sent = 0
+        dropped = False
+        start = time.monotonic()
+        with open(path, "rb") as image:
+            image.seek(first)
+            while sent < length:
+                data = image.read(min(self.chunk, length - sent))
+                if not data:
+                    break
+                if self.drop_after and sent + len(data) > self.drop_after * 1024:
+                    data = data[:max(self.drop_after * 1024 - sent, 0)]
+                    dropped = True
+                try:
+                    self.wfile.write(data)
+                except (BrokenPipeError, ConnectionResetError):
+                    break
+                sent += len(data)
+                if dropped or (self.drop_rate and random.random() < self.drop_rate):
+                    dropped = True
+                    break
+                if self.rate > 0:
+                    due = start + sent / (self.rate * 1024.0)
+                    delay = due - time.monotonic()
+                    if delay > 0:
+                        time.sleep(delay)
+        if dropped:
+            self.close_connection = True
+            self.connection.shutdown(2)  # the client sees the connection drop mid body
+        seconds = max(time.monotonic() - start, 1e-6)
+        self.log_message("%s: bytes %d-%d of %d, sent %d in %.2f s, %.1f KB/s%s",
+                         match.group(1), first, last, size, sent, seconds, sent / 1024.0 / seconds,
+                         ", dropped" if dropped else "")
+
+    def send_hash(self, path):
+        with open(path, "rb") as image:
+            body = (hashlib.sha256(image.read()).hexdigest() + "\n").encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+class ThreadingServer(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--bin", default=os.path.join(here, "..", "..", "bin"), help="directory of the s3miniV*.bin images and patches")
+    parser.add_argument("--rate", type=float, default=0, help="send rate limit in KB/s, 0 = unlimited")
+    parser.add_argument("--chunk", type=int, default=1460, help="bytes per socket write")
+    parser.add_argument("--drop-after", type=int, default=0, help="close every connection after this many KB, 0 = never")
+    parser.add_argument("--drop-rate", type=float, default=0, help="chance to close the connection after each chunk")
+    parser.add_argument("--no-range", action="store_true", help="ignore Range requests")
+    args = parser.parse_args()
+
+    OtaHandler.bin_dir = os.path.abspath(args.bin)
+    OtaHandler.rate = args.rate
+    OtaHandler.chunk = max(args.chunk, 1)
+    OtaHandler.drop_after = args.drop_after
+    OtaHandler.drop_rate = args.drop_rate
+    OtaHandler.use_range = not args.no_range
+    images = sorted(f for f in os.listdir(OtaHandler.bin_dir) if IMAGE_PATH.match("/" + f))
+    print("serving %s from %s on port %d" % (", ".join(images) or "no images", OtaHandler.bin_dir, args.port))
+    ThreadingServer(("", args.port), OtaHandler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()